@@ -93,6 +93,59 @@ function(lgd_generate_sourcelists relative_dir)
   endif(RAW_SOURCES OR RAW_HEADERS)
 endfunction(lgd_generate_sourcelists)
 
+# compiles source once for each instruction set in ARGN (SSE4_1, AVX,
+# AVX2, AVX512F) and appends the resulting objects to the list
+# sources_var. Kernels register themselves via
+# LIBGEODECOMP_REGISTER_ISA_VARIANT, see ISADispatcher. Each variant
+# is prelinked and all of its hidden symbols get localized so that
+# the linker won't merge the inline functions and template instances
+# which the variants share by name, but not by code. Without
+# WITH_ISA_DISPATCH source is simply appended, i.e. compiled once
+# with the default flags.
+function(lgd_add_isa_variants sources_var source)
+  if(NOT WITH_ISA_DISPATCH)
+    set(${sources_var} ${${sources_var}} ${source} PARENT_SCOPE)
+    return()
+  endif()
+
+  file(RELATIVE_PATH variant_prefix "${CMAKE_SOURCE_DIR}" "${CMAKE_CURRENT_SOURCE_DIR}/${source}")
+  string(REGEX REPLACE "[^A-Za-z0-9_]" "_" variant_prefix "${variant_prefix}")
+  set(objects)
+
+  foreach(isa ${ARGN})
+    if(isa STREQUAL "SSE4_1")
+      set(isa_flags -march=nehalem)
+    elseif(isa STREQUAL "AVX")
+      set(isa_flags -march=sandybridge)
+    elseif(isa STREQUAL "AVX2")
+      set(isa_flags -march=haswell)
+    elseif(isa STREQUAL "AVX512F")
+      set(isa_flags -march=skylake-avx512)
+    else()
+      message(FATAL_ERROR "lgd_add_isa_variants: unknown instruction set ${isa}")
+    endif()
+
+    # a later -march overrides -march=native from the default flags:
+    set(variant ${variant_prefix}_${isa})
+    set(object "${CMAKE_CURRENT_BINARY_DIR}/${variant}.o")
+    add_library(${variant} OBJECT ${source})
+    set_target_properties(${variant} PROPERTIES COMPILE_FLAGS
+      "${isa_flags} -mtune=generic -fvisibility=hidden -fvisibility-inlines-hidden")
+
+    add_custom_command(
+      OUTPUT "${object}"
+      COMMAND ${CMAKE_LINKER} -r --force-group-allocation -o "${object}" $<TARGET_OBJECTS:${variant}>
+      COMMAND ${CMAKE_OBJCOPY} --localize-hidden "${object}"
+      DEPENDS ${variant} $<TARGET_OBJECTS:${variant}>
+      COMMENT "Localizing symbols of ${isa} variant of ${source}"
+      VERBATIM)
+    set_source_files_properties("${object}" PROPERTIES EXTERNAL_OBJECT true GENERATED true)
+    list(APPEND objects "${object}")
+  endforeach(isa)
+
+  set(${sources_var} ${${sources_var}} ${objects} PARENT_SCOPE)
+endfunction(lgd_add_isa_variants)
+
 # creates a string constant from a source file, handy for e.g.
 # just-in-time compilation of OpenCL kernels
 function(lgd_escape_kernel outfile infile)
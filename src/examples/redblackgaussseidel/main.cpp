@@ -3,6 +3,7 @@
  * solving a heat transfer problem with Dirichlet-boundary cells
  */
 #include <libgeodecomp.h>
+#include <libgeodecomp/communication/mpidatatypebuilder.h>
 #include <libgeodecomp/io/collectingwriter.h>
 #include <libgeodecomp/io/simpleinitializer.h>
 #include <libgeodecomp/io/ppmwriter.h>
@@ -23,7 +24,7 @@ public:
     class API :
         public APITraits::HasStencil<Stencils::VonNeumann<2, 1> >,
         public APITraits::HasNanoSteps<2>,
-        public APITraits::HasOpaqueMPIDataType<Cell>
+        public APITraits::HasRegisteredMPIDataType
     {};
 
     explicit
@@ -60,6 +61,8 @@ public:
 
 };
 
+LIBGEODECOMP_REGISTER_MPI_DATATYPE(Cell, ((double)(temp))((CellType)(type)))
+
 /**
  * range x=[0;1] y[0;1]
  *
@@ -0,0 +1,81 @@
+#ifndef LIBGEODECOMP_EXAMPLES_SPMVMVECTORIZED_CELL_H
+#define LIBGEODECOMP_EXAMPLES_SPMVMVECTORIZED_CELL_H
+
+#include <libgeodecomp/misc/apitraits.h>
+#include <libgeodecomp/parallelization/monolithicsimulator.h>
+
+#include <libflatarray/api_traits.hpp>
+#include <libflatarray/macros.hpp>
+#include <libflatarray/short_vec.hpp>
+
+using namespace LibGeoDecomp;
+using namespace LibFlatArray;
+
+// defining settings for SELL-C-q
+typedef double ValueType;
+static const std::size_t MATRICES = 1;
+static const int C = 4;
+static const int SIGMA = 1;
+typedef short_vec<ValueType, C> ShortVec;
+
+class Cell
+{
+public:
+    class API :
+        public APITraits::HasUpdateLineX,
+        public APITraits::HasSoA,
+        public APITraits::HasUnstructuredTopology,
+        public APITraits::HasPredefinedMPIDataType<double>,
+        public APITraits::HasSellType<ValueType>,
+        public APITraits::HasSellMatrices<MATRICES>,
+        public APITraits::HasSellC<C>,
+        public APITraits::HasSellSigma<SIGMA>,
+        public LibFlatArray::api_traits::has_default_1d_sizes
+    {};
+
+    inline explicit Cell(double v = 0) :
+        value(v), sum(0)
+    {}
+
+    template<typename HOOD_NEW, typename HOOD_OLD>
+    static void updateLineX(HOOD_NEW& hoodNew, int indexEnd, HOOD_OLD& hoodOld, unsigned /* nanoStep */)
+    {
+        for (; hoodNew.index() < indexEnd; hoodNew += C, ++hoodOld) {
+            ShortVec tmp;
+            tmp.load_aligned(&hoodNew->sum());
+
+            for (const auto& j: hoodOld.weights(0)) {
+                ShortVec weights;
+                ShortVec values;
+                weights.load_aligned(j.second());
+                values.gather(&hoodOld->value(), j.first());
+                tmp += values * weights;
+            }
+
+            tmp.store_aligned(&hoodNew->sum());
+        }
+    }
+
+    inline bool operator==(const Cell& cell) const
+    {
+        return (cell.sum == sum) && (cell.value == value);
+    }
+
+    inline bool operator!=(const Cell& cell) const
+    {
+        return !(*this == cell);
+    }
+
+    double value;
+    double sum;
+};
+
+LIBFLATARRAY_REGISTER_SOA(Cell, ((double)(sum))((double)(value)))
+
+/**
+ * Signature of the simulator factory in kernel.cpp, which gets
+ * compiled once per instruction set. See ISADispatcher.
+ */
+typedef MonolithicSimulator<Cell> *SimulatorFactory(Initializer<Cell> *initializer);
+
+#endif
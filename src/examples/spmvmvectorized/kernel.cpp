@@ -0,0 +1,17 @@
+#include <libgeodecomp/misc/isadispatcher.h>
+#include <libgeodecomp/parallelization/serialsimulator.h>
+#include <libgeodecomp/storage/unstructuredsoagrid.h>
+
+#include "cell.h"
+
+// This file is built for multiple instruction sets (see
+// lgd_add_isa_variants() in CMakeLists.txt). Everything which
+// instantiates the Cell's updateLineX() -- i.e. the simulator and
+// its grids -- needs to be created in here so that it picks up this
+// variant's short_vec implementation.
+MonolithicSimulator<Cell> *buildSimulator(Initializer<Cell> *initializer)
+{
+    return new SerialSimulator<Cell>(initializer);
+}
+
+LIBGEODECOMP_REGISTER_ISA_VARIANT("spmvmvectorized", buildSimulator)
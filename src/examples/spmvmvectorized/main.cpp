@@ -1,5 +1,6 @@
 #include <cstdlib>
 #include <cmath>
+#include <iostream>
 #include <map>
 #include <fstream>
 #include <string>
@@ -8,79 +9,13 @@
 #include <libgeodecomp.h>
 #include <libgeodecomp/io/tracingwriter.h>
 #include <libgeodecomp/io/asciiwriter.h>
+#include <libgeodecomp/io/logger.h>
 #include <libgeodecomp/io/simpleinitializer.h>
-#include <libgeodecomp/misc/apitraits.h>
-#include <libgeodecomp/parallelization/serialsimulator.h>
+#include <libgeodecomp/misc/isadispatcher.h>
 #include <libgeodecomp/storage/unstructuredsoagrid.h>
 #include <libgeodecomp/io/sellsortingwriter.h>
 
-#include <libflatarray/api_traits.hpp>
-#include <libflatarray/macros.hpp>
-#include <libflatarray/short_vec.hpp>
-
-using namespace LibGeoDecomp;
-using namespace LibFlatArray;
-
-// defining settings for SELL-C-q
-typedef double ValueType;
-static const std::size_t MATRICES = 1;
-static const int C = 4;
-static const int SIGMA = 1;
-typedef short_vec<ValueType, C> ShortVec;
-
-class Cell
-{
-public:
-    class API :
-        public APITraits::HasUpdateLineX,
-        public APITraits::HasSoA,
-        public APITraits::HasUnstructuredTopology,
-        public APITraits::HasPredefinedMPIDataType<double>,
-        public APITraits::HasSellType<ValueType>,
-        public APITraits::HasSellMatrices<MATRICES>,
-        public APITraits::HasSellC<C>,
-        public APITraits::HasSellSigma<SIGMA>,
-        public LibFlatArray::api_traits::has_default_1d_sizes
-    {};
-
-    inline explicit Cell(double v = 0) :
-        value(v), sum(0)
-    {}
-
-    template<typename HOOD_NEW, typename HOOD_OLD>
-    static void updateLineX(HOOD_NEW& hoodNew, int indexEnd, HOOD_OLD& hoodOld, unsigned /* nanoStep */)
-    {
-        for (; hoodNew.index() < indexEnd; hoodNew += C, ++hoodOld) {
-            ShortVec tmp;
-            tmp.load_aligned(&hoodNew->sum());
-
-            for (const auto& j: hoodOld.weights(0)) {
-                ShortVec weights;
-                ShortVec values;
-                weights.load_aligned(j.second());
-                values.gather(&hoodOld->value(), j.first());
-                tmp += values * weights;
-            }
-
-            tmp.store_aligned(&hoodNew->sum());
-        }
-    }
-
-    inline bool operator==(const Cell& cell) const
-    {
-        return (cell.sum == sum) && (cell.value == value);
-    }
-
-    inline bool operator!=(const Cell& cell) const
-    {
-        return !(*this == cell);
-    }
-
-    double value;
-    double sum;
-};
-
-LIBFLATARRAY_REGISTER_SOA(Cell, ((double)(sum))((double)(value)))
+#include "cell.h"
 
 class CellInitializerDiagonal : public SimpleInitializer<Cell>
 {
@@ -191,17 +126,24 @@ void runSimulation(int argc, char *argv[])
     } else {
         init = new CellInitializerDiagonal(steps);
     }
-    SerialSimulator<Cell> sim(init);
-    sim.addWriter(new TracingWriter<Cell>(outputFrequency, init->maxSteps()));
+
+    // pick the variant of the kernel for the widest instruction set
+    // available on this CPU:
+    LOG(Logger::INFO, "running " << CPUFeatures::name(ISADispatcher::select("spmvmvectorized"))
+        << " variant of the SELL-C-sigma kernel");
+    SimulatorFactory *buildSimulator = ISADispatcher::get<SimulatorFactory>("spmvmvectorized");
+    SharedPtr<MonolithicSimulator<Cell> >::Type sim(buildSimulator(init));
+
+    sim->addWriter(new TracingWriter<Cell>(outputFrequency, init->maxSteps()));
     if (SIGMA == 1) {
-        sim.addWriter(new ASCIIWriter<Cell>("sum", &Cell::sum, outputFrequency));
+        sim->addWriter(new ASCIIWriter<Cell>("sum", &Cell::sum, outputFrequency));
     } else {
         // fixme
         // auto asciiWriter = new ASCIIWriter<Cell>("sum", &Cell::sum, outputFrequency);
         // sim.addWriter(new SellSortingWriter<Cell, ASCIIWriter<Cell> >(
         //                   asciiWriter, 0, "sum", &Cell::sum, outputFrequency));
     }
-    sim.run();
+    sim->run();
 }
 
 int main(int argc, char *argv[])
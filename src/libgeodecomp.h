@@ -4,6 +4,7 @@
 
 #if defined (LIBGEODECOMP_WITH_HPX) || defined (LIBGEODECOMP_WITH_MPI)
 #include <libgeodecomp/geometry/partitions/checkerboardingpartition.h>
+#include <libgeodecomp/geometry/partitions/hilbertcurvepartition.h>
 #include <libgeodecomp/geometry/partitions/recursivebisectionpartition.h>
 #include <libgeodecomp/geometry/partitions/zcurvepartition.h>
 #endif
@@ -16,6 +17,7 @@
 #ifdef LIBGEODECOMP_WITH_MPI
 #include <mpi.h>
 #include <libgeodecomp/io/collectingwriter.h>
+#include <libgeodecomp/io/metricswriter.h>
 #include <libgeodecomp/io/parallelwriter.h>
 #include <libgeodecomp/parallelization/hiparsimulator.h>
 #endif
@@ -58,5 +60,6 @@
 #include <libgeodecomp/storage/simplefilter.h>
 #include <libgeodecomp/storage/passthroughcontainer.h>
 #include <libgeodecomp/storage/unstructuredlooppeeler.h>
+#include <libgeodecomp/storage/verletboxcell.h>
 
 #endif
@@ -0,0 +1,320 @@
+#ifndef LIBGEODECOMP_COMMUNICATION_MPIDATATYPEBUILDER_H
+#define LIBGEODECOMP_COMMUNICATION_MPIDATATYPEBUILDER_H
+
+#include <libgeodecomp/config.h>
+
+#include <libflatarray/flat_array.hpp>
+
+#ifdef LIBGEODECOMP_WITH_MPI
+
+#include <libgeodecomp/communication/typemaps.h>
+
+#include <mpi.h>
+#include <algorithm>
+#include <type_traits>
+#include <vector>
+
+namespace LibGeoDecomp {
+
+/**
+ * Holds the member list of a cell class, as registered via
+ * LIBGEODECOMP_REGISTER_MPI_DATATYPE. Members need to be accessible
+ * to this class, so private members require a friend declaration.
+ */
+template<typename CELL>
+class MPIDataTypeMembers;
+
+namespace MPIDataTypeBuilderHelpers {
+
+/**
+ * Yields the MPI datatype and element count for a single member.
+ * Enums are transferred as raw bytes, all other types are looked up
+ * in Typemaps. Specialize this template to add support for custom
+ * member types.
+ */
+template<typename MEMBER, bool IS_ENUM = std::is_enum<MEMBER>::value>
+class MemberDataType
+{
+public:
+    static inline MPI_Datatype value()
+    {
+        return Typemaps::lookup<MEMBER>();
+    }
+
+    static inline int count()
+    {
+        return 1;
+    }
+};
+
+template<typename MEMBER>
+class MemberDataType<MEMBER, true>
+{
+public:
+    static inline MPI_Datatype value()
+    {
+        return MPI_BYTE;
+    }
+
+    static inline int count()
+    {
+        return sizeof(MEMBER);
+    }
+};
+
+/**
+ * Location and type of a single member within a cell.
+ */
+class MemberSpec
+{
+public:
+    MemberSpec(MPI_Aint offset, MPI_Datatype type, int length) :
+        offset(offset),
+        type(type),
+        length(length)
+    {}
+
+    bool operator<(const MemberSpec& other) const
+    {
+        return offset < other.offset;
+    }
+
+    MPI_Aint offset;
+    MPI_Datatype type;
+    int length;
+};
+
+}
+
+/**
+ * Derives MPI datatypes from a list of member pointers, so that cell
+ * classes can be communicated without the typemap generator and
+ * without resorting to opaque datatypes (see
+ * APITraits::HasOpaqueMPIDataType), which would send padding bytes,
+ * too. Two variants can be built:
+ *
+ * - build() describes the cell as laid out in memory. Its extent is
+ *   sizeof(CELL), so it can be used for arrays of cells (e.g. grids).
+ *   Padding is skipped in transfers.
+ *
+ * - buildPacked() describes the same sequence of members, but stored
+ *   back to back. As the type signatures of both variants match, a
+ *   message sent with one can be received with the other, e.g. to
+ *   pack cells into a compact buffer.
+ *
+ * Usually the member list is registered via
+ * LIBGEODECOMP_REGISTER_MPI_DATATYPE and looked up via
+ * MPIDataTypeRegistry, but a builder may also be filled manually.
+ */
+template<typename CELL>
+class MPIDataTypeBuilder
+{
+public:
+    typedef MPIDataTypeBuilderHelpers::MemberSpec MemberSpec;
+
+    template<typename MEMBER>
+    MPIDataTypeBuilder& operator()(MEMBER CELL:: *member)
+    {
+        typedef MPIDataTypeBuilderHelpers::MemberDataType<MEMBER> Lookup;
+        members.push_back(MemberSpec(offset(member), Lookup::value(), Lookup::count()));
+        return *this;
+    }
+
+    template<typename MEMBER, std::size_t ARITY>
+    MPIDataTypeBuilder& operator()(MEMBER (CELL:: *member)[ARITY])
+    {
+        typedef MPIDataTypeBuilderHelpers::MemberDataType<MEMBER> Lookup;
+        members.push_back(MemberSpec(offset(member), Lookup::value(), Lookup::count() * ARITY));
+        return *this;
+    }
+
+    MPI_Datatype build() const
+    {
+        std::vector<MemberSpec> specs = sortedMembers();
+        return create(specs, sizeof(CELL));
+    }
+
+    MPI_Datatype buildPacked() const
+    {
+        std::vector<MemberSpec> specs = sortedMembers();
+        MPI_Aint offset = 0;
+        for (std::size_t i = 0; i < specs.size(); ++i) {
+            MPI_Aint size = memberSize(specs[i]);
+            specs[i].offset = offset;
+            offset += size;
+        }
+
+        return create(specs, offset);
+    }
+
+    /**
+     * Number of bytes a cell occupies when packed, i.e. without
+     * padding.
+     */
+    std::size_t packedSize() const
+    {
+        std::size_t ret = 0;
+        for (std::size_t i = 0; i < members.size(); ++i) {
+            ret += memberSize(members[i]);
+        }
+
+        return ret;
+    }
+
+private:
+    std::vector<MemberSpec> members;
+
+    template<typename MEMBER>
+    static MPI_Aint offset(MEMBER CELL:: *member)
+    {
+        char fakeObject[sizeof(CELL)];
+        CELL *obj = reinterpret_cast<CELL*>(fakeObject);
+
+        return
+            reinterpret_cast<char*>(&(obj->*member)) -
+            reinterpret_cast<char*>(obj);
+    }
+
+    static MPI_Aint memberSize(const MemberSpec& spec)
+    {
+        int size;
+        MPI_Type_size(spec.type, &size);
+        return MPI_Aint(size) * spec.length;
+    }
+
+    std::vector<MemberSpec> sortedMembers() const
+    {
+        std::vector<MemberSpec> ret = members;
+        std::stable_sort(ret.begin(), ret.end());
+        return ret;
+    }
+
+    static MPI_Datatype create(const std::vector<MemberSpec>& specs, MPI_Aint extent)
+    {
+        int count = specs.size();
+        std::vector<int> lengths(count);
+        std::vector<MPI_Aint> displacements(count);
+        std::vector<MPI_Datatype> memberTypes(count);
+        for (int i = 0; i < count; ++i) {
+            lengths[i] = specs[i].length;
+            displacements[i] = specs[i].offset;
+            memberTypes[i] = specs[i].type;
+        }
+
+        MPI_Datatype structType;
+        MPI_Type_create_struct(
+            count,
+            count ? &lengths[0] : 0,
+            count ? &displacements[0] : 0,
+            count ? &memberTypes[0] : 0,
+            &structType);
+
+        // MPI would otherwise round the extent up to the alignment
+        // of the largest member, which may differ from the stride in
+        // memory (or, for the packed variant, insert padding again):
+        MPI_Datatype ret;
+        MPI_Type_create_resized(structType, 0, extent, &ret);
+        MPI_Type_commit(&ret);
+        MPI_Type_free(&structType);
+
+        return ret;
+    }
+};
+
+/**
+ * Lazily creates and caches the MPI datatypes of all cell classes
+ * registered via LIBGEODECOMP_REGISTER_MPI_DATATYPE. This is the
+ * provider behind APITraits::HasRegisteredMPIDataType.
+ */
+class MPIDataTypeRegistry
+{
+public:
+    template<typename CELL>
+    static inline MPI_Datatype lookup()
+    {
+        return lookup(reinterpret_cast<CELL*>(0));
+    }
+
+    template<typename CELL>
+    static MPI_Datatype lookup(CELL*)
+    {
+        static MPI_Datatype datatype = MPI_DATATYPE_NULL;
+        if (datatype == MPI_DATATYPE_NULL) {
+            datatype = builder<CELL>().build();
+        }
+
+        return datatype;
+    }
+
+    template<typename CELL>
+    static MPI_Datatype lookupPacked()
+    {
+        static MPI_Datatype datatype = MPI_DATATYPE_NULL;
+        if (datatype == MPI_DATATYPE_NULL) {
+            datatype = builder<CELL>().buildPacked();
+        }
+
+        return datatype;
+    }
+
+    template<typename CELL>
+    static std::size_t packedSize()
+    {
+        return builder<CELL>().packedSize();
+    }
+
+private:
+    template<typename CELL>
+    static MPIDataTypeBuilder<CELL> builder()
+    {
+        MPIDataTypeBuilder<CELL> ret;
+        MPIDataTypeMembers<CELL>::addTo(ret);
+        return ret;
+    }
+};
+
+}
+
+#define LIBGEODECOMP_MPI_DATATYPE_MEMBER(INDEX, CELL_TYPE, MEMBER)      \
+    builder(&CELL_TYPE::LIBFLATARRAY_ELEM(1, MEMBER));
+
+/**
+ * Registers the members of a cell class for MPIDataTypeRegistry.
+ * The member list uses the same syntax as LIBFLATARRAY_REGISTER_SOA,
+ * e.g. ((double)(temp))((int)(flags))((double)(velocity)(3)) -- only
+ * the member names are actually evaluated, the types are deduced.
+ * Needs to be called from the global namespace.
+ */
+#define LIBGEODECOMP_REGISTER_MPI_DATATYPE(CELL_TYPE, CELL_MEMBERS)     \
+    namespace LibGeoDecomp {                                            \
+    template<>                                                          \
+    class MPIDataTypeMembers<CELL_TYPE>                                 \
+    {                                                                   \
+    public:                                                             \
+        template<typename BUILDER>                                      \
+        static void addTo(BUILDER& builder)                             \
+        {                                                               \
+            LIBFLATARRAY_FOR_EACH(                                      \
+                LIBGEODECOMP_MPI_DATATYPE_MEMBER,                       \
+                CELL_TYPE,                                              \
+                CELL_MEMBERS)                                           \
+        }                                                               \
+    };                                                                  \
+    }
+
+#else
+
+#define LIBGEODECOMP_REGISTER_MPI_DATATYPE(CELL_TYPE, CELL_MEMBERS)
+
+#endif
+
+/**
+ * Convenience macro for SoA models which need MPI datatypes, too:
+ * registers the same member list with LibFlatArray and
+ * MPIDataTypeRegistry.
+ */
+#define LIBGEODECOMP_REGISTER_SOA_AND_MPI_DATATYPE(CELL_TYPE, CELL_MEMBERS) \
+    LIBFLATARRAY_REGISTER_SOA(CELL_TYPE, CELL_MEMBERS)                  \
+    LIBGEODECOMP_REGISTER_MPI_DATATYPE(CELL_TYPE, CELL_MEMBERS)
+
+#endif
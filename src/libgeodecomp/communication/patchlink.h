@@ -18,6 +18,10 @@ namespace LibGeoDecomp {
  * remote processes. PatchLink::Accepter takes the patches from a
  * Stepper hands them on to MPI, while PatchLink::Provider will receive
  * the patches from the net and provide then to a Stepper.
+ *
+ * Cells are serialized via GhostZoneSerializationBuffer, so models
+ * may restrict the transfer to the members their neighbors actually
+ * read (see APITraits::HasGhostMembers).
  */
 template<class GRID_TYPE>
 class PatchLink
@@ -26,8 +30,9 @@ public:
     friend class PatchLinkTest;
 
     typedef typename GRID_TYPE::CellType CellType;
-    typedef typename SerializationBuffer<CellType>::BufferType BufferType;
-    typedef typename SerializationBuffer<CellType>::FixedSize FixedSize;
+    typedef GhostZoneSerializationBuffer<CellType> Buffer;
+    typedef typename Buffer::BufferType BufferType;
+    typedef typename Buffer::FixedSize FixedSize;
 
     const static int DIM = GRID_TYPE::DIM;
 
@@ -48,7 +53,7 @@ public:
             stride(1),
             mpiLayer(communicator),
             region(region),
-            buffer(SerializationBuffer<CellType>::create(region)),
+            buffer(Buffer::create(region)),
             tag(tag)
         {}
 
@@ -136,7 +141,7 @@ public:
             }
 
             wait();
-            grid.saveRegion(&buffer, region);
+            Buffer::save(grid, &buffer, region);
             sendHeader(FixedSize());
             mpiLayer.send(&buffer[0], dest, buffer.size(), tag, cellMPIDatatype);
 
@@ -231,7 +236,7 @@ public:
             recvSecondPart(FixedSize());
             transmissionInFlight = false;
 
-            grid->loadRegion(buffer, region);
+            Buffer::load(grid, buffer, region);
 
             std::size_t nextNanoStep = (min)(storedNanoSteps) + stride;
             if ((lastNanoStep == infinity()) ||
@@ -0,0 +1,183 @@
+#include <cxxtest/TestSuite.h>
+#include <mpi.h>
+
+#include <libgeodecomp/communication/mpidatatypebuilder.h>
+#include <libgeodecomp/communication/mpilayer.h>
+#include <libgeodecomp/misc/apitraits.h>
+#include <libgeodecomp/misc/testcell.h>
+
+using namespace LibGeoDecomp;
+
+namespace LibGeoDecomp {
+
+enum MPIDataTypeBuilderTestState {SOLID, LIQUID, GAS};
+
+/**
+ * Padded on purpose: 1 + 8 + 4 + 3 * 8 + 4 bytes of payload.
+ */
+class MPIDataTypeBuilderTestCell
+{
+public:
+    class API :
+        public APITraits::HasRegisteredMPIDataType
+    {};
+
+    MPIDataTypeBuilderTestCell(
+        char flag = 0,
+        double value = 0,
+        int id = 0,
+        MPIDataTypeBuilderTestState state = SOLID) :
+        flag(flag),
+        value(value),
+        id(id),
+        state(state)
+    {
+        for (int i = 0; i < 3; ++i) {
+            velocity[i] = value * (i + 1);
+        }
+    }
+
+    bool operator==(const MPIDataTypeBuilderTestCell& other) const
+    {
+        return
+            (flag == other.flag) &&
+            (value == other.value) &&
+            (id == other.id) &&
+            (velocity[0] == other.velocity[0]) &&
+            (velocity[1] == other.velocity[1]) &&
+            (velocity[2] == other.velocity[2]) &&
+            (state == other.state);
+    }
+
+    char flag;
+    double value;
+    int id;
+    double velocity[3];
+    MPIDataTypeBuilderTestState state;
+};
+
+}
+
+LIBGEODECOMP_REGISTER_MPI_DATATYPE(
+    LibGeoDecomp::MPIDataTypeBuilderTestCell,
+    ((double)(value))((char)(flag))((int)(id))((double)(velocity)(3))((LibGeoDecomp::MPIDataTypeBuilderTestState)(state)))
+
+namespace LibGeoDecomp {
+
+class MPIDataTypeBuilderTest : public CxxTest::TestSuite
+{
+public:
+    typedef MPIDataTypeBuilderTestCell CellType;
+
+    void testSizeAndExtent()
+    {
+        MPI_Datatype datatype = MPIDataTypeRegistry::lookup<CellType>();
+        TS_ASSERT_EQUALS(std::size_t(41), MPIDataTypeRegistry::packedSize<CellType>());
+        TS_ASSERT_EQUALS(41, typeSize(datatype));
+        TS_ASSERT_EQUALS(MPI_Aint(sizeof(CellType)), typeExtent(datatype));
+
+        MPI_Datatype packed = MPIDataTypeRegistry::lookupPacked<CellType>();
+        TS_ASSERT_EQUALS(41, typeSize(packed));
+        TS_ASSERT_EQUALS(MPI_Aint(41), typeExtent(packed));
+
+        // the type is cached:
+        TS_ASSERT_EQUALS(datatype, MPIDataTypeRegistry::lookup<CellType>());
+    }
+
+    void testAPITraits()
+    {
+        TS_ASSERT_EQUALS(
+            MPIDataTypeRegistry::lookup<CellType>(),
+            APITraits::SelectMPIDataType<CellType>::value());
+    }
+
+    void testSendRecv()
+    {
+        std::vector<CellType> source;
+        source << CellType('a', 1.5, 4711, LIQUID)
+               << CellType('b', 2.5, -1,   GAS)
+               << CellType('c', 3.5, 42,   SOLID);
+        std::vector<CellType> target(3);
+
+        MPILayer layer;
+        layer.send(&source[0], 0, 3, APITraits::SelectMPIDataType<CellType>::value());
+        layer.recv(&target[0], 0, 3, APITraits::SelectMPIDataType<CellType>::value());
+        layer.waitAll();
+
+        TS_ASSERT_EQUALS(source, target);
+    }
+
+    void testPacking()
+    {
+        std::vector<CellType> source;
+        source << CellType('x', 0.25, 17, GAS)
+               << CellType('y', 0.75, 18, LIQUID);
+        std::vector<char> buffer(2 * 41);
+        std::vector<CellType> target(2);
+
+        // type signatures match, so cells can be sent as-is and
+        // received into a packed buffer (and vice versa):
+        MPI_Sendrecv(
+            &source[0], 2, MPIDataTypeRegistry::lookup<CellType>(), 0, 0,
+            &buffer[0], 2, MPIDataTypeRegistry::lookupPacked<CellType>(), 0, 0,
+            MPI_COMM_SELF, MPI_STATUS_IGNORE);
+
+        // members are ordered by their offset in the cell:
+        TS_ASSERT_EQUALS('y', buffer[41]);
+        double value;
+        std::copy(&buffer[42], &buffer[42] + sizeof(double), reinterpret_cast<char*>(&value));
+        TS_ASSERT_EQUALS(0.75, value);
+
+        MPI_Sendrecv(
+            &buffer[0], 2, MPIDataTypeRegistry::lookupPacked<CellType>(), 0, 0,
+            &target[0], 2, MPIDataTypeRegistry::lookup<CellType>(), 0, 0,
+            MPI_COMM_SELF, MPI_STATUS_IGNORE);
+
+        TS_ASSERT_EQUALS(source, target);
+    }
+
+    void testManualBuilderMatchesTypemaps()
+    {
+        MPIDataTypeBuilder<TestCell<2> > builder;
+        builder
+            (&TestCell<2>::pos)
+            (&TestCell<2>::dimensions)
+            (&TestCell<2>::cycleCounter)
+            (&TestCell<2>::isEdgeCell)
+            (&TestCell<2>::testValue)
+            (&TestCell<2>::isValid);
+
+        MPI_Datatype datatype = builder.build();
+        TS_ASSERT_EQUALS(typeSize(Typemaps::lookup<TestCell<2> >()), typeSize(datatype));
+        TS_ASSERT_EQUALS(MPI_Aint(sizeof(TestCell<2>)), typeExtent(datatype));
+        TS_ASSERT(typeSize(datatype) < int(sizeof(TestCell<2>)));
+
+        TestCell<2> source(Coord<2>(3, 4), Coord<2>(20, 10), 7, 8.5);
+        TestCell<2> target;
+        MPI_Sendrecv(
+            &source, 1, datatype, 0, 0,
+            &target, 1, datatype, 0, 0,
+            MPI_COMM_SELF, MPI_STATUS_IGNORE);
+        TS_ASSERT_EQUALS(source, target);
+
+        MPI_Type_free(&datatype);
+    }
+
+private:
+    int typeSize(MPI_Datatype datatype)
+    {
+        int size;
+        MPI_Type_size(datatype, &size);
+        return size;
+    }
+
+    MPI_Aint typeExtent(MPI_Datatype datatype)
+    {
+        MPI_Aint lowerBound;
+        MPI_Aint extent;
+        MPI_Type_get_extent(datatype, &lowerBound, &extent);
+        return extent;
+    }
+};
+
+}
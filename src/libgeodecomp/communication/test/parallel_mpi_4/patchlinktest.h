@@ -51,6 +51,32 @@ public:
     std::vector<int> cargo;
 };
 
+/**
+ * Test model which restricts ghost zone exchange to a single member
+ */
+class PatchLinkGhostMembersCell
+{
+public:
+    class API :
+        public APITraits::HasGhostMembers
+    {};
+
+    explicit PatchLinkGhostMembersCell(double value = 0, int diagnostic = 0) :
+        value(value),
+        diagnostic(diagnostic)
+    {}
+
+    static std::vector<Selector<PatchLinkGhostMembersCell> > ghostMembers()
+    {
+        std::vector<Selector<PatchLinkGhostMembersCell> > ret;
+        ret << Selector<PatchLinkGhostMembersCell>(&PatchLinkGhostMembersCell::value, "value");
+        return ret;
+    }
+
+    double value;
+    int diagnostic;
+};
+
 class PatchLinkTest : public CxxTest::TestSuite
 {
 public:
@@ -306,6 +332,68 @@ public:
         accepter.wait();
     }
 
+    void testGhostMembers()
+    {
+        typedef DisplacedGrid<PatchLinkGhostMembersCell> GridType4;
+        typedef GhostZoneSerializationBuffer<PatchLinkGhostMembersCell> BufferType;
+
+        Coord<2> dim(30, 20);
+        CoordBox<2> box(Coord<2>(), dim);
+        Region<2> boxRegion;
+        boxRegion << box;
+
+        GridType4 sendGrid(box);
+        GridType4 recvGrid(box, PatchLinkGhostMembersCell(-1, -1));
+        for (CoordBox<2>::Iterator i = box.begin(); i != box.end(); ++i) {
+            sendGrid[*i] = PatchLinkGhostMembersCell(i->x() + 100 * mpiLayer->rank(), 4711);
+        }
+
+        std::vector<Region<2> > regions(mpiLayer->size());
+        for (int i = 0; i < mpiLayer->size(); ++i) {
+            regions[i] << Streak<2>(Coord<2>(0, i), dim.x());
+        }
+
+        PatchLink<GridType4>::Accepter accepter(
+            regions[mpiLayer->rank()],
+            mpiLayer->size() - 1,
+            2702,
+            BufferType::cellMPIDataType());
+        accepter.charge(4, 4, 1);
+        accepter.put(sendGrid, boxRegion, dim, 4, mpiLayer->rank());
+
+        if (mpiLayer->rank() == (mpiLayer->size() - 1)) {
+            std::vector<SharedPtr<PatchLink<GridType4>::Provider>::Type> providers;
+            for (int i = 0; i < mpiLayer->size(); ++i) {
+                providers.push_back(
+                    SharedPtr<PatchLink<GridType4>::Provider>::Type(
+                        new PatchLink<GridType4>::Provider(
+                            regions[i],
+                            i,
+                            2702,
+                            BufferType::cellMPIDataType())));
+
+                providers[i]->charge(4, 4, 1);
+            }
+
+            for (int i = 0; i < mpiLayer->size(); ++i) {
+                providers[i]->get(&recvGrid, boxRegion, dim, 4, i);
+            }
+
+            for (CoordBox<2>::Iterator i = box.begin(); i != box.end(); ++i) {
+                double expectedValue = -1;
+                if (i->y() < mpiLayer->size()) {
+                    expectedValue = i->x() + 100 * i->y();
+                }
+
+                TS_ASSERT_EQUALS(expectedValue, recvGrid[*i].value);
+                // only ghost members are being transmitted:
+                TS_ASSERT_EQUALS(-1, recvGrid[*i].diagnostic);
+            }
+        }
+
+        accepter.wait();
+    }
+
     void testBoostSerialization()
     {
 #ifdef LIBGEODECOMP_WITH_BOOST_SERIALIZATION
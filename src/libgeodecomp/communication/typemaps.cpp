@@ -942,11 +942,12 @@ Typemaps::generateMapLibGeoDecomp_Chronometer() {
     char fakeObject[sizeof(LibGeoDecomp::Chronometer)];
     LibGeoDecomp::Chronometer *obj = (LibGeoDecomp::Chronometer*)fakeObject;
 
-    const int count = 1;
+    const int count = 2;
     int lengths[count];
 
     // sort addresses in ascending order
     MemberSpec rawSpecs[] = {
+        MemberSpec(getAddress(&obj->totalAllocations), lookup<FixedArray<double,Chronometer::NUM_INTERVALS > >(), 1),
         MemberSpec(getAddress(&obj->totalTimes), lookup<FixedArray<double,Chronometer::NUM_INTERVALS > >(), 1)
     };
     std::sort(rawSpecs, rawSpecs + count, addressLower);
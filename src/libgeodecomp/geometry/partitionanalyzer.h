@@ -0,0 +1,318 @@
+#ifndef LIBGEODECOMP_GEOMETRY_PARTITIONANALYZER_H
+#define LIBGEODECOMP_GEOMETRY_PARTITIONANALYZER_H
+
+#include <libgeodecomp/geometry/dummyadjacencymanufacturer.h>
+#include <libgeodecomp/geometry/partitionmanager.h>
+#include <libgeodecomp/misc/sharedptr.h>
+
+#include <algorithm>
+#include <map>
+#include <sstream>
+
+namespace LibGeoDecomp {
+
+/**
+ * The PartitionAnalyzer evaluates the quality of a domain
+ * decomposition offline, i.e. without running a simulation. For each
+ * rank it sets up a PartitionManager, just like the UpdateGroup of
+ * the HiParSimulator would, and derives subdomain volume, ghost zone
+ * volume, neighbor count, message sizes and connectedness from the
+ * actual ghost zone fragments. A simple latency/bandwidth model
+ * yields an estimate of the communication time per time step.
+ *
+ * This is meant to help users select the most appropriate Partition
+ * for a given model, grid size and rank count.
+ */
+template<typename TOPOLOGY>
+class PartitionAnalyzer
+{
+public:
+    friend class PartitionAnalyzerTest;
+
+    typedef TOPOLOGY Topology;
+    static const int DIM = Topology::DIM;
+    typedef PartitionManager<Topology> PartitionManagerType;
+    typedef typename PartitionManagerType::RegionVecMap RegionVecMap;
+    typedef typename SharedPtr<Partition<DIM> >::Type PartitionPtr;
+
+    /**
+     * Metrics for a single rank. Volumes are given in cells. Sent
+     * cells correspond to the inner ghost zone, received cells to
+     * the outer ghost zone.
+     */
+    class RankReport
+    {
+    public:
+        inline RankReport() :
+            volume(0),
+            cellsSent(0),
+            cellsReceived(0),
+            numNeighbors(0),
+            maxMessageVolume(0),
+            numComponents(0),
+            communicationTime(0)
+        {}
+
+        std::size_t volume;
+        std::size_t cellsSent;
+        std::size_t cellsReceived;
+        std::size_t numNeighbors;
+        std::size_t maxMessageVolume;
+        std::size_t numComponents;
+        double communicationTime;
+    };
+
+    /**
+     * Aggregated metrics for the whole decomposition.
+     * communicationTime refers to one time step, i.e. the time for
+     * one ghost zone synchronization is amortized over ghostZoneWidth
+     * steps.
+     */
+    class Report
+    {
+    public:
+        inline Report() :
+            maxVolume(0),
+            meanVolume(0),
+            imbalance(0),
+            totalCellsSent(0),
+            maxCellsSent(0),
+            maxNeighbors(0),
+            meanNeighbors(0),
+            maxMessageVolume(0),
+            meanMessageVolume(0),
+            numDisconnectedRanks(0),
+            communicationTime(0)
+        {}
+
+        inline std::string toString() const
+        {
+            std::stringstream buf;
+            buf << "PartitionAnalyzer::Report(\n"
+                << "  maxVolume: " << maxVolume << "\n"
+                << "  meanVolume: " << meanVolume << "\n"
+                << "  imbalance: " << imbalance << "\n"
+                << "  totalCellsSent: " << totalCellsSent << "\n"
+                << "  maxCellsSent: " << maxCellsSent << "\n"
+                << "  maxNeighbors: " << maxNeighbors << "\n"
+                << "  meanNeighbors: " << meanNeighbors << "\n"
+                << "  maxMessageVolume: " << maxMessageVolume << "\n"
+                << "  meanMessageVolume: " << meanMessageVolume << "\n"
+                << "  numDisconnectedRanks: " << numDisconnectedRanks << "\n"
+                << "  communicationTime: " << communicationTime << "\n"
+                << ")";
+            return buf.str();
+        }
+
+        std::vector<RankReport> ranks;
+        std::size_t maxVolume;
+        double meanVolume;
+        double imbalance;
+        std::size_t totalCellsSent;
+        std::size_t maxCellsSent;
+        std::size_t maxNeighbors;
+        double meanNeighbors;
+        std::size_t maxMessageVolume;
+        double meanMessageVolume;
+        std::size_t numDisconnectedRanks;
+        double communicationTime;
+    };
+
+    /**
+     * latency is the time (in seconds) required to send a message
+     * (regardless of its size), bandwidth is given in bytes per
+     * second, cellSize in bytes.
+     */
+    inline explicit PartitionAnalyzer(
+        const CoordBox<DIM>& simulationArea,
+        unsigned ghostZoneWidth = 1,
+        std::size_t cellSize = sizeof(double),
+        double latency = 2e-6,
+        double bandwidth = 5e9) :
+        simulationArea(simulationArea),
+        ghostZoneWidth(ghostZoneWidth),
+        cellSize(cellSize),
+        latency(latency),
+        bandwidth(bandwidth)
+    {}
+
+    /**
+     * Evaluates the given Partition. The number of ranks is deduced
+     * from the Partition's weights.
+     */
+    inline Report operator()(PartitionPtr partition) const
+    {
+        std::size_t numRanks = partition->getWeights().size();
+        typename SharedPtr<AdjacencyManufacturer<DIM> >::Type adjacencyManufacturer(
+            new DummyAdjacencyManufacturer<DIM>());
+
+        // the UpdateGroup would gather these via MPI:
+        std::vector<CoordBox<DIM> > boundingBoxes;
+        std::vector<CoordBox<DIM> > expandedBoundingBoxes;
+        PartitionManagerType globalManager;
+        globalManager.resetRegions(
+            adjacencyManufacturer,
+            simulationArea,
+            partition,
+            0,
+            ghostZoneWidth);
+        for (std::size_t i = 0; i < numRanks; ++i) {
+            boundingBoxes << globalManager.getRegion(i, 0).boundingBox();
+            expandedBoundingBoxes << globalManager.getRegion(i, ghostZoneWidth).boundingBox();
+        }
+
+        Report report;
+        for (std::size_t i = 0; i < numRanks; ++i) {
+            PartitionManagerType manager;
+            manager.resetRegions(
+                adjacencyManufacturer,
+                simulationArea,
+                partition,
+                i,
+                ghostZoneWidth);
+            manager.resetGhostZones(boundingBoxes, expandedBoundingBoxes);
+            report.ranks << analyzeRank(&manager);
+        }
+
+        aggregate(&report);
+        return report;
+    }
+
+    /**
+     * Counts the face-connected components of the given Region.
+     * Periodic boundary conditions are not taken into account.
+     */
+    static std::size_t countComponents(const Region<DIM>& region)
+    {
+        typedef std::map<Coord<DIM>, std::vector<std::size_t> > RowMap;
+
+        std::vector<Streak<DIM> > streaks;
+        RowMap rows;
+        for (typename Region<DIM>::StreakIterator i = region.beginStreak();
+             i != region.endStreak();
+             ++i) {
+            rows[rowKey(*i)] << streaks.size();
+            streaks << *i;
+        }
+
+        std::vector<std::size_t> parents(streaks.size());
+        for (std::size_t i = 0; i < parents.size(); ++i) {
+            parents[i] = i;
+        }
+
+        for (std::size_t i = 0; i < streaks.size(); ++i) {
+            for (int d = 1; d < DIM; ++d) {
+                Coord<DIM> neighborRow = rowKey(streaks[i]);
+                neighborRow[d] -= 1;
+                typename RowMap::iterator row = rows.find(neighborRow);
+                if (row == rows.end()) {
+                    continue;
+                }
+
+                for (std::vector<std::size_t>::iterator j = row->second.begin();
+                     j != row->second.end();
+                     ++j) {
+                    if ((streaks[*j].origin.x() < streaks[i].endX) &&
+                        (streaks[i].origin.x()  < streaks[*j].endX)) {
+                        parents[findRoot(&parents, i)] = findRoot(&parents, *j);
+                    }
+                }
+            }
+        }
+
+        std::size_t ret = 0;
+        for (std::size_t i = 0; i < parents.size(); ++i) {
+            ret += (parents[i] == i);
+        }
+
+        return ret;
+    }
+
+private:
+    CoordBox<DIM> simulationArea;
+    unsigned ghostZoneWidth;
+    std::size_t cellSize;
+    double latency;
+    double bandwidth;
+
+    inline RankReport analyzeRank(PartitionManagerType *manager) const
+    {
+        RankReport ret;
+        ret.volume = manager->ownRegion().size();
+        ret.numComponents = countComponents(manager->ownRegion());
+
+        const RegionVecMap& inner = manager->getInnerGhostZoneFragments();
+        for (typename RegionVecMap::const_iterator i = inner.begin(); i != inner.end(); ++i) {
+            if ((i->first == PartitionManagerType::OUTGROUP) || i->second.back().empty()) {
+                continue;
+            }
+
+            std::size_t messageVolume = i->second.back().size();
+            ret.cellsSent += messageVolume;
+            ret.maxMessageVolume = (std::max)(ret.maxMessageVolume, messageVolume);
+            ret.communicationTime += latency + messageVolume * cellSize / bandwidth;
+            ++ret.numNeighbors;
+        }
+
+        const RegionVecMap& outer = manager->getOuterGhostZoneFragments();
+        for (typename RegionVecMap::const_iterator i = outer.begin(); i != outer.end(); ++i) {
+            if (i->first != PartitionManagerType::OUTGROUP) {
+                ret.cellsReceived += i->second.back().size();
+            }
+        }
+
+        return ret;
+    }
+
+    inline void aggregate(Report *report) const
+    {
+        std::size_t totalVolume = 0;
+        std::size_t totalNeighbors = 0;
+        double maxCommunicationTime = 0;
+
+        for (typename std::vector<RankReport>::iterator i = report->ranks.begin();
+             i != report->ranks.end();
+             ++i) {
+            totalVolume += i->volume;
+            totalNeighbors += i->numNeighbors;
+            report->totalCellsSent += i->cellsSent;
+            report->maxVolume = (std::max)(report->maxVolume, i->volume);
+            report->maxCellsSent = (std::max)(report->maxCellsSent, i->cellsSent);
+            report->maxNeighbors = (std::max)(report->maxNeighbors, i->numNeighbors);
+            report->maxMessageVolume = (std::max)(report->maxMessageVolume, i->maxMessageVolume);
+            report->numDisconnectedRanks += (i->numComponents > 1);
+            maxCommunicationTime = (std::max)(maxCommunicationTime, i->communicationTime);
+        }
+
+        double numRanks = report->ranks.size();
+        report->meanVolume = totalVolume / numRanks;
+        report->imbalance = report->maxVolume / report->meanVolume;
+        report->meanNeighbors = totalNeighbors / numRanks;
+        if (totalNeighbors > 0) {
+            report->meanMessageVolume = 1.0 * report->totalCellsSent / totalNeighbors;
+        }
+        // the slowest rank dictates the pace:
+        report->communicationTime = maxCommunicationTime / ghostZoneWidth;
+    }
+
+    static inline Coord<DIM> rowKey(const Streak<DIM>& streak)
+    {
+        Coord<DIM> ret = streak.origin;
+        ret.x() = 0;
+        return ret;
+    }
+
+    static inline std::size_t findRoot(std::vector<std::size_t> *parents, std::size_t i)
+    {
+        while ((*parents)[i] != i) {
+            (*parents)[i] = (*parents)[(*parents)[i]];
+            i = (*parents)[i];
+        }
+
+        return i;
+    }
+};
+
+}
+
+#endif
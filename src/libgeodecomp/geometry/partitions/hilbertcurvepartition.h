@@ -0,0 +1,430 @@
+#ifndef LIBGEODECOMP_GEOMETRY_PARTITIONS_HILBERTCURVEPARTITION_H
+#define LIBGEODECOMP_GEOMETRY_PARTITIONS_HILBERTCURVEPARTITION_H
+
+#include <libgeodecomp/geometry/coordbox.h>
+#include <libgeodecomp/geometry/partitions/spacefillingcurve.h>
+#include <libgeodecomp/geometry/streak.h>
+
+#include <algorithm>
+#include <stdexcept>
+#include <vector>
+
+namespace LibGeoDecomp {
+
+/**
+ * Hilbert's space-filling curve for an arbitrary number of
+ * dimensions. Unlike HilbertPartition (which is limited to 2D) this
+ * class traverses the smallest power-of-two hypercube which
+ * encloses the simulation space and skips all sub-cubes which lie
+ * outside of it. The orientation of each sub-cube is tracked with
+ * the entry point/direction state machine described by Chris
+ * Hamilton in "Compact Hilbert Indices" (2006), so moving from one
+ * cell to the next takes amortized constant time. Within boxes whose
+ * extents are powers of two all subdomains are connected.
+ *
+ * Regions are assembled from whole sub-cubes, i.e. the cost of
+ * getRegion() is proportional to the surface of the subdomain, not
+ * to its volume. This makes the partition well suited for frequent
+ * rebalancing: only the weights need to be shifted.
+ */
+template<int DIMENSIONS>
+class HilbertCurvePartition : public SpaceFillingCurve<DIMENSIONS>
+{
+public:
+    friend class HilbertCurvePartitionTest;
+
+    const static int DIM = DIMENSIONS;
+    const static int NUM_CHILDREN = 1 << DIM;
+    const static int NUM_STATES = NUM_CHILDREN * DIM;
+    // sub-cubes of up to (2^CACHED_LEVEL)^DIM cells will be
+    // enumerated from a lookup table:
+    const static int CACHED_LEVEL = (DIM > 3) ? 1 : 2;
+
+    typedef std::vector<Coord<DIM> > CoordVector;
+    typedef typename Partition<DIM>::AdjacencyPtr AdjacencyPtr;
+
+    /**
+     * A hypercube of edge length 2^level, located at corner
+     * (relative to the origin of the simulation space). entry and
+     * direction define the orientation of the curve within the cube,
+     * child is the index (along the curve) of the sub-cube currently
+     * being visited.
+     */
+    class Cube
+    {
+    public:
+        inline Cube(
+            const Coord<DIM>& corner = Coord<DIM>(),
+            int level = 0,
+            unsigned entry = 0,
+            unsigned direction = 0) :
+            corner(corner),
+            level(level),
+            entry(entry),
+            direction(direction),
+            child(0)
+        {}
+
+        inline Cube subCube(unsigned index) const
+        {
+            int newLevel = level - 1;
+            unsigned octant = rotateLeft(grayCode(index), direction + 1) ^ entry;
+
+            Coord<DIM> newCorner = corner;
+            for (int d = 0; d < DIM; ++d) {
+                if (octant & (1u << d)) {
+                    newCorner[d] += 1 << newLevel;
+                }
+            }
+
+            return Cube(
+                newCorner,
+                newLevel,
+                entry ^ rotateLeft(childEntry(index), direction + 1),
+                (direction + childDirection(index) + 1) % DIM);
+        }
+
+        inline int state() const
+        {
+            return entry * DIM + direction;
+        }
+
+        Coord<DIM> corner;
+        int level;
+        unsigned entry;
+        unsigned direction;
+        unsigned child;
+    };
+
+    class Iterator : public SpaceFillingCurve<DIM>::Iterator
+    {
+    public:
+        friend class HilbertCurvePartitionTest;
+
+        using SpaceFillingCurve<DIM>::Iterator::cursor;
+        using SpaceFillingCurve<DIM>::Iterator::endReached;
+        using SpaceFillingCurve<DIM>::Iterator::origin;
+        using SpaceFillingCurve<DIM>::Iterator::sublevelState;
+
+        inline Iterator(
+            const Coord<DIM>& origin,
+            const Coord<DIM>& dimensions,
+            std::size_t pos = 0) :
+            SpaceFillingCurve<DIM>::Iterator(origin, false),
+            dimensions(dimensions)
+        {
+            sublevelState = CACHED;
+            cubeStack.push_back(Cube(Coord<DIM>(), levels(dimensions)));
+            digDown(pos);
+        }
+
+        inline explicit Iterator(const Coord<DIM>& origin) :
+            SpaceFillingCurve<DIM>::Iterator(origin, true)
+        {}
+
+        inline Iterator& operator++()
+        {
+            if (endReached) {
+                return *this;
+            }
+
+            ++cachedCubeCoordsIterator;
+            if (cachedCubeCoordsIterator != cachedCubeCoordsEnd) {
+                cursor = cachedCubeOrigin + *cachedCubeCoordsIterator;
+            } else {
+                ++cubeStack.back().child;
+                digDown(0);
+            }
+
+            return *this;
+        }
+
+    private:
+        std::vector<Cube> cubeStack;
+        Coord<DIM> dimensions;
+        Coord<DIM> cachedCubeOrigin;
+        const Coord<DIM> *cachedCubeCoordsIterator;
+        const Coord<DIM> *cachedCubeCoordsEnd;
+
+        /**
+         * Moves the cursor to the offset-th cell which follows the
+         * current child of the topmost cube on the stack.
+         */
+        inline void digDown(std::size_t offset)
+        {
+            for (;;) {
+                if (cubeStack.empty()) {
+                    endReached = true;
+                    cursor = origin;
+                    return;
+                }
+
+                Cube& cube = cubeStack.back();
+                if (cube.child == unsigned(NUM_CHILDREN)) {
+                    cubeStack.pop_back();
+                    if (!cubeStack.empty()) {
+                        ++cubeStack.back().child;
+                    }
+                    continue;
+                }
+
+                Cube subCube = cube.subCube(cube.child);
+                std::size_t volume = clippedVolume(subCube, dimensions);
+                if (offset >= volume) {
+                    offset -= volume;
+                    ++cube.child;
+                    continue;
+                }
+
+                if ((subCube.level <= CACHED_LEVEL) &&
+                    (volume == (std::size_t(1) << (subCube.level * DIM)))) {
+                    const CoordVector& coords = cachedCoords(subCube);
+                    cachedCubeOrigin = origin + subCube.corner;
+                    cachedCubeCoordsIterator = &coords[0] + offset;
+                    cachedCubeCoordsEnd      = &coords[0] + coords.size();
+                    cursor = cachedCubeOrigin + *cachedCubeCoordsIterator;
+                    return;
+                }
+
+                cubeStack.push_back(subCube);
+            }
+        }
+    };
+
+    inline explicit HilbertCurvePartition(
+        const Coord<DIM>& origin = Coord<DIM>(),
+        const Coord<DIM>& dimensions = Coord<DIM>(),
+        const long& offset = 0,
+        const std::vector<std::size_t>& weights = std::vector<std::size_t>(2),
+        const AdjacencyPtr& /* unused: adjacency */ = AdjacencyPtr()) :
+        SpaceFillingCurve<DIM>(offset, weights),
+        origin(origin),
+        dimensions(dimensions)
+    {}
+
+    inline Iterator operator[](std::size_t i) const
+    {
+        return Iterator(origin, dimensions, i);
+    }
+
+    inline Iterator begin() const
+    {
+        return (*this)[0];
+    }
+
+    inline Iterator end() const
+    {
+        return Iterator(origin);
+    }
+
+    inline Region<DIM> getRegion(const std::size_t node) const
+    {
+        std::vector<Streak<DIM> > streaks;
+        collectStreaks(
+            Cube(Coord<DIM>(), levels(dimensions)),
+            0,
+            startOffsets[node + 0],
+            startOffsets[node + 1],
+            &streaks);
+
+        // inserting the streaks in the Region's native order makes
+        // each insertion an append operation:
+        std::sort(streaks.begin(), streaks.end(), streakLessThan);
+        Region<DIM> ret;
+        for (typename std::vector<Streak<DIM> >::iterator i = streaks.begin();
+             i != streaks.end();
+             ++i) {
+            ret << *i;
+        }
+
+        return ret;
+    }
+
+private:
+    using SpaceFillingCurve<DIM>::startOffsets;
+
+    Coord<DIM> origin;
+    Coord<DIM> dimensions;
+
+    static inline unsigned rotateLeft(unsigned bits, unsigned shift)
+    {
+        shift %= DIM;
+        return ((bits << shift) | (bits >> (DIM - shift))) & (NUM_CHILDREN - 1);
+    }
+
+    static inline unsigned grayCode(unsigned i)
+    {
+        return i ^ (i >> 1);
+    }
+
+    static inline unsigned trailingOnes(unsigned i)
+    {
+        unsigned ret = 0;
+        for (; i & 1; i >>= 1) {
+            ++ret;
+        }
+        return ret;
+    }
+
+    /**
+     * Corner at which the curve enters the index-th sub-cube
+     * (Hamilton's e(i)).
+     */
+    static inline unsigned childEntry(unsigned index)
+    {
+        if (index == 0) {
+            return 0;
+        }
+
+        return grayCode(2 * ((index - 1) / 2));
+    }
+
+    /**
+     * Dimension along which the curve leaves the index-th sub-cube
+     * (Hamilton's d(i)).
+     */
+    static inline unsigned childDirection(unsigned index)
+    {
+        if (index == 0) {
+            return 0;
+        }
+        if ((index % 2) == 0) {
+            return trailingOnes(index - 1) % DIM;
+        }
+
+        return trailingOnes(index) % DIM;
+    }
+
+    /**
+     * Returns the minimum number of subdivisions so that a hypercube
+     * of edge length 2^levels encloses the given dimensions.
+     */
+    static inline int levels(const Coord<DIM>& dimensions)
+    {
+        int maxDim = dimensions.maxElement();
+        int ret = 1;
+        while ((1 << ret) < maxDim) {
+            ++ret;
+        }
+
+        return ret;
+    }
+
+    /**
+     * Number of cells within the cube which are also part of the
+     * simulation space.
+     */
+    static inline std::size_t clippedVolume(const Cube& cube, const Coord<DIM>& dimensions)
+    {
+        std::size_t ret = 1;
+        for (int d = 0; d < DIM; ++d) {
+            int length = (std::min)(1 << cube.level, dimensions[d] - cube.corner[d]);
+            if (length <= 0) {
+                return 0;
+            }
+            ret *= length;
+        }
+
+        return ret;
+    }
+
+    static inline CoordBox<DIM> clippedBox(const Cube& cube, const Coord<DIM>& dimensions)
+    {
+        Coord<DIM> boxDim;
+        for (int d = 0; d < DIM; ++d) {
+            boxDim[d] = (std::min)(1 << cube.level, dimensions[d] - cube.corner[d]);
+        }
+
+        return CoordBox<DIM>(cube.corner, boxDim);
+    }
+
+    static inline const CoordVector& cachedCoords(const Cube& cube)
+    {
+        // function-local static: initialization is thread-safe and
+        // independent of the order of static initializers.
+        static const std::vector<CoordVector> cache = fillCache();
+        return cache[cube.level * NUM_STATES + cube.state()];
+    }
+
+    static inline std::vector<CoordVector> fillCache()
+    {
+        std::vector<CoordVector> cache((CACHED_LEVEL + 1) * NUM_STATES);
+
+        for (int level = 0; level <= CACHED_LEVEL; ++level) {
+            for (unsigned entry = 0; entry < unsigned(NUM_CHILDREN); ++entry) {
+                for (unsigned direction = 0; direction < unsigned(DIM); ++direction) {
+                    Cube cube(Coord<DIM>(), level, entry, direction);
+                    enumerateCube(cube, &cache[level * NUM_STATES + cube.state()]);
+                }
+            }
+        }
+
+        return cache;
+    }
+
+    static inline void enumerateCube(const Cube& cube, CoordVector *coords)
+    {
+        if (cube.level == 0) {
+            coords->push_back(cube.corner);
+            return;
+        }
+
+        for (unsigned i = 0; i < unsigned(NUM_CHILDREN); ++i) {
+            enumerateCube(cube.subCube(i), coords);
+        }
+    }
+
+    static inline bool streakLessThan(const Streak<DIM>& a, const Streak<DIM>& b)
+    {
+        for (int d = DIM - 1; d >= 0; --d) {
+            if (a.origin[d] != b.origin[d]) {
+                return a.origin[d] < b.origin[d];
+            }
+        }
+
+        return false;
+    }
+
+    /**
+     * Adds the Streaks of all cells within cube whose index along
+     * the curve lies within [start, end). pos is the index of the
+     * cube's first cell, the return value the index of the first
+     * cell following it.
+     */
+    inline std::size_t collectStreaks(
+        const Cube& cube,
+        std::size_t pos,
+        std::size_t start,
+        std::size_t end,
+        std::vector<Streak<DIM> > *streaks) const
+    {
+        std::size_t volume = clippedVolume(cube, dimensions);
+        std::size_t next = pos + volume;
+
+        if ((volume == 0) || (next <= start) || (pos >= end)) {
+            return next;
+        }
+
+        if ((pos >= start) && (next <= end)) {
+            CoordBox<DIM> box = clippedBox(cube, dimensions);
+            box.origin += origin;
+            for (typename CoordBox<DIM>::StreakIterator i = box.beginStreak();
+                 i != box.endStreak();
+                 ++i) {
+                *streaks << *i;
+            }
+
+            return next;
+        }
+
+        for (unsigned i = 0; i < unsigned(NUM_CHILDREN); ++i) {
+            pos = collectStreaks(cube.subCube(i), pos, start, end, streaks);
+        }
+
+        return pos;
+    }
+};
+
+}
+
+#endif
@@ -5,13 +5,17 @@
 #include <libgeodecomp/geometry/partitions/partition.h>
 #include <libgeodecomp/misc/math.h>
 
+#include <cmath>
+
 namespace LibGeoDecomp {
 
 /**
  * This class implements a recursive weighted coordinate bisection. It
  * yields perfectly rectangular domains which can be acutely tuned to
  * match load profiles, but small changes in the load vector may lead
- * to huge communication volumes for rebalanciation.
+ * to huge communication volumes for rebalanciation. To avoid this,
+ * use the rebalancing c-tor, which retains the bisection tree of a
+ * previous partition and only moves its cut planes.
  */
 template<int DIM>
 class RecursiveBisectionPartition : public Partition<DIM>
@@ -21,6 +25,29 @@ public:
     typedef std::vector<std::size_t> SizeTVec;
     typedef typename Partition<DIM>::AdjacencyPtr AdjacencyPtr;
 
+    /**
+     * A single cut of the bisection tree: the nodes [begin, middle)
+     * go to the lower half, [middle, end) to the upper half of the
+     * cuboid. The cut plane is orthogonal to dimension and located
+     * at the given (absolute) coordinate.
+     */
+    class Bisection
+    {
+    public:
+        inline Bisection(
+            std::size_t middle = 0,
+            int dimension = 0,
+            int coordinate = 0) :
+            middle(middle),
+            dimension(dimension),
+            coordinate(coordinate)
+        {}
+
+        std::size_t middle;
+        int dimension;
+        int coordinate;
+    };
+
     inline explicit RecursiveBisectionPartition(
         const Coord<DIM>& origin = Coord<DIM>(),
         const Coord<DIM>& dimensions = Coord<DIM>(),
@@ -31,32 +58,107 @@ public:
         Partition<DIM>(0, weights),
         origin(origin),
         dimensions(dimensions),
-        dimWeights(dimWeights)
+        dimWeights(dimWeights),
+        migrationVolume(0)
     {
         if (dimensions.prod() == 0) {
             throw std::invalid_argument("size of simulation space may not be zero");
         }
     }
 
+    /**
+     * Migration-aware rebalancing: assigns newWeights to the nodes
+     * while retaining the bisection tree of oldPartition. Each cut
+     * plane stays where it was as long as no node receives more than
+     * (1 + tolerance) times its weight in cells. Otherwise the plane
+     * is moved only as far as necessary. This keeps the number of
+     * cells which need to be migrated low, even if small load changes
+     * would trigger a completely different bisection tree. The
+     * migration volume is available via getMigrationVolume().
+     */
+    inline RecursiveBisectionPartition(
+        const RecursiveBisectionPartition& oldPartition,
+        const SizeTVec& newWeights,
+        double tolerance = 0.05) :
+        Partition<DIM>(0, newWeights),
+        origin(oldPartition.origin),
+        dimensions(oldPartition.dimensions),
+        dimWeights(oldPartition.dimWeights),
+        migrationVolume(0)
+    {
+        if (newWeights.size() != oldPartition.getWeights().size()) {
+            throw std::invalid_argument("number of weights must not change during rebalancing");
+        }
+
+        std::vector<Bisection> oldBisections = oldPartition.getBisections();
+        typename std::vector<Bisection>::const_iterator cursor = oldBisections.begin();
+        cuboids.resize(newWeights.size());
+
+        rebalance(
+            0,
+            newWeights.size(),
+            CoordBox<DIM>(origin, dimensions),
+            tolerance,
+            &cursor);
+
+        for (std::size_t i = 0; i < cuboids.size(); ++i) {
+            migrationVolume += (getRegion(i) - oldPartition.getRegion(i)).size();
+        }
+    }
+
     inline Region<DIM> getRegion(const std::size_t i) const
     {
+        Region<DIM> r;
+
+        if (!cuboids.empty()) {
+            r << cuboids[i];
+            return r;
+        }
+
         CoordBox<DIM> cuboid = searchNodeCuboid(
             startOffsets.begin(),
             startOffsets.end() - 1,
             startOffsets.begin() + i,
             CoordBox<DIM>(origin, dimensions));
 
-        Region<DIM> r;
         r << cuboid;
         return r;
     }
 
+    /**
+     * Returns the bisection tree in pre-order.
+     */
+    inline std::vector<Bisection> getBisections() const
+    {
+        if (!bisections.empty()) {
+            return bisections;
+        }
+
+        std::vector<Bisection> ret;
+        collectBisections(0, weights.size(), CoordBox<DIM>(origin, dimensions), &ret);
+        return ret;
+    }
+
+    /**
+     * Number of cells which the nodes had to receive when switching
+     * from the partition passed to the rebalancing c-tor to this one.
+     */
+    inline std::size_t getMigrationVolume() const
+    {
+        return migrationVolume;
+    }
+
 private:
     using Partition<DIM>::startOffsets;
+    using Partition<DIM>::weights;
 
     Coord<DIM> origin;
     Coord<DIM> dimensions;
     Coord<DIM> dimWeights;
+    std::size_t migrationVolume;
+    // only set for rebalanced partitions:
+    std::vector<Bisection> bisections;
+    std::vector<CoordBox<DIM> > cuboids;
 
     /**
      * returns the CoordBox which belongs to the node whose weight is
@@ -74,6 +176,106 @@ private:
             return box;
         }
 
+        SizeTVec::const_iterator approxMiddle = findMiddle(begin, end);
+        double ratio = 1.0 * (*approxMiddle - *begin) / (*end - *begin);
+        CoordBox<DIM> newBoxes[2];
+        splitBox(newBoxes, box, ratio);
+
+        if (*node < *approxMiddle) {
+            return searchNodeCuboid(begin, approxMiddle, node, newBoxes[0]);
+        } else {
+            return searchNodeCuboid(approxMiddle, end, node, newBoxes[1]);
+        }
+    }
+
+    /**
+     * Same traversal as searchNodeCuboid(), but for all nodes
+     * [begin, end) and recording each cut.
+     */
+    inline void collectBisections(
+        std::size_t begin,
+        std::size_t end,
+        const CoordBox<DIM>& box,
+        std::vector<Bisection> *ret) const
+    {
+        if ((end - begin) == 1) {
+            return;
+        }
+
+        SizeTVec::const_iterator approxMiddle = findMiddle(
+            startOffsets.begin() + begin,
+            startOffsets.begin() + end);
+        double ratio = 1.0 * (*approxMiddle - startOffsets[begin]) /
+            (startOffsets[end] - startOffsets[begin]);
+        CoordBox<DIM> newBoxes[2];
+        int dim = splitBox(newBoxes, box, ratio);
+
+        std::size_t middle = approxMiddle - startOffsets.begin();
+        *ret << Bisection(middle, dim, newBoxes[1].origin[dim]);
+        collectBisections(begin, middle, newBoxes[0], ret);
+        collectBisections(middle, end, newBoxes[1], ret);
+    }
+
+    inline void rebalance(
+        std::size_t begin,
+        std::size_t end,
+        const CoordBox<DIM>& box,
+        double tolerance,
+        typename std::vector<Bisection>::const_iterator *oldBisection)
+    {
+        if ((end - begin) == 1) {
+            cuboids[begin] = box;
+            return;
+        }
+
+        const Bisection& old = **oldBisection;
+        ++*oldBisection;
+
+        int dim = old.dimension;
+        int length = box.dimensions[dim];
+        double lowerWeight = startOffsets[old.middle] - startOffsets[begin];
+        double upperWeight = startOffsets[end]        - startOffsets[old.middle];
+
+        // empty boxes or nodes without any weight leave nothing to
+        // balance, so we simply split in the middle:
+        int cut = length / 2;
+        if ((box.dimensions.prod() > 0) && ((lowerWeight + upperWeight) > 0)) {
+            double crossSection = 1.0 * box.dimensions.prod() / length;
+            // the cut which would balance the load perfectly (rounded
+            // to nearest, the argument is non-negative):
+            int optimum = std::floor(lowerWeight / (lowerWeight + upperWeight) * length + 0.5);
+            // admissible cuts according to the tolerance:
+            int maxCut = std::floor((1 + tolerance) * lowerWeight / crossSection);
+            int minCut = length - std::floor((1 + tolerance) * upperWeight / crossSection);
+
+            cut = optimum;
+            if (minCut <= maxCut) {
+                cut = old.coordinate - box.origin[dim];
+                cut = (std::max)(cut, minCut);
+                cut = (std::min)(cut, maxCut);
+            }
+            cut = (std::max)(cut, 0);
+            cut = (std::min)(cut, length);
+        }
+
+        CoordBox<DIM> newBoxes[2] = {box, box};
+        newBoxes[0].dimensions[dim] = cut;
+        newBoxes[1].dimensions[dim] = length - cut;
+        newBoxes[1].origin[dim] += cut;
+
+        bisections << Bisection(old.middle, dim, newBoxes[1].origin[dim]);
+        rebalance(begin, old.middle, newBoxes[0], tolerance, oldBisection);
+        rebalance(old.middle, end, newBoxes[1], tolerance, oldBisection);
+    }
+
+    /**
+     * Splits the nodes [begin, end) into two groups of roughly equal
+     * weight. Returns the first node of the second group.
+     */
+    inline SizeTVec::const_iterator findMiddle(
+        const SizeTVec::const_iterator& begin,
+        const SizeTVec::const_iterator& end) const
+    {
         std::size_t halfWeight = (*begin + *end) / 2;
 
         SizeTVec::const_iterator approxMiddle = std::lower_bound(
@@ -89,18 +291,14 @@ private:
             }
         }
 
-        double ratio = 1.0 * (*approxMiddle - *begin) / (*end - *begin);
-        CoordBox<DIM> newBoxes[2];
-        splitBox(newBoxes, box, ratio);
-
-        if (*node < *approxMiddle) {
-            return searchNodeCuboid(begin, approxMiddle, node, newBoxes[0]);
-        } else {
-            return searchNodeCuboid(approxMiddle, end, node, newBoxes[1]);
-        }
+        return approxMiddle;
     }
 
-    inline void splitBox(
+    /**
+     * Cuts oldBox orthogonally to its longest (weighted) dimension,
+     * which is returned.
+     */
+    inline int splitBox(
         CoordBox<DIM> *newBoxes,
         const CoordBox<DIM>& oldBox,
         double ratio) const
@@ -121,6 +319,8 @@ private:
         newBoxes[0].dimensions[longestDim] = offset;
         newBoxes[1].dimensions[longestDim] = remainder;
         newBoxes[1].origin[longestDim] += offset;
+
+        return longestDim;
     }
 };
 
@@ -0,0 +1,148 @@
+#include <libgeodecomp/geometry/partitions/hilbertcurvepartition.h>
+
+#include <cxxtest/TestSuite.h>
+
+using namespace LibGeoDecomp;
+
+namespace LibGeoDecomp {
+
+class HilbertCurvePartitionTest : public CxxTest::TestSuite
+{
+public:
+    typedef std::vector<Coord<2> > CoordVector;
+
+    void testSimple2D()
+    {
+        HilbertCurvePartition<2> partition(Coord<2>(10, 20), Coord<2>(4, 4));
+        CoordVector expected;
+        expected << Coord<2>(10, 20) << Coord<2>(11, 20) << Coord<2>(11, 21) << Coord<2>(10, 21)
+                 << Coord<2>(10, 22) << Coord<2>(10, 23) << Coord<2>(11, 23) << Coord<2>(11, 22)
+                 << Coord<2>(12, 22) << Coord<2>(12, 23) << Coord<2>(13, 23) << Coord<2>(13, 22)
+                 << Coord<2>(13, 21) << Coord<2>(12, 21) << Coord<2>(12, 20) << Coord<2>(13, 20);
+
+        CoordVector actual1;
+        for (int i = 0; i < 16; ++i) {
+            actual1 << *partition[i];
+        }
+
+        CoordVector actual2;
+        for (HilbertCurvePartition<2>::Iterator i = partition.begin(); i != partition.end(); ++i) {
+            actual2 << *i;
+        }
+
+        TS_ASSERT_EQUALS(actual1, expected);
+        TS_ASSERT_EQUALS(actual2, expected);
+    }
+
+    void testContinuity()
+    {
+        checkContinuity(Coord<2>(64, 64));
+        checkContinuity(Coord<3>(16, 16, 16));
+        checkContinuity(Coord<3>(32, 32, 32));
+    }
+
+    void testCompleteness()
+    {
+        checkCompleteness(Coord<2>(5, 3));
+        checkCompleteness(Coord<2>(600, 35));
+        checkCompleteness(Coord<3>(5, 7, 20));
+        checkCompleteness(Coord<3>(5, 40, 4));
+        checkCompleteness(Coord<3>(50, 8, 9));
+        checkCompleteness(Coord<3>(1, 1, 1));
+    }
+
+    void testSquareBracketsOperatorVersusIteration()
+    {
+        Coord<3> dimensions(13, 6, 9);
+        HilbertCurvePartition<3> partition(Coord<3>(1, 2, 3), dimensions);
+
+        std::vector<Coord<3> > actual1;
+        for (int i = 0; i < dimensions.prod(); ++i) {
+            actual1 << *partition[i];
+        }
+
+        std::vector<Coord<3> > actual2;
+        for (HilbertCurvePartition<3>::Iterator i = partition.begin(); i != partition.end(); ++i) {
+            actual2 << *i;
+        }
+
+        TS_ASSERT_EQUALS(actual1, actual2);
+    }
+
+    void testGetRegion()
+    {
+        Coord<3> origin(10, 20, 30);
+        Coord<3> dimensions(30, 17, 21);
+
+        std::vector<std::size_t> weights;
+        weights << 1000 << 2000 << 1234 << 3000 << 3476;
+        HilbertCurvePartition<3> partition(origin, dimensions, 0, weights);
+
+        HilbertCurvePartition<3>::Iterator iter = partition.begin();
+        Region<3> whole;
+
+        for (std::size_t node = 0; node < weights.size(); ++node) {
+            Region<3> expected;
+            for (std::size_t i = 0; i < weights[node]; ++i) {
+                expected << *iter;
+                ++iter;
+            }
+
+            Region<3> actual = partition.getRegion(node);
+            TS_ASSERT_EQUALS(expected, actual);
+            TS_ASSERT_EQUALS(weights[node], actual.size());
+            TS_ASSERT((whole & actual).empty());
+            whole += actual;
+        }
+
+        TS_ASSERT_EQUALS(Region<3>(CoordBox<3>(origin, dimensions)), whole);
+    }
+
+private:
+    template<int DIM>
+    void checkContinuity(const Coord<DIM>& dimensions)
+    {
+        HilbertCurvePartition<DIM> partition(Coord<DIM>(), dimensions);
+        typename HilbertCurvePartition<DIM>::Iterator i = partition.begin();
+        Coord<DIM> last = *i;
+        int counter = 1;
+
+        for (++i; i != partition.end(); ++i) {
+            Coord<DIM> delta = *i - last;
+            int manhattanDistance = 0;
+            for (int d = 0; d < DIM; ++d) {
+                manhattanDistance += std::abs(delta[d]);
+            }
+
+            TS_ASSERT_EQUALS(1, manhattanDistance);
+            last = *i;
+            ++counter;
+        }
+
+        TS_ASSERT_EQUALS(dimensions.prod(), counter);
+    }
+
+    template<int DIM>
+    void checkCompleteness(const Coord<DIM>& dimensions)
+    {
+        Coord<DIM> origin = Coord<DIM>::diagonal(7);
+        HilbertCurvePartition<DIM> partition(origin, dimensions);
+
+        std::vector<Coord<DIM> > expected;
+        CoordBox<DIM> box(origin, dimensions);
+        for (typename CoordBox<DIM>::Iterator i = box.begin(); i != box.end(); ++i) {
+            expected << *i;
+        }
+
+        std::vector<Coord<DIM> > actual;
+        for (typename HilbertCurvePartition<DIM>::Iterator i = partition.begin(); i != partition.end(); ++i) {
+            actual << *i;
+        }
+
+        sort(expected);
+        sort(actual);
+        TS_ASSERT_EQUALS(expected, actual);
+    }
+};
+
+}
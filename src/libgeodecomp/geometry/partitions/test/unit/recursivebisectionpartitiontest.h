@@ -108,6 +108,121 @@ public:
             std::invalid_argument);
     }
 
+    void testRebalancingRetainsBisectionTree()
+    {
+        std::vector<std::size_t> oldWeights;
+        oldWeights << 100
+                   << 100
+                   << 200;
+        std::vector<std::size_t> newWeights;
+        newWeights << 150
+                   << 150
+                   << 100;
+
+        Coord<2> dim(20, 20);
+        RecursiveBisectionPartition<2> oldPartition(Coord<2>(), dim, 0, oldWeights);
+        RecursiveBisectionPartition<2> freshPartition(Coord<2>(), dim, 0, newWeights);
+        RecursiveBisectionPartition<2> newPartition(oldPartition, newWeights);
+
+        TS_ASSERT_EQUALS(genRegion(0,  0, 15, 10), newPartition.getRegion(0));
+        TS_ASSERT_EQUALS(genRegion(0, 10, 15, 10), newPartition.getRegion(1));
+        TS_ASSERT_EQUALS(genRegion(15, 0,  5, 20), newPartition.getRegion(2));
+        TS_ASSERT_EQUALS(std::size_t(100), newPartition.getMigrationVolume());
+
+        // a new bisection tree would result in far more migration:
+        std::size_t freshMigrationVolume = 0;
+        for (int i = 0; i < 3; ++i) {
+            freshMigrationVolume += (freshPartition.getRegion(i) - oldPartition.getRegion(i)).size();
+        }
+        TS_ASSERT_EQUALS(std::size_t(236), freshMigrationVolume);
+    }
+
+    void testRebalancingTolerance()
+    {
+        std::vector<std::size_t> oldWeights(4, 100);
+        std::vector<std::size_t> newWeights;
+        newWeights << 105
+                   <<  95
+                   << 100
+                   << 100;
+
+        Coord<2> dim(40, 10);
+        RecursiveBisectionPartition<2> oldPartition(Coord<2>(), dim, 0, oldWeights);
+
+        RecursiveBisectionPartition<2> lax(oldPartition, newWeights, 0.1);
+        TS_ASSERT_EQUALS(std::size_t(0), lax.getMigrationVolume());
+        for (int i = 0; i < 4; ++i) {
+            TS_ASSERT_EQUALS(oldPartition.getRegion(i), lax.getRegion(i));
+        }
+
+        RecursiveBisectionPartition<2> strict(oldPartition, newWeights, 0.0);
+        TS_ASSERT_EQUALS(std::size_t(10), strict.getMigrationVolume());
+        TS_ASSERT_EQUALS(genRegion( 0, 0, 11, 10), strict.getRegion(0));
+        TS_ASSERT_EQUALS(genRegion(11, 0,  9, 10), strict.getRegion(1));
+        TS_ASSERT_EQUALS(genRegion(20, 0, 10, 10), strict.getRegion(2));
+        TS_ASSERT_EQUALS(genRegion(30, 0, 10, 10), strict.getRegion(3));
+    }
+
+    void testRebalancingZeroWeights()
+    {
+        std::vector<std::size_t> oldWeights;
+        oldWeights << 100
+                   << 100
+                   << 200;
+        Coord<2> dim(20, 20);
+        RecursiveBisectionPartition<2> oldPartition(Coord<2>(), dim, 0, oldWeights);
+
+        // no weight at all: each cut halves its box
+        RecursiveBisectionPartition<2> idle(oldPartition, std::vector<std::size_t>(3, 0));
+        TS_ASSERT_EQUALS(genRegion(0,   0, 10, 10), idle.getRegion(0));
+        TS_ASSERT_EQUALS(genRegion(0,  10, 10, 10), idle.getRegion(1));
+        TS_ASSERT_EQUALS(genRegion(10,  0, 10, 20), idle.getRegion(2));
+
+        // the first two nodes end up with an empty box, which still
+        // needs to be bisected:
+        std::vector<std::size_t> newWeights;
+        newWeights << 0
+                   << 0
+                   << 400;
+        RecursiveBisectionPartition<2> skewed(oldPartition, newWeights);
+        TS_ASSERT_EQUALS(Region<2>(), skewed.getRegion(0));
+        TS_ASSERT_EQUALS(Region<2>(), skewed.getRegion(1));
+        TS_ASSERT_EQUALS(genRegion(0, 0, 20, 20), skewed.getRegion(2));
+    }
+
+    void testRebalancing3D()
+    {
+        std::vector<std::size_t> oldWeights(16, 64 * 64 * 4);
+        std::vector<std::size_t> newWeights;
+        for (std::size_t i = 0; i < oldWeights.size(); ++i) {
+            newWeights << ((i % 2) ? (oldWeights[i] + 512) : (oldWeights[i] - 512));
+        }
+
+        Coord<3> dim(64, 64, 64);
+        double tolerance = 0.1;
+        RecursiveBisectionPartition<3> oldPartition(Coord<3>(), dim, 0, oldWeights);
+        RecursiveBisectionPartition<3> newPartition(oldPartition, newWeights, tolerance);
+        TS_ASSERT_EQUALS(
+            oldPartition.getBisections().size(),
+            newPartition.getBisections().size());
+
+        Region<3> whole;
+        for (std::size_t i = 0; i < newWeights.size(); ++i) {
+            Region<3> r = newPartition.getRegion(i);
+            TS_ASSERT(r.size() <= (1 + tolerance) * newWeights[i]);
+            TS_ASSERT((whole & r).empty());
+            whole += r;
+        }
+        TS_ASSERT_EQUALS(Region<3>(CoordBox<3>(Coord<3>(), dim)), whole);
+        TS_ASSERT(newPartition.getMigrationVolume() < (64 * 64 * 64 / 16));
+
+        // rebalancing can be chained:
+        RecursiveBisectionPartition<3> backPartition(newPartition, oldWeights, tolerance);
+        for (std::size_t i = 0; i < newWeights.size(); ++i) {
+            TS_ASSERT(backPartition.getRegion(i).size() <= (1 + tolerance) * oldWeights[i]);
+        }
+    }
+
     void checkCuboid(
         std::vector<std::size_t> weights,
         long node,
@@ -134,6 +249,11 @@ public:
                 CoordBox<2>(origin, dimensions)));
     }
 
+    Region<2> genRegion(int o1, int o2, int d1, int d2)
+    {
+        return Region<2>(CoordBox<2>(Coord<2>(o1, o2), Coord<2>(d1, d2)));
+    }
+
     Region<3> genRegion(int o1, int o2, int o3, int d1, int d2, int d3)
     {
         CoordBox<3> box(Coord<3>(o1, o2, o3), Coord<3>(d1, d2, d3));
@@ -0,0 +1,124 @@
+#include <libgeodecomp/geometry/partitionanalyzer.h>
+#include <libgeodecomp/geometry/partitions/hilbertcurvepartition.h>
+#include <libgeodecomp/geometry/partitions/recursivebisectionpartition.h>
+#include <libgeodecomp/geometry/partitions/stripingpartition.h>
+
+#include <cxxtest/TestSuite.h>
+
+using namespace LibGeoDecomp;
+
+namespace LibGeoDecomp {
+
+class PartitionAnalyzerTest : public CxxTest::TestSuite
+{
+public:
+    typedef PartitionAnalyzer<Topologies::Cube<2>::Topology> AnalyzerType;
+
+    void testStriping()
+    {
+        Coord<2> dim(20, 20);
+        std::vector<std::size_t> weights(4, 100);
+        AnalyzerType::PartitionPtr partition(
+            new StripingPartition<2>(Coord<2>(), dim, 0, weights));
+
+        AnalyzerType analyzer(CoordBox<2>(Coord<2>(), dim), 1, 8, 1e-6, 1e9);
+        AnalyzerType::Report report = analyzer(partition);
+
+        TS_ASSERT_EQUALS(std::size_t(4), report.ranks.size());
+        for (int i = 0; i < 4; ++i) {
+            TS_ASSERT_EQUALS(std::size_t(100), report.ranks[i].volume);
+            TS_ASSERT_EQUALS(std::size_t(1),   report.ranks[i].numComponents);
+            TS_ASSERT_EQUALS(std::size_t(20),  report.ranks[i].maxMessageVolume);
+        }
+
+        TS_ASSERT_EQUALS(std::size_t(1),  report.ranks[0].numNeighbors);
+        TS_ASSERT_EQUALS(std::size_t(2),  report.ranks[1].numNeighbors);
+        TS_ASSERT_EQUALS(std::size_t(2),  report.ranks[2].numNeighbors);
+        TS_ASSERT_EQUALS(std::size_t(1),  report.ranks[3].numNeighbors);
+        TS_ASSERT_EQUALS(std::size_t(20), report.ranks[0].cellsSent);
+        TS_ASSERT_EQUALS(std::size_t(40), report.ranks[1].cellsSent);
+        TS_ASSERT_EQUALS(std::size_t(40), report.ranks[2].cellsReceived);
+
+        TS_ASSERT_EQUALS(std::size_t(100), report.maxVolume);
+        TS_ASSERT_EQUALS(1.0, report.imbalance);
+        TS_ASSERT_EQUALS(std::size_t(120), report.totalCellsSent);
+        TS_ASSERT_EQUALS(std::size_t(2), report.maxNeighbors);
+        TS_ASSERT_EQUALS(1.5, report.meanNeighbors);
+        TS_ASSERT_EQUALS(20.0, report.meanMessageVolume);
+        TS_ASSERT_EQUALS(std::size_t(0), report.numDisconnectedRanks);
+        TS_ASSERT_DELTA(2 * (1e-6 + 20 * 8 / 1e9), report.communicationTime, 1e-12);
+    }
+
+    void testGhostZoneWidthAmortizesCommunication()
+    {
+        Coord<2> dim(64, 64);
+        std::vector<std::size_t> weights(4, 1024);
+        AnalyzerType::PartitionPtr partition(
+            new RecursiveBisectionPartition<2>(Coord<2>(), dim, 0, weights));
+
+        AnalyzerType::Report report1 = AnalyzerType(CoordBox<2>(Coord<2>(), dim), 1)(partition);
+        AnalyzerType::Report report3 = AnalyzerType(CoordBox<2>(Coord<2>(), dim), 3)(partition);
+
+        // quadrants are in touch with all other quadrants, if only diagonally:
+        TS_ASSERT_EQUALS(std::size_t(3), report1.maxNeighbors);
+        TS_ASSERT_EQUALS(std::size_t(32 + 32 + 1), report1.ranks[0].cellsSent);
+        TS_ASSERT(report3.totalCellsSent > report1.totalCellsSent);
+        TS_ASSERT(report3.communicationTime < report1.communicationTime);
+    }
+
+    void testImbalanceAndConnectedness()
+    {
+        Coord<2> dim(30, 10);
+        std::vector<std::size_t> weights;
+        weights << 50 << 125 << 125;
+        AnalyzerType::PartitionPtr partition(
+            new StripingPartition<2>(Coord<2>(), dim, 0, weights));
+
+        AnalyzerType::Report report = AnalyzerType(CoordBox<2>(Coord<2>(), dim))(partition);
+        TS_ASSERT_EQUALS(std::size_t(125), report.maxVolume);
+        TS_ASSERT_EQUALS(1.25, report.imbalance);
+        TS_ASSERT_EQUALS(std::size_t(0), report.numDisconnectedRanks);
+    }
+
+    void testCountComponents()
+    {
+        Region<2> region;
+        TS_ASSERT_EQUALS(std::size_t(0), AnalyzerType::countComponents(region));
+
+        region << CoordBox<2>(Coord<2>(0, 0), Coord<2>(5, 5));
+        TS_ASSERT_EQUALS(std::size_t(1), AnalyzerType::countComponents(region));
+
+        // diagonal neighbors don't count as connected:
+        region << Coord<2>(5, 5);
+        TS_ASSERT_EQUALS(std::size_t(2), AnalyzerType::countComponents(region));
+
+        region << Coord<2>(5, 4);
+        TS_ASSERT_EQUALS(std::size_t(1), AnalyzerType::countComponents(region));
+
+        // U shape, connected only at the bottom:
+        Region<3> u;
+        u << CoordBox<3>(Coord<3>(0, 0, 0), Coord<3>(2, 10, 3))
+          << CoordBox<3>(Coord<3>(8, 0, 0), Coord<3>(2, 10, 3));
+        TS_ASSERT_EQUALS(std::size_t(2), PartitionAnalyzer<Topologies::Cube<3>::Topology>::countComponents(u));
+        u << CoordBox<3>(Coord<3>(0, 0, 2), Coord<3>(10, 1, 1));
+        TS_ASSERT_EQUALS(std::size_t(1), PartitionAnalyzer<Topologies::Cube<3>::Topology>::countComponents(u));
+    }
+
+    void testHilbertCurveVersusStriping3D()
+    {
+        typedef PartitionAnalyzer<Topologies::Cube<3>::Topology> Analyzer3D;
+        Coord<3> dim(32, 32, 32);
+        std::vector<std::size_t> weights(8, 32 * 32 * 4);
+        Analyzer3D analyzer((CoordBox<3>(Coord<3>(), dim)));
+
+        Analyzer3D::Report striping = analyzer(
+            Analyzer3D::PartitionPtr(new StripingPartition<3>(Coord<3>(), dim, 0, weights)));
+        Analyzer3D::Report hilbert = analyzer(
+            Analyzer3D::PartitionPtr(new HilbertCurvePartition<3>(Coord<3>(), dim, 0, weights)));
+
+        TS_ASSERT_EQUALS(std::size_t(0), hilbert.numDisconnectedRanks);
+        TS_ASSERT(hilbert.totalCellsSent < striping.totalCellsSent);
+    }
+};
+
+}
@@ -0,0 +1,65 @@
+#ifndef LIBGEODECOMP_IO_ANALYZER_H
+#define LIBGEODECOMP_IO_ANALYZER_H
+
+#include <libgeodecomp/geometry/region.h>
+#include <libgeodecomp/misc/apitraits.h>
+#include <libgeodecomp/storage/gridbase.h>
+
+#include <stdexcept>
+
+namespace LibGeoDecomp {
+
+/**
+ * An Analyzer is a hook for in-situ analysis (histograms, global
+ * statistics etc.). Unlike a Writer it is not run synchronously
+ * after each time step: a Simulator may defer it and run it on a
+ * spare core, concurrently with the update of the following step
+ * (see SerialSimulator::addAnalyzer()). This is possible without
+ * copying the grid, as the update only reads from the old grid
+ * while it writes to the new one.
+ *
+ * Consequently analyze() must treat the grid as read-only and must
+ * not interact with the Simulator. MemberView offers efficient
+ * access to single members for both, AoS and SoA grids.
+ */
+template<typename CELL_TYPE>
+class Analyzer
+{
+public:
+    typedef typename APITraits::SelectTopology<CELL_TYPE>::Value Topology;
+    static const int DIM = Topology::DIM;
+    typedef GridBase<CELL_TYPE, DIM> GridType;
+
+    explicit Analyzer(const unsigned period = 1) :
+        period(period)
+    {
+        if (period == 0) {
+            throw std::invalid_argument("period must be positive");
+        }
+    }
+
+    virtual ~Analyzer()
+    {}
+
+    /**
+     * is called for every period-th step with the grid as it was at
+     * the end of that step. validRegion specifies the cells which
+     * are accessible via grid.
+     */
+    virtual void analyze(
+        const GridType& grid,
+        const Region<DIM>& validRegion,
+        unsigned step) = 0;
+
+    unsigned getPeriod() const
+    {
+        return period;
+    }
+
+protected:
+    unsigned period;
+};
+
+}
+
+#endif
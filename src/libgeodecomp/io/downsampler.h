@@ -0,0 +1,309 @@
+#ifndef LIBGEODECOMP_IO_DOWNSAMPLER_H
+#define LIBGEODECOMP_IO_DOWNSAMPLER_H
+
+#include <libgeodecomp/config.h>
+#include <libgeodecomp/geometry/coord.h>
+#include <libgeodecomp/geometry/region.h>
+#include <libgeodecomp/geometry/streak.h>
+#include <libgeodecomp/misc/color.h>
+#include <libgeodecomp/misc/sharedptr.h>
+#include <libgeodecomp/storage/gridbase.h>
+#include <libgeodecomp/storage/selector.h>
+#include <libgeodecomp/storage/simplefilter.h>
+
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+
+namespace LibGeoDecomp {
+
+/**
+ * Parameters for rendering grids which are larger than the desired
+ * image: each pixel represents a block of blockDim cells. Its color
+ * is derived from the average, minimum or maximum of the selected
+ * member within that block.
+ */
+class Downsampling
+{
+public:
+    enum Mode {AVERAGE, MINIMUM, MAXIMUM};
+
+    explicit Downsampling(
+        const Coord<2>& blockDim = Coord<2>(1, 1),
+        Mode mode = AVERAGE) :
+        blockDim(blockDim),
+        mode(mode)
+    {
+        if ((blockDim.x() < 1) || (blockDim.y() < 1)) {
+            throw std::invalid_argument("downsampling block dimensions must be positive");
+        }
+    }
+
+    /**
+     * Partial blocks at the lower/right edges of the grid still
+     * yield a pixel.
+     */
+    Coord<2> imageDim(const Coord<2>& gridDim) const
+    {
+        return Coord<2>(
+            (gridDim.x() + blockDim.x() - 1) / blockDim.x(),
+            (gridDim.y() + blockDim.y() - 1) / blockDim.y());
+    }
+
+    const Coord<2>& getBlockDim() const
+    {
+        return blockDim;
+    }
+
+    Mode getMode() const
+    {
+        return mode;
+    }
+
+private:
+    Coord<2> blockDim;
+    Mode mode;
+};
+
+namespace DownsamplerHelpers {
+
+/**
+ * Extracts a member as double, regardless of its actual type, so
+ * that Downsampler doesn't need to be templated on it.
+ */
+template<typename CELL, typename MEMBER>
+class MemberToDouble : public SimpleFilter<CELL, MEMBER, double>
+{
+public:
+    void load(const double& source, MEMBER *target)
+    {
+        *target = static_cast<MEMBER>(source);
+    }
+
+    void save(const MEMBER& source, double *target)
+    {
+        *target = static_cast<double>(source);
+    }
+};
+
+/**
+ * Type erasure for palettes, see below.
+ */
+class ColorMap
+{
+public:
+    virtual ~ColorMap()
+    {}
+
+    virtual Color operator()(double value) const = 0;
+};
+
+/**
+ * Converts the aggregated value back to the member's type before
+ * looking up its color.
+ */
+template<typename MEMBER, typename PALETTE>
+class PaletteColorMap : public ColorMap
+{
+public:
+    explicit PaletteColorMap(const PALETTE& palette) :
+        palette(palette)
+    {}
+
+    Color operator()(double value) const
+    {
+        return palette[static_cast<MEMBER>(value)];
+    }
+
+private:
+    PALETTE palette;
+};
+
+}
+
+/**
+ * Renders 2D grids at a reduced resolution (see Downsampling). This
+ * decouples the size of the output images from the grid size.
+ *
+ * Pixels are computed from aggregates: a running sum and a cell count
+ * per pixel for AVERAGE, a running minimum or maximum otherwise. The
+ * aggregates of multiple partial grids (e.g. the subdomains of
+ * different MPI ranks) can be merged via sum/min/max, which is what
+ * ParallelPPMWriter does.
+ */
+template<typename CELL>
+class Downsampler
+{
+public:
+    template<typename MEMBER, typename PALETTE>
+    Downsampler(
+        MEMBER CELL:: *member,
+        const PALETTE& palette,
+        const Downsampling& downsampling) :
+        downsampling(downsampling),
+        selector(
+            member,
+            "downsampledMember",
+            typename SharedPtr<FilterBase<CELL> >::Type(
+                new DownsamplerHelpers::MemberToDouble<CELL, MEMBER>())),
+        colorMap(new DownsamplerHelpers::PaletteColorMap<MEMBER, PALETTE>(palette))
+    {}
+
+    Coord<2> imageDim(const Coord<2>& gridDim) const
+    {
+        return downsampling.imageDim(gridDim);
+    }
+
+    const Downsampling& getDownsampling() const
+    {
+        return downsampling;
+    }
+
+    /**
+     * Initializes num aggregates to the neutral element of the
+     * reduction.
+     */
+    void resetAggregates(double *values, double *counts, std::size_t num) const
+    {
+        std::fill(values, values + num, neutralElement());
+        std::fill(counts, counts + num, 0.0);
+    }
+
+    /**
+     * Adds all cells of the streak to the aggregates. Coordinates are
+     * relative to gridOrigin, the aggregate arrays cover the image
+     * rows starting at firstImageRow. buffer is scratch space, reuse
+     * it to avoid allocations.
+     */
+    void aggregate(
+        const GridBase<CELL, 2>& grid,
+        const Streak<2>& streak,
+        const Coord<2>& gridOrigin,
+        int imageWidth,
+        int firstImageRow,
+        double *values,
+        double *counts,
+        std::vector<double> *buffer) const
+    {
+        std::size_t length = streak.length();
+        if (length == 0) {
+            return;
+        }
+        if (buffer->size() < length) {
+            buffer->resize(length);
+        }
+
+        Region<2> region;
+        region << streak;
+        grid.saveMemberUnchecked(
+            reinterpret_cast<char*>(&(*buffer)[0]),
+            MemoryLocation::HOST,
+            selector,
+            region);
+
+        const Coord<2>& blockDim = downsampling.getBlockDim();
+        int row = (streak.origin.y() - gridOrigin.y()) / blockDim.y() - firstImageRow;
+        double *rowValues = values + long(row) * imageWidth;
+        double *rowCounts = counts + long(row) * imageWidth;
+
+        int x = streak.origin.x() - gridOrigin.x();
+        for (std::size_t i = 0; i < length; ++i, ++x) {
+            int pixel = x / blockDim.x();
+            add(rowValues + pixel, (*buffer)[i]);
+            rowCounts[pixel] += 1;
+        }
+    }
+
+    Color color(double value, double count) const
+    {
+        if (downsampling.getMode() == Downsampling::AVERAGE) {
+            if (count > 0) {
+                value /= count;
+            }
+        }
+
+        return (*colorMap)(value);
+    }
+
+    /**
+     * Renders image rows [startY, endY) of the given grid into
+     * target, which needs to hold (endY - startY) rows of the full
+     * image width. Rows are distributed among threads.
+     */
+    void renderRows(
+        const GridBase<CELL, 2>& grid,
+        int startY,
+        int endY,
+        Color *target) const
+    {
+        CoordBox<2> box = grid.boundingBox();
+        const Coord<2>& blockDim = downsampling.getBlockDim();
+        int imageWidth = imageDim(box.dimensions).x();
+
+#ifdef LIBGEODECOMP_WITH_THREADS
+#pragma omp parallel
+#endif
+        {
+            // scratch space per thread:
+            std::vector<double> values(imageWidth);
+            std::vector<double> counts(imageWidth);
+            std::vector<double> buffer(box.dimensions.x());
+
+#ifdef LIBGEODECOMP_WITH_THREADS
+#pragma omp for schedule(dynamic)
+#endif
+            for (int y = startY; y < endY; ++y) {
+                resetAggregates(&values[0], &counts[0], imageWidth);
+
+                int cellEndY = (std::min)((y + 1) * blockDim.y(), box.dimensions.y());
+                for (int cellY = y * blockDim.y(); cellY < cellEndY; ++cellY) {
+                    Streak<2> streak(
+                        box.origin + Coord<2>(0, cellY),
+                        box.origin.x() + box.dimensions.x());
+                    aggregate(grid, streak, box.origin, imageWidth, y, &values[0], &counts[0], &buffer);
+                }
+
+                Color *row = target + long(y - startY) * imageWidth;
+                for (int x = 0; x < imageWidth; ++x) {
+                    row[x] = color(values[x], counts[x]);
+                }
+            }
+        }
+    }
+
+private:
+    Downsampling downsampling;
+    Selector<CELL> selector;
+    typename SharedPtr<DownsamplerHelpers::ColorMap>::Type colorMap;
+
+    double neutralElement() const
+    {
+        switch (downsampling.getMode()) {
+        case Downsampling::MINIMUM:
+            return (std::numeric_limits<double>::max)();
+        case Downsampling::MAXIMUM:
+            return -(std::numeric_limits<double>::max)();
+        default:
+            return 0;
+        }
+    }
+
+    void add(double *aggregate, double value) const
+    {
+        switch (downsampling.getMode()) {
+        case Downsampling::MINIMUM:
+            *aggregate = (std::min)(*aggregate, value);
+            break;
+        case Downsampling::MAXIMUM:
+            *aggregate = (std::max)(*aggregate, value);
+            break;
+        default:
+            *aggregate += value;
+        }
+    }
+};
+
+}
+
+#endif
@@ -0,0 +1,129 @@
+#ifndef LIBGEODECOMP_IO_HISTOGRAMANALYZER_H
+#define LIBGEODECOMP_IO_HISTOGRAMANALYZER_H
+
+#include <libgeodecomp/io/analyzer.h>
+#include <libgeodecomp/storage/memberview.h>
+
+#include <algorithm>
+#include <limits>
+#include <map>
+#include <vector>
+
+namespace LibGeoDecomp {
+
+/**
+ * Computes a histogram and basic statistics (min, max, mean) of a
+ * single member of all cells. Values outside of [minValue, maxValue)
+ * are accounted for in the first and last bin, respectively. Results
+ * are retained per step.
+ */
+template<typename CELL_TYPE, typename MEMBER_TYPE>
+class HistogramAnalyzer : public Analyzer<CELL_TYPE>
+{
+public:
+    typedef typename Analyzer<CELL_TYPE>::GridType GridType;
+    static const int DIM = Analyzer<CELL_TYPE>::DIM;
+
+    class Result
+    {
+    public:
+        Result() :
+            count(0),
+            min(std::numeric_limits<double>::max()),
+            max(-std::numeric_limits<double>::max()),
+            sum(0)
+        {}
+
+        double mean() const
+        {
+            return count ? sum / count : 0;
+        }
+
+        std::vector<std::size_t> bins;
+        std::size_t count;
+        double min;
+        double max;
+        double sum;
+    };
+
+    typedef std::map<unsigned, Result> ResultMap;
+
+    HistogramAnalyzer(
+        MEMBER_TYPE CELL_TYPE:: *memberPointer,
+        double minValue,
+        double maxValue,
+        std::size_t numBins,
+        const unsigned period = 1) :
+        Analyzer<CELL_TYPE>(period),
+        memberPointer(memberPointer),
+        minValue(minValue),
+        maxValue(maxValue),
+        numBins(numBins)
+    {
+        if ((numBins == 0) || !(minValue < maxValue)) {
+            throw std::invalid_argument("histogram needs at least one bin and a non-empty value range");
+        }
+    }
+
+    void analyze(
+        const GridType& grid,
+        const Region<DIM>& validRegion,
+        unsigned step)
+    {
+        Result& result = results[step];
+        result = Result();
+        result.bins.resize(numBins, 0);
+
+        Accumulator accumulator(this, &result);
+        MemberView<CELL_TYPE, MEMBER_TYPE, DIM>(grid, memberPointer, validRegion).forEach(accumulator);
+    }
+
+    const ResultMap& getResults() const
+    {
+        return results;
+    }
+
+private:
+    MEMBER_TYPE CELL_TYPE:: *memberPointer;
+    double minValue;
+    double maxValue;
+    std::size_t numBins;
+    ResultMap results;
+
+    class Accumulator
+    {
+    public:
+        Accumulator(const HistogramAnalyzer *analyzer, Result *result) :
+            analyzer(analyzer),
+            result(result),
+            scale(analyzer->numBins / (analyzer->maxValue - analyzer->minValue))
+        {}
+
+        void operator()(const MEMBER_TYPE& member)
+        {
+            double value = member;
+            result->min = (std::min)(result->min, value);
+            result->max = (std::max)(result->max, value);
+            result->sum += value;
+            ++result->count;
+
+            double bin = (value - analyzer->minValue) * scale;
+            std::size_t index = 0;
+            if (bin >= analyzer->numBins) {
+                index = analyzer->numBins - 1;
+            } else if (bin > 0) {
+                index = std::size_t(bin);
+            }
+            ++result->bins[index];
+        }
+
+    private:
+        const HistogramAnalyzer *analyzer;
+        Result *result;
+        double scale;
+    };
+};
+
+}
+
+#endif
@@ -0,0 +1,304 @@
+#include <libgeodecomp/config.h>
+#ifdef LIBGEODECOMP_WITH_MPI
+#ifndef LIBGEODECOMP_IO_METRICSWRITER_H
+#define LIBGEODECOMP_IO_METRICSWRITER_H
+
+#include <libgeodecomp/communication/mpilayer.h>
+#include <libgeodecomp/io/ioexception.h>
+#include <libgeodecomp/io/parallelwriter.h>
+#include <libgeodecomp/misc/chronometer.h>
+#include <libgeodecomp/misc/clonable.h>
+#include <libgeodecomp/misc/scopedtimer.h>
+#include <libgeodecomp/parallelization/simulator.h>
+
+#include <cstdio>
+#include <ctime>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+
+namespace LibGeoDecomp {
+
+/**
+ * The MetricsWriter is the machine-readable sibling of the
+ * TracingWriter: every period steps it gathers the step time, the
+ * split of compute, ghost zone and communication time (taken from
+ * the Chronometer of the Simulator passed as statisticsSource) and
+ * the number of cells of each rank. These are reduced to min, average
+ * and max across all ranks (plus the rank of the slowest node), from
+ * which the overall GLUPS and the load imbalance ratio (max compute
+ * time over average compute time) are derived.
+ *
+ * Output is done by outputRank only, either by appending one JSON
+ * object per record to the file (JSON_LINES), or by atomically
+ * replacing it with the current values in Prometheus' text exposition
+ * format (PROMETHEUS), which suits node_exporter's textfile
+ * collector.
+ *
+ * All times are given in seconds per time step and refer to the
+ * steps since the previous record. Without statisticsSource only the
+ * wall clock time per step is available.
+ */
+template<typename CELL_TYPE>
+class MetricsWriter : public Clonable<ParallelWriter<CELL_TYPE>, MetricsWriter<CELL_TYPE> >
+{
+public:
+    typedef typename ParallelWriter<CELL_TYPE>::GridType WriterGridType;
+    typedef typename ParallelWriter<CELL_TYPE>::Topology Topology;
+    using ParallelWriter<CELL_TYPE>::period;
+    using ParallelWriter<CELL_TYPE>::prefix;
+    using ParallelWriter<CELL_TYPE>::region;
+
+    static const int DIM = Topology::DIM;
+    static const unsigned NANO_STEPS = APITraits::SelectNanoSteps<CELL_TYPE>::VALUE;
+
+    enum Format {
+        JSON_LINES,
+        PROMETHEUS
+    };
+
+    /**
+     * The Simulator referenced by statisticsSource needs to outlive
+     * this writer.
+     */
+    explicit MetricsWriter(
+        const std::string& filename,
+        const unsigned period = 1,
+        Format format = JSON_LINES,
+        const Simulator<CELL_TYPE> *statisticsSource = 0,
+        int outputRank = 0,
+        MPI_Comm communicator = MPI_COMM_WORLD) :
+        Clonable<ParallelWriter<CELL_TYPE>, MetricsWriter<CELL_TYPE> >(filename, period),
+        format(format),
+        statisticsSource(statisticsSource),
+        outputRank(outputRank),
+        mpiLayer(communicator),
+        lastTime(0),
+        lastStep(0)
+    {}
+
+    virtual void stepFinished(
+        const WriterGridType& /* grid */,
+        const Region<DIM>& /* validRegion */,
+        const Coord<DIM>& globalDimensions,
+        unsigned step,
+        WriterEvent event,
+        std::size_t /* rank */,
+        bool lastCall)
+    {
+        if (!lastCall) {
+            return;
+        }
+
+        if (event == WRITER_INITIALIZED) {
+            resetBaseline(step);
+            if ((format == JSON_LINES) && (mpiLayer.rank() == outputRank)) {
+                // truncate previous runs' output:
+                writeFile(prefix, std::ios_base::out, "");
+            }
+            return;
+        }
+
+        if ((event == WRITER_STEP_FINISHED) && (step % period != 0)) {
+            return;
+        }
+
+        if (step > lastStep) {
+            record(step, globalDimensions);
+        }
+    }
+
+private:
+    enum Metric {
+        STEP_TIME,
+        COMPUTE_TIME,
+        GHOST_TIME,
+        COMMUNICATION_TIME,
+        CELLS,
+        NUM_METRICS
+    };
+
+    Format format;
+    const Simulator<CELL_TYPE> *statisticsSource;
+    int outputRank;
+    MPILayer mpiLayer;
+    double lastTime;
+    unsigned lastStep;
+    Chronometer lastStatistics;
+
+    Chronometer currentStatistics() const
+    {
+        if (statisticsSource) {
+            return statisticsSource->currentStatistics();
+        }
+
+        return Chronometer();
+    }
+
+    void resetBaseline(unsigned step)
+    {
+        lastTime = ScopedTimer::time();
+        lastStep = step;
+        lastStatistics = currentStatistics();
+    }
+
+    void record(unsigned step, const Coord<DIM>& globalDimensions)
+    {
+        double now = ScopedTimer::time();
+        double steps = step - lastStep;
+        Chronometer delta = currentStatistics().delta(lastStatistics);
+
+        double local[NUM_METRICS];
+        local[STEP_TIME]          = (now - lastTime) / steps;
+        local[COMPUTE_TIME]       = delta.interval<TimeCompute>() / steps;
+        local[GHOST_TIME]         = delta.interval<TimeComputeGhost>() / steps;
+        local[COMMUNICATION_TIME] = (delta.interval<TimeCommunication>() +
+                                     delta.interval<TimePatchProviders>()) / steps;
+        local[CELLS]              = region.size();
+
+        // min is reduced as max of the negated values, so that two
+        // reductions plus a MAXLOC for locating the slowest rank
+        // suffice:
+        double localExtrema[2 * NUM_METRICS];
+        for (int i = 0; i < NUM_METRICS; ++i) {
+            localExtrema[i] = local[i];
+            localExtrema[NUM_METRICS + i] = -local[i];
+        }
+        struct {
+            double value;
+            int rank;
+        } localSlowest = { local[STEP_TIME], mpiLayer.rank() }, slowest;
+
+        double extrema[2 * NUM_METRICS];
+        double sums[NUM_METRICS];
+        MPI_Comm comm = mpiLayer.communicator();
+        MPI_Reduce(localExtrema, extrema, 2 * NUM_METRICS, MPI_DOUBLE, MPI_MAX, outputRank, comm);
+        MPI_Reduce(local, sums, NUM_METRICS, MPI_DOUBLE, MPI_SUM, outputRank, comm);
+        MPI_Reduce(&localSlowest, &slowest, 1, MPI_DOUBLE_INT, MPI_MAXLOC, outputRank, comm);
+
+        resetBaseline(step);
+        if (mpiLayer.rank() != outputRank) {
+            return;
+        }
+
+        int ranks = mpiLayer.size();
+        double mins[NUM_METRICS];
+        double avgs[NUM_METRICS];
+        double maxs[NUM_METRICS];
+        for (int i = 0; i < NUM_METRICS; ++i) {
+            maxs[i] = extrema[i];
+            mins[i] = -extrema[NUM_METRICS + i];
+            avgs[i] = sums[i] / ranks;
+        }
+
+        double updates = 1.0 * NANO_STEPS * globalDimensions.prod();
+        double glups = (maxs[STEP_TIME] > 0) ? (updates / maxs[STEP_TIME] * 1e-9) : 0;
+        Metric balanceMetric = (avgs[COMPUTE_TIME] > 0) ? COMPUTE_TIME : STEP_TIME;
+        double imbalance = (avgs[balanceMetric] > 0) ? (maxs[balanceMetric] / avgs[balanceMetric]) : 1;
+
+        std::ostringstream buf;
+        buf << std::setprecision(9);
+        if (format == JSON_LINES) {
+            buf << "{\"step\": " << step
+                << ", \"timestamp\": " << std::time(0)
+                << ", \"ranks\": " << ranks
+                << ", \"glups\": " << glups
+                << ", \"imbalance\": " << imbalance
+                << ", \"slowest_rank\": " << slowest.rank;
+            for (int i = 0; i < NUM_METRICS; ++i) {
+                buf << ", \"" << metricName(i) << "\": {"
+                    << "\"min\": " << mins[i] << ", "
+                    << "\"avg\": " << avgs[i] << ", "
+                    << "\"max\": " << maxs[i] << "}";
+            }
+            buf << "}\n";
+
+            writeFile(prefix, std::ios_base::app, buf.str());
+            return;
+        }
+
+        writeGauge(&buf, "step", "Last time step covered by these metrics.", step);
+        writeGauge(&buf, "timestamp_seconds", "Unix time at which the metrics were recorded.", std::time(0));
+        writeGauge(&buf, "ranks", "Number of ranks.", ranks);
+        writeGauge(&buf, "glups", "Giga lattice updates per second, based on the slowest rank.", glups);
+        writeGauge(&buf, "imbalance_ratio", "Max compute time over average compute time.", imbalance);
+        writeGauge(&buf, "slowest_rank", "Rank with the longest step time.", slowest.rank);
+        for (int i = 0; i < NUM_METRICS; ++i) {
+            std::string name = "libgeodecomp_" + metricName(i);
+            buf << "# HELP " << name << " " << metricHelp(i) << "\n"
+                << "# TYPE " << name << " gauge\n"
+                << name << "{stat=\"min\"} " << mins[i] << "\n"
+                << name << "{stat=\"avg\"} " << avgs[i] << "\n"
+                << name << "{stat=\"max\"} " << maxs[i] << "\n";
+        }
+
+        // scrapers must never see a partially written file:
+        std::string tempName = prefix + ".tmp";
+        writeFile(tempName, std::ios_base::out, buf.str());
+        if (std::rename(tempName.c_str(), prefix.c_str()) != 0) {
+            throw FileWriteException(prefix);
+        }
+    }
+
+    template<typename VALUE>
+    void writeGauge(std::ostringstream *buf, const std::string& name, const std::string& help, VALUE value)
+    {
+        *buf << "# HELP libgeodecomp_" << name << " " << help << "\n"
+             << "# TYPE libgeodecomp_" << name << " gauge\n"
+             << "libgeodecomp_" << name << " " << value << "\n";
+    }
+
+    std::string metricName(int metric) const
+    {
+        switch (metric) {
+        case STEP_TIME:
+            return "step_time_seconds";
+        case COMPUTE_TIME:
+            return "compute_time_seconds";
+        case GHOST_TIME:
+            return "ghost_time_seconds";
+        case COMMUNICATION_TIME:
+            return "communication_time_seconds";
+        case CELLS:
+            return "cells";
+        default:
+            throw std::invalid_argument("unknown metric");
+        }
+    }
+
+    std::string metricHelp(int metric) const
+    {
+        switch (metric) {
+        case STEP_TIME:
+            return "Wall clock time per step across ranks.";
+        case COMPUTE_TIME:
+            return "Time per step spent updating cells across ranks.";
+        case GHOST_TIME:
+            return "Time per step spent updating ghost zones across ranks.";
+        case COMMUNICATION_TIME:
+            return "Time per step spent communicating or waiting for ghost zones across ranks.";
+        case CELLS:
+            return "Number of cells per rank.";
+        default:
+            throw std::invalid_argument("unknown metric");
+        }
+    }
+
+    void writeFile(const std::string& filename, std::ios_base::openmode mode, const std::string& content)
+    {
+        std::ofstream file(filename.c_str(), mode);
+        if (!file.good()) {
+            throw FileOpenException(filename);
+        }
+
+        file << content;
+        if (!file.good()) {
+            throw FileWriteException(filename);
+        }
+    }
+};
+
+}
+
+#endif
+#endif
@@ -0,0 +1,191 @@
+#ifndef LIBGEODECOMP_IO_PARALLELPPMWRITER_H
+#define LIBGEODECOMP_IO_PARALLELPPMWRITER_H
+
+#include <libgeodecomp/config.h>
+#ifdef LIBGEODECOMP_WITH_MPI
+
+#include <libgeodecomp/io/downsampler.h>
+#include <libgeodecomp/io/parallelwriter.h>
+#include <libgeodecomp/misc/clonable.h>
+
+#include <mpi.h>
+#include <iomanip>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace LibGeoDecomp {
+
+/**
+ * Parallel counterpart of PPMWriter for downsampled images (see
+ * Downsampling). Unlike wrapping a PPMWriter in a CollectingWriter,
+ * the grid is never gathered on a single rank: each rank aggregates
+ * its own subdomain into pixel-sized sums, minima or maxima. These
+ * get reduced so that every rank ends up with one horizontal band of
+ * the image, which it then colors and writes to the shared file via
+ * MPI-IO. Thus neither memory nor bandwidth on any rank scale with
+ * the size of the global grid.
+ */
+template<typename CELL_TYPE>
+class ParallelPPMWriter : public Clonable<ParallelWriter<CELL_TYPE>, ParallelPPMWriter<CELL_TYPE> >
+{
+public:
+    friend class ParallelPPMWriterTest;
+    typedef typename ParallelWriter<CELL_TYPE>::GridType GridType;
+    typedef typename APITraits::SelectTopology<CELL_TYPE>::Value Topology;
+    using ParallelWriter<CELL_TYPE>::period;
+    using ParallelWriter<CELL_TYPE>::prefix;
+
+    template<typename MEMBER, typename PALETTE>
+    ParallelPPMWriter(
+        MEMBER CELL_TYPE:: *member,
+        const PALETTE& palette,
+        const std::string& prefix,
+        const unsigned period = 1,
+        const Downsampling& downsampling = Downsampling(),
+        const MPI_Comm& communicator = MPI_COMM_WORLD) :
+        Clonable<ParallelWriter<CELL_TYPE>, ParallelPPMWriter<CELL_TYPE> >(prefix, period),
+        downsampler(member, palette, downsampling),
+        comm(communicator),
+        collecting(false)
+    {}
+
+    virtual void stepFinished(
+        const GridType& grid,
+        const Region<Topology::DIM>& validRegion,
+        const Coord<Topology::DIM>& globalDimensions,
+        unsigned step,
+        WriterEvent event,
+        std::size_t rank,
+        bool lastCall)
+    {
+        if ((event == WRITER_STEP_FINISHED) && (step % period != 0)) {
+            return;
+        }
+
+        Coord<2> imageDim = downsampler.imageDim(globalDimensions);
+        if (!collecting) {
+            std::size_t numPixels = std::size_t(imageDim.x()) * imageDim.y();
+            values.resize(numPixels);
+            counts.resize(numPixels);
+            downsampler.resetAggregates(values.data(), counts.data(), numPixels);
+            aggregatedRegion.clear();
+            collecting = true;
+        }
+
+        // the grid may be handed to us multiple times per time step
+        // (e.g. for multiple threads or update groups), each time with
+        // a different valid region:
+        Region<2> globalRegion;
+        globalRegion << CoordBox<2>(Coord<2>(), globalDimensions);
+        Region<2> newRegion = (validRegion & globalRegion) - aggregatedRegion;
+        aggregatedRegion += newRegion;
+
+        for (Region<2>::StreakIterator i = newRegion.beginStreak(); i != newRegion.endStreak(); ++i) {
+            downsampler.aggregate(
+                grid, *i, Coord<2>(), imageDim.x(), 0, values.data(), counts.data(), &buffer);
+        }
+
+        if (lastCall) {
+            writeImage(imageDim, filename(step));
+            collecting = false;
+        }
+    }
+
+private:
+    Downsampler<CELL_TYPE> downsampler;
+    MPI_Comm comm;
+    bool collecting;
+    Region<2> aggregatedRegion;
+    std::vector<double> values;
+    std::vector<double> counts;
+    std::vector<double> buffer;
+
+    /**
+     * Rank r owns image rows [bandStart(r), bandStart(r + 1)).
+     */
+    static int bandStart(int rank, int numRanks, int imageHeight)
+    {
+        return int(long(rank) * imageHeight / numRanks);
+    }
+
+    void writeImage(const Coord<2>& imageDim, const std::string& filename)
+    {
+        int rank;
+        int size;
+        MPI_Comm_rank(comm, &rank);
+        MPI_Comm_size(comm, &size);
+
+        std::vector<int> bandSizes(size);
+        for (int i = 0; i < size; ++i) {
+            bandSizes[i] = imageDim.x() *
+                (bandStart(i + 1, size, imageDim.y()) - bandStart(i, size, imageDim.y()));
+        }
+        int startY = bandStart(rank, size, imageDim.y());
+
+        std::vector<double> bandValues(bandSizes[rank]);
+        std::vector<double> bandCounts(bandSizes[rank]);
+        MPI_Reduce_scatter(
+            values.data(), bandValues.data(), bandSizes.data(), MPI_DOUBLE, reductionOperator(), comm);
+        if (downsampler.getDownsampling().getMode() == Downsampling::AVERAGE) {
+            MPI_Reduce_scatter(
+                counts.data(), bandCounts.data(), bandSizes.data(), MPI_DOUBLE, MPI_SUM, comm);
+        }
+
+        std::vector<char> pixels(3 * std::size_t(bandSizes[rank]));
+        for (int i = 0; i < bandSizes[rank]; ++i) {
+            Color color = downsampler.color(bandValues[i], bandCounts[i]);
+            pixels[3 * i + 0] = (char)color.red();
+            pixels[3 * i + 1] = (char)color.green();
+            pixels[3 * i + 2] = (char)color.blue();
+        }
+
+        std::ostringstream buf;
+        buf << "P6 " << imageDim.x() << " " << imageDim.y() << " 255\n";
+        std::string header = buf.str();
+        MPI_Offset headerLength = MPI_Offset(header.size());
+
+        MPI_File file;
+        MPI_File_open(
+            comm, const_cast<char*>(filename.c_str()),
+            MPI_MODE_CREATE | MPI_MODE_WRONLY, MPI_INFO_NULL,
+            &file);
+        MPI_File_set_errhandler(file, MPI_ERRORS_ARE_FATAL);
+        // truncate leftovers from previous, larger images:
+        MPI_File_set_size(file, headerLength + MPI_Offset(3) * imageDim.x() * imageDim.y());
+
+        if (rank == 0) {
+            MPI_File_write_at(
+                file, 0, const_cast<char*>(header.c_str()), int(header.size()), MPI_CHAR, MPI_STATUS_IGNORE);
+        }
+
+        MPI_Offset offset = headerLength + MPI_Offset(3) * imageDim.x() * startY;
+        MPI_File_write_at_all(
+            file, offset, pixels.data(), int(pixels.size()), MPI_CHAR, MPI_STATUS_IGNORE);
+        MPI_File_close(&file);
+    }
+
+    MPI_Op reductionOperator() const
+    {
+        switch (downsampler.getDownsampling().getMode()) {
+        case Downsampling::MINIMUM:
+            return MPI_MIN;
+        case Downsampling::MAXIMUM:
+            return MPI_MAX;
+        default:
+            return MPI_SUM;
+        }
+    }
+
+    std::string filename(unsigned step) const
+    {
+        std::ostringstream buf;
+        buf << prefix << "." << std::setfill('0') << std::setw(4) << step << ".ppm";
+        return buf.str();
+    }
+};
+
+}
+
+#endif
+#endif
@@ -0,0 +1,1125 @@
+#ifndef LIBGEODECOMP_IO_PARALLELVTKWRITER_H
+#define LIBGEODECOMP_IO_PARALLELVTKWRITER_H
+
+#include <libgeodecomp/config.h>
+#ifdef LIBGEODECOMP_WITH_MPI
+
+#include <libgeodecomp/communication/mpilayer.h>
+#include <libgeodecomp/geometry/floatcoord.h>
+#include <libgeodecomp/geometry/region.h>
+#include <libgeodecomp/io/ioexception.h>
+#include <libgeodecomp/io/parallelwriter.h>
+#include <libgeodecomp/misc/apitraits.h>
+#include <libgeodecomp/misc/clonable.h>
+#include <libgeodecomp/misc/sharedptr.h>
+#include <libgeodecomp/misc/stdcontaineroverloads.h>
+#include <libgeodecomp/storage/collectioninterface.h>
+#include <libgeodecomp/storage/selector.h>
+
+#include <mpi.h>
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <map>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace LibGeoDecomp {
+
+namespace ParallelVTKWriterHelpers {
+
+/**
+ * Maps the type names reported by Selectors to VTK's names.
+ */
+inline std::string vtkTypeName(const std::string& typeName)
+{
+    if (typeName == "BYTE") {
+        return "Int8";
+    }
+    if (typeName == "INT") {
+        return "Int32";
+    }
+    if (typeName == "LONG") {
+        return "Int64";
+    }
+    if (typeName == "FLOAT") {
+        return "Float32";
+    }
+    if (typeName == "DOUBLE") {
+        return "Float64";
+    }
+
+    throw std::invalid_argument("no VTK type known for selector type " + typeName);
+}
+
+/**
+ * Raw values of one variable, as extracted by a Selector.
+ */
+class DataArray
+{
+public:
+    DataArray(const std::string& name, const std::string& type, int components) :
+        name(name),
+        type(type),
+        components(components)
+    {}
+
+    std::string name;
+    std::string type;
+    int components;
+    std::vector<char> data;
+};
+
+/**
+ * Splits a Region into few, disjoint boxes: streaks of equal extent
+ * in neighboring rows are merged into rectangles, rectangles of
+ * equal extent in neighboring planes into cuboids.
+ */
+template<int DIM>
+std::vector<CoordBox<DIM> > boxes(const Region<DIM>& region)
+{
+    std::vector<CoordBox<DIM> > ret;
+    for (typename Region<DIM>::StreakIterator i = region.beginStreak(); i != region.endStreak(); ++i) {
+        Coord<DIM> dimensions = Coord<DIM>::diagonal(1);
+        dimensions[0] = i->length();
+        ret << CoordBox<DIM>(i->origin, dimensions);
+    }
+
+    for (int d = 1; d < DIM; ++d) {
+        // boxes which may still grow along d, indexed by the origin
+        // and shape their next slice would need to have:
+        typedef std::map<std::pair<Coord<DIM>, Coord<DIM> >, std::size_t> OpenBoxes;
+        OpenBoxes openBoxes;
+        std::vector<CoordBox<DIM> > merged;
+
+        for (typename std::vector<CoordBox<DIM> >::const_iterator i = ret.begin(); i != ret.end(); ++i) {
+            typename OpenBoxes::iterator match = openBoxes.find(std::make_pair(i->origin, i->dimensions));
+            std::size_t index = merged.size();
+
+            if (match == openBoxes.end()) {
+                merged << *i;
+            } else {
+                index = match->second;
+                merged[index].dimensions[d] += 1;
+                openBoxes.erase(match);
+            }
+
+            Coord<DIM> next = i->origin;
+            next[d] += 1;
+            openBoxes[std::make_pair(next, i->dimensions)] = index;
+        }
+
+        std::swap(ret, merged);
+    }
+
+    return ret;
+}
+
+/**
+ * Common parts of the VTK XML files written by ParallelVTKWriter.
+ * All arrays are stored in raw, appended binary format. This keeps
+ * the files compact and avoids any dependencies on external
+ * libraries.
+ */
+class PieceBase
+{
+public:
+    std::vector<DataArray> cellData;
+
+protected:
+    template<typename T>
+    static std::size_t byteSize(const std::vector<T>& vec)
+    {
+        return vec.size() * sizeof(T);
+    }
+
+    static void writeFileHeader(std::ofstream& file, const std::string& type)
+    {
+        file << "<?xml version=\"1.0\"?>\n"
+             << "<VTKFile type=\"" << type << "\" version=\"1.0\" "
+             << "byte_order=\"LittleEndian\" header_type=\"UInt64\">\n";
+    }
+
+    static void writeArrayHeader(
+        std::ofstream& file,
+        const std::string& name,
+        const std::string& type,
+        int components,
+        std::size_t byteSize,
+        std::size_t *offset)
+    {
+        file << "        <DataArray type=\"" << type << "\" Name=\"" << name
+             << "\" NumberOfComponents=\"" << components
+             << "\" format=\"appended\" offset=\"" << *offset << "\"/>\n";
+        *offset += sizeof(unsigned long long) + byteSize;
+    }
+
+    static void writeIndexArrayHeader(
+        std::ofstream& file,
+        const std::string& name,
+        const std::string& type,
+        int components)
+    {
+        file << "      <PDataArray type=\"" << type << "\" Name=\"" << name
+             << "\" NumberOfComponents=\"" << components << "\"/>\n";
+    }
+
+    static void writeArray(std::ofstream& file, const char *data, std::size_t byteSize)
+    {
+        unsigned long long size = byteSize;
+        file.write(reinterpret_cast<const char*>(&size), sizeof(size));
+        if (size > 0) {
+            file.write(data, std::streamsize(size));
+        }
+    }
+
+    template<typename T>
+    static void writeArray(std::ofstream& file, const std::vector<T>& vec)
+    {
+        writeArray(file, vec.empty() ? 0 : reinterpret_cast<const char*>(&vec[0]), byteSize(vec));
+    }
+};
+
+/**
+ * One partition of a mesh, stored as a VTK XML UnstructuredGrid
+ * (.vtu).
+ */
+class Piece : public PieceBase
+{
+public:
+    // cell type IDs as defined by VTK:
+    static const unsigned char VTK_VERTEX = 1;
+    static const unsigned char VTK_POLYGON = 7;
+
+    void clear()
+    {
+        points.clear();
+        connectivity.clear();
+        offsets.clear();
+        types.clear();
+        pointData.clear();
+        cellData.clear();
+    }
+
+    long long numPoints() const
+    {
+        return points.size() / 3;
+    }
+
+    long long numCells() const
+    {
+        return types.size();
+    }
+
+    /**
+     * Adds a point to the mesh without adding a cell. VTK points
+     * are always 3D, missing components are set to 0.
+     */
+    template<typename COORD>
+    void addPoint(const COORD& coord)
+    {
+        for (int d = 0; d < 3; ++d) {
+            points << ((d < COORD::DIM) ? double(coord[d]) : 0.0);
+        }
+    }
+
+    /**
+     * Closes a cell whose points have been appended to the
+     * connectivity list.
+     */
+    void endCell(unsigned char type)
+    {
+        offsets << (long long)connectivity.size();
+        types << type;
+    }
+
+    template<typename COORD>
+    void addVertex(const COORD& coord)
+    {
+        connectivity << numPoints();
+        addPoint(coord);
+        endCell(VTK_VERTEX);
+    }
+
+    template<typename SHAPE>
+    void addPolygon(const SHAPE& shape)
+    {
+        for (typename SHAPE::const_iterator i = shape.begin(); i != shape.end(); ++i) {
+            connectivity << numPoints();
+            addPoint(*i);
+        }
+        endCell(VTK_POLYGON);
+    }
+
+    void write(const std::string& filename) const
+    {
+        std::ofstream file(filename.c_str(), std::ios::binary);
+        if (!file) {
+            throw FileOpenException(filename);
+        }
+
+        std::size_t offset = 0;
+        writeFileHeader(file, "UnstructuredGrid");
+        file << "  <UnstructuredGrid>\n"
+             << "    <Piece NumberOfPoints=\"" << numPoints()
+             << "\" NumberOfCells=\"" << numCells() << "\">\n";
+
+        file << "      <PointData>\n";
+        for (std::size_t i = 0; i < pointData.size(); ++i) {
+            writeArrayHeader(file, pointData[i].name, pointData[i].type,
+                             pointData[i].components, pointData[i].data.size(), &offset);
+        }
+        file << "      </PointData>\n"
+             << "      <CellData>\n";
+        for (std::size_t i = 0; i < cellData.size(); ++i) {
+            writeArrayHeader(file, cellData[i].name, cellData[i].type,
+                             cellData[i].components, cellData[i].data.size(), &offset);
+        }
+        file << "      </CellData>\n"
+             << "      <Points>\n";
+        writeArrayHeader(file, "Points", "Float64", 3, byteSize(points), &offset);
+        file << "      </Points>\n"
+             << "      <Cells>\n";
+        writeArrayHeader(file, "connectivity", "Int64", 1, byteSize(connectivity), &offset);
+        writeArrayHeader(file, "offsets",      "Int64", 1, byteSize(offsets),      &offset);
+        writeArrayHeader(file, "types",        "UInt8", 1, byteSize(types),        &offset);
+        file << "      </Cells>\n"
+             << "    </Piece>\n"
+             << "  </UnstructuredGrid>\n"
+             << "  <AppendedData encoding=\"raw\">\n"
+             << "_";
+
+        for (std::size_t i = 0; i < pointData.size(); ++i) {
+            writeArray(file, pointData[i].data);
+        }
+        for (std::size_t i = 0; i < cellData.size(); ++i) {
+            writeArray(file, cellData[i].data);
+        }
+        writeArray(file, points);
+        writeArray(file, connectivity);
+        writeArray(file, offsets);
+        writeArray(file, types);
+
+        file << "\n  </AppendedData>\n"
+             << "</VTKFile>\n";
+
+        if (!file.good()) {
+            throw FileWriteException(filename);
+        }
+    }
+
+    /**
+     * Writes the index file which lets VisIt/ParaView load all pieces
+     * as one dataset. Only the array layout of this piece is taken
+     * into account, which is the same on all ranks.
+     */
+    void writeIndex(const std::string& filename, const std::vector<std::string>& pieceFiles) const
+    {
+        std::ofstream file(filename.c_str());
+        if (!file) {
+            throw FileOpenException(filename);
+        }
+
+        writeFileHeader(file, "PUnstructuredGrid");
+        file << "  <PUnstructuredGrid GhostLevel=\"0\">\n"
+             << "    <PPointData>\n";
+        for (std::size_t i = 0; i < pointData.size(); ++i) {
+            writeIndexArrayHeader(file, pointData[i].name, pointData[i].type, pointData[i].components);
+        }
+        file << "    </PPointData>\n"
+             << "    <PCellData>\n";
+        for (std::size_t i = 0; i < cellData.size(); ++i) {
+            writeIndexArrayHeader(file, cellData[i].name, cellData[i].type, cellData[i].components);
+        }
+        file << "    </PCellData>\n"
+             << "    <PPoints>\n";
+        writeIndexArrayHeader(file, "Points", "Float64", 3);
+        file << "    </PPoints>\n";
+        for (std::size_t i = 0; i < pieceFiles.size(); ++i) {
+            file << "    <Piece Source=\"" << pieceFiles[i] << "\"/>\n";
+        }
+        file << "  </PUnstructuredGrid>\n"
+             << "</VTKFile>\n";
+
+        if (!file.good()) {
+            throw FileWriteException(filename);
+        }
+    }
+
+    std::vector<double> points;
+    std::vector<long long> connectivity;
+    std::vector<long long> offsets;
+    std::vector<unsigned char> types;
+    std::vector<DataArray> pointData;
+};
+
+/**
+ * The part of a regular grid held by one rank, stored as a VTK XML
+ * ImageData file (.vti). Its region is split into boxes, each of
+ * which becomes a piece of its own. Their geometry follows from
+ * their extents, so unlike for a Piece no points or connectivity
+ * need to be written.
+ *
+ * Boxes are always 3D and measured in cells. Axes which the model
+ * lacks have an extent of 0.
+ */
+class ImagePiece : public PieceBase
+{
+public:
+    ImagePiece()
+    {
+        clear();
+    }
+
+    void clear()
+    {
+        boxes.clear();
+        cellOffsets.assign(1, 0);
+        cellData.clear();
+    }
+
+    void setGeometry(
+        const Coord<3>& newGridDimensions,
+        const FloatCoord<3>& newOrigin,
+        const FloatCoord<3>& newSpacing)
+    {
+        gridDimensions = newGridDimensions;
+        origin = newOrigin;
+        spacing = newSpacing;
+    }
+
+    /**
+     * The box's variables need to be appended to cellData in the
+     * same order, x varying fastest.
+     */
+    void addBox(const CoordBox<3>& box)
+    {
+        std::size_t cells = 1;
+        for (int d = 0; d < 3; ++d) {
+            cells *= (std::max)(box.dimensions[d], 1);
+        }
+
+        boxes << box;
+        cellOffsets << cellOffsets.back() + cells;
+    }
+
+    void write(const std::string& filename) const
+    {
+        std::ofstream file(filename.c_str(), std::ios::binary);
+        if (!file) {
+            throw FileOpenException(filename);
+        }
+
+        std::size_t offset = 0;
+        writeFileHeader(file, "ImageData");
+        file << "  <ImageData ";
+        writeGeometry(file);
+        file << ">\n";
+
+        for (std::size_t i = 0; i < boxes.size(); ++i) {
+            file << "    <Piece Extent=\"" << extent(boxes[i]) << "\">\n"
+                 << "      <CellData>\n";
+            for (std::size_t j = 0; j < cellData.size(); ++j) {
+                writeArrayHeader(file, cellData[j].name, cellData[j].type,
+                                 cellData[j].components, sliceSize(j, i), &offset);
+            }
+            file << "      </CellData>\n"
+                 << "    </Piece>\n";
+        }
+
+        file << "  </ImageData>\n"
+             << "  <AppendedData encoding=\"raw\">\n"
+             << "_";
+
+        for (std::size_t i = 0; i < boxes.size(); ++i) {
+            for (std::size_t j = 0; j < cellData.size(); ++j) {
+                writeArray(file, &cellData[j].data[0] + cellSize(j) * cellOffsets[i], sliceSize(j, i));
+            }
+        }
+
+        file << "\n  </AppendedData>\n"
+             << "</VTKFile>\n";
+
+        if (!file.good()) {
+            throw FileWriteException(filename);
+        }
+    }
+
+    /**
+     * Writes the index file, which has to list the boxes of all
+     * ranks, pieceBoxes[i] being the boxes stored in pieceFiles[i].
+     */
+    void writeIndex(
+        const std::string& filename,
+        const std::vector<std::string>& pieceFiles,
+        const std::vector<std::vector<CoordBox<3> > >& pieceBoxes) const
+    {
+        std::ofstream file(filename.c_str());
+        if (!file) {
+            throw FileOpenException(filename);
+        }
+
+        writeFileHeader(file, "PImageData");
+        file << "  <PImageData GhostLevel=\"0\" ";
+        writeGeometry(file);
+        file << ">\n"
+             << "    <PCellData>\n";
+        for (std::size_t i = 0; i < cellData.size(); ++i) {
+            writeIndexArrayHeader(file, cellData[i].name, cellData[i].type, cellData[i].components);
+        }
+        file << "    </PCellData>\n";
+        for (std::size_t i = 0; i < pieceFiles.size(); ++i) {
+            for (std::size_t j = 0; j < pieceBoxes[i].size(); ++j) {
+                file << "    <Piece Extent=\"" << extent(pieceBoxes[i][j])
+                     << "\" Source=\"" << pieceFiles[i] << "\"/>\n";
+            }
+        }
+        file << "  </PImageData>\n"
+             << "</VTKFile>\n";
+
+        if (!file.good()) {
+            throw FileWriteException(filename);
+        }
+    }
+
+    std::vector<CoordBox<3> > boxes;
+
+private:
+    Coord<3> gridDimensions;
+    FloatCoord<3> origin;
+    FloatCoord<3> spacing;
+    std::vector<std::size_t> cellOffsets;
+
+    /**
+     * Byte size of one cell's entry in array j.
+     */
+    std::size_t cellSize(std::size_t j) const
+    {
+        if (cellOffsets.back() == 0) {
+            return 0;
+        }
+
+        return cellData[j].data.size() / cellOffsets.back();
+    }
+
+    /**
+     * Byte size of array j's part which belongs to box i.
+     */
+    std::size_t sliceSize(std::size_t j, std::size_t i) const
+    {
+        return cellSize(j) * (cellOffsets[i + 1] - cellOffsets[i]);
+    }
+
+    /**
+     * VTK's extents refer to the corner points of the cells.
+     */
+    static std::string extent(const CoordBox<3>& box)
+    {
+        std::ostringstream buf;
+        for (int d = 0; d < 3; ++d) {
+            buf << (d ? " " : "") << box.origin[d] << " " << box.origin[d] + box.dimensions[d];
+        }
+        return buf.str();
+    }
+
+    void writeGeometry(std::ofstream& file) const
+    {
+        file << "WholeExtent=\"" << extent(CoordBox<3>(Coord<3>(), gridDimensions)) << "\" "
+             << std::setprecision(17)
+             << "Origin=\"" << origin[0] << " " << origin[1] << " " << origin[2] << "\" "
+             << "Spacing=\"" << spacing[0] << " " << spacing[1] << " " << spacing[2] << "\"";
+    }
+};
+
+/**
+ * Type erasure for the items (e.g. particles or elements) contained
+ * in the cells, which make up point meshes and unstructured grids.
+ */
+template<typename CELL>
+class CargoMeshBase
+{
+public:
+    virtual ~CargoMeshBase()
+    {}
+
+    virtual void declareVariables(std::vector<DataArray> *arrays) const = 0;
+
+    virtual void addItems(const CELL& cell, Piece *piece) const = 0;
+
+    virtual void addVariables(const CELL& cell, std::vector<DataArray> *arrays) const = 0;
+};
+
+/**
+ * Holds the Selectors for the cargo type. Adding Selectors requires
+ * the concrete cargo type to be known, but not the collection
+ * interface.
+ */
+template<typename CELL, typename CARGO>
+class CargoSelectors : public CargoMeshBase<CELL>
+{
+public:
+    void addSelector(const Selector<CARGO>& selector)
+    {
+        selectors << selector;
+    }
+
+    void declareVariables(std::vector<DataArray> *arrays) const
+    {
+        for (typename std::vector<Selector<CARGO> >::const_iterator i = selectors.begin();
+             i != selectors.end();
+             ++i) {
+            *arrays << DataArray(i->name(), vtkTypeName(i->typeName()), i->arity());
+        }
+    }
+
+protected:
+    std::vector<Selector<CARGO> > selectors;
+};
+
+/**
+ * Adds an item to a point mesh, just like for the SiloWriter items
+ * need to provide getPoint().
+ */
+class AddPoint
+{
+public:
+    template<typename ITEM>
+    void operator()(const ITEM& item, Piece *piece) const
+    {
+        piece->addVertex(item.getPoint());
+    }
+};
+
+/**
+ * Adds an item to an unstructured grid. getShape() has to return a
+ * container of the polygon's vertices.
+ */
+class AddShape
+{
+public:
+    template<typename ITEM>
+    void operator()(const ITEM& item, Piece *piece) const
+    {
+        piece->addPolygon(item.getShape());
+    }
+};
+
+/**
+ * Retrieves the items via a COLLECTION_INTERFACE (see
+ * CollectionInterface) and adds them to the mesh via ADD_ITEM.
+ */
+template<typename CELL, typename COLLECTION_INTERFACE, typename ADD_ITEM>
+class CargoMesh : public CargoSelectors<CELL, typename COLLECTION_INTERFACE::Cargo>
+{
+public:
+    typedef typename COLLECTION_INTERFACE::Cargo Cargo;
+    typedef typename COLLECTION_INTERFACE::ConstIterator ConstIterator;
+    using CargoSelectors<CELL, Cargo>::selectors;
+
+    explicit CargoMesh(const COLLECTION_INTERFACE& collectionInterface) :
+        collectionInterface(collectionInterface)
+    {}
+
+    void addItems(const CELL& cell, Piece *piece) const
+    {
+        for (ConstIterator i = collectionInterface.begin(cell); i != collectionInterface.end(cell); ++i) {
+            ADD_ITEM()(*i, piece);
+        }
+    }
+
+    void addVariables(const CELL& cell, std::vector<DataArray> *arrays) const
+    {
+        for (std::size_t j = 0; j < selectors.size(); ++j) {
+            const Selector<Cargo>& selector = selectors[j];
+            std::vector<char>& data = (*arrays)[j].data;
+            std::size_t oldSize = data.size();
+            data.resize(oldSize + collectionInterface.size(cell) * selector.sizeOfExternal());
+
+            char *cursor = &data[0] + oldSize;
+            for (ConstIterator i = collectionInterface.begin(cell); i != collectionInterface.end(cell); ++i) {
+                selector.copyMemberOut(&*i, MemoryLocation::HOST, cursor, MemoryLocation::HOST, 1);
+                cursor += selector.sizeOfExternal();
+            }
+        }
+    }
+
+private:
+    COLLECTION_INTERFACE collectionInterface;
+};
+
+}
+
+/**
+ * ParallelVTKWriter writes the same meshes as the SiloWriter (a
+ * regular grid, an unstructured grid and a point mesh, depending on
+ * the model's APITraits), but without any external dependencies and
+ * without funneling all data through one rank: each rank writes its
+ * part of each mesh to a separate VTK XML file
+ * (prefix.LABEL.STEP.RANK.vtu), rank 0 adds an index file
+ * (prefix.LABEL.STEP.pvtu) which VisIt and ParaView can open
+ * directly. The regular grid is stored as ImageData instead
+ * (.vti/.pvti), which needs neither points nor connectivity.
+ *
+ * Variables need to be defined by means of Selectors; multiple
+ * Selectors per mesh are supported. Vectorial members (arity > 1)
+ * are written as multi-component arrays.
+ */
+template<typename CELL>
+class ParallelVTKWriter : public Clonable<ParallelWriter<CELL>, ParallelVTKWriter<CELL> >
+{
+public:
+    friend class ParallelVTKWriterTest;
+
+    typedef typename ParallelWriter<CELL>::GridType GridType;
+    typedef typename ParallelWriter<CELL>::Topology Topology;
+    typedef CELL Cell;
+    typedef ParallelVTKWriterHelpers::Piece Piece;
+    typedef ParallelVTKWriterHelpers::CargoMeshBase<Cell> CargoMeshBase;
+    typedef typename SharedPtr<CargoMeshBase>::Type CargoMeshPtr;
+    typedef ParallelVTKWriterHelpers::AddPoint AddPoint;
+    typedef ParallelVTKWriterHelpers::AddShape AddShape;
+
+    static const int DIM = Topology::DIM;
+
+    using ParallelWriter<CELL>::period;
+    using ParallelWriter<CELL>::prefix;
+
+    /**
+     * This c-tor assumes that your cells are containers of the items
+     * which make up the point mesh and the unstructured grid (if the
+     * model has either), see CollectionInterface::PassThrough.
+     */
+    ParallelVTKWriter(
+        const std::string& prefix,
+        const unsigned period,
+        const std::string& regularGridLabel = "regular_grid",
+        const std::string& unstructuredMeshLabel = "unstructured_mesh",
+        const std::string& pointMeshLabel = "point_mesh",
+        const MPI_Comm& communicator = MPI_COMM_WORLD) :
+        Clonable<ParallelWriter<CELL>, ParallelVTKWriter<CELL> >(prefix, period),
+        pointMesh(makePassThroughMesh<AddPoint>(typename APITraits::SelectPointMesh<Cell>::Value())),
+        unstructuredGrid(makePassThroughMesh<AddShape>(typename APITraits::SelectUnstructuredGrid<Cell>::Value())),
+        regularGridLabel(regularGridLabel),
+        unstructuredMeshLabel(unstructuredMeshLabel),
+        pointMeshLabel(pointMeshLabel),
+        comm(communicator),
+        collecting(false)
+    {}
+
+    /**
+     * Unlike the previous constructor, this c-tor assumes that a
+     * member variable of your class holds the items for output.
+     */
+    template<typename CONTAINER>
+    ParallelVTKWriter(
+        CONTAINER Cell:: *memberPointer,
+        const std::string& prefix,
+        const unsigned period,
+        const std::string& regularGridLabel = "regular_grid",
+        const std::string& unstructuredMeshLabel = "unstructured_mesh",
+        const std::string& pointMeshLabel = "point_mesh",
+        const MPI_Comm& communicator = MPI_COMM_WORLD) :
+        Clonable<ParallelWriter<CELL>, ParallelVTKWriter<CELL> >(prefix, period),
+        pointMesh(makeDelegateMesh<AddPoint>(memberPointer, typename APITraits::SelectPointMesh<Cell>::Value())),
+        unstructuredGrid(makeDelegateMesh<AddShape>(
+                             memberPointer, typename APITraits::SelectUnstructuredGrid<Cell>::Value())),
+        regularGridLabel(regularGridLabel),
+        unstructuredMeshLabel(unstructuredMeshLabel),
+        pointMeshLabel(pointMeshLabel),
+        comm(communicator),
+        collecting(false)
+    {}
+
+    /**
+     * Same as above, but with different members for the point mesh
+     * and the unstructured grid.
+     */
+    template<typename CONTAINER1, typename CONTAINER2>
+    ParallelVTKWriter(
+        CONTAINER1 Cell:: *memberPointerForPointMesh,
+        CONTAINER2 Cell:: *memberPointerForUnstructuredGrid,
+        const std::string& prefix,
+        const unsigned period,
+        const std::string& regularGridLabel = "regular_grid",
+        const std::string& unstructuredMeshLabel = "unstructured_mesh",
+        const std::string& pointMeshLabel = "point_mesh",
+        const MPI_Comm& communicator = MPI_COMM_WORLD) :
+        Clonable<ParallelWriter<CELL>, ParallelVTKWriter<CELL> >(prefix, period),
+        pointMesh(makeDelegateMesh<AddPoint>(
+                      memberPointerForPointMesh, typename APITraits::SelectPointMesh<Cell>::Value())),
+        unstructuredGrid(makeDelegateMesh<AddShape>(
+                             memberPointerForUnstructuredGrid,
+                             typename APITraits::SelectUnstructuredGrid<Cell>::Value())),
+        regularGridLabel(regularGridLabel),
+        unstructuredMeshLabel(unstructuredMeshLabel),
+        pointMeshLabel(pointMeshLabel),
+        comm(communicator),
+        collecting(false)
+    {}
+
+    /**
+     * Adds another model variable of the cells to writer's output.
+     */
+    template<typename MEMBER>
+    void addSelector(
+        MEMBER Cell:: *memberPointer,
+        const std::string& memberName,
+        const typename SharedPtr<FilterBase<Cell> >::Type& filter)
+    {
+        addSelector(Selector<Cell>(memberPointer, memberName, filter));
+    }
+
+    template<typename MEMBER>
+    void addSelector(
+        MEMBER Cell:: *memberPointer,
+        const std::string& memberName)
+    {
+        addSelector(Selector<Cell>(memberPointer, memberName));
+    }
+
+    void addSelector(const Selector<Cell>& selector)
+    {
+        cellSelectors << selector;
+    }
+
+    /**
+     * Adds another variable of the cargo data (e.g. the particles) to
+     * this writer's output.
+     */
+    template<typename MEMBER, typename CARGO>
+    void addSelectorForPointMesh(
+        MEMBER CARGO:: *memberPointer,
+        const std::string& memberName,
+        const typename SharedPtr<FilterBase<CARGO> >::Type& filter)
+    {
+        addCargoSelector(pointMesh.get(), Selector<CARGO>(memberPointer, memberName, filter));
+    }
+
+    template<typename MEMBER, typename CARGO>
+    void addSelectorForPointMesh(
+        MEMBER CARGO:: *memberPointer,
+        const std::string& memberName)
+    {
+        addCargoSelector(pointMesh.get(), Selector<CARGO>(memberPointer, memberName));
+    }
+
+    /**
+     * Adds another variable of the cargo data, but associate it with
+     * the unstructured grid.
+     */
+    template<typename MEMBER, typename CARGO>
+    void addSelectorForUnstructuredGrid(
+        MEMBER CARGO:: *memberPointer,
+        const std::string& memberName,
+        const typename SharedPtr<FilterBase<CARGO> >::Type& filter)
+    {
+        addCargoSelector(unstructuredGrid.get(), Selector<CARGO>(memberPointer, memberName, filter));
+    }
+
+    template<typename MEMBER, typename CARGO>
+    void addSelectorForUnstructuredGrid(
+        MEMBER CARGO:: *memberPointer,
+        const std::string& memberName)
+    {
+        addCargoSelector(unstructuredGrid.get(), Selector<CARGO>(memberPointer, memberName));
+    }
+
+    virtual void stepFinished(
+        const GridType& grid,
+        const Region<DIM>& validRegion,
+        const Coord<DIM>& globalDimensions,
+        unsigned step,
+        WriterEvent event,
+        std::size_t rank,
+        bool lastCall)
+    {
+        if ((event == WRITER_STEP_FINISHED) && (step % period != 0)) {
+            return;
+        }
+
+        if (!collecting) {
+            startPieces();
+            collecting = true;
+        }
+
+        // we may be called multiple times per time step, each time
+        // with a different region:
+        Region<DIM> newRegion = validRegion - collectedRegion;
+        collectedRegion += newRegion;
+
+        collectRegularGrid(grid, newRegion, globalDimensions, typename APITraits::SelectRegularGrid<Cell>::Value());
+        collectCargo(grid, newRegion, unstructuredGrid.get(), &unstructuredGridPiece, false);
+        collectCargo(grid, newRegion, pointMesh.get(), &pointMeshPiece, true);
+
+        if (lastCall) {
+            writePieces(step);
+            collecting = false;
+        }
+    }
+
+private:
+    CargoMeshPtr pointMesh;
+    CargoMeshPtr unstructuredGrid;
+    std::vector<Selector<Cell> > cellSelectors;
+    std::string regularGridLabel;
+    std::string unstructuredMeshLabel;
+    std::string pointMeshLabel;
+    MPI_Comm comm;
+    bool collecting;
+    Region<DIM> collectedRegion;
+    ParallelVTKWriterHelpers::ImagePiece regularGridPiece;
+    Piece unstructuredGridPiece;
+    Piece pointMeshPiece;
+
+    template<typename ADD_ITEM>
+    static CargoMeshPtr makePassThroughMesh(APITraits::TrueType)
+    {
+        typedef CollectionInterface::PassThrough<Cell> Interface;
+        return CargoMeshPtr(new ParallelVTKWriterHelpers::CargoMesh<Cell, Interface, ADD_ITEM>(Interface()));
+    }
+
+    template<typename ADD_ITEM>
+    static CargoMeshPtr makePassThroughMesh(APITraits::FalseType)
+    {
+        // the model doesn't have this mesh
+        return CargoMeshPtr();
+    }
+
+    template<typename ADD_ITEM, typename CONTAINER>
+    static CargoMeshPtr makeDelegateMesh(CONTAINER Cell:: *memberPointer, APITraits::TrueType)
+    {
+        typedef CollectionInterface::Delegate<Cell, CONTAINER> Interface;
+        return CargoMeshPtr(
+            new ParallelVTKWriterHelpers::CargoMesh<Cell, Interface, ADD_ITEM>(Interface(memberPointer)));
+    }
+
+    template<typename ADD_ITEM, typename CONTAINER>
+    static CargoMeshPtr makeDelegateMesh(CONTAINER Cell:: * /* memberPointer */, APITraits::FalseType)
+    {
+        return CargoMeshPtr();
+    }
+
+    template<typename CARGO>
+    static void addCargoSelector(CargoMeshBase *mesh, const Selector<CARGO>& selector)
+    {
+        ParallelVTKWriterHelpers::CargoSelectors<Cell, CARGO> *selectors =
+            dynamic_cast<ParallelVTKWriterHelpers::CargoSelectors<Cell, CARGO>*>(mesh);
+        if (selectors == 0) {
+            throw std::invalid_argument(
+                "selector doesn't match the cargo type of the mesh, or the model lacks the mesh");
+        }
+
+        selectors->addSelector(selector);
+    }
+
+    void startPieces()
+    {
+        collectedRegion.clear();
+        regularGridPiece.clear();
+        unstructuredGridPiece.clear();
+        pointMeshPiece.clear();
+
+        for (typename std::vector<Selector<Cell> >::const_iterator i = cellSelectors.begin();
+             i != cellSelectors.end();
+             ++i) {
+            regularGridPiece.cellData << ParallelVTKWriterHelpers::DataArray(
+                i->name(), ParallelVTKWriterHelpers::vtkTypeName(i->typeName()), i->arity());
+        }
+
+        if (unstructuredGrid) {
+            unstructuredGrid->declareVariables(&unstructuredGridPiece.cellData);
+        }
+        if (pointMesh) {
+            pointMesh->declareVariables(&pointMeshPiece.pointData);
+        }
+    }
+
+    /**
+     * Regular grids are written as VTK ImageData, one piece per box
+     * of the region, so their geometry is fully described by the
+     * boxes' extents.
+     */
+    void collectRegularGrid(
+        const GridType& grid,
+        const Region<DIM>& region,
+        const Coord<DIM>& globalDimensions,
+        APITraits::TrueType)
+    {
+        FloatCoord<DIM> quadrantDim;
+        FloatCoord<DIM> origin;
+        APITraits::SelectRegularGrid<Cell>::value(&quadrantDim, &origin);
+
+        Coord<3> gridDimensions;
+        FloatCoord<3> gridOrigin;
+        FloatCoord<3> spacing(1, 1, 1);
+        for (int d = 0; d < DIM; ++d) {
+            gridDimensions[d] = globalDimensions[d];
+            gridOrigin[d] = origin[d];
+            spacing[d] = quadrantDim[d];
+        }
+        regularGridPiece.setGeometry(gridDimensions, gridOrigin, spacing);
+
+        std::vector<CoordBox<DIM> > boxes = ParallelVTKWriterHelpers::boxes(region);
+        for (typename std::vector<CoordBox<DIM> >::const_iterator i = boxes.begin(); i != boxes.end(); ++i) {
+            // the coords need to be normalized because on torus
+            // topologies the coordinates may exceed the bounding box:
+            Coord<DIM> boxOrigin = Topology::normalize(i->origin, globalDimensions);
+            CoordBox<3> box;
+            for (int d = 0; d < DIM; ++d) {
+                box.origin[d] = boxOrigin[d];
+                box.dimensions[d] = i->dimensions[d];
+            }
+            regularGridPiece.addBox(box);
+
+            Region<DIM> boxRegion(*i);
+            for (std::size_t j = 0; j < cellSelectors.size(); ++j) {
+                std::vector<char>& data = regularGridPiece.cellData[j].data;
+                std::size_t oldSize = data.size();
+                data.resize(oldSize + boxRegion.size() * cellSelectors[j].sizeOfExternal());
+                grid.saveMemberUnchecked(&data[0] + oldSize, MemoryLocation::HOST, cellSelectors[j], boxRegion);
+            }
+        }
+    }
+
+    void collectRegularGrid(
+        const GridType& grid,
+        const Region<DIM>& region,
+        const Coord<DIM>& globalDimensions,
+        APITraits::FalseType)
+    {
+        // intentinally left blank. not all meshfree codes may want to expose this.
+    }
+
+    void collectCargo(
+        const GridType& grid,
+        const Region<DIM>& region,
+        CargoMeshBase *mesh,
+        Piece *piece,
+        bool isPointMesh)
+    {
+        if (mesh == 0) {
+            return;
+        }
+
+        // variables of point meshes are attached to the points, for
+        // unstructured grids to the polygons:
+        std::vector<ParallelVTKWriterHelpers::DataArray> *arrays =
+            isPointMesh ? &piece->pointData : &piece->cellData;
+
+        for (typename Region<DIM>::Iterator i = region.begin(); i != region.end(); ++i) {
+            Cell cell = grid.get(*i);
+            mesh->addItems(cell, piece);
+            mesh->addVariables(cell, arrays);
+        }
+    }
+
+    void writePieces(unsigned step)
+    {
+        if (typename APITraits::SelectRegularGrid<Cell>::Value()) {
+            writePiece(regularGridPiece, regularGridLabel, step);
+        }
+        if (unstructuredGrid) {
+            writePiece(unstructuredGridPiece, unstructuredMeshLabel, step);
+        }
+        if (pointMesh) {
+            writePiece(pointMeshPiece, pointMeshLabel, step);
+        }
+    }
+
+    void writePiece(const Piece& piece, const std::string& label, unsigned step)
+    {
+        MPILayer mpiLayer(comm);
+        int rank = mpiLayer.rank();
+        piece.write(pieceFilename(label, step, rank, "vtu"));
+
+        if (rank == 0) {
+            piece.writeIndex(
+                indexFilename(label, step, "pvtu"),
+                pieceFilenames(label, step, mpiLayer.size(), "vtu"));
+        }
+    }
+
+    void writePiece(const ParallelVTKWriterHelpers::ImagePiece& piece, const std::string& label, unsigned step)
+    {
+        MPILayer mpiLayer(comm);
+        int rank = mpiLayer.rank();
+        piece.write(pieceFilename(label, step, rank, "vti"));
+
+        // the index needs to list the boxes of all ranks:
+        std::vector<int> localBoxes;
+        for (std::size_t i = 0; i < piece.boxes.size(); ++i) {
+            for (int d = 0; d < 3; ++d) {
+                localBoxes << piece.boxes[i].origin[d] << piece.boxes[i].dimensions[d];
+            }
+        }
+        std::vector<int> lengths = mpiLayer.gather(int(localBoxes.size()), 0);
+        std::vector<int> allBoxes(sum(lengths));
+        mpiLayer.gatherV(localBoxes, lengths, 0, allBoxes);
+
+        if (rank == 0) {
+            std::vector<std::vector<CoordBox<3> > > pieceBoxes(mpiLayer.size());
+            std::vector<int>::const_iterator cursor = allBoxes.begin();
+            for (int i = 0; i < mpiLayer.size(); ++i) {
+                for (int j = 0; j < lengths[i]; j += 6) {
+                    CoordBox<3> box;
+                    for (int d = 0; d < 3; ++d) {
+                        box.origin[d] = *cursor++;
+                        box.dimensions[d] = *cursor++;
+                    }
+                    pieceBoxes[i] << box;
+                }
+            }
+
+            piece.writeIndex(
+                indexFilename(label, step, "pvti"),
+                pieceFilenames(label, step, mpiLayer.size(), "vti"),
+                pieceBoxes);
+        }
+    }
+
+    std::string indexFilename(const std::string& label, unsigned step, const std::string& suffix) const
+    {
+        std::ostringstream buf;
+        buf << prefix << "." << label << "." << std::setfill('0') << std::setw(5) << step << "." << suffix;
+        return buf.str();
+    }
+
+    std::string pieceFilename(const std::string& label, unsigned step, int rank, const std::string& suffix) const
+    {
+        std::ostringstream buf;
+        buf << prefix << "." << label << "." << std::setfill('0') << std::setw(5) << step
+            << "." << rank << "." << suffix;
+        return buf.str();
+    }
+
+    std::vector<std::string> pieceFilenames(
+        const std::string& label, unsigned step, int size, const std::string& suffix) const
+    {
+        std::vector<std::string> ret;
+        for (int i = 0; i < size; ++i) {
+            ret << stripPath(pieceFilename(label, step, i, suffix));
+        }
+
+        return ret;
+    }
+
+    /**
+     * Pieces are referenced relative to the index file's location.
+     */
+    static std::string stripPath(const std::string& filename)
+    {
+        std::size_t pos = filename.rfind('/');
+        if (pos == std::string::npos) {
+            return filename;
+        }
+
+        return filename.substr(pos + 1);
+    }
+};
+
+}
+
+#endif
+#endif
@@ -1,6 +1,7 @@
 #ifndef LIBGEODECOMP_IO_PLOTTER_H
 #define LIBGEODECOMP_IO_PLOTTER_H
 
+#include <libgeodecomp/config.h>
 #include <libgeodecomp/io/simplecellplotter.h>
 #include <libgeodecomp/io/writer.h>
 #include <libgeodecomp/storage/grid.h>
@@ -58,23 +59,40 @@ public:
         PAINTER& painter,
         const CoordBox<2>& viewport) const
     {
-        int sx = viewport.origin.x() / cellDim.x();
-        int sy = viewport.origin.y() / cellDim.y();
-        int ex = int(ceil((double(viewport.origin.x()) + viewport.dimensions.x()) / cellDim.x()));
-        int ey = int(ceil((double(viewport.origin.y()) + viewport.dimensions.y()) / cellDim.y()));
-        ex = (std::min)(ex, grid.dimensions().x());
-        ey = (std::min)(ey, grid.dimensions().y());
+        CoordBox<2> cells = cellsInViewport(grid, viewport);
+
+        for (int y = cells.origin.y(); y < (cells.origin.y() + cells.dimensions.y()); ++y) {
+            plotRow(grid, painter, viewport, cells, y);
+        }
+    }
+
+    /**
+     * Same as plotGridInViewport(), but the rows of cells are
+     * distributed among threads. Each thread draws via its own copy
+     * of the painter, so this is only safe for painters which may
+     * draw to disjoint areas concurrently (e.g. ImagePainter, but not
+     * a QPainter).
+     */
+    template<typename PAINTER>
+    void plotGridInViewportParallel(
+        const typename Writer<CELL>::GridType& grid,
+        const PAINTER& painter,
+        const CoordBox<2>& viewport) const
+    {
+        CoordBox<2> cells = cellsInViewport(grid, viewport);
+        int endY = cells.origin.y() + cells.dimensions.y();
+
+#ifdef LIBGEODECOMP_WITH_THREADS
+#pragma omp parallel
+#endif
+        {
+            PAINTER threadPainter(painter);
 
-        for (int y = sy; y < ey; ++y) {
-            for (int x = sx; x < ex; ++x) {
-                Coord<2> relativeUpperLeft =
-                    Coord<2>(x * cellDim.x(),
-                             y * cellDim.y()) - viewport.origin;
-                painter.moveTo(relativeUpperLeft);
-                cellPlotter(
-                    grid.get(Coord<2>(x, y)),
-                    painter,
-                    cellDim);
+#ifdef LIBGEODECOMP_WITH_THREADS
+#pragma omp for schedule(dynamic)
+#endif
+            for (int y = cells.origin.y(); y < endY; ++y) {
+                plotRow(grid, threadPainter, viewport, cells, y);
             }
         }
     }
@@ -92,6 +110,42 @@ public:
 private:
     Coord<2> cellDim;
     CELL_PLOTTER cellPlotter;
+
+    CoordBox<2> cellsInViewport(
+        const typename Writer<CELL>::GridType& grid,
+        const CoordBox<2>& viewport) const
+    {
+        int sx = viewport.origin.x() / cellDim.x();
+        int sy = viewport.origin.y() / cellDim.y();
+        int ex = int(ceil((double(viewport.origin.x()) + viewport.dimensions.x()) / cellDim.x()));
+        int ey = int(ceil((double(viewport.origin.y()) + viewport.dimensions.y()) / cellDim.y()));
+        ex = (std::min)(ex, grid.dimensions().x());
+        ey = (std::min)(ey, grid.dimensions().y());
+
+        return CoordBox<2>(Coord<2>(sx, sy), Coord<2>((std::max)(ex - sx, 0), (std::max)(ey - sy, 0)));
+    }
+
+    template<typename PAINTER>
+    void plotRow(
+        const typename Writer<CELL>::GridType& grid,
+        PAINTER& painter,
+        const CoordBox<2>& viewport,
+        const CoordBox<2>& cells,
+        int y) const
+    {
+        int endX = cells.origin.x() + cells.dimensions.x();
+
+        for (int x = cells.origin.x(); x < endX; ++x) {
+            Coord<2> relativeUpperLeft =
+                Coord<2>(x * cellDim.x(),
+                         y * cellDim.y()) - viewport.origin;
+            painter.moveTo(relativeUpperLeft);
+            cellPlotter(
+                grid.get(Coord<2>(x, y)),
+                painter,
+                cellDim);
+        }
+    }
 };
 
 }
@@ -1,6 +1,7 @@
 #ifndef LIBGEODECOMP_IO_PPMWRITER_H
 #define LIBGEODECOMP_IO_PPMWRITER_H
 
+#include <libgeodecomp/io/downsampler.h>
 #include <libgeodecomp/io/imagepainter.h>
 #include <libgeodecomp/io/ioexception.h>
 #include <libgeodecomp/io/plotter.h>
@@ -14,6 +15,7 @@
 #include <fstream>
 #include <iomanip>
 #include <string>
+#include <vector>
 
 namespace LibGeoDecomp {
 
@@ -21,6 +23,12 @@ namespace LibGeoDecomp {
  * This writer will periodically write images in PPM format. The
  * CELL_PLOTTER is responsible for rendering individual cells into
  * tiles. The default will render uniformly colored tiles.
+ *
+ * Alternatively each pixel may represent a block of cells (see
+ * Downsampling), which keeps frames of very large grids at a
+ * manageable size. Either way images are rendered by multiple
+ * threads in bands of BAND_HEIGHT rows which are written to disk
+ * right away, so the whole image never needs to be kept in memory.
  */
 template<typename CELL_TYPE, typename CELL_PLOTTER = SimpleCellPlotter<CELL_TYPE> >
 class PPMWriter : public Clonable<Writer<CELL_TYPE>, PPMWriter<CELL_TYPE, CELL_PLOTTER> >
@@ -32,6 +40,8 @@ public:
     using Writer<CELL_TYPE>::period;
     using Writer<CELL_TYPE>::prefix;
 
+    static const int BAND_HEIGHT = 256;
+
     /**
      * This PPMWriter will render a given member (e.g. &Cell::fooBar).
      * Colouring is handled by a predefined palette. The color range
@@ -65,51 +75,102 @@ public:
        plotter(cellDimensions, CELL_PLOTTER(member, palette))
     {}
 
+    /**
+     * Renders one pixel per block of cells, as specified by
+     * downsampling. The CELL_PLOTTER is not being used in this mode.
+     */
+    template<typename MEMBER, typename PALETTE>
+    PPMWriter(
+        MEMBER CELL_TYPE:: *member,
+        const PALETTE& palette,
+        const std::string& prefix,
+        const unsigned period,
+        const Downsampling& downsampling) :
+        Clonable<Writer<CELL_TYPE>, PPMWriter<CELL_TYPE, CELL_PLOTTER> >(prefix, period),
+        plotter(Coord<2>(1, 1), CELL_PLOTTER(member, palette)),
+        downsampler(new Downsampler<CELL_TYPE>(member, palette, downsampling))
+    {}
+
     virtual void stepFinished(const GridType& grid, unsigned step, WriterEvent event)
     {
         if ((event == WRITER_STEP_FINISHED) && (step % period != 0)) {
             return;
         }
 
-        Coord<2> imageDim = plotter.calcImageDim(grid.boundingBox().dimensions);
-        Image image(imageDim);
-        ImagePainter painter(&image);
-        plotter.plotGrid(grid, painter);
-        writePPM(image, step);
-    }
-
- private:
-    Plotter<CELL_TYPE, CELL_PLOTTER> plotter;
-
-    void writePPM(const Image& img, unsigned step)
-    {
-        std::ostringstream filename;
-        filename << prefix << "." << std::setfill('0') << std::setw(4)
-                 << step << ".ppm";
-        std::ofstream outfile(filename.str().c_str());
+        std::string filename = ppmFilename(step);
+        std::ofstream outfile(filename.c_str(), std::ios::binary);
         if (!outfile) {
-            throw FileOpenException(filename.str());
+            throw FileOpenException(filename);
         }
 
+        Coord<2> imageDim = calcImageDim(grid.boundingBox().dimensions);
+
         // header first:
-        outfile << "P6 " << img.getDimensions().x()
-                << " "   << img.getDimensions().y() << " 255\n";
+        outfile << "P6 " << imageDim.x()
+                << " "   << imageDim.y() << " 255\n";
 
         // body second:
-        for (int y = 0; y < img.getDimensions().y(); ++y) {
-            for (int x = 0; x < img.getDimensions().x(); ++x) {
-                const Color& rgb = img[Coord<2>(x, y)];
-                outfile << (char)rgb.red()
-                        << (char)rgb.green()
-                        << (char)rgb.blue();
+        Image band(imageDim.x(), (std::min)(int(BAND_HEIGHT), imageDim.y()));
+        std::vector<char> rowBuffer(3 * std::size_t(imageDim.x()));
+
+        for (int startY = 0; startY < imageDim.y(); startY += BAND_HEIGHT) {
+            int endY = (std::min)(startY + int(BAND_HEIGHT), imageDim.y());
+            renderBand(grid, imageDim, startY, endY, &band);
+
+            for (int y = 0; y < (endY - startY); ++y) {
+                writeRow(outfile, &band[Coord<2>(0, y)], imageDim.x(), &rowBuffer);
             }
         }
 
         if (!outfile.good()) {
-            throw FileWriteException(filename.str());
+            throw FileWriteException(filename);
         }
         outfile.close();
     }
+
+ private:
+    Plotter<CELL_TYPE, CELL_PLOTTER> plotter;
+    typename SharedPtr<Downsampler<CELL_TYPE> >::Type downsampler;
+
+    Coord<2> calcImageDim(const Coord<2>& gridDim)
+    {
+        if (downsampler) {
+            return downsampler->imageDim(gridDim);
+        }
+
+        return plotter.calcImageDim(gridDim);
+    }
+
+    void renderBand(const GridType& grid, const Coord<2>& imageDim, int startY, int endY, Image *band)
+    {
+        if (downsampler) {
+            downsampler->renderRows(grid, startY, endY, &(*band)[Coord<2>(0, 0)]);
+            return;
+        }
+
+        CoordBox<2> viewport(Coord<2>(0, startY), Coord<2>(imageDim.x(), endY - startY));
+        plotter.plotGridInViewportParallel(grid, ImagePainter(band), viewport);
+    }
+
+    static void writeRow(std::ofstream& outfile, const Color *row, int width, std::vector<char> *buffer)
+    {
+        char *cursor = &(*buffer)[0];
+        for (int x = 0; x < width; ++x) {
+            *cursor++ = (char)row[x].red();
+            *cursor++ = (char)row[x].green();
+            *cursor++ = (char)row[x].blue();
+        }
+
+        outfile.write(&(*buffer)[0], std::streamsize(buffer->size()));
+    }
+
+    std::string ppmFilename(unsigned step) const
+    {
+        std::ostringstream filename;
+        filename << prefix << "." << std::setfill('0') << std::setw(4)
+                 << step << ".ppm";
+        return filename.str();
+    }
 };
 
 }
@@ -0,0 +1,579 @@
+#ifndef LIBGEODECOMP_IO_SNAPSHOT_H
+#define LIBGEODECOMP_IO_SNAPSHOT_H
+
+#include <libgeodecomp/config.h>
+#include <libgeodecomp/geometry/coordbox.h>
+#include <libgeodecomp/geometry/region.h>
+#include <libgeodecomp/geometry/streak.h>
+#include <libgeodecomp/io/ioexception.h>
+#include <libgeodecomp/misc/apitraits.h>
+#include <libgeodecomp/storage/gridbase.h>
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iterator>
+#include <sstream>
+#include <vector>
+
+#ifdef LIBGEODECOMP_WITH_CPP14
+#include <type_traits>
+#endif
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace LibGeoDecomp {
+
+namespace SnapshotHelpers {
+
+/**
+ * Leading block of each snapshot piece. It's followed by the Streaks
+ * (numStreaks times DIM + 1 ints: origin and endX), the edge cell at
+ * edgeOffset and, beginning at dataOffset, by the cells in the order
+ * of the Streaks.
+ */
+class Header
+{
+public:
+    static const int MAX_DIM = 3;
+    static const int ALIGNMENT = 64;
+
+    char magic[8];
+    unsigned version;
+    unsigned dim;
+    unsigned long long cellSize;
+    unsigned numPieces;
+    unsigned step;
+    unsigned maxSteps;
+    int dimensions[MAX_DIM];
+    unsigned long long numStreaks;
+    unsigned long long edgeOffset;
+    unsigned long long dataOffset;
+
+    static const char *magicString()
+    {
+        return "LGDSNAP";
+    }
+
+    static unsigned long long align(unsigned long long offset)
+    {
+        return (offset + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT;
+    }
+};
+
+/**
+ * Leading block of a snapshot's index, which is followed by the edge
+ * cell and the bounding boxes of all pieces (numPieces times 2 * DIM
+ * ints: origin and dimensions).
+ */
+class IndexHeader
+{
+public:
+    char magic[8];
+    unsigned version;
+    unsigned dim;
+    unsigned long long cellSize;
+    unsigned numPieces;
+    unsigned step;
+    unsigned maxSteps;
+    int dimensions[Header::MAX_DIM];
+
+    static const char *magicString()
+    {
+        return "LGDSIDX";
+    }
+};
+
+/**
+ * Writes to a temporary file which is renamed to filename once
+ * finished, so that an interrupted write won't leave a truncated file
+ * behind.
+ */
+class AtomicFile
+{
+public:
+    explicit AtomicFile(const std::string& filename) :
+        filename(filename),
+        tempFilename(filename + ".tmp"),
+        file(tempFilename.c_str(), std::ios::binary)
+    {
+        if (!file.good()) {
+            throw FileOpenException(tempFilename);
+        }
+    }
+
+    void write(const void *data, std::size_t size)
+    {
+        if (size > 0) {
+            file.write(reinterpret_cast<const char*>(data), size);
+        }
+    }
+
+    void commit()
+    {
+        file.close();
+
+        if (!file.good() || (std::rename(tempFilename.c_str(), filename.c_str()) != 0)) {
+            throw FileWriteException(filename);
+        }
+    }
+
+private:
+    std::string filename;
+    std::string tempFilename;
+    std::ofstream file;
+};
+
+}
+
+/**
+ * Our own checkpoint format: each process stores the cells of its
+ * local Region in a separate file (a "piece"), without any
+ * synchronization. The header of each piece encodes its Region, so a
+ * restart may use a different number of processes (or a different
+ * domain decomposition). The cells are stored verbatim and suitably
+ * aligned so that SnapshotPiece can map the file into memory and set
+ * the grid straight from the page cache. Hence CELL_TYPE needs to be
+ * trivially copyable and the files are not portable between
+ * architectures.
+ *
+ * An index (see SnapshotIndex) lists the bounding boxes of all
+ * pieces, so that a restart only needs to open the pieces which
+ * overlap with its own region. See SnapshotWriter and
+ * SnapshotInitializer.
+ */
+template<typename CELL_TYPE>
+class Snapshot
+{
+public:
+    typedef typename APITraits::SelectTopology<CELL_TYPE>::Value Topology;
+    static const int DIM = Topology::DIM;
+    typedef SnapshotHelpers::Header Header;
+    typedef SnapshotHelpers::IndexHeader IndexHeader;
+
+#ifdef LIBGEODECOMP_WITH_CPP14
+    static_assert(
+        std::is_trivially_copyable<CELL_TYPE>::value,
+        "snapshots store cells verbatim, so they need to be trivially copyable");
+#endif
+
+    static std::string filename(const std::string& prefix, unsigned step, unsigned piece)
+    {
+        std::ostringstream buf;
+        buf << prefix << std::setfill('0') << std::setw(5) << step << "." << piece << ".snapshot";
+        return buf.str();
+    }
+
+    static std::string indexFilename(const std::string& prefix, unsigned step)
+    {
+        std::ostringstream buf;
+        buf << prefix << std::setfill('0') << std::setw(5) << step << ".index";
+        return buf.str();
+    }
+
+    /**
+     * Writes a piece which holds cells, which is expected to contain
+     * all cells of streaks in their given order.
+     */
+    static void write(
+        const std::string& filename,
+        const std::vector<Streak<DIM> >& streaks,
+        const std::vector<CELL_TYPE>& cells,
+        const CELL_TYPE& edgeCell,
+        const Coord<DIM>& globalDimensions,
+        unsigned step,
+        unsigned maxSteps,
+        unsigned numPieces)
+    {
+        Header header;
+        std::memset(&header, 0, sizeof(header));
+        std::strncpy(header.magic, Header::magicString(), sizeof(header.magic));
+        header.version = 1;
+        header.dim = DIM;
+        header.cellSize = sizeof(CELL_TYPE);
+        header.numPieces = numPieces;
+        header.step = step;
+        header.maxSteps = maxSteps;
+        for (int d = 0; d < DIM; ++d) {
+            header.dimensions[d] = globalDimensions[d];
+        }
+        header.numStreaks = streaks.size();
+
+        std::vector<int> encodedStreaks;
+        encodedStreaks.reserve(streaks.size() * (DIM + 1));
+        for (typename std::vector<Streak<DIM> >::const_iterator i = streaks.begin(); i != streaks.end(); ++i) {
+            for (int d = 0; d < DIM; ++d) {
+                encodedStreaks.push_back(i->origin[d]);
+            }
+            encodedStreaks.push_back(i->endX);
+        }
+
+        std::size_t streakBytes = encodedStreaks.size() * sizeof(int);
+        std::size_t streaksEnd = sizeof(Header) + streakBytes;
+        header.edgeOffset = Header::align(streaksEnd);
+        header.dataOffset = Header::align(header.edgeOffset + sizeof(CELL_TYPE));
+        std::vector<char> padding1(header.edgeOffset - streaksEnd, 0);
+        std::vector<char> padding2(header.dataOffset - header.edgeOffset - sizeof(CELL_TYPE), 0);
+
+        SnapshotHelpers::AtomicFile file(filename);
+        file.write(&header, sizeof(header));
+        file.write(encodedStreaks.empty() ? 0 : &encodedStreaks[0], streakBytes);
+        file.write(padding1.empty() ? 0 : &padding1[0], padding1.size());
+        file.write(&edgeCell, sizeof(CELL_TYPE));
+        file.write(padding2.empty() ? 0 : &padding2[0], padding2.size());
+        file.write(cells.empty() ? 0 : &cells[0], cells.size() * sizeof(CELL_TYPE));
+        file.commit();
+    }
+
+    /**
+     * Writes the index of a snapshot. boundingBoxes[i] is expected to
+     * contain the region of piece i.
+     */
+    static void writeIndex(
+        const std::string& filename,
+        const std::vector<CoordBox<DIM> >& boundingBoxes,
+        const CELL_TYPE& edgeCell,
+        const Coord<DIM>& globalDimensions,
+        unsigned step,
+        unsigned maxSteps)
+    {
+        IndexHeader header;
+        std::memset(&header, 0, sizeof(header));
+        std::strncpy(header.magic, IndexHeader::magicString(), sizeof(header.magic));
+        header.version = 1;
+        header.dim = DIM;
+        header.cellSize = sizeof(CELL_TYPE);
+        header.numPieces = boundingBoxes.size();
+        header.step = step;
+        header.maxSteps = maxSteps;
+        for (int d = 0; d < DIM; ++d) {
+            header.dimensions[d] = globalDimensions[d];
+        }
+
+        std::vector<int> encodedBoxes;
+        encodedBoxes.reserve(boundingBoxes.size() * 2 * DIM);
+        for (typename std::vector<CoordBox<DIM> >::const_iterator i = boundingBoxes.begin(); i != boundingBoxes.end(); ++i) {
+            for (int d = 0; d < DIM; ++d) {
+                encodedBoxes.push_back(i->origin[d]);
+            }
+            for (int d = 0; d < DIM; ++d) {
+                encodedBoxes.push_back(i->dimensions[d]);
+            }
+        }
+
+        SnapshotHelpers::AtomicFile file(filename);
+        file.write(&header, sizeof(header));
+        file.write(&edgeCell, sizeof(CELL_TYPE));
+        file.write(encodedBoxes.empty() ? 0 : &encodedBoxes[0], encodedBoxes.size() * sizeof(int));
+        file.commit();
+    }
+};
+
+/**
+ * Reads the index of a snapshot, which is tiny compared to the
+ * pieces. It holds the global parameters of the snapshot and the
+ * bounding box of each piece.
+ */
+template<typename CELL_TYPE>
+class SnapshotIndex
+{
+public:
+    typedef typename APITraits::SelectTopology<CELL_TYPE>::Value Topology;
+    static const int DIM = Topology::DIM;
+    typedef SnapshotHelpers::IndexHeader IndexHeader;
+
+#ifdef LIBGEODECOMP_WITH_CPP14
+    static_assert(
+        std::is_trivially_copyable<CELL_TYPE>::value,
+        "snapshots store cells verbatim, so they need to be trivially copyable");
+#endif
+
+    explicit SnapshotIndex(const std::string& filename)
+    {
+        std::ifstream file(filename.c_str(), std::ios::binary);
+        if (!file.good()) {
+            throw FileOpenException(filename);
+        }
+
+        file.read(reinterpret_cast<char*>(&header), sizeof(header));
+        if (!file.good() ||
+            (std::strncmp(header.magic, IndexHeader::magicString(), sizeof(header.magic)) != 0) ||
+            (header.dim != unsigned(DIM)) ||
+            (header.cellSize != sizeof(CELL_TYPE))) {
+            throw FileReadException(filename);
+        }
+
+        file.read(reinterpret_cast<char*>(&edge), sizeof(CELL_TYPE));
+        std::vector<int> encodedBoxes(header.numPieces * 2 * DIM);
+        if (!encodedBoxes.empty()) {
+            file.read(reinterpret_cast<char*>(&encodedBoxes[0]), encodedBoxes.size() * sizeof(int));
+        }
+        if (!file.good()) {
+            throw FileReadException(filename);
+        }
+
+        std::vector<int>::const_iterator encoded = encodedBoxes.begin();
+        boxes.resize(header.numPieces);
+        for (unsigned i = 0; i < header.numPieces; ++i) {
+            for (int d = 0; d < DIM; ++d) {
+                boxes[i].origin[d] = *encoded++;
+            }
+            for (int d = 0; d < DIM; ++d) {
+                boxes[i].dimensions[d] = *encoded++;
+            }
+        }
+    }
+
+    unsigned step() const
+    {
+        return header.step;
+    }
+
+    unsigned maxSteps() const
+    {
+        return header.maxSteps;
+    }
+
+    unsigned numPieces() const
+    {
+        return header.numPieces;
+    }
+
+    Coord<DIM> dimensions() const
+    {
+        Coord<DIM> ret;
+        for (int d = 0; d < DIM; ++d) {
+            ret[d] = header.dimensions[d];
+        }
+        return ret;
+    }
+
+    const CELL_TYPE& edgeCell() const
+    {
+        return edge;
+    }
+
+    const std::vector<CoordBox<DIM> >& boundingBoxes() const
+    {
+        return boxes;
+    }
+
+private:
+    IndexHeader header;
+    CELL_TYPE edge;
+    std::vector<CoordBox<DIM> > boxes;
+};
+
+/**
+ * Read-only view of a snapshot piece. The file is mapped into memory
+ * (read into a buffer on systems without mmap()), so constructing a
+ * SnapshotPiece is cheap and only the pages which are actually
+ * loaded into a grid are read from disk.
+ */
+template<typename CELL_TYPE>
+class SnapshotPiece
+{
+public:
+    typedef typename APITraits::SelectTopology<CELL_TYPE>::Value Topology;
+    static const int DIM = Topology::DIM;
+    typedef SnapshotHelpers::Header Header;
+
+#ifdef LIBGEODECOMP_WITH_CPP14
+    static_assert(
+        std::is_trivially_copyable<CELL_TYPE>::value,
+        "snapshots store cells verbatim, so they need to be trivially copyable");
+#endif
+
+    explicit SnapshotPiece(const std::string& filename) :
+        filename(filename),
+        data(0),
+        size(0)
+    {
+        map();
+
+        if ((size < sizeof(Header)) ||
+            (std::strncmp(header().magic, Header::magicString(), sizeof(header().magic)) != 0) ||
+            (header().dim != unsigned(DIM)) ||
+            (header().cellSize != sizeof(CELL_TYPE)) ||
+            (header().edgeOffset < sizeof(Header) + header().numStreaks * (DIM + 1) * sizeof(int)) ||
+            (header().dataOffset < header().edgeOffset + sizeof(CELL_TYPE)) ||
+            (size < header().dataOffset)) {
+            unmap();
+            throw FileReadException(filename);
+        }
+
+        std::size_t numCells = 0;
+        const int *encoded = reinterpret_cast<const int*>(data + sizeof(Header));
+        streaks.reserve(header().numStreaks);
+        for (unsigned long long i = 0; i < header().numStreaks; ++i) {
+            Streak<DIM> streak;
+            for (int d = 0; d < DIM; ++d) {
+                streak.origin[d] = *encoded++;
+            }
+            streak.endX = *encoded++;
+
+            streaks.push_back(streak);
+            pieceRegion << streak;
+            numCells += streak.length();
+        }
+
+        if (size < header().dataOffset + numCells * sizeof(CELL_TYPE)) {
+            unmap();
+            throw FileReadException(filename);
+        }
+    }
+
+    ~SnapshotPiece()
+    {
+        unmap();
+    }
+
+    unsigned step() const
+    {
+        return header().step;
+    }
+
+    unsigned maxSteps() const
+    {
+        return header().maxSteps;
+    }
+
+    unsigned numPieces() const
+    {
+        return header().numPieces;
+    }
+
+    Coord<DIM> dimensions() const
+    {
+        Coord<DIM> ret;
+        for (int d = 0; d < DIM; ++d) {
+            ret[d] = header().dimensions[d];
+        }
+        return ret;
+    }
+
+    const Region<DIM>& region() const
+    {
+        return pieceRegion;
+    }
+
+    const CELL_TYPE& edgeCell() const
+    {
+        return *reinterpret_cast<const CELL_TYPE*>(data + header().edgeOffset);
+    }
+
+    /**
+     * Copies all cells which are both, part of this piece and of
+     * wanted, to target. Returns the number of cells loaded.
+     */
+    std::size_t load(GridBase<CELL_TYPE, DIM> *target, const Region<DIM>& wanted) const
+    {
+        const CELL_TYPE *cells = reinterpret_cast<const CELL_TYPE*>(data + header().dataOffset);
+        std::size_t counter = 0;
+
+        for (typename std::vector<Streak<DIM> >::const_iterator i = streaks.begin(); i != streaks.end(); ++i) {
+            if (wanted.count(*i)) {
+                // fast path, e.g. for restarts with the same decomposition:
+                target->set(*i, cells);
+                counter += i->length();
+            } else {
+                Region<DIM> overlap;
+                overlap << *i;
+                overlap &= wanted;
+
+                for (typename Region<DIM>::StreakIterator j = overlap.beginStreak(); j != overlap.endStreak(); ++j) {
+                    target->set(*j, cells + (j->origin.x() - i->origin.x()));
+                    counter += j->length();
+                }
+            }
+
+            cells += i->length();
+        }
+
+        return counter;
+    }
+
+private:
+    std::string filename;
+    const char *data;
+    std::size_t size;
+    std::vector<Streak<DIM> > streaks;
+    Region<DIM> pieceRegion;
+#ifdef _WIN32
+    std::vector<char> buffer;
+#endif
+
+    SnapshotPiece(const SnapshotPiece& other);
+    SnapshotPiece& operator=(const SnapshotPiece& other);
+
+    const Header& header() const
+    {
+        return *reinterpret_cast<const Header*>(data);
+    }
+
+#ifndef _WIN32
+    void map()
+    {
+        int fd = open(filename.c_str(), O_RDONLY);
+        if (fd == -1) {
+            throw FileOpenException(filename);
+        }
+
+        struct stat info;
+        if ((fstat(fd, &info) != 0) || (info.st_size == 0)) {
+            close(fd);
+            throw FileReadException(filename);
+        }
+        size = info.st_size;
+
+        void *address = mmap(0, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        close(fd);
+        if (address == MAP_FAILED) {
+            throw FileReadException(filename);
+        }
+
+        madvise(address, size, MADV_SEQUENTIAL);
+        data = reinterpret_cast<const char*>(address);
+    }
+
+    void unmap()
+    {
+        if (data != 0) {
+            munmap(const_cast<char*>(data), size);
+            data = 0;
+        }
+    }
+#else
+    void map()
+    {
+        std::ifstream file(filename.c_str(), std::ios::binary);
+        if (!file.good()) {
+            throw FileOpenException(filename);
+        }
+
+        buffer.assign(
+            (std::istreambuf_iterator<char>(file)),
+            std::istreambuf_iterator<char>());
+        if (buffer.empty()) {
+            throw FileReadException(filename);
+        }
+        data = &buffer[0];
+        size = buffer.size();
+    }
+
+    void unmap()
+    {
+        data = 0;
+    }
+#endif
+};
+
+}
+
+#endif
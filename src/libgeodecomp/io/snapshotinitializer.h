@@ -0,0 +1,74 @@
+#ifndef LIBGEODECOMP_IO_SNAPSHOTINITIALIZER_H
+#define LIBGEODECOMP_IO_SNAPSHOTINITIALIZER_H
+
+#include <libgeodecomp/io/initializer.h>
+#include <libgeodecomp/io/snapshot.h>
+
+namespace LibGeoDecomp {
+
+/**
+ * Restarts a simulation from a checkpoint written by SnapshotWriter.
+ * Each process reads the snapshot's index, maps only those pieces
+ * whose bounding boxes overlap with its own grid and copies the
+ * cells which intersect with it. Hence the number of processes may
+ * differ from the run which wrote the checkpoint.
+ */
+template<typename CELL_TYPE>
+class SnapshotInitializer : public Initializer<CELL_TYPE>
+{
+public:
+    typedef typename APITraits::SelectTopology<CELL_TYPE>::Value Topology;
+    static const int DIM = Topology::DIM;
+
+    SnapshotInitializer(const std::string& prefix, unsigned step) :
+        prefix(prefix),
+        currentStep(step),
+        index(Snapshot<CELL_TYPE>::indexFilename(prefix, step))
+    {}
+
+    virtual void grid(GridBase<CELL_TYPE, DIM> *target)
+    {
+        CoordBox<DIM> box = target->boundingBox();
+        Region<DIM> globalRegion;
+        globalRegion << CoordBox<DIM>(Coord<DIM>(), index.dimensions());
+        Region<DIM> wanted;
+        wanted << box;
+        wanted &= globalRegion;
+
+        const std::vector<CoordBox<DIM> >& pieceBoxes = index.boundingBoxes();
+        for (std::size_t i = 0; i < pieceBoxes.size(); ++i) {
+            if (!box.intersects(pieceBoxes[i])) {
+                continue;
+            }
+
+            SnapshotPiece<CELL_TYPE> piece(Snapshot<CELL_TYPE>::filename(prefix, currentStep, i));
+            piece.load(target, wanted);
+        }
+
+        target->setEdge(index.edgeCell());
+    }
+
+    virtual Coord<DIM> gridDimensions() const
+    {
+        return index.dimensions();
+    }
+
+    virtual unsigned maxSteps() const
+    {
+        return index.maxSteps();
+    }
+
+    virtual unsigned startStep() const
+    {
+        return currentStep;
+    }
+
+private:
+    std::string prefix;
+    unsigned currentStep;
+    SnapshotIndex<CELL_TYPE> index;
+};
+
+}
+
+#endif
@@ -0,0 +1,119 @@
+#ifndef LIBGEODECOMP_IO_SNAPSHOTWRITER_H
+#define LIBGEODECOMP_IO_SNAPSHOTWRITER_H
+
+#include <libgeodecomp/config.h>
+#ifdef LIBGEODECOMP_WITH_MPI
+
+#include <libgeodecomp/communication/mpilayer.h>
+#include <libgeodecomp/io/parallelwriter.h>
+#include <libgeodecomp/io/snapshot.h>
+#include <libgeodecomp/misc/clonable.h>
+
+#include <mpi.h>
+
+namespace LibGeoDecomp {
+
+/**
+ * Writes checkpoints in the Snapshot format: unlike
+ * ParallelMPIIOWriter each process writes its local Region into a
+ * separate file (prefix + step + "." + rank + ".snapshot"), so
+ * neither collective I/O nor a shared file lock are required. Once
+ * all pieces are written, rank 0 gathers their bounding boxes into
+ * an index (prefix + step + ".index"). SnapshotInitializer can
+ * restart from these files, even with a different number of
+ * processes.
+ */
+template<typename CELL_TYPE>
+class SnapshotWriter : public Clonable<ParallelWriter<CELL_TYPE>, SnapshotWriter<CELL_TYPE> >
+{
+public:
+    friend class SnapshotWriterTest;
+    typedef typename ParallelWriter<CELL_TYPE>::GridType GridType;
+    typedef typename APITraits::SelectTopology<CELL_TYPE>::Value Topology;
+    static const int DIM = Topology::DIM;
+    using ParallelWriter<CELL_TYPE>::period;
+    using ParallelWriter<CELL_TYPE>::prefix;
+
+    SnapshotWriter(
+        const std::string& prefix,
+        const unsigned period,
+        const unsigned maxSteps,
+        const MPI_Comm& communicator = MPI_COMM_WORLD) :
+        Clonable<ParallelWriter<CELL_TYPE>, SnapshotWriter<CELL_TYPE> >(prefix, period),
+        maxSteps(maxSteps),
+        comm(communicator)
+    {}
+
+    virtual void stepFinished(
+        const GridType& grid,
+        const Region<DIM>& validRegion,
+        const Coord<DIM>& globalDimensions,
+        unsigned step,
+        WriterEvent event,
+        std::size_t rank,
+        bool lastCall)
+    {
+        if ((event == WRITER_STEP_FINISHED) && (step % period != 0)) {
+            return;
+        }
+
+        // we may be called multiple times per time step, each time
+        // with a different region:
+        Region<DIM> newRegion = validRegion - collectedRegion;
+        collectedRegion += newRegion;
+
+        for (typename Region<DIM>::StreakIterator i = newRegion.beginStreak(); i != newRegion.endStreak(); ++i) {
+            std::size_t offset = cells.size();
+            cells.resize(offset + i->length());
+            grid.get(*i, &cells[offset]);
+            streaks.push_back(*i);
+        }
+
+        if (lastCall) {
+            int myRank;
+            int size;
+            MPI_Comm_rank(comm, &myRank);
+            MPI_Comm_size(comm, &size);
+
+            Snapshot<CELL_TYPE>::write(
+                Snapshot<CELL_TYPE>::filename(prefix, step, myRank),
+                streaks,
+                cells,
+                grid.getEdge(),
+                globalDimensions,
+                step,
+                maxSteps,
+                size);
+
+            // the gather doubles as a barrier, so the index won't
+            // appear before all pieces are complete:
+            std::vector<CoordBox<DIM> > boundingBoxes =
+                MPILayer(comm).gather(collectedRegion.boundingBox(), 0);
+            if (myRank == 0) {
+                Snapshot<CELL_TYPE>::writeIndex(
+                    Snapshot<CELL_TYPE>::indexFilename(prefix, step),
+                    boundingBoxes,
+                    grid.getEdge(),
+                    globalDimensions,
+                    step,
+                    maxSteps);
+            }
+
+            collectedRegion.clear();
+            streaks.clear();
+            cells.clear();
+        }
+    }
+
+private:
+    unsigned maxSteps;
+    MPI_Comm comm;
+    Region<DIM> collectedRegion;
+    std::vector<Streak<DIM> > streaks;
+    std::vector<CELL_TYPE> cells;
+};
+
+}
+
+#endif
+#endif
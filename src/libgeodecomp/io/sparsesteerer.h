@@ -0,0 +1,364 @@
+#ifndef LIBGEODECOMP_IO_SPARSESTEERER_H
+#define LIBGEODECOMP_IO_SPARSESTEERER_H
+
+#include <libgeodecomp/config.h>
+#include <libgeodecomp/geometry/region.h>
+#include <libgeodecomp/io/steerer.h>
+#include <libgeodecomp/misc/sharedptr.h>
+#include <libgeodecomp/misc/stdcontaineroverloads.h>
+
+#ifdef LIBGEODECOMP_WITH_MPI
+#include <libgeodecomp/communication/mpilayer.h>
+#endif
+
+#include <vector>
+
+namespace LibGeoDecomp {
+
+namespace SparseSteererHelpers {
+
+/**
+ * Type erasure for edits which modify a cell in place.
+ */
+template<typename CELL_TYPE>
+class Modifier
+{
+public:
+    virtual ~Modifier()
+    {}
+
+    virtual void operator()(CELL_TYPE *cell) const = 0;
+};
+
+template<typename CELL_TYPE, typename FUNCTOR>
+class FunctorModifier : public Modifier<CELL_TYPE>
+{
+public:
+    explicit FunctorModifier(const FUNCTOR& functor) :
+        functor(functor)
+    {}
+
+    void operator()(CELL_TYPE *cell) const
+    {
+        functor(cell);
+    }
+
+private:
+    FUNCTOR functor;
+};
+
+}
+
+/**
+ * A sparse set of cell modifications. Each edit either replaces a
+ * cell by a given value or applies a functor to it. Edits are
+ * applied in the order in which they were submitted.
+ */
+template<typename CELL_TYPE>
+class SteererEditBatch
+{
+public:
+    typedef typename Steerer<CELL_TYPE>::Topology Topology;
+    typedef typename Steerer<CELL_TYPE>::GridType GridType;
+    typedef SparseSteererHelpers::Modifier<CELL_TYPE> Modifier;
+    typedef typename SharedPtr<Modifier>::Type ModifierPtr;
+    static const int DIM = Topology::DIM;
+
+    /**
+     * Overwrites the cell at coord with value.
+     */
+    void set(const Coord<DIM>& coord, const CELL_TYPE& value)
+    {
+        coords << coord;
+        values << value;
+        modifiers << ModifierPtr();
+        editedRegion << coord;
+    }
+
+    /**
+     * Calls functor(&cell) for the cell at coord. The functor is
+     * copied.
+     */
+    template<typename FUNCTOR>
+    void modify(const Coord<DIM>& coord, const FUNCTOR& functor)
+    {
+        coords << coord;
+        values << CELL_TYPE();
+        modifiers << ModifierPtr(
+            new SparseSteererHelpers::FunctorModifier<CELL_TYPE, FUNCTOR>(functor));
+        editedRegion << coord;
+    }
+
+    /**
+     * Applies all edits which lie within applicableRegion and yields
+     * the number of edits applied. Only the edited cells are
+     * touched, the rest of the grid is never traversed.
+     */
+    std::size_t apply(GridType *grid, const Region<DIM>& applicableRegion) const
+    {
+        if ((applicableRegion & editedRegion).empty()) {
+            return 0;
+        }
+
+        std::size_t counter = 0;
+        for (std::size_t i = 0; i < coords.size(); ++i) {
+            if (!applicableRegion.count(coords[i])) {
+                continue;
+            }
+
+            if (modifiers[i]) {
+                CELL_TYPE cell = grid->get(coords[i]);
+                (*modifiers[i])(&cell);
+                grid->set(coords[i], cell);
+            } else {
+                grid->set(coords[i], values[i]);
+            }
+            ++counter;
+        }
+
+        return counter;
+    }
+
+    /**
+     * Copies the i-th edit of other to this batch.
+     */
+    void append(const SteererEditBatch& other, std::size_t i)
+    {
+        coords << other.coords[i];
+        values << other.values[i];
+        modifiers << other.modifiers[i];
+        editedRegion << other.coords[i];
+    }
+
+    void clear()
+    {
+        coords.clear();
+        values.clear();
+        modifiers.clear();
+        editedRegion.clear();
+    }
+
+    bool empty() const
+    {
+        return coords.empty();
+    }
+
+    std::size_t size() const
+    {
+        return coords.size();
+    }
+
+    /**
+     * All coordinates touched by this batch.
+     */
+    const Region<DIM>& region() const
+    {
+        return editedRegion;
+    }
+
+    const std::vector<Coord<DIM> >& getCoords() const
+    {
+        return coords;
+    }
+
+    const std::vector<CELL_TYPE>& getValues() const
+    {
+        return values;
+    }
+
+    /**
+     * Returns true if the i-th edit is a plain value assignment
+     * (i.e. may be shipped to another process).
+     */
+    bool isValueEdit(std::size_t i) const
+    {
+        return !modifiers[i];
+    }
+
+private:
+    std::vector<Coord<DIM> > coords;
+    std::vector<CELL_TYPE> values;
+    std::vector<ModifierPtr> modifiers;
+    Region<DIM> editedRegion;
+};
+
+/**
+ * Base class for Steerers which only modify few cells per step (e.g.
+ * placing obstacles or sources at user-selected positions). Instead
+ * of implementing nextStep(), which hands over the whole local
+ * grid, derived classes fill a SteererEditBatch in nextEdits(). The
+ * SparseSteerer then applies each edit exactly once, on the process
+ * which owns the cell, even if the Simulator calls nextStep()
+ * multiple times per step (e.g. for ghost zone and inner set).
+ * Processes without pending edits return immediately without
+ * touching the grid.
+ *
+ * By default each process only applies the edits it has submitted
+ * itself and drops those outside of its region. If the edits are
+ * generated on a single process (e.g. the one with the user
+ * interface), pass a communicator to the constructor: value edits
+ * for foreign cells will then be forwarded once per step, which is
+ * a collective operation among all processes of the communicator.
+ * Functor edits can't be forwarded and are always applied locally.
+ */
+template<typename CELL_TYPE>
+class SparseSteerer : public Steerer<CELL_TYPE>
+{
+public:
+    typedef typename Steerer<CELL_TYPE>::SteererFeedback SteererFeedback;
+    typedef typename Steerer<CELL_TYPE>::Topology Topology;
+    typedef typename Steerer<CELL_TYPE>::GridType GridType;
+    typedef SteererEditBatch<CELL_TYPE> EditBatch;
+    static const int DIM = Topology::DIM;
+
+    using Steerer<CELL_TYPE>::region;
+
+    explicit SparseSteerer(unsigned period) :
+        Steerer<CELL_TYPE>(period),
+        collected(false)
+    {}
+
+#ifdef LIBGEODECOMP_WITH_MPI
+    /**
+     * Enables forwarding of value edits to their owners. The
+     * default cellDatatype requires the model to specify its MPI
+     * data type via APITraits::HasMPIDataType.
+     */
+    SparseSteerer(
+        unsigned period,
+        MPI_Comm communicator,
+        MPI_Datatype cellDatatype = APITraits::SelectMPIDataType<CELL_TYPE>::value()) :
+        Steerer<CELL_TYPE>(period),
+        collected(false),
+        mpiLayer(new MPILayer(communicator)),
+        cellDatatype(cellDatatype)
+    {}
+#endif
+
+    /**
+     * Callback for derived classes: add all edits which should be
+     * carried out at the given step to edits. Called once per step.
+     */
+    virtual void nextEdits(
+        unsigned step,
+        SteererEvent event,
+        std::size_t rank,
+        EditBatch *edits,
+        SteererFeedback *feedback) = 0;
+
+    virtual void nextStep(
+        GridType *grid,
+        const Region<DIM>& validRegion,
+        const Coord<DIM>& globalDimensions,
+        unsigned step,
+        SteererEvent event,
+        std::size_t rank,
+        bool lastCall,
+        SteererFeedback *feedback)
+    {
+        if (!collected) {
+            edits.clear();
+            appliedRegion.clear();
+            nextEdits(step, event, rank, &edits, feedback);
+#ifdef LIBGEODECOMP_WITH_MPI
+            if (mpiLayer) {
+                route();
+            }
+#endif
+            collected = true;
+        }
+
+        if (lastCall) {
+            collected = false;
+        }
+
+        if (edits.empty()) {
+            return;
+        }
+
+        // cells may be part of the validRegion of multiple calls per
+        // step, but must only be edited once:
+        Region<DIM> applicableRegion = (validRegion & edits.region()) - appliedRegion;
+        if (applicableRegion.empty()) {
+            return;
+        }
+
+        edits.apply(grid, applicableRegion);
+        appliedRegion += applicableRegion;
+    }
+
+private:
+    EditBatch edits;
+    Region<DIM> appliedRegion;
+    bool collected;
+#ifdef LIBGEODECOMP_WITH_MPI
+    SharedPtr<MPILayer>::Type mpiLayer;
+    MPI_Datatype cellDatatype;
+
+    /**
+     * Exchanges value edits for cells outside of the local region.
+     * Costs a single allgather of an int if no process has any
+     * foreign edits.
+     */
+    void route()
+    {
+        EditBatch local;
+        std::vector<Coord<DIM> > foreignCoords;
+        std::vector<CELL_TYPE> foreignValues;
+        const std::vector<Coord<DIM> >& coords = edits.getCoords();
+
+        for (std::size_t i = 0; i < edits.size(); ++i) {
+            if (region.count(coords[i]) || !edits.isValueEdit(i)) {
+                continue;
+            }
+
+            foreignCoords << coords[i];
+            foreignValues << edits.getValues()[i];
+        }
+
+        std::vector<int> lengths = mpiLayer->allGather(int(foreignCoords.size()));
+        if (sum(lengths) == 0) {
+            return;
+        }
+
+        std::vector<Coord<DIM> > allCoords = mpiLayer->allGatherV(
+            foreignCoords.empty() ? 0 : &foreignCoords[0], lengths);
+        std::vector<CELL_TYPE> allValues = mpiLayer->allGatherV(
+            foreignValues.empty() ? 0 : &foreignValues[0], lengths, cellDatatype);
+
+        // edits received from lower ranks precede our own, the order
+        // among one process' edits is retained:
+        int offset = 0;
+        for (int r = 0; r < mpiLayer->size(); ++r) {
+            if (r == mpiLayer->rank()) {
+                appendLocalEdits(&local);
+            } else {
+                for (int i = offset; i < offset + lengths[r]; ++i) {
+                    if (region.count(allCoords[i])) {
+                        local.set(allCoords[i], allValues[i]);
+                    }
+                }
+            }
+            offset += lengths[r];
+        }
+
+        edits = local;
+    }
+
+    void appendLocalEdits(EditBatch *local) const
+    {
+        const std::vector<Coord<DIM> >& coords = edits.getCoords();
+
+        for (std::size_t i = 0; i < edits.size(); ++i) {
+            if (edits.isValueEdit(i) && !region.count(coords[i])) {
+                continue;
+            }
+            local->append(edits, i);
+        }
+    }
+#endif
+};
+
+}
+
+#endif
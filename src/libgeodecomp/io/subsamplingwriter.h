@@ -0,0 +1,230 @@
+#ifndef LIBGEODECOMP_IO_SUBSAMPLINGWRITER_H
+#define LIBGEODECOMP_IO_SUBSAMPLINGWRITER_H
+
+#include <libgeodecomp/geometry/coordbox.h>
+#include <libgeodecomp/geometry/region.h>
+#include <libgeodecomp/io/parallelwriter.h>
+#include <libgeodecomp/misc/clonable.h>
+#include <libgeodecomp/misc/sharedptr.h>
+#include <libgeodecomp/storage/displacedgrid.h>
+
+#include <stdexcept>
+
+namespace LibGeoDecomp {
+
+/**
+ * Decorator which restricts the output of another ParallelWriter to
+ * a region of interest and/or every n-th cell per dimension (stride).
+ *
+ * The selected cells are packed into a compact grid before they're
+ * handed to the delegate: cell regionOfInterest.origin + c * stride
+ * becomes cell c, and the global dimensions are shrunk accordingly.
+ * Thus writers which derive their header metadata from the global
+ * dimensions (e.g. BOVWriter, ParallelMPIIOWriter) will produce
+ * consistent files without any modifications.
+ *
+ * Each rank only packs the intersection of the selection with its
+ * own validRegion, so no communication is necessary.
+ */
+template<typename CELL_TYPE>
+class SubsamplingWriter : public Clonable<ParallelWriter<CELL_TYPE>, SubsamplingWriter<CELL_TYPE> >
+{
+public:
+    friend class SubsamplingWriterTest;
+
+    typedef typename ParallelWriter<CELL_TYPE>::GridType GridType;
+    typedef typename ParallelWriter<CELL_TYPE>::Topology Topology;
+    typedef typename SharedPtr<ParallelWriter<CELL_TYPE> >::Type WriterPtr;
+    static const int DIM = Topology::DIM;
+    typedef DisplacedGrid<CELL_TYPE, typename Topologies::Cube<DIM>::Topology> PackedGridType;
+
+    using ParallelWriter<CELL_TYPE>::period;
+
+    /**
+     * Takes ownership of delegate. An empty regionOfInterest selects
+     * the whole grid.
+     */
+    explicit SubsamplingWriter(
+        ParallelWriter<CELL_TYPE> *delegate,
+        const Coord<DIM>& stride = Coord<DIM>::diagonal(1),
+        const CoordBox<DIM>& regionOfInterest = CoordBox<DIM>()) :
+        Clonable<ParallelWriter<CELL_TYPE>, SubsamplingWriter<CELL_TYPE> >(
+            checkDelegate(delegate)->getPrefix(), checkDelegate(delegate)->getPeriod()),
+        delegate(delegate),
+        stride(stride)
+    {
+        init(regionOfInterest);
+    }
+
+    /**
+     * Same as above, but limits the output to an arbitrary Region.
+     * Its bounding box defines the packed grid, cells outside of the
+     * Region won't be written.
+     */
+    SubsamplingWriter(
+        ParallelWriter<CELL_TYPE> *delegate,
+        const Coord<DIM>& stride,
+        const Region<DIM>& regionOfInterest) :
+        Clonable<ParallelWriter<CELL_TYPE>, SubsamplingWriter<CELL_TYPE> >(
+            checkDelegate(delegate)->getPrefix(), checkDelegate(delegate)->getPeriod()),
+        delegate(delegate),
+        stride(stride),
+        regionOfInterest(regionOfInterest)
+    {
+        init(regionOfInterest.boundingBox());
+    }
+
+    /**
+     * Deep copy so that clones don't share the delegate's state.
+     */
+    SubsamplingWriter(const SubsamplingWriter& other) :
+        Clonable<ParallelWriter<CELL_TYPE>, SubsamplingWriter<CELL_TYPE> >(other),
+        delegate(other.delegate->clone()),
+        stride(other.stride),
+        regionOfInterest(other.regionOfInterest),
+        boxOfInterest(other.boxOfInterest)
+    {}
+
+    virtual void setRegion(const Region<DIM>& newRegion)
+    {
+        ParallelWriter<CELL_TYPE>::setRegion(newRegion);
+
+        CoordBox<DIM> box = boxOfInterest;
+        if (box.dimensions.prod() == 0) {
+            // the global dimensions aren't known yet, but any box
+            // anchored at the origin which covers the region will do:
+            CoordBox<DIM> boundingBox = newRegion.boundingBox();
+            box = CoordBox<DIM>(Coord<DIM>(), boundingBox.origin + boundingBox.dimensions);
+        }
+
+        delegate->setRegion(pack(newRegion, box));
+    }
+
+    virtual void stepFinished(
+        const GridType& grid,
+        const Region<DIM>& validRegion,
+        const Coord<DIM>& globalDimensions,
+        unsigned step,
+        WriterEvent event,
+        std::size_t rank,
+        bool lastCall)
+    {
+        if ((event == WRITER_STEP_FINISHED) && (step % period != 0)) {
+            return;
+        }
+
+        CoordBox<DIM> box = boxOfInterest;
+        if (box.dimensions.prod() == 0) {
+            box = CoordBox<DIM>(Coord<DIM>(), globalDimensions);
+        }
+
+        Region<DIM> packedRegion = pack(validRegion, box);
+        packedGrid.resize(packedRegion.boundingBox());
+
+        for (typename Region<DIM>::Iterator i = packedRegion.begin(); i != packedRegion.end(); ++i) {
+            packedGrid.set(*i, grid.get(box.origin + i->scale(stride)));
+        }
+        packedGrid.setEdge(grid.getEdge());
+
+        delegate->stepFinished(packedGrid, packedRegion, packedDimensions(box), step, event, rank, lastCall);
+    }
+
+    /**
+     * Dimensions of the grid as seen by the delegate.
+     */
+    Coord<DIM> packedDimensions(const CoordBox<DIM>& box) const
+    {
+        Coord<DIM> ret;
+        for (int d = 0; d < DIM; ++d) {
+            ret[d] = (box.dimensions[d] + stride[d] - 1) / stride[d];
+        }
+
+        return ret;
+    }
+
+private:
+    WriterPtr delegate;
+    Coord<DIM> stride;
+    Region<DIM> regionOfInterest;
+    CoordBox<DIM> boxOfInterest;
+    PackedGridType packedGrid;
+
+    static ParallelWriter<CELL_TYPE> *checkDelegate(ParallelWriter<CELL_TYPE> *delegate)
+    {
+        if (delegate == 0) {
+            throw std::invalid_argument("delegate writer must not be NULL");
+        }
+
+        return delegate;
+    }
+
+    void init(const CoordBox<DIM>& box)
+    {
+        for (int d = 0; d < DIM; ++d) {
+            if (stride[d] < 1) {
+                throw std::invalid_argument("stride must be positive");
+            }
+        }
+
+        boxOfInterest = box;
+    }
+
+    /**
+     * Yields the packed coordinates of all cells within region which
+     * are part of the selection.
+     */
+    Region<DIM> pack(const Region<DIM>& region, const CoordBox<DIM>& box) const
+    {
+        Region<DIM> selected;
+        selected << box;
+        selected &= region;
+        if (!regionOfInterest.empty()) {
+            selected &= regionOfInterest;
+        }
+
+        Region<DIM> ret;
+        for (typename Region<DIM>::StreakIterator i = selected.beginStreak(); i != selected.endStreak(); ++i) {
+            Coord<DIM> relativeOrigin = i->origin - box.origin;
+            if (!onLattice(relativeOrigin)) {
+                continue;
+            }
+
+            // first and last cell within the streak which lie on the
+            // lattice, expressed in packed coordinates:
+            Coord<DIM> packedOrigin = relativeOrigin;
+            int startX = (relativeOrigin.x() + stride.x() - 1) / stride.x();
+            int endX = (i->endX - box.origin.x() + stride.x() - 1) / stride.x();
+            if (startX >= endX) {
+                continue;
+            }
+
+            for (int d = 1; d < DIM; ++d) {
+                packedOrigin[d] /= stride[d];
+            }
+            packedOrigin.x() = startX;
+
+            ret << Streak<DIM>(packedOrigin, endX);
+        }
+
+        return ret;
+    }
+
+    /**
+     * Only checks the dimensions orthogonal to streaks, which need
+     * to be hit exactly.
+     */
+    bool onLattice(const Coord<DIM>& relativeCoord) const
+    {
+        for (int d = 1; d < DIM; ++d) {
+            if (relativeCoord[d] % stride[d] != 0) {
+                return false;
+            }
+        }
+
+        return true;
+    }
+};
+
+}
+
+#endif
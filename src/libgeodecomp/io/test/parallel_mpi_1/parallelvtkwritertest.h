@@ -0,0 +1,317 @@
+#include <libgeodecomp/io/parallelvtkwriter.h>
+#include <libgeodecomp/misc/tempfile.h>
+#include <libgeodecomp/misc/testhelper.h>
+#include <libgeodecomp/storage/grid.h>
+
+#include <cxxtest/TestSuite.h>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <unistd.h>
+
+using namespace LibGeoDecomp;
+
+namespace LibGeoDecomp {
+
+class VTKTestParticle
+{
+public:
+    explicit VTKTestParticle(const FloatCoord<2>& pos = FloatCoord<2>(), double mass = 0) :
+        pos(pos),
+        mass(mass)
+    {}
+
+    FloatCoord<2> getPoint() const
+    {
+        return pos;
+    }
+
+    FloatCoord<2> pos;
+    double mass;
+};
+
+class VTKTestElement
+{
+public:
+    explicit VTKTestElement(const FloatCoord<2>& pos = FloatCoord<2>(), int id = 0) :
+        id(id)
+    {
+        shape << pos
+              << pos + FloatCoord<2>(1, 0)
+              << pos + FloatCoord<2>(0, 1);
+    }
+
+    std::vector<FloatCoord<2> > getShape() const
+    {
+        return shape;
+    }
+
+    std::vector<FloatCoord<2> > shape;
+    int id;
+};
+
+class VTKTestCell
+{
+public:
+    class API :
+        public APITraits::HasCustomRegularGrid,
+        public APITraits::HasPointMesh,
+        public APITraits::HasUnstructuredGrid
+    {
+    public:
+        static FloatCoord<2> getRegularGridSpacing()
+        {
+            return FloatCoord<2>(20, 10);
+        }
+
+        static FloatCoord<2> getRegularGridOrigin()
+        {
+            return FloatCoord<2>(5, 0);
+        }
+    };
+
+    explicit VTKTestCell(double value = 0) :
+        value(value)
+    {}
+
+    std::vector<VTKTestParticle> particles;
+    std::vector<VTKTestElement> elements;
+    double value;
+};
+
+/**
+ * Minimal reader for the files written by ParallelVTKWriter.
+ */
+class VTKFileReader
+{
+public:
+    explicit VTKFileReader(const std::string& filename)
+    {
+        std::ifstream file(filename.c_str(), std::ios::binary);
+        std::string content(
+            (std::istreambuf_iterator<char>(file)),
+            std::istreambuf_iterator<char>());
+
+        std::string marker = "<AppendedData encoding=\"raw\">\n_";
+        std::size_t pos = content.find(marker);
+        xml = content.substr(0, pos);
+        if (pos != std::string::npos) {
+            raw = content.substr(pos + marker.size());
+        }
+    }
+
+    int attribute(const std::string& name) const
+    {
+        std::size_t pos = xml.find(name + "=\"");
+        return atoi(xml.c_str() + pos + name.size() + 2);
+    }
+
+    int count(const std::string& pattern) const
+    {
+        int ret = 0;
+        for (std::size_t pos = xml.find(pattern); pos != std::string::npos; pos = xml.find(pattern, pos + 1)) {
+            ++ret;
+        }
+        return ret;
+    }
+
+    /**
+     * Concatenates the arrays of all pieces.
+     */
+    template<typename T>
+    std::vector<T> array(const std::string& name) const
+    {
+        std::vector<T> ret;
+        for (std::size_t pos = xml.find("Name=\"" + name + "\"");
+             pos != std::string::npos;
+             pos = xml.find("Name=\"" + name + "\"", pos + 1)) {
+            std::size_t offset = atol(xml.c_str() + xml.find("offset=\"", pos) + 8);
+
+            unsigned long long size;
+            std::memcpy(&size, raw.data() + offset, sizeof(size));
+            std::size_t oldSize = ret.size();
+            ret.resize(oldSize + size / sizeof(T));
+            std::memcpy(ret.data() + oldSize, raw.data() + offset + sizeof(size), size);
+        }
+        return ret;
+    }
+
+    std::string xml;
+    std::string raw;
+};
+
+class ParallelVTKWriterTest : public CxxTest::TestSuite
+{
+public:
+    void setUp()
+    {
+        prefix = TempFile::serial("parallelvtkwriter");
+        files.clear();
+    }
+
+    void tearDown()
+    {
+        for (std::size_t i = 0; i < files.size(); ++i) {
+            unlink(files[i].c_str());
+        }
+    }
+
+    void testAllMeshes()
+    {
+        ParallelVTKWriter<VTKTestCell> writer(
+            &VTKTestCell::particles, &VTKTestCell::elements, prefix, 1);
+        writer.addSelector(&VTKTestCell::value, "value");
+        writer.addSelectorForPointMesh(&VTKTestParticle::mass, "mass");
+        writer.addSelectorForUnstructuredGrid(&VTKTestElement::id, "id");
+
+        Coord<2> dim(3, 2);
+        Grid<VTKTestCell> grid(dim);
+        for (int y = 0; y < dim.y(); ++y) {
+            for (int x = 0; x < dim.x(); ++x) {
+                VTKTestCell cell(x + 10 * y);
+                for (int i = 0; i < x; ++i) {
+                    cell.particles << VTKTestParticle(FloatCoord<2>(x, y), 100 * y + x);
+                }
+                cell.elements << VTKTestElement(FloatCoord<2>(x, y), x + 10 * y);
+                grid.set(Coord<2>(x, y), cell);
+            }
+        }
+
+        Region<2> region;
+        region << grid.boundingBox();
+        writer.stepFinished(grid, region, dim, 42, WRITER_INITIALIZED, 0, true);
+
+        // regular grid:
+        std::string index = prefix + ".regular_grid.00042.pvti";
+        std::string piece = prefix + ".regular_grid.00042.0.vti";
+        files << index << piece;
+        TS_ASSERT_FILE(index);
+
+        VTKFileReader indexFile(index);
+        std::string source = piece.substr(piece.rfind('/') + 1);
+        TS_ASSERT_EQUALS(1, indexFile.count("<Piece Extent=\"0 3 0 2 0 0\" Source=\"" + source + "\"/>"));
+        TS_ASSERT_EQUALS(1, indexFile.count("WholeExtent=\"0 3 0 2 0 0\" Origin=\"5 0 0\" Spacing=\"20 10 1\""));
+        TS_ASSERT_EQUALS(1, indexFile.count("Name=\"value\""));
+
+        // the grid's geometry follows from the extents, no points needed:
+        VTKFileReader regular(piece);
+        TS_ASSERT_EQUALS(1, regular.count("<Piece Extent=\"0 3 0 2 0 0\">"));
+        TS_ASSERT_EQUALS(0, regular.count("Points"));
+
+        std::vector<double> values = regular.array<double>("value");
+        double expectedValues[] = { 0, 1, 2, 10, 11, 12 };
+        TS_ASSERT_EQUALS(std::vector<double>(expectedValues, expectedValues + 6), values);
+
+        // point mesh:
+        piece = prefix + ".point_mesh.00042.0.vtu";
+        files << prefix + ".point_mesh.00042.pvtu" << piece;
+        VTKFileReader pointMesh(piece);
+        TS_ASSERT_EQUALS(6, pointMesh.attribute("NumberOfPoints"));
+        TS_ASSERT_EQUALS(6, pointMesh.attribute("NumberOfCells"));
+
+        std::vector<double> masses = pointMesh.array<double>("mass");
+        double expectedMasses[] = { 1, 2, 2, 101, 102, 102 };
+        TS_ASSERT_EQUALS(std::vector<double>(expectedMasses, expectedMasses + 6), masses);
+        std::vector<double> points = pointMesh.array<double>("Points");
+        TS_ASSERT_EQUALS(2.0, points[3 * 5 + 0]);
+        TS_ASSERT_EQUALS(1.0, points[3 * 5 + 1]);
+
+        // unstructured grid:
+        piece = prefix + ".unstructured_mesh.00042.0.vtu";
+        files << prefix + ".unstructured_mesh.00042.pvtu" << piece;
+        VTKFileReader unstructured(piece);
+        TS_ASSERT_EQUALS(18, unstructured.attribute("NumberOfPoints"));
+        TS_ASSERT_EQUALS(6,  unstructured.attribute("NumberOfCells"));
+
+        std::vector<int> ids = unstructured.array<int>("id");
+        int expectedIDs[] = { 0, 1, 2, 10, 11, 12 };
+        TS_ASSERT_EQUALS(std::vector<int>(expectedIDs, expectedIDs + 6), ids);
+
+        std::vector<long long> offsets = unstructured.array<long long>("offsets");
+        TS_ASSERT_EQUALS(std::size_t(6), offsets.size());
+        TS_ASSERT_EQUALS(18, offsets[5]);
+        TS_ASSERT_EQUALS(7, unstructured.array<unsigned char>("types")[0]);
+    }
+
+    void testMultipleCallsPerStep()
+    {
+        ParallelVTKWriter<VTKTestCell> writer(
+            &VTKTestCell::particles, &VTKTestCell::elements, prefix, 2);
+        writer.addSelector(&VTKTestCell::value, "value");
+
+        Coord<2> dim(4, 3);
+        Grid<VTKTestCell> grid(dim, VTKTestCell(4.5));
+        Region<2> upper;
+        upper << CoordBox<2>(Coord<2>(0, 0), Coord<2>(4, 2));
+        Region<2> lower;
+        lower << CoordBox<2>(Coord<2>(0, 1), Coord<2>(4, 2));
+
+        // skipped because of the period:
+        writer.stepFinished(grid, upper, dim, 3, WRITER_STEP_FINISHED, 0, true);
+        TS_ASSERT_NO_FILE(prefix + ".regular_grid.00003.pvti");
+
+        // overlapping regions must not yield duplicate cells:
+        writer.stepFinished(grid, upper, dim, 4, WRITER_STEP_FINISHED, 0, false);
+        writer.stepFinished(grid, lower, dim, 4, WRITER_STEP_FINISHED, 0, true);
+
+        std::string piece = prefix + ".regular_grid.00004.0.vti";
+        files << piece
+              << prefix + ".regular_grid.00004.pvti"
+              << prefix + ".point_mesh.00004.0.vtu"
+              << prefix + ".point_mesh.00004.pvtu"
+              << prefix + ".unstructured_mesh.00004.0.vtu"
+              << prefix + ".unstructured_mesh.00004.pvtu";
+
+        VTKFileReader regular(piece);
+        TS_ASSERT_EQUALS(1, regular.count("<Piece Extent=\"0 4 0 2 0 0\">"));
+        TS_ASSERT_EQUALS(1, regular.count("<Piece Extent=\"0 4 2 3 0 0\">"));
+        TS_ASSERT_EQUALS(std::vector<double>(12, 4.5), regular.array<double>("value"));
+
+        VTKFileReader index(prefix + ".regular_grid.00004.pvti");
+        TS_ASSERT_EQUALS(2, index.count("<Piece Extent="));
+
+        VTKFileReader pointMesh(prefix + ".point_mesh.00004.0.vtu");
+        TS_ASSERT_EQUALS(0, pointMesh.attribute("NumberOfPoints"));
+    }
+
+    void testBoxes()
+    {
+        // an L-shaped prism with a hole:
+        Region<3> region;
+        region << CoordBox<3>(Coord<3>(0, 0, 0), Coord<3>(10, 4, 5))
+               << CoordBox<3>(Coord<3>(0, 4, 0), Coord<3>(3,  6, 5));
+        region >> Coord<3>(5, 2, 2);
+
+        std::vector<CoordBox<3> > boxes = ParallelVTKWriterHelpers::boxes(region);
+        Region<3> covered;
+        std::size_t cells = 0;
+        for (std::size_t i = 0; i < boxes.size(); ++i) {
+            covered << boxes[i];
+            cells += boxes[i].size();
+        }
+        TS_ASSERT_EQUALS(region, covered);
+        TS_ASSERT_EQUALS(region.size(), cells);
+        TS_ASSERT_EQUALS(std::size_t(7), boxes.size());
+
+        std::vector<CoordBox<3> > expected;
+        expected << CoordBox<3>(Coord<3>(), Coord<3>(4, 5, 6));
+        Region<3> box;
+        box << expected[0];
+        TS_ASSERT_EQUALS(expected, ParallelVTKWriterHelpers::boxes(box));
+    }
+
+    void testCargoTypeMismatch()
+    {
+        ParallelVTKWriter<VTKTestCell> writer(
+            &VTKTestCell::particles, &VTKTestCell::elements, prefix, 1);
+        TS_ASSERT_THROWS(
+            writer.addSelectorForPointMesh(&VTKTestElement::id, "id"),
+            std::invalid_argument&);
+    }
+
+private:
+    std::string prefix;
+    std::vector<std::string> files;
+};
+
+}
@@ -139,6 +139,25 @@ public:
         TS_ASSERT_EQUALS(actSlice, uncSlice);
     }
 
+    void testPlotGridInViewportParallel()
+    {
+        Grid<TestCell<2> > testGrid(Coord<2>(30, 20));
+        for (int y = 0; y < 20; ++y) {
+            for (int x = 0; x < 30; ++x) {
+                testGrid[Coord<2>(x, y)].testValue = (x * 7 + y * 13) % 256;
+            }
+        }
+
+        CoordBox<2> viewport(Coord<2>(15, 10), Coord<2>(200, 300));
+        Image expected(viewport.dimensions);
+        Image actual(viewport.dimensions);
+        ImagePainter painter(&expected);
+
+        plotter->plotGridInViewport(testGrid, painter, viewport);
+        plotter->plotGridInViewportParallel(testGrid, ImagePainter(&actual), viewport);
+        TS_ASSERT_EQUALS(expected, actual);
+    }
+
     void testPlotGridInViewportLarge()
     {
         Grid<TestCell<2> > testGrid(Coord<2>(2000, 2000));
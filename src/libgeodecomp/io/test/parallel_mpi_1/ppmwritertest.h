@@ -85,6 +85,39 @@ public:
         TS_ASSERT_EQUALS(content, expected);
     }
 
+    void testWritePPMDownsampled()
+    {
+        simulator->addWriter(
+            new PPMWriter<TestCell<2> >(
+                &TestCell<2>::testValue, TestCellPalette(), tempFile, 1,
+                Downsampling(Coord<2>(4, 4), Downsampling::MAXIMUM)));
+        simulator->run();
+
+        std::string firstFile = tempFile + ".0000.ppm";
+        std::ifstream infile(firstFile.c_str(), std::ios::binary);
+
+        std::string header;
+        std::getline(infile, header);
+        TS_ASSERT_EQUALS("P6 3 3 255", header);
+
+        // testValue is 1 + x + 10 * y, pixels at the lower and right
+        // edges represent partial blocks:
+        int expected[] = {
+            34,  38,  40,
+            74,  78,  80,
+            104, 108, 110
+        };
+
+        for (int i = 0; i < 9; ++i) {
+            TS_ASSERT_EQUALS(expected[i], infile.get());
+            TS_ASSERT_EQUALS(47, infile.get());
+            TS_ASSERT_EQUALS(11, infile.get());
+        }
+
+        infile.get();
+        TS_ASSERT(infile.eof());
+    }
+
     void testWritePPMPeriod()
     {
         int period = 2;
@@ -0,0 +1,111 @@
+#include <libgeodecomp/io/metricswriter.h>
+#include <libgeodecomp/io/testinitializer.h>
+#include <libgeodecomp/loadbalancer/noopbalancer.h>
+#include <libgeodecomp/misc/testcell.h>
+#include <libgeodecomp/parallelization/stripingsimulator.h>
+
+#include <cxxtest/TestSuite.h>
+#include <fstream>
+#include <unistd.h>
+
+using namespace LibGeoDecomp;
+
+namespace LibGeoDecomp {
+
+class MetricsWriterTest : public CxxTest::TestSuite
+{
+public:
+    void setUp()
+    {
+        simulator.reset(new StripingSimulator<TestCell<2> >(
+                            new TestInitializer<TestCell<2> >(Coord<2>(30, 20), 21, 0),
+                            MPILayer().rank() ? 0 : new NoOpBalancer(),
+                            1000));
+        filename = "metricswritertest.out";
+    }
+
+    void tearDown()
+    {
+        simulator.reset();
+        if (MPILayer().rank() == 0) {
+            unlink(filename.c_str());
+        }
+    }
+
+    void testJSONLines()
+    {
+        simulator->addWriter(
+            new MetricsWriter<TestCell<2> >(
+                filename,
+                5,
+                MetricsWriter<TestCell<2> >::JSON_LINES,
+                &*simulator));
+        simulator->run();
+
+        if (MPILayer().rank() != 0) {
+            return;
+        }
+
+        std::vector<std::string> lines = readLines();
+        // steps 5, 10, 15, 20 and the final step 21:
+        TS_ASSERT_EQUALS(std::size_t(5), lines.size());
+        TS_ASSERT_EQUALS(std::string("{\"step\": 5, "), lines[0].substr(0, 12));
+        TS_ASSERT_EQUALS(std::string("{\"step\": 21, "), lines[4].substr(0, 13));
+
+        for (std::size_t i = 0; i < lines.size(); ++i) {
+            TS_ASSERT(lines[i].find("\"ranks\": 2") != std::string::npos);
+            TS_ASSERT(lines[i].find("\"glups\": ") != std::string::npos);
+            TS_ASSERT(lines[i].find("\"imbalance\": ") != std::string::npos);
+            TS_ASSERT(lines[i].find("\"slowest_rank\": ") != std::string::npos);
+            TS_ASSERT(lines[i].find("\"compute_time_seconds\": {\"min\": ") != std::string::npos);
+            TS_ASSERT(lines[i].find("\"communication_time_seconds\": {") != std::string::npos);
+            // the StripingSimulator splits the 20 rows evenly:
+            TS_ASSERT(lines[i].find("\"cells\": {\"min\": 300, \"avg\": 300, \"max\": 300}") != std::string::npos);
+        }
+    }
+
+    void testPrometheus()
+    {
+        simulator->addWriter(
+            new MetricsWriter<TestCell<2> >(
+                filename,
+                4,
+                MetricsWriter<TestCell<2> >::PROMETHEUS,
+                &*simulator));
+        simulator->run();
+
+        if (MPILayer().rank() != 0) {
+            return;
+        }
+
+        std::vector<std::string> lines = readLines();
+        std::set<std::string> lineSet(lines.begin(), lines.end());
+        // only the last record is retained:
+        TS_ASSERT_EQUALS(1u, lineSet.count("libgeodecomp_step 21"));
+        TS_ASSERT_EQUALS(1u, lineSet.count("libgeodecomp_ranks 2"));
+        TS_ASSERT_EQUALS(1u, lineSet.count("# TYPE libgeodecomp_step_time_seconds gauge"));
+        TS_ASSERT_EQUALS(1u, lineSet.count("libgeodecomp_cells{stat=\"max\"} 300"));
+
+        for (std::size_t i = 0; i < lines.size(); ++i) {
+            TS_ASSERT_EQUALS(std::string::npos, lines[i].find("nan"));
+        }
+    }
+
+private:
+    SharedPtr<StripingSimulator<TestCell<2> > >::Type simulator;
+    std::string filename;
+
+    std::vector<std::string> readLines()
+    {
+        std::vector<std::string> ret;
+        std::ifstream file(filename.c_str());
+        std::string line;
+        while (std::getline(file, line)) {
+            ret << line;
+        }
+
+        return ret;
+    }
+};
+
+}
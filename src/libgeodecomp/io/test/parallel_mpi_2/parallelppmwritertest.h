@@ -0,0 +1,107 @@
+#include <libgeodecomp/io/parallelppmwriter.h>
+#include <libgeodecomp/io/ppmwriter.h>
+#include <libgeodecomp/io/testinitializer.h>
+#include <libgeodecomp/loadbalancer/noopbalancer.h>
+#include <libgeodecomp/parallelization/serialsimulator.h>
+#include <libgeodecomp/parallelization/stripingsimulator.h>
+
+#include <cxxtest/TestSuite.h>
+#include <fstream>
+#include <iterator>
+#include <unistd.h>
+
+using namespace LibGeoDecomp;
+
+namespace LibGeoDecomp {
+
+class ParallelPPMWriterTestPalette
+{
+public:
+    Color operator[](const double value) const
+    {
+        return Color(int(value) % 256, int(value) / 256, 11);
+    }
+};
+
+class ParallelPPMWriterTest : public CxxTest::TestSuite
+{
+public:
+    void tearDown()
+    {
+        MPILayer().barrier();
+        if (MPILayer().rank() == 0) {
+            for (std::size_t i = 0; i < files.size(); ++i) {
+                unlink(files[i].c_str());
+            }
+        }
+        files.clear();
+    }
+
+    void testAverage()
+    {
+        checkAgainstPPMWriter(Downsampling(Coord<2>(3, 2), Downsampling::AVERAGE));
+    }
+
+    void testMinimum()
+    {
+        checkAgainstPPMWriter(Downsampling(Coord<2>(4, 5), Downsampling::MINIMUM));
+    }
+
+    void testMaximum()
+    {
+        checkAgainstPPMWriter(Downsampling(Coord<2>(1, 7), Downsampling::MAXIMUM));
+    }
+
+private:
+    std::vector<std::string> files;
+
+    void checkAgainstPPMWriter(const Downsampling& downsampling)
+    {
+        Coord<2> dim(31, 25);
+        int maxSteps = 3;
+
+        LoadBalancer *balancer = MPILayer().rank()? 0 : new NoOpBalancer;
+        StripingSimulator<TestCell<2> > sim(new TestInitializer<TestCell<2> >(dim, maxSteps), balancer);
+        ParallelPPMWriter<TestCell<2> > *writer = new ParallelPPMWriter<TestCell<2> >(
+            &TestCell<2>::testValue, ParallelPPMWriterTestPalette(), "parallelppmwriter", 2, downsampling);
+        sim.addWriter(writer);
+        sim.run();
+
+        if (MPILayer().rank() != 0) {
+            return;
+        }
+
+        SerialSimulator<TestCell<2> > reference(new TestInitializer<TestCell<2> >(dim, maxSteps));
+        reference.addWriter(
+            new PPMWriter<TestCell<2> >(
+                &TestCell<2>::testValue, ParallelPPMWriterTestPalette(), "serialppmwriter", 2, downsampling));
+        reference.run();
+
+        TS_ASSERT_EQUALS("parallelppmwriter.0123.ppm", writer->filename(123));
+
+        // the final step gets written regardless of the period:
+        for (int step = 0; step <= maxSteps; step += (step == 2) ? 1 : 2) {
+            std::ostringstream suffix;
+            suffix << "." << std::setfill('0') << std::setw(4) << step << ".ppm";
+            std::string actualFile = "parallelppmwriter" + suffix.str();
+            std::string expectedFile = "serialppmwriter" + suffix.str();
+            files.push_back(actualFile);
+            files.push_back(expectedFile);
+
+            std::vector<char> actual = readFile(actualFile);
+            std::vector<char> expected = readFile(expectedFile);
+            TS_ASSERT_LESS_THAN(std::size_t(11), expected.size());
+            TS_ASSERT_EQUALS(expected, actual);
+        }
+    }
+
+    std::vector<char> readFile(const std::string& filename)
+    {
+        std::ifstream file(filename.c_str(), std::ios::binary);
+        return std::vector<char>(
+            (std::istreambuf_iterator<char>(file)),
+            std::istreambuf_iterator<char>());
+    }
+};
+
+}
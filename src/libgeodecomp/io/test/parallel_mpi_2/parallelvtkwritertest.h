@@ -0,0 +1,121 @@
+#include <libgeodecomp/io/parallelvtkwriter.h>
+#include <libgeodecomp/io/testinitializer.h>
+#include <libgeodecomp/loadbalancer/noopbalancer.h>
+#include <libgeodecomp/parallelization/stripingsimulator.h>
+
+#include <cxxtest/TestSuite.h>
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <unistd.h>
+
+using namespace LibGeoDecomp;
+
+namespace LibGeoDecomp {
+
+class ParallelVTKWriterTest : public CxxTest::TestSuite
+{
+public:
+    void tearDown()
+    {
+        MPILayer().barrier();
+        for (std::size_t i = 0; i < files.size(); ++i) {
+            unlink(files[i].c_str());
+        }
+        files.clear();
+    }
+
+    void testPiecesCoverGrid()
+    {
+        Coord<3> dim(7, 5, 6);
+        int maxSteps = 2;
+
+        LoadBalancer *balancer = MPILayer().rank()? 0 : new NoOpBalancer;
+        StripingSimulator<TestCell<3> > sim(new TestInitializer<TestCell<3> >(dim, maxSteps), balancer);
+        ParallelVTKWriter<TestCell<3> > *writer = new ParallelVTKWriter<TestCell<3> >("parallelvtkwriter", 2);
+        writer->addSelector(&TestCell<3>::testValue, "testValue");
+        writer->addSelector(&TestCell<3>::isValid, "isValid");
+        sim.addWriter(writer);
+        sim.run();
+
+        MPILayer().barrier();
+        int rank = MPILayer().rank();
+        files << pieceFilename(0, rank) << pieceFilename(2, rank);
+        if (rank == 0) {
+            files << "parallelvtkwriter.regular_grid.00000.pvti"
+                  << "parallelvtkwriter.regular_grid.00002.pvti";
+        }
+
+        std::string piece = readFile(pieceFilename(2, rank));
+        std::vector<double> values = readArray<double>(piece, "testValue");
+        std::vector<char> valid = readArray<char>(piece, "isValid");
+        TS_ASSERT_EQUALS(values.size(), valid.size());
+
+        // every cell has to be written by exactly one rank:
+        std::vector<double> allValues = MPILayer().allGatherV(values.data(), MPILayer().allGather(int(values.size())));
+        TS_ASSERT_EQUALS(std::size_t(dim.prod()), allValues.size());
+        std::sort(allValues.begin(), allValues.end());
+        for (int i = 0; i < dim.prod(); ++i) {
+            TS_ASSERT_EQUALS(i + 1, allValues[i]);
+        }
+
+        for (std::size_t i = 0; i < valid.size(); ++i) {
+            TS_ASSERT_EQUALS(1, valid[i]);
+        }
+
+        if (rank == 0) {
+            std::string index = readFile("parallelvtkwriter.regular_grid.00002.pvti");
+            TS_ASSERT_DIFFERS(std::string::npos, index.find("WholeExtent=\"0 7 0 5 0 6\""));
+            for (int i = 0; i < MPILayer().size(); ++i) {
+                TS_ASSERT_DIFFERS(
+                    std::string::npos,
+                    index.find("Source=\"" + pieceFilename(2, i) + "\"/>"));
+            }
+        }
+    }
+
+private:
+    std::vector<std::string> files;
+
+    std::string pieceFilename(int step, int rank)
+    {
+        std::ostringstream buf;
+        buf << "parallelvtkwriter.regular_grid.0000" << step << "." << rank << ".vti";
+        return buf.str();
+    }
+
+    std::string readFile(const std::string& filename)
+    {
+        std::ifstream file(filename.c_str(), std::ios::binary);
+        return std::string(
+            (std::istreambuf_iterator<char>(file)),
+            std::istreambuf_iterator<char>());
+    }
+
+    /**
+     * Concatenates the arrays of all pieces.
+     */
+    template<typename T>
+    std::vector<T> readArray(const std::string& piece, const std::string& name)
+    {
+        std::string marker = "<AppendedData encoding=\"raw\">\n_";
+        std::size_t dataStart = piece.find(marker) + marker.size();
+        std::vector<T> ret;
+
+        for (std::size_t pos = piece.find("Name=\"" + name + "\"");
+             pos < dataStart;
+             pos = piece.find("Name=\"" + name + "\"", pos + 1)) {
+            std::size_t offset = atol(piece.c_str() + piece.find("offset=\"", pos) + 8);
+
+            unsigned long long size;
+            std::memcpy(&size, piece.data() + dataStart + offset, sizeof(size));
+            std::size_t oldSize = ret.size();
+            ret.resize(oldSize + size / sizeof(T));
+            std::memcpy(&ret[0] + oldSize, piece.data() + dataStart + offset + sizeof(size), size);
+        }
+        return ret;
+    }
+};
+
+}
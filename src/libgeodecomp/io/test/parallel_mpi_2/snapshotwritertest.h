@@ -0,0 +1,112 @@
+#include <libgeodecomp/communication/mpilayer.h>
+#include <libgeodecomp/io/memorywriter.h>
+#include <libgeodecomp/io/snapshotinitializer.h>
+#include <libgeodecomp/io/snapshotwriter.h>
+#include <libgeodecomp/io/testinitializer.h>
+#include <libgeodecomp/loadbalancer/noopbalancer.h>
+#include <libgeodecomp/loadbalancer/randombalancer.h>
+#include <libgeodecomp/misc/testhelper.h>
+#include <libgeodecomp/parallelization/serialsimulator.h>
+#include <libgeodecomp/parallelization/stripingsimulator.h>
+
+#include <algorithm>
+#include <unistd.h>
+#include <cxxtest/TestSuite.h>
+
+using namespace LibGeoDecomp;
+
+namespace LibGeoDecomp {
+
+class SnapshotWriterTest : public CxxTest::TestSuite
+{
+public:
+    std::vector<std::string> files;
+    int rank;
+
+    void setUp()
+    {
+        rank = MPILayer().rank();
+        files.clear();
+    }
+
+    void tearDown()
+    {
+        MPILayer().barrier();
+        if (rank == 0) {
+            for (std::size_t i = 0; i < files.size(); ++i) {
+                unlink(files[i].c_str());
+            }
+        }
+    }
+
+    void testWriteAndRestart()
+    {
+        typedef TestCell<3> CellType;
+        typedef APITraits::SelectTopology<CellType>::Value Topology;
+        std::string prefix = "testsnapshotwriter1_";
+        std::string restartPrefix = "testsnapshotwriter2_";
+        for (unsigned step = 0; step <= 24; step += 4) {
+            unsigned actualStep = (std::min)(step, 21u);
+            files << Snapshot<CellType>::indexFilename(prefix, actualStep);
+            if (actualStep >= 8) {
+                files << Snapshot<CellType>::indexFilename(restartPrefix, actualStep);
+            }
+            for (int piece = 0; piece < 2; ++piece) {
+                files << Snapshot<CellType>::filename(prefix, actualStep, piece);
+                if (actualStep >= 8) {
+                    files << Snapshot<CellType>::filename(restartPrefix, actualStep, piece);
+                }
+            }
+        }
+
+        LoadBalancer *balancer = MPILayer().rank()? 0 : new NoOpBalancer;
+        StripingSimulator<CellType> sim(new TestInitializer<CellType>(), balancer);
+        sim.addWriter(new SnapshotWriter<CellType>(prefix, 4, 21));
+        sim.run();
+        MPILayer().barrier();
+
+        // each rank wrote its own piece:
+        SnapshotPiece<CellType> piece0(Snapshot<CellType>::filename(prefix, 8, 0));
+        SnapshotPiece<CellType> piece1(Snapshot<CellType>::filename(prefix, 8, 1));
+        TS_ASSERT_EQUALS(unsigned(2), piece0.numPieces());
+        TS_ASSERT_EQUALS(unsigned(8), piece1.step());
+        TS_ASSERT_EQUALS(unsigned(21), piece1.maxSteps());
+        TS_ASSERT((piece0.region() & piece1.region()).empty());
+
+        Coord<3> dimensions = TestInitializer<CellType>().gridDimensions();
+        Region<3> globalRegion;
+        globalRegion << CoordBox<3>(Coord<3>(), dimensions);
+        TS_ASSERT_EQUALS(globalRegion, piece0.region() + piece1.region());
+
+        // the index lists both pieces:
+        SnapshotIndex<CellType> index(Snapshot<CellType>::indexFilename(prefix, 8));
+        TS_ASSERT_EQUALS(unsigned(2), index.numPieces());
+        TS_ASSERT_EQUALS(piece0.region().boundingBox(), index.boundingBoxes()[0]);
+        TS_ASSERT_EQUALS(piece1.region().boundingBox(), index.boundingBoxes()[1]);
+
+        // restart from step 8 with a different decomposition:
+        balancer = MPILayer().rank()? 0 : new RandomBalancer;
+        SnapshotInitializer<CellType> *init = new SnapshotInitializer<CellType>(prefix, 8);
+        TS_ASSERT_EQUALS(unsigned(8), init->startStep());
+        TS_ASSERT_EQUALS(unsigned(21), init->maxSteps());
+        TS_ASSERT_EQUALS(dimensions, init->gridDimensions());
+
+        StripingSimulator<CellType> restartSim(init, balancer, 2);
+        restartSim.addWriter(new SnapshotWriter<CellType>(restartPrefix, 4, 21));
+        restartSim.run();
+        MPILayer().barrier();
+
+        if (rank == 0) {
+            typedef Grid<CellType, Topology> GridType;
+            GridType expected(dimensions);
+            GridType actual(dimensions);
+            SnapshotInitializer<CellType>(prefix, 21).grid(&expected);
+            SnapshotInitializer<CellType>(restartPrefix, 21).grid(&actual);
+
+            TS_ASSERT_TEST_GRID(GridType, actual, 21 * CellType::NANO_STEPS);
+            TS_ASSERT_EQUALS(expected, actual);
+        }
+    }
+};
+
+}
@@ -0,0 +1,92 @@
+#include <libgeodecomp/communication/typemaps.h>
+#include <libgeodecomp/io/sparsesteerer.h>
+#include <libgeodecomp/misc/testcell.h>
+#include <libgeodecomp/storage/grid.h>
+
+#include <cxxtest/TestSuite.h>
+
+using namespace LibGeoDecomp;
+
+namespace LibGeoDecomp {
+
+class SparseSteererTestMarker
+{
+public:
+    void operator()(TestCell<2> *cell) const
+    {
+        cell->testValue = -1;
+    }
+};
+
+/**
+ * Only rank 0 generates edits, just like a steerer which is fed by a
+ * user interface.
+ */
+class RoutingTestSteerer : public SparseSteerer<TestCell<2> >
+{
+public:
+    RoutingTestSteerer() :
+        SparseSteerer<TestCell<2> >(1, MPI_COMM_WORLD, Typemaps::lookup<TestCell<2> >())
+    {}
+
+    void nextEdits(
+        unsigned step,
+        SteererEvent event,
+        std::size_t rank,
+        EditBatch *edits,
+        SteererFeedback *feedback)
+    {
+        if ((rank != 0) || (step != 3)) {
+            return;
+        }
+
+        TestCell<2> cell;
+        cell.testValue = 47;
+        edits->set(Coord<2>(1, 1), cell);
+        cell.testValue = 11;
+        edits->set(Coord<2>(2, 6), cell);
+        edits->set(Coord<2>(3, 7), cell);
+        // functors stay on the submitting process:
+        edits->modify(Coord<2>(0, 0), SparseSteererTestMarker());
+        edits->modify(Coord<2>(0, 7), SparseSteererTestMarker());
+    }
+};
+
+class SparseSteererTest : public CxxTest::TestSuite
+{
+public:
+    void testRoutingToOwners()
+    {
+        int rank = MPILayer().rank();
+        Coord<2> dim(4, 8);
+        CoordBox<2> box(Coord<2>(0, 4 * rank), Coord<2>(4, 4));
+        Grid<TestCell<2> > grid(dim);
+        Region<2> region;
+        region << box;
+
+        RoutingTestSteerer steerer;
+        steerer.setRegion(region);
+        for (unsigned step = 0; step < 5; ++step) {
+            steerer.nextStep(&grid, region, dim, step, STEERER_NEXT_STEP, rank, true, 0);
+        }
+
+        for (CoordBox<2>::Iterator i = box.begin(); i != box.end(); ++i) {
+            TestCell<2> cell = grid.get(*i);
+            double expectedValue = TestCell<2>().testValue;
+
+            if (*i == Coord<2>(1, 1)) {
+                expectedValue = 47;
+            }
+            if ((*i == Coord<2>(2, 6)) || (*i == Coord<2>(3, 7))) {
+                expectedValue = 11;
+            }
+            if (*i == Coord<2>(0, 0)) {
+                expectedValue = -1;
+            }
+
+            TS_ASSERT_EQUALS(expectedValue, cell.testValue);
+        }
+    }
+};
+
+}
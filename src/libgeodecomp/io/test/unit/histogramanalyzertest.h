@@ -0,0 +1,75 @@
+#include <libgeodecomp/io/histogramanalyzer.h>
+#include <libgeodecomp/misc/stdcontaineroverloads.h>
+#include <libgeodecomp/misc/testcell.h>
+#include <libgeodecomp/storage/grid.h>
+
+#include <cxxtest/TestSuite.h>
+
+using namespace LibGeoDecomp;
+
+namespace LibGeoDecomp {
+
+class HistogramAnalyzerTest : public CxxTest::TestSuite
+{
+public:
+    void testBinsAndStatistics()
+    {
+        Grid<TestCell<2> > grid(Coord<2>(5, 2));
+        for (int y = 0; y < 2; ++y) {
+            for (int x = 0; x < 5; ++x) {
+                grid[Coord<2>(x, y)].testValue = 5 * y + x;
+            }
+        }
+        // outliers end up in the outermost bins:
+        grid[Coord<2>(0, 0)].testValue = -3;
+        grid[Coord<2>(4, 1)].testValue = 20;
+
+        Region<2> region;
+        region << grid.boundingBox();
+
+        HistogramAnalyzer<TestCell<2>, double> analyzer(&TestCell<2>::testValue, 0, 10, 5);
+        analyzer.analyze(grid, region, 7);
+
+        TS_ASSERT_EQUALS(std::size_t(1), analyzer.getResults().size());
+        const HistogramAnalyzer<TestCell<2>, double>::Result& result = analyzer.getResults().find(7)->second;
+
+        // values: -3 1 2 3 4 5 6 7 8 20
+        std::vector<std::size_t> expectedBins;
+        expectedBins << 2 << 2 << 2 << 2 << 2;
+        TS_ASSERT_EQUALS(expectedBins, result.bins);
+        TS_ASSERT_EQUALS(std::size_t(10), result.count);
+        TS_ASSERT_EQUALS(-3.0, result.min);
+        TS_ASSERT_EQUALS(20.0, result.max);
+        TS_ASSERT_EQUALS(5.3, result.mean());
+    }
+
+    void testPartialRegion()
+    {
+        Grid<TestCell<2> > grid(Coord<2>(5, 2));
+        grid[Coord<2>(0, 0)].testValue = 1;
+        grid[Coord<2>(3, 1)].testValue = 9;
+
+        Region<2> region;
+        region << Coord<2>(3, 1)
+               << Coord<2>(0, 0);
+
+        HistogramAnalyzer<TestCell<2>, double> analyzer(&TestCell<2>::testValue, 0, 10, 2);
+        analyzer.analyze(grid, region, 0);
+
+        const HistogramAnalyzer<TestCell<2>, double>::Result& result = analyzer.getResults().find(0)->second;
+        TS_ASSERT_EQUALS(std::size_t(2), result.count);
+        TS_ASSERT_EQUALS(std::size_t(1), result.bins[0]);
+        TS_ASSERT_EQUALS(std::size_t(1), result.bins[1]);
+        TS_ASSERT_EQUALS(9.0, result.max);
+    }
+
+    void testInvalidArguments()
+    {
+        typedef HistogramAnalyzer<TestCell<2>, double> AnalyzerType;
+        TS_ASSERT_THROWS(AnalyzerType(&TestCell<2>::testValue, 0, 10, 0), std::invalid_argument&);
+        TS_ASSERT_THROWS(AnalyzerType(&TestCell<2>::testValue, 1, 1, 4), std::invalid_argument&);
+        TS_ASSERT_THROWS(AnalyzerType(&TestCell<2>::testValue, 0, 1, 4, 0), std::invalid_argument&);
+    }
+};
+
+}
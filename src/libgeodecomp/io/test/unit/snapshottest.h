@@ -0,0 +1,242 @@
+#include <libgeodecomp/io/snapshot.h>
+#include <libgeodecomp/io/snapshotinitializer.h>
+#include <libgeodecomp/io/testinitializer.h>
+#include <libgeodecomp/misc/stdcontaineroverloads.h>
+#include <libgeodecomp/misc/tempfile.h>
+#include <libgeodecomp/storage/displacedgrid.h>
+#include <libgeodecomp/storage/grid.h>
+
+#include <cxxtest/TestSuite.h>
+#include <fstream>
+#include <unistd.h>
+
+using namespace LibGeoDecomp;
+
+namespace LibGeoDecomp {
+
+class SnapshotTest : public CxxTest::TestSuite
+{
+public:
+    typedef TestCell<2> CellType;
+    typedef APITraits::SelectTopology<CellType>::Value Topology;
+    typedef Grid<CellType, Topology> GridType;
+
+    std::string prefix;
+    std::vector<std::string> files;
+    Coord<2> dimensions;
+    GridType reference;
+
+    void setUp()
+    {
+        prefix = TempFile::serial("snapshottest");
+        files.clear();
+
+        dimensions = Coord<2>(17, 12);
+        reference = GridType(dimensions);
+        TestInitializer<CellType> init(dimensions, 31, 5);
+        init.grid(&reference);
+    }
+
+    void tearDown()
+    {
+        for (std::size_t i = 0; i < files.size(); ++i) {
+            unlink(files[i].c_str());
+        }
+    }
+
+    void testRoundTrip()
+    {
+        Region<2> region;
+        region << CoordBox<2>(Coord<2>(), dimensions);
+        writePiece(region, 0, 1);
+
+        SnapshotPiece<CellType> piece(files[0]);
+        TS_ASSERT_EQUALS(unsigned(5), piece.step());
+        TS_ASSERT_EQUALS(unsigned(31), piece.maxSteps());
+        TS_ASSERT_EQUALS(unsigned(1), piece.numPieces());
+        TS_ASSERT_EQUALS(dimensions, piece.dimensions());
+        TS_ASSERT_EQUALS(region, piece.region());
+        TS_ASSERT_EQUALS(reference.getEdge(), piece.edgeCell());
+
+        GridType actual(dimensions);
+        TS_ASSERT_EQUALS(std::size_t(17 * 12), piece.load(&actual, region));
+        actual.setEdge(piece.edgeCell());
+        TS_ASSERT_EQUALS(reference, actual);
+    }
+
+    void testPartialLoad()
+    {
+        Region<2> region;
+        region << CoordBox<2>(Coord<2>(0, 2), Coord<2>(17, 5));
+        writePiece(region, 0, 1);
+
+        CoordBox<2> box(Coord<2>(3, 4), Coord<2>(10, 8));
+        DisplacedGrid<CellType> actual(box);
+        Region<2> wanted;
+        wanted << box;
+
+        SnapshotPiece<CellType> piece(files[0]);
+        TS_ASSERT_EQUALS(std::size_t(10 * 3), piece.load(&actual, wanted));
+
+        for (CoordBox<2>::Iterator i = box.begin(); i != box.end(); ++i) {
+            if (i->y() < 7) {
+                TS_ASSERT_EQUALS(reference[*i], actual[*i]);
+            } else {
+                TS_ASSERT_EQUALS(CellType(), actual[*i]);
+            }
+        }
+    }
+
+    void testRedistribution()
+    {
+        // three pieces with a decomposition unlike the one used for reading:
+        Region<2> region0;
+        Region<2> region1;
+        Region<2> region2;
+        region0 << CoordBox<2>(Coord<2>(0, 0), Coord<2>(17, 3))
+                << CoordBox<2>(Coord<2>(0, 3), Coord<2>(5,  2));
+        region1 << CoordBox<2>(Coord<2>(5, 3), Coord<2>(12, 2))
+                << CoordBox<2>(Coord<2>(0, 5), Coord<2>(17, 3));
+        region2 << CoordBox<2>(Coord<2>(0, 8), Coord<2>(17, 4));
+        writePiece(region0, 0, 3);
+        writePiece(region1, 1, 3);
+        writePiece(region2, 2, 3);
+        std::vector<Region<2> > regions;
+        regions << region0 << region1 << region2;
+        writeIndex(regions);
+
+        SnapshotInitializer<CellType> init(prefix, 5);
+        TS_ASSERT_EQUALS(dimensions, init.gridDimensions());
+        TS_ASSERT_EQUALS(unsigned(5), init.startStep());
+        TS_ASSERT_EQUALS(unsigned(31), init.maxSteps());
+
+        GridType actual(dimensions);
+        init.grid(&actual);
+        TS_ASSERT_EQUALS(reference, actual);
+
+        // ghost cells outside of the simulation space are left alone:
+        CoordBox<2> box(Coord<2>(-1, 4), Coord<2>(8, 6));
+        DisplacedGrid<CellType> partial(box);
+        init.grid(&partial);
+
+        for (CoordBox<2>::Iterator i = box.begin(); i != box.end(); ++i) {
+            if (i->x() < 0) {
+                TS_ASSERT_EQUALS(CellType(), partial[*i]);
+            } else {
+                TS_ASSERT_EQUALS(reference[*i], partial[*i]);
+            }
+        }
+        TS_ASSERT_EQUALS(reference.getEdge(), partial.getEdge());
+    }
+
+    void testIndex()
+    {
+        Region<2> region0;
+        Region<2> region1;
+        Region<2> region2;
+        region0 << CoordBox<2>(Coord<2>(0, 0), Coord<2>(17, 4));
+        region2 << CoordBox<2>(Coord<2>(2, 4), Coord<2>(15, 8));
+        std::vector<Region<2> > regions;
+        regions << region0 << region1 << region2;
+        writeIndex(regions);
+
+        SnapshotIndex<CellType> index(Snapshot<CellType>::indexFilename(prefix, 5));
+        TS_ASSERT_EQUALS(unsigned(5), index.step());
+        TS_ASSERT_EQUALS(unsigned(31), index.maxSteps());
+        TS_ASSERT_EQUALS(unsigned(3), index.numPieces());
+        TS_ASSERT_EQUALS(dimensions, index.dimensions());
+        TS_ASSERT_EQUALS(reference.getEdge(), index.edgeCell());
+
+        std::vector<CoordBox<2> > expected;
+        expected << region0.boundingBox()
+                 << region1.boundingBox()
+                 << region2.boundingBox();
+        TS_ASSERT_EQUALS(expected, index.boundingBoxes());
+
+        TS_ASSERT_THROWS(SnapshotIndex<TestCell<3> > wrongType(files[0]), FileReadException&);
+    }
+
+    void testOnlyOverlappingPiecesAreOpened()
+    {
+        Region<2> region0;
+        Region<2> region1;
+        region0 << CoordBox<2>(Coord<2>(0, 0), Coord<2>(17, 6));
+        region1 << CoordBox<2>(Coord<2>(0, 6), Coord<2>(17, 6));
+        writePiece(region0, 0, 2);
+        std::vector<Region<2> > regions;
+        regions << region0 << region1;
+        writeIndex(regions);
+        // piece 1 doesn't exist, but isn't needed either:
+        files << Snapshot<CellType>::filename(prefix, 5, 1);
+
+        CoordBox<2> box(Coord<2>(3, 1), Coord<2>(10, 5));
+        DisplacedGrid<CellType> actual(box);
+        SnapshotInitializer<CellType> init(prefix, 5);
+        init.grid(&actual);
+        for (CoordBox<2>::Iterator i = box.begin(); i != box.end(); ++i) {
+            TS_ASSERT_EQUALS(reference[*i], actual[*i]);
+        }
+
+        DisplacedGrid<CellType> overlapping(CoordBox<2>(Coord<2>(3, 5), Coord<2>(10, 2)));
+        TS_ASSERT_THROWS(init.grid(&overlapping), FileOpenException&);
+    }
+
+    void testMissingFile()
+    {
+        TS_ASSERT_THROWS(SnapshotPiece<CellType>(prefix + "nonexistent"), FileOpenException&);
+        TS_ASSERT_THROWS(SnapshotInitializer<CellType>(prefix, 5), FileOpenException&);
+    }
+
+    void testCorruptFile()
+    {
+        Region<2> region;
+        region << CoordBox<2>(Coord<2>(), dimensions);
+        writePiece(region, 0, 1);
+
+        // truncated:
+        truncate(files[0].c_str(), 500);
+        TS_ASSERT_THROWS(SnapshotPiece<CellType> piece(files[0]), FileReadException&);
+
+        // wrong cell type:
+        TS_ASSERT_THROWS(SnapshotPiece<TestCell<3> > piece(files[0]), FileReadException&);
+
+        // garbage:
+        {
+            std::ofstream file(files[0].c_str());
+            file << "this is not a snapshot, but it's long enough to be mistaken for one. "
+                 << "this is not a snapshot, but it's long enough to be mistaken for one.";
+        }
+        TS_ASSERT_THROWS(SnapshotPiece<CellType> piece(files[0]), FileReadException&);
+    }
+
+private:
+    void writeIndex(const std::vector<Region<2> >& regions)
+    {
+        std::vector<CoordBox<2> > boxes;
+        for (std::size_t i = 0; i < regions.size(); ++i) {
+            boxes << regions[i].boundingBox();
+        }
+
+        std::string filename = Snapshot<CellType>::indexFilename(prefix, 5);
+        files << filename;
+        Snapshot<CellType>::writeIndex(filename, boxes, reference.getEdge(), dimensions, 5, 31);
+    }
+
+    void writePiece(const Region<2>& region, unsigned piece, unsigned numPieces)
+    {
+        std::vector<Streak<2> > streaks;
+        std::vector<CellType> cells;
+        for (Region<2>::StreakIterator i = region.beginStreak(); i != region.endStreak(); ++i) {
+            streaks << *i;
+            for (Coord<2> c = i->origin; c.x() < i->endX; ++c.x()) {
+                cells << reference[c];
+            }
+        }
+
+        std::string filename = Snapshot<CellType>::filename(prefix, 5, piece);
+        files << filename;
+        Snapshot<CellType>::write(filename, streaks, cells, reference.getEdge(), dimensions, 5, 31, numPieces);
+    }
+};
+
+}
@@ -0,0 +1,146 @@
+#include <libgeodecomp/io/sparsesteerer.h>
+#include <libgeodecomp/misc/stdcontaineroverloads.h>
+#include <libgeodecomp/storage/grid.h>
+
+#include <cxxtest/TestSuite.h>
+
+using namespace LibGeoDecomp;
+
+namespace LibGeoDecomp {
+
+class SparseSteererTestIncrement
+{
+public:
+    explicit SparseSteererTestIncrement(double delta) :
+        delta(delta)
+    {}
+
+    void operator()(double *cell) const
+    {
+        *cell += delta;
+    }
+
+private:
+    double delta;
+};
+
+/**
+ * Sets a single cell to the current step and increments another one.
+ */
+class SparseSteererTestSteerer : public SparseSteerer<double>
+{
+public:
+    SparseSteererTestSteerer() :
+        SparseSteerer<double>(1)
+    {}
+
+    void nextEdits(
+        unsigned step,
+        SteererEvent event,
+        std::size_t rank,
+        EditBatch *edits,
+        SteererFeedback *feedback)
+    {
+        steps << step;
+        if (step % 2) {
+            return;
+        }
+
+        edits->set(Coord<2>(1, 1), step);
+        edits->modify(Coord<2>(3, 4), SparseSteererTestIncrement(0.5));
+    }
+
+    std::vector<unsigned> steps;
+};
+
+class SparseSteererTest : public CxxTest::TestSuite
+{
+public:
+    void setUp()
+    {
+        grid = Grid<double>(Coord<2>(5, 6), 0.0);
+    }
+
+    void testBatchAppliesInOrder()
+    {
+        SteererEditBatch<double> batch;
+        TS_ASSERT(batch.empty());
+
+        batch.set(Coord<2>(2, 3), 10);
+        batch.modify(Coord<2>(2, 3), SparseSteererTestIncrement(1.5));
+        batch.set(Coord<2>(4, 0), 7);
+        TS_ASSERT_EQUALS(std::size_t(3), batch.size());
+
+        Region<2> expectedRegion;
+        expectedRegion << Coord<2>(2, 3)
+                       << Coord<2>(4, 0);
+        TS_ASSERT_EQUALS(expectedRegion, batch.region());
+
+        Region<2> applicableRegion;
+        applicableRegion << grid.boundingBox();
+        TS_ASSERT_EQUALS(std::size_t(3), batch.apply(&grid, applicableRegion));
+        TS_ASSERT_EQUALS(11.5, grid.get(Coord<2>(2, 3)));
+        TS_ASSERT_EQUALS(7.0,  grid.get(Coord<2>(4, 0)));
+        TS_ASSERT_EQUALS(0.0,  grid.get(Coord<2>(2, 2)));
+
+        batch.clear();
+        TS_ASSERT(batch.empty());
+        TS_ASSERT(batch.region().empty());
+    }
+
+    void testBatchRespectsRegion()
+    {
+        SteererEditBatch<double> batch;
+        batch.set(Coord<2>(0, 0), 1);
+        batch.set(Coord<2>(0, 5), 2);
+
+        Region<2> upperHalf;
+        upperHalf << CoordBox<2>(Coord<2>(0, 0), Coord<2>(5, 3));
+        TS_ASSERT_EQUALS(std::size_t(1), batch.apply(&grid, upperHalf));
+        TS_ASSERT_EQUALS(1.0, grid.get(Coord<2>(0, 0)));
+        TS_ASSERT_EQUALS(0.0, grid.get(Coord<2>(0, 5)));
+
+        Region<2> elsewhere;
+        elsewhere << Streak<2>(Coord<2>(1, 2), 5);
+        TS_ASSERT_EQUALS(std::size_t(0), batch.apply(&grid, elsewhere));
+    }
+
+    void testEditsAreAppliedOncePerStep()
+    {
+        SparseSteererTestSteerer steerer;
+        Region<2> ghost;
+        ghost << CoordBox<2>(Coord<2>(0, 3), Coord<2>(5, 2));
+        Region<2> inner;
+        inner << CoordBox<2>(Coord<2>(0, 0), Coord<2>(5, 5));
+        Coord<2> dim = grid.boundingBox().dimensions;
+
+        for (unsigned step = 0; step < 5; ++step) {
+            // the regions overlap, but the functor edit must still
+            // be carried out only once per step:
+            steerer.nextStep(&grid, ghost, dim, step, STEERER_NEXT_STEP, 0, false, 0);
+            steerer.nextStep(&grid, inner, dim, step, STEERER_NEXT_STEP, 0, true,  0);
+        }
+
+        std::vector<unsigned> expectedSteps;
+        expectedSteps << 0 << 1 << 2 << 3 << 4;
+        TS_ASSERT_EQUALS(expectedSteps, steerer.steps);
+        TS_ASSERT_EQUALS(4.0, grid.get(Coord<2>(1, 1)));
+        TS_ASSERT_EQUALS(1.5, grid.get(Coord<2>(3, 4)));
+    }
+
+    void testCellsOutsideValidRegionAreSkipped()
+    {
+        SparseSteererTestSteerer steerer;
+        Region<2> validRegion;
+        validRegion << CoordBox<2>(Coord<2>(0, 0), Coord<2>(5, 3));
+
+        steerer.nextStep(&grid, validRegion, grid.boundingBox().dimensions, 2, STEERER_NEXT_STEP, 0, true, 0);
+        TS_ASSERT_EQUALS(2.0, grid.get(Coord<2>(1, 1)));
+        TS_ASSERT_EQUALS(0.0, grid.get(Coord<2>(3, 4)));
+    }
+
+private:
+    Grid<double> grid;
+};
+
+}
@@ -0,0 +1,190 @@
+#include <libgeodecomp/io/subsamplingwriter.h>
+#include <libgeodecomp/misc/stdcontaineroverloads.h>
+#include <libgeodecomp/storage/grid.h>
+
+#include <cxxtest/TestSuite.h>
+
+using namespace LibGeoDecomp;
+
+namespace LibGeoDecomp {
+
+/**
+ * Records everything it gets passed so we can check what the
+ * SubsamplingWriter hands down.
+ */
+class SubsamplingRecorder : public Clonable<ParallelWriter<double>, SubsamplingRecorder>
+{
+public:
+    SubsamplingRecorder() :
+        Clonable<ParallelWriter<double>, SubsamplingRecorder>("recorder", 3),
+        grid(Coord<2>())
+    {}
+
+    void setRegion(const Region<2>& newRegion)
+    {
+        region = newRegion;
+    }
+
+    void stepFinished(
+        const GridType& newGrid,
+        const Region<2>& validRegion,
+        const Coord<2>& globalDimensions,
+        unsigned step,
+        WriterEvent event,
+        std::size_t rank,
+        bool lastCall)
+    {
+        steps << step;
+        dimensions = globalDimensions;
+        validRegions << validRegion;
+
+        if (grid.boundingBox().dimensions != globalDimensions) {
+            grid.resize(globalDimensions);
+        }
+        for (Region<2>::Iterator i = validRegion.begin(); i != validRegion.end(); ++i) {
+            grid.set(*i, newGrid.get(*i));
+        }
+    }
+
+    std::vector<unsigned> steps;
+    std::vector<Region<2> > validRegions;
+    Coord<2> dimensions;
+    Grid<double> grid;
+    using ParallelWriter<double>::region;
+};
+
+class SubsamplingWriterTest : public CxxTest::TestSuite
+{
+public:
+    void setUp()
+    {
+        dim = Coord<2>(20, 10);
+        grid = Grid<double>(dim);
+        for (int y = 0; y < dim.y(); ++y) {
+            for (int x = 0; x < dim.x(); ++x) {
+                grid.set(Coord<2>(x, y), 100 * y + x);
+            }
+        }
+    }
+
+    void testStride()
+    {
+        SubsamplingRecorder *recorder = new SubsamplingRecorder;
+        SubsamplingWriter<double> writer(recorder, Coord<2>(4, 3));
+        TS_ASSERT_EQUALS(unsigned(3), writer.getPeriod());
+        TS_ASSERT_EQUALS("recorder", writer.getPrefix());
+
+        Region<2> validRegion;
+        validRegion << grid.boundingBox();
+        writer.stepFinished(grid, validRegion, dim, 6, WRITER_STEP_FINISHED, 0, true);
+
+        TS_ASSERT_EQUALS(Coord<2>(5, 4), recorder->dimensions);
+        Region<2> expectedRegion;
+        expectedRegion << CoordBox<2>(Coord<2>(), Coord<2>(5, 4));
+        TS_ASSERT_EQUALS(expectedRegion, recorder->validRegions[0]);
+
+        for (int y = 0; y < 4; ++y) {
+            for (int x = 0; x < 5; ++x) {
+                TS_ASSERT_EQUALS(300 * y + 4 * x, recorder->grid.get(Coord<2>(x, y)));
+            }
+        }
+    }
+
+    void testPeriod()
+    {
+        SubsamplingRecorder *recorder = new SubsamplingRecorder;
+        SubsamplingWriter<double> writer(recorder, Coord<2>(2, 2));
+        Region<2> validRegion;
+        validRegion << grid.boundingBox();
+
+        for (unsigned step = 0; step < 7; ++step) {
+            writer.stepFinished(grid, validRegion, dim, step, WRITER_STEP_FINISHED, 0, true);
+        }
+        writer.stepFinished(grid, validRegion, dim, 7, WRITER_ALL_DONE, 0, true);
+
+        std::vector<unsigned> expected;
+        expected << 0 << 3 << 6 << 7;
+        TS_ASSERT_EQUALS(expected, recorder->steps);
+    }
+
+    void testBoxOfInterestAndPartialRegions()
+    {
+        SubsamplingRecorder *recorder = new SubsamplingRecorder;
+        CoordBox<2> box(Coord<2>(3, 2), Coord<2>(10, 5));
+        SubsamplingWriter<double> writer(recorder, Coord<2>(2, 2), box);
+
+        // two ranks, split at y = 5. only rows 2, 4 (rank 0) and 6
+        // (rank 1) are within the box and on the lattice:
+        Region<2> upper;
+        upper << CoordBox<2>(Coord<2>(0, 0), Coord<2>(20, 5));
+        Region<2> lower;
+        lower << CoordBox<2>(Coord<2>(0, 5), Coord<2>(20, 5));
+
+        writer.setRegion(upper);
+        Region<2> expectedUpper;
+        expectedUpper << CoordBox<2>(Coord<2>(0, 0), Coord<2>(5, 2));
+        TS_ASSERT_EQUALS(expectedUpper, recorder->region);
+
+        writer.stepFinished(grid, upper, dim, 0, WRITER_INITIALIZED, 0, false);
+        writer.stepFinished(grid, lower, dim, 0, WRITER_INITIALIZED, 0, true);
+
+        TS_ASSERT_EQUALS(Coord<2>(5, 3), recorder->dimensions);
+        TS_ASSERT_EQUALS(expectedUpper, recorder->validRegions[0]);
+        Region<2> expectedLower;
+        expectedLower << CoordBox<2>(Coord<2>(0, 2), Coord<2>(5, 1));
+        TS_ASSERT_EQUALS(expectedLower, recorder->validRegions[1]);
+
+        TS_ASSERT_EQUALS(203, recorder->grid.get(Coord<2>(0, 0)));
+        TS_ASSERT_EQUALS(611, recorder->grid.get(Coord<2>(4, 2)));
+    }
+
+    void testRegionOfInterest()
+    {
+        SubsamplingRecorder *recorder = new SubsamplingRecorder;
+        Region<2> regionOfInterest;
+        regionOfInterest << Streak<2>(Coord<2>(5, 1), 12)
+                         << Streak<2>(Coord<2>(1, 3), 4);
+        SubsamplingWriter<double> writer(recorder, Coord<2>(3, 2), regionOfInterest);
+
+        Region<2> validRegion;
+        validRegion << grid.boundingBox();
+        writer.stepFinished(grid, validRegion, dim, 0, WRITER_INITIALIZED, 0, true);
+
+        // bounding box of the region is (1, 1) to (12, 4):
+        TS_ASSERT_EQUALS(Coord<2>(4, 2), recorder->dimensions);
+        Region<2> expected;
+        expected << Streak<2>(Coord<2>(2, 0), 4)
+                 << Streak<2>(Coord<2>(0, 1), 1);
+        TS_ASSERT_EQUALS(expected, recorder->validRegions[0]);
+        TS_ASSERT_EQUALS(107, recorder->grid.get(Coord<2>(2, 0)));
+        TS_ASSERT_EQUALS(110, recorder->grid.get(Coord<2>(3, 0)));
+        TS_ASSERT_EQUALS(301, recorder->grid.get(Coord<2>(0, 1)));
+    }
+
+    void testClone()
+    {
+        SubsamplingRecorder *recorder = new SubsamplingRecorder;
+        SubsamplingWriter<double> writer(recorder, Coord<2>(2, 2));
+        ParallelWriter<double> *clone = writer.clone();
+
+        Region<2> validRegion;
+        validRegion << grid.boundingBox();
+        clone->stepFinished(grid, validRegion, dim, 0, WRITER_INITIALIZED, 0, true);
+        TS_ASSERT_EQUALS(std::size_t(0), recorder->steps.size());
+        delete clone;
+    }
+
+    void testInvalidArguments()
+    {
+        TS_ASSERT_THROWS(SubsamplingWriter<double>(0), std::invalid_argument&);
+        TS_ASSERT_THROWS(
+            SubsamplingWriter<double>(new SubsamplingRecorder, Coord<2>(0, 1)),
+            std::invalid_argument&);
+    }
+
+private:
+    Coord<2> dim;
+    Grid<double> grid;
+};
+
+}
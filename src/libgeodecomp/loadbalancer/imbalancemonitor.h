@@ -0,0 +1,250 @@
+#ifndef LIBGEODECOMP_LOADBALANCER_IMBALANCEMONITOR_H
+#define LIBGEODECOMP_LOADBALANCER_IMBALANCEMONITOR_H
+
+#include <libgeodecomp/config.h>
+#ifdef LIBGEODECOMP_WITH_MPI
+
+#include <libgeodecomp/loadbalancer/loadbalancer.h>
+#include <libgeodecomp/misc/chronometer.h>
+#include <mpi.h>
+#include <algorithm>
+#include <stdexcept>
+#include <vector>
+
+namespace LibGeoDecomp {
+
+/**
+ * The ImbalanceMonitor keeps track of the load distribution while a
+ * simulation is running. Each call to post() takes the current
+ * statistics of the local simulator, derives the time spent
+ * computing since the previous call and starts a non-blocking
+ * all-gather of these deltas. The exchange is completed by
+ * evaluate(), which should be called some time later (typically at
+ * the next check) so that the reduction overlaps with computation.
+ *
+ * After evaluation all ranks know the imbalance (max compute time
+ * over mean compute time) and which ranks have been slow, i.e. took
+ * longer than threshold times the mean, in at least patience
+ * consecutive checks. A single slow check may be noise, a
+ * consistently slow rank is usually a degraded node or a bad domain
+ * decomposition. rebalancingRecommended() applies the same rule to
+ * the imbalance as a whole.
+ *
+ * All ranks of the communicator need to call post() and evaluate()
+ * in the same order, and the final post() needs to be followed by
+ * an evaluate() before MPI_Finalize().
+ */
+class ImbalanceMonitor
+{
+public:
+    typedef LoadBalancer::LoadVec LoadVec;
+
+    explicit ImbalanceMonitor(
+        double threshold = 1.2,
+        unsigned patience = 3,
+        MPI_Comm communicator = MPI_COMM_WORLD) :
+        threshold(threshold),
+        patience(patience),
+        communicator(communicator),
+        request(MPI_REQUEST_NULL),
+        posted(false),
+        checks(0),
+        imbalanceStrikes(0),
+        currentImbalance(1)
+    {
+        if (threshold < 1) {
+            throw std::invalid_argument("ImbalanceMonitor threshold needs to be at least 1");
+        }
+        if (patience == 0) {
+            throw std::invalid_argument("ImbalanceMonitor patience needs to be at least 1");
+        }
+
+        int size;
+        MPI_Comm_size(communicator, &size);
+        receiveBuffer.resize(2 * size);
+        strikes.resize(size, 0);
+        currentLoads.resize(size, 1.0);
+        computeTimes.resize(size, 0);
+    }
+
+    /**
+     * Owners should complete any outstanding exchange via evaluate()
+     * before MPI gets finalized. Only as a last resort (e.g. during
+     * stack unwinding) we'll wait for it here, as the request refers
+     * to our buffers.
+     */
+    ~ImbalanceMonitor()
+    {
+        if (!pending()) {
+            return;
+        }
+
+        int finalized = 0;
+        MPI_Finalized(&finalized);
+        if (!finalized) {
+            MPI_Wait(&request, MPI_STATUS_IGNORE);
+        }
+    }
+
+    /**
+     * Starts the exchange of the time spent since the previous call.
+     * A Chronometer which has been reset in between is taken as is.
+     */
+    inline void post(const Chronometer& statistics)
+    {
+        if (pending()) {
+            throw std::logic_error("ImbalanceMonitor needs to evaluate() before it can post() again");
+        }
+
+        Chronometer delta = statistics.delta(lastStatistics);
+        lastStatistics = statistics;
+
+        sendBuffer[0] = delta.interval<TimeCompute>();
+        sendBuffer[1] = delta.interval<TimeTotal>();
+
+#if MPI_VERSION >= 3
+        MPI_Iallgather(sendBuffer, 2, MPI_DOUBLE, &receiveBuffer[0], 2, MPI_DOUBLE, communicator, &request);
+#else
+        MPI_Allgather(sendBuffer, 2, MPI_DOUBLE, &receiveBuffer[0], 2, MPI_DOUBLE, communicator);
+#endif
+        posted = true;
+    }
+
+    inline bool pending() const
+    {
+        return posted;
+    }
+
+    /**
+     * Completes the exchange started by post() and updates the
+     * imbalance and the per-rank strike counters. Returns false if
+     * nothing was posted.
+     */
+    inline bool evaluate()
+    {
+        if (!pending()) {
+            return false;
+        }
+        MPI_Wait(&request, MPI_STATUS_IGNORE);
+        posted = false;
+
+        std::size_t size = strikes.size();
+        double sum = 0;
+        double max = 0;
+        for (std::size_t i = 0; i < size; ++i) {
+            computeTimes[i] = receiveBuffer[2 * i + 0];
+            double total = receiveBuffer[2 * i + 1];
+            currentLoads[i] = (total > 0) ? (computeTimes[i] / total) : 1.0;
+
+            sum += computeTimes[i];
+            max = (std::max)(max, computeTimes[i]);
+        }
+
+        double mean = sum / size;
+        currentImbalance = (mean > 0) ? (max / mean) : 1.0;
+        ++checks;
+
+        for (std::size_t i = 0; i < size; ++i) {
+            if ((mean > 0) && (computeTimes[i] > threshold * mean)) {
+                ++strikes[i];
+            } else {
+                strikes[i] = 0;
+            }
+        }
+        if (currentImbalance > threshold) {
+            ++imbalanceStrikes;
+        } else {
+            imbalanceStrikes = 0;
+        }
+
+        return true;
+    }
+
+    /**
+     * Ratio of compute time to total time per rank, as observed in
+     * the last evaluation. Suitable as relativeLoads for a
+     * LoadBalancer.
+     */
+    inline const LoadVec& loads() const
+    {
+        return currentLoads;
+    }
+
+    /**
+     * Time spent computing per rank during the last evaluated period.
+     */
+    inline const std::vector<double>& times() const
+    {
+        return computeTimes;
+    }
+
+    inline double imbalance() const
+    {
+        return currentImbalance;
+    }
+
+    /**
+     * Number of completed evaluations.
+     */
+    inline unsigned evaluations() const
+    {
+        return checks;
+    }
+
+    /**
+     * Ranks which exceeded threshold times the mean compute time in
+     * at least patience consecutive evaluations.
+     */
+    inline std::vector<int> slowRanks() const
+    {
+        std::vector<int> ret;
+        for (std::size_t i = 0; i < strikes.size(); ++i) {
+            if (strikes[i] >= patience) {
+                ret.push_back(int(i));
+            }
+        }
+
+        return ret;
+    }
+
+    inline bool rebalancingRecommended() const
+    {
+        return imbalanceStrikes >= patience;
+    }
+
+    /**
+     * Should be called once the load has been rebalanced, as the
+     * previous observations don't apply to the new decomposition.
+     */
+    inline void resetStrikes()
+    {
+        imbalanceStrikes = 0;
+        std::fill(strikes.begin(), strikes.end(), 0);
+    }
+
+private:
+    double threshold;
+    unsigned patience;
+    MPI_Comm communicator;
+    MPI_Request request;
+    bool posted;
+    unsigned checks;
+    unsigned imbalanceStrikes;
+    double currentImbalance;
+    Chronometer lastStatistics;
+    double sendBuffer[2];
+    std::vector<double> receiveBuffer;
+    std::vector<unsigned> strikes;
+    LoadVec currentLoads;
+    std::vector<double> computeTimes;
+
+    // pending requests refer to the buffers, so copies are not allowed:
+    ImbalanceMonitor(const ImbalanceMonitor&);
+    ImbalanceMonitor& operator=(const ImbalanceMonitor&);
+};
+
+}
+
+#endif
+
+#endif
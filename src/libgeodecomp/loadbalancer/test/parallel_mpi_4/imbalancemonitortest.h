@@ -0,0 +1,116 @@
+#include <libgeodecomp/communication/mpilayer.h>
+#include <libgeodecomp/loadbalancer/imbalancemonitor.h>
+
+#include <cxxtest/TestSuite.h>
+
+using namespace LibGeoDecomp;
+
+namespace LibGeoDecomp {
+
+class ImbalanceMonitorTest : public CxxTest::TestSuite
+{
+public:
+    void setUp()
+    {
+        rank = MPILayer().rank();
+    }
+
+    void testStragglerDetection()
+    {
+        ImbalanceMonitor monitor(1.5, 2);
+        TS_ASSERT(!monitor.evaluate());
+        TS_ASSERT_EQUALS(0u, monitor.evaluations());
+
+        // rank 2 needs three times as long as the others, statistics
+        // are cumulative:
+        Chronometer statistics;
+        for (int i = 1; i <= 2; ++i) {
+            statistics[TimeTotal::ID] = 4 * i;
+            statistics[TimeCompute::ID] = (rank == 2) ? (3 * i) : i;
+
+            monitor.post(statistics);
+            TS_ASSERT(monitor.pending());
+            TS_ASSERT(monitor.evaluate());
+            TS_ASSERT(!monitor.pending());
+
+            TS_ASSERT_EQUALS(unsigned(i), monitor.evaluations());
+            TS_ASSERT_DELTA(2.0, monitor.imbalance(), 1e-12);
+            TS_ASSERT_EQUALS(i == 2, monitor.rebalancingRecommended());
+        }
+
+        std::vector<double> expectedLoads;
+        expectedLoads << 0.25 << 0.25 << 0.75 << 0.25;
+        TS_ASSERT_EQUALS(expectedLoads, monitor.loads());
+
+        std::vector<double> expectedTimes;
+        expectedTimes << 1 << 1 << 3 << 1;
+        TS_ASSERT_EQUALS(expectedTimes, monitor.times());
+
+        std::vector<int> expectedSlowRanks;
+        expectedSlowRanks << 2;
+        TS_ASSERT_EQUALS(expectedSlowRanks, monitor.slowRanks());
+
+        // a single balanced period clears the record:
+        statistics[TimeTotal::ID] += 4;
+        statistics[TimeCompute::ID] += 2;
+        monitor.post(statistics);
+        monitor.evaluate();
+        TS_ASSERT_DELTA(1.0, monitor.imbalance(), 1e-12);
+        TS_ASSERT(monitor.slowRanks().empty());
+        TS_ASSERT(!monitor.rebalancingRecommended());
+    }
+
+    void testResetStrikes()
+    {
+        ImbalanceMonitor monitor(1.2, 1);
+        Chronometer statistics;
+        statistics[TimeTotal::ID] = 1;
+        statistics[TimeCompute::ID] = (rank == 0) ? 1 : 0.5;
+
+        monitor.post(statistics);
+        monitor.evaluate();
+        TS_ASSERT(monitor.rebalancingRecommended());
+        TS_ASSERT_EQUALS(std::vector<int>(1, 0), monitor.slowRanks());
+
+        monitor.resetStrikes();
+        TS_ASSERT(!monitor.rebalancingRecommended());
+        TS_ASSERT(monitor.slowRanks().empty());
+    }
+
+    void testChronometerReset()
+    {
+        ImbalanceMonitor monitor;
+        Chronometer statistics;
+        statistics[TimeTotal::ID] = 10;
+        statistics[TimeCompute::ID] = 8;
+        monitor.post(statistics);
+        monitor.evaluate();
+
+        // after a reset the current values are the best estimate:
+        statistics[TimeTotal::ID] = 2;
+        statistics[TimeCompute::ID] = 1 + rank;
+        monitor.post(statistics);
+        monitor.evaluate();
+
+        std::vector<double> expectedTimes;
+        expectedTimes << 1 << 2 << 3 << 4;
+        TS_ASSERT_EQUALS(expectedTimes, monitor.times());
+        TS_ASSERT_DELTA(4.0 / 2.5, monitor.imbalance(), 1e-12);
+    }
+
+    void testInvalidUsage()
+    {
+        TS_ASSERT_THROWS(ImbalanceMonitor(0.9), std::invalid_argument&);
+        TS_ASSERT_THROWS(ImbalanceMonitor(1.2, 0), std::invalid_argument&);
+
+        ImbalanceMonitor monitor;
+        monitor.post(Chronometer());
+        TS_ASSERT_THROWS(monitor.post(Chronometer()), std::logic_error&);
+        monitor.evaluate();
+    }
+
+private:
+    int rank;
+};
+
+}
@@ -0,0 +1,8 @@
+#include <libgeodecomp/misc/allocationcounter.h>
+
+namespace LibGeoDecomp {
+
+std::atomic<std::size_t> AllocationCounter::allocationsCounter(0);
+std::atomic<std::size_t> AllocationCounter::bytesCounter(0);
+
+}
@@ -0,0 +1,108 @@
+#ifndef LIBGEODECOMP_MISC_ALLOCATIONCOUNTER_H
+#define LIBGEODECOMP_MISC_ALLOCATIONCOUNTER_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+
+namespace LibGeoDecomp {
+
+/**
+ * Process-wide tally of heap allocations. The Chronometer samples it
+ * to attribute allocations to the events it measures, which is how
+ * we verify that time steps in steady state don't allocate memory.
+ *
+ * Only programs which opt in via
+ * LIBGEODECOMP_COUNT_HEAP_ALLOCATIONS() (e.g. tests and benchmarks)
+ * count all calls of operator new, including those of std::vector,
+ * Region and MPI request lists. Otherwise the tally only includes
+ * the memory which HugePageAllocator maps directly, so don't read a
+ * zero count as proof unless the hook is installed.
+ */
+class AllocationCounter
+{
+public:
+    static inline void count(std::size_t bytes)
+    {
+        allocationsCounter.fetch_add(1, std::memory_order_relaxed);
+        bytesCounter.fetch_add(bytes, std::memory_order_relaxed);
+    }
+
+    static inline std::size_t allocations()
+    {
+        return allocationsCounter.load(std::memory_order_relaxed);
+    }
+
+    static inline std::size_t bytes()
+    {
+        return bytesCounter.load(std::memory_order_relaxed);
+    }
+
+    static inline void *allocate(std::size_t bytes)
+    {
+        count(bytes);
+        return std::malloc(bytes ? bytes : 1);
+    }
+
+private:
+    // defined in allocationcounter.cpp so that all modules (including
+    // the ISA variants built by lgd_add_isa_variants()) share one tally:
+    static std::atomic<std::size_t> allocationsCounter;
+    static std::atomic<std::size_t> bytesCounter;
+};
+
+}
+
+/**
+ * Replaces the global operator new/delete with versions which report
+ * each allocation to the AllocationCounter. Needs to be expanded
+ * exactly once per executable, at namespace scope (test executables
+ * do so in countheapallocations.cpp).
+ */
+#define LIBGEODECOMP_COUNT_HEAP_ALLOCATIONS()                           \
+    void *operator new(std::size_t bytes)                               \
+    {                                                                   \
+        void *ret = LibGeoDecomp::AllocationCounter::allocate(bytes);   \
+        if (ret == 0) {                                                 \
+            throw std::bad_alloc();                                     \
+        }                                                               \
+        return ret;                                                     \
+    }                                                                   \
+                                                                        \
+    void *operator new[](std::size_t bytes)                             \
+    {                                                                   \
+        return operator new(bytes);                                     \
+    }                                                                   \
+                                                                        \
+    void *operator new(std::size_t bytes, const std::nothrow_t&) throw() \
+    {                                                                   \
+        return LibGeoDecomp::AllocationCounter::allocate(bytes);        \
+    }                                                                   \
+                                                                        \
+    void *operator new[](std::size_t bytes, const std::nothrow_t&) throw() \
+    {                                                                   \
+        return LibGeoDecomp::AllocationCounter::allocate(bytes);        \
+    }                                                                   \
+                                                                        \
+    void operator delete(void *p) throw()                               \
+    {                                                                   \
+        std::free(p);                                                   \
+    }                                                                   \
+                                                                        \
+    void operator delete[](void *p) throw()                             \
+    {                                                                   \
+        std::free(p);                                                   \
+    }                                                                   \
+                                                                        \
+    void operator delete(void *p, const std::nothrow_t&) throw()        \
+    {                                                                   \
+        std::free(p);                                                   \
+    }                                                                   \
+                                                                        \
+    void operator delete[](void *p, const std::nothrow_t&) throw()      \
+    {                                                                   \
+        std::free(p);                                                   \
+    }
+
+#endif
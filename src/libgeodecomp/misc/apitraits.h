@@ -19,6 +19,7 @@
 namespace LibGeoDecomp {
 
 #ifdef LIBGEODECOMP_WITH_MPI
+class MPIDataTypeRegistry;
 class Typemaps;
 #endif
 
@@ -489,6 +490,69 @@ public:
 
     // XXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXX
 
+    template<typename CELL, typename HAS_SELL_LOCALITY_REORDERING = void>
+    class SelectSellLocalityReordering
+    {
+    public:
+        typedef FalseType Value;
+    };
+
+    template<typename CELL>
+    class SelectSellLocalityReordering<CELL, typename CELL::API::SupportsSellLocalityReordering>
+    {
+    public:
+        typedef TrueType Value;
+    };
+
+    /**
+     * For unstructured grids: renumber the nodes via Reverse
+     * Cuthill-McKee before they're sorted into SELL-C-q chunks. This
+     * reduces the bandwidth of the weights matrix so that neighbors
+     * end up close to each other in memory, which speeds up the
+     * gathers in updateLineX() for meshes whose IDs don't reflect
+     * their spatial layout. IDs seen by initializers, writers and
+     * steerers are not affected.
+     */
+    class HasSellLocalityReordering
+    {
+    public:
+        typedef void SupportsSellLocalityReordering;
+    };
+
+    // XXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXX
+
+    template<typename CELL, typename HAS_SELL_WEIGHT_STORAGE = void>
+    class SelectSellWeightStorage
+    {
+    public:
+        typedef void Value;
+    };
+
+    template<typename CELL>
+    class SelectSellWeightStorage<CELL, typename CELL::API::SupportsSellWeightStorage>
+    {
+    public:
+        typedef typename CELL::API::SellWeightStorage Value;
+    };
+
+    /**
+     * For UnstructuredSoAGrid: store the weights in reduced precision
+     * (float or BFloat16) instead of the SellType. The
+     * UnstructuredSoANeighborhood widens them back to the SellType on
+     * the fly, so kernels still accumulate in full precision, but need
+     * to stream fewer bytes per non-zero entry.
+     */
+    template<typename WEIGHT_STORAGE>
+    class HasSellWeightStorage
+    {
+    public:
+        typedef void SupportsSellWeightStorage;
+
+        typedef WEIGHT_STORAGE SellWeightStorage;
+    };
+
+    // XXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXX
+
     /**
      * determine whether a cell has an architecture-specific speed indicator defined
      */
@@ -628,6 +692,23 @@ public:
         typedef BASE_TYPE MPIDataTypeBase;
     };
 
+    /**
+     * Use this specifier if the cell's members have been registered
+     * via LIBGEODECOMP_REGISTER_MPI_DATATYPE (see
+     * communication/mpidatatypebuilder.h). The MPI data type is then
+     * derived from the member list at runtime, the typemap generator
+     * isn't required.
+     */
+    class HasRegisteredMPIDataType
+    {
+    public:
+        typedef void SupportsMPIDataType;
+        typedef void SupportsAutoGeneratedMPIDataType;
+#ifdef LIBGEODECOMP_WITH_MPI
+        typedef MPIDataTypeRegistry MPIDataTypeProvider;
+#endif
+    };
+
     /**
      * Use this specifyer if your cell is bitwise serializable
      */
@@ -654,6 +735,46 @@ public:
 
     // XXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXX
 
+    /**
+     * Check whether a cell restricts ghost zone exchange to a subset
+     * of its members.
+     */
+    template<typename CELL, typename HAS_GHOST_MEMBERS = void>
+    class SelectGhostMembers
+    {
+    public:
+        typedef FalseType Value;
+    };
+
+    template<typename CELL>
+    class SelectGhostMembers<CELL, typename CELL::API::SupportsGhostMembers>
+    {
+    public:
+        typedef TrueType Value;
+    };
+
+    /**
+     * Use this specifier if neighbors read only some members of a
+     * cell (e.g. an LBM needs the distribution functions, but not
+     * the diagnostics). Ghost zones exchanged via PatchLink will then
+     * only transfer these members. The cell needs to provide a
+     * static function
+     *
+     *   static std::vector<Selector<CELL> > ghostMembers();
+     *
+     * All other members of ghost cells will retain their initial
+     * values. With ghost zones wider than 1 ghost cells are also
+     * updated locally, so the list needs to include all members which
+     * the update of the listed members depends on, too.
+     */
+    class HasGhostMembers
+    {
+    public:
+        typedef void SupportsGhostMembers;
+    };
+
+    // XXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXX
+
     /**
      * Decide whether a model can be (de-)serialized with Boost.Serialization.
      */
@@ -1138,6 +1259,24 @@ public:
 
     // XXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXX
 
+    /**
+     * Entities stored in a ContainerCell may move to a neighboring
+     * container by returning the relative offset of the target
+     * container (each component being -1, 0, or 1) from
+     * migrationTarget() after their update. A zero offset means the
+     * entity stays where it is. Migrations are collected during
+     * update() and applied in bulk during the next time step.
+     * Migrating out of the simulation domain is an error, entities
+     * leaving the domain need to be removed explicitly.
+     */
+    class HasMigration
+    {
+    public:
+        typedef void SupportsMigration;
+    };
+
+    // XXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXX
+
     template<typename CELL, typename HAS_TEMPLATE_NAME = void>
     class SelectMessageType
     {
@@ -1169,6 +1308,37 @@ public:
 
     // XXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXX
 
+    template<typename CELL, typename DEFAULT_ALLOCATOR, typename HAS_ALLOCATOR = void>
+    class SelectAllocator
+    {
+    public:
+        typedef DEFAULT_ALLOCATOR Value;
+    };
+
+    template<typename CELL, typename DEFAULT_ALLOCATOR>
+    class SelectAllocator<CELL, DEFAULT_ALLOCATOR, typename CELL::API::SupportsCustomAllocator>
+    {
+    public:
+        typedef typename DEFAULT_ALLOCATOR::value_type ValueType;
+        typedef typename CELL::API::Allocator::template rebind<ValueType>::other Value;
+    };
+
+    /**
+     * Grids (Grid, SoAGrid, UnstructuredSoAGrid) will allocate their
+     * cell storage via ALLOCATOR (rebound to the element type they
+     * need) instead of their default aligned allocator. Use this with
+     * HugePageAllocator to back large grids with huge pages.
+     */
+    template<typename ALLOCATOR>
+    class HasAllocator
+    {
+    public:
+        typedef void SupportsCustomAllocator;
+        typedef ALLOCATOR Allocator;
+    };
+
+    // XXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXX
+
     // Trait Template:
 
     // template<typename CELL, typename HAS_TEMPLATE_NAME = void>
@@ -0,0 +1,84 @@
+#ifndef LIBGEODECOMP_MISC_BFLOAT16_H
+#define LIBGEODECOMP_MISC_BFLOAT16_H
+
+#include <cstring>
+#include <stdint.h>
+
+namespace LibGeoDecomp {
+
+/**
+ * Storage-only 16-bit floating point type: the upper half of an IEEE
+ * single precision float, i.e. same range as float, but only 8 bits
+ * of mantissa. Useful to halve the memory traffic of read-only data
+ * such as the weights of unstructured grids (see
+ * APITraits::HasSellWeightStorage). There is no arithmetic defined
+ * on it, values need to be converted to float/double first.
+ */
+class BFloat16
+{
+public:
+    inline
+    BFloat16() :
+        bits(0)
+    {}
+
+    /**
+     * Rounds to nearest, ties to even. NaNs stay NaNs.
+     */
+    inline
+    explicit BFloat16(float value)
+    {
+        uint32_t raw;
+        std::memcpy(&raw, &value, sizeof(raw));
+
+        if ((raw & 0x7fffffff) > 0x7f800000) {
+            // keep NaNs quiet, truncation alone might turn them into infinity:
+            bits = static_cast<uint16_t>((raw >> 16) | 0x0040);
+            return;
+        }
+
+        raw += 0x7fff + ((raw >> 16) & 1);
+        bits = static_cast<uint16_t>(raw >> 16);
+    }
+
+    inline
+    operator float() const
+    {
+        return toFloat(bits);
+    }
+
+    inline
+    uint16_t raw() const
+    {
+        return bits;
+    }
+
+    /**
+     * Conversion of the raw representation, branch-free so that
+     * loops over arrays of BFloat16 can be vectorized.
+     */
+    static inline float toFloat(uint16_t bits)
+    {
+        uint32_t raw = static_cast<uint32_t>(bits) << 16;
+        float ret;
+        std::memcpy(&ret, &raw, sizeof(ret));
+        return ret;
+    }
+
+    inline bool operator==(const BFloat16& other) const
+    {
+        return bits == other.bits;
+    }
+
+    inline bool operator!=(const BFloat16& other) const
+    {
+        return bits != other.bits;
+    }
+
+private:
+    uint16_t bits;
+};
+
+}
+
+#endif
@@ -1,6 +1,7 @@
 #ifndef LIBGEODECOMP_MISC_CHRONOMETER_H
 #define LIBGEODECOMP_MISC_CHRONOMETER_H
 
+#include <libgeodecomp/misc/allocationcounter.h>
 #include <libgeodecomp/misc/scopedtimer.h>
 #include <libgeodecomp/storage/fixedarray.h>
 
@@ -25,7 +26,8 @@ class EventUtil;
 
 /**
  * This class is being subclassed from by generated event classes (see
- * below).
+ * below). Besides the time it also records the number of allocations
+ * (see AllocationCounter) which happened while the event was active.
  */
 class BasicTimerImplementation
 {
@@ -34,24 +36,35 @@ public:
     inline explicit
     BasicTimerImplementation(CHRONOMETER *chrono) :
         totalTimes(chrono->rawTotalTimes()),
-        t(ScopedTimer::time())
+        totalAllocations(chrono->rawTotalAllocations()),
+        t(ScopedTimer::time()),
+        allocations(AllocationCounter::allocations())
     {}
 
     template<typename CHRONOMETER>
     inline
     BasicTimerImplementation(CHRONOMETER *chrono, double t) :
         totalTimes(chrono->rawTotalTimes()),
-        t(t)
+        totalAllocations(chrono->rawTotalAllocations()),
+        t(t),
+        allocations(0)
     {}
 
 protected:
     double *totalTimes;
+    double *totalAllocations;
     double t;
+    std::size_t allocations;
 
     double elapsed() const
     {
         return ScopedTimer::time() - t;
     }
+
+    std::size_t allocationsSinceStart() const
+    {
+        return AllocationCounter::allocations() - allocations;
+    }
 };
 
 #ifdef _MSC_BUILD
@@ -117,6 +130,7 @@ public:
         ~CLASS_NAME ## Implementation()                             \
         {                                                           \
             totalTimes[ID] += t;                                    \
+            totalAllocations[ID] += allocations;                    \
         }                                                           \
     };                                                              \
                                                                     \
@@ -135,6 +149,7 @@ public:
         ~CLASS_NAME()                                               \
         {                                                           \
             t = elapsed();                                          \
+            allocations = allocationsSinceStart();                  \
         }                                                           \
     };
 }
@@ -213,6 +228,13 @@ public:
  * This class can be used to measure execution time of different parts
  * of our code. This is useful to determine the relative load of a
  * node or to find out which part of the algorithm the most time.
+ *
+ * For each event it also counts the heap allocations (see
+ * AllocationCounter, which only sees all of them in programs which
+ * install LIBGEODECOMP_COUNT_HEAP_ALLOCATIONS()). Time steps in
+ * steady state should not allocate at all. The counts are stored as
+ * doubles so that they can be aggregated and averaged just like the
+ * times.
  */
 class Chronometer
 {
@@ -226,7 +248,8 @@ public:
     static const std::size_t NUM_INTERVALS = ChronometerHelpers::EventUtil<100>::NUM_EVENTS;
 
     Chronometer() :
-        totalTimes(NUM_INTERVALS, 0)
+        totalTimes(NUM_INTERVALS, 0),
+        totalAllocations(NUM_INTERVALS, 0)
     {
         reset();
     }
@@ -249,6 +272,7 @@ public:
     {
         for (std::size_t i = 0; i < NUM_INTERVALS; ++i) {
             totalTimes[i] += other.totalTimes[i];
+            totalAllocations[i] += other.totalAllocations[i];
         }
 
         return *this;
@@ -262,11 +286,36 @@ public:
     }
 
     /**
-     * Flushes all time totals to 0.
+     * Returns the time and allocations accumulated since previous was
+     * taken from this Chronometer. Some simulators reset their
+     * Chronometer (e.g. after load balancing); if any total is below
+     * its previous value, the current totals are the best estimate
+     * we can get and are returned unchanged.
+     */
+    Chronometer delta(const Chronometer& previous) const
+    {
+        for (std::size_t i = 0; i < NUM_INTERVALS; ++i) {
+            if (totalTimes[i] < previous.totalTimes[i]) {
+                return *this;
+            }
+        }
+
+        Chronometer ret(*this);
+        for (std::size_t i = 0; i < NUM_INTERVALS; ++i) {
+            ret.totalTimes[i] -= previous.totalTimes[i];
+            ret.totalAllocations[i] -= previous.totalAllocations[i];
+        }
+
+        return ret;
+    }
+
+    /**
+     * Flushes all time and allocation totals to 0.
      */
     void reset()
     {
         std::fill(totalTimes.begin(), totalTimes.end(), 0);
+        std::fill(totalAllocations.begin(), totalAllocations.end(), 0);
     }
 
     void cycle()
@@ -285,6 +334,21 @@ public:
         return totalTimes[INTERVAL::ID];
     }
 
+    double allocations(std::size_t i) const
+    {
+        return totalAllocations[i];
+    }
+
+    /**
+     * Number of allocations which happened while an event of type
+     * INTERVAL (or one of its children) was being measured.
+     */
+    template<typename INTERVAL>
+    double allocations() const
+    {
+        return totalAllocations[INTERVAL::ID];
+    }
+
     /**
      * Returns the ratio of the accumulated times of INTERVAL1 and
      * INTERVAL2.
@@ -310,6 +374,11 @@ public:
         return totalTimes.begin();
     }
 
+    double *rawTotalAllocations()
+    {
+        return totalAllocations.begin();
+    }
+
     template<typename EVENT>
     void addTime(double elapsedTime)
     {
@@ -328,7 +397,8 @@ public:
 
         for (std::size_t i = 0; i < NUM_INTERVALS; ++i) {
             buf << std::left << std::setw(20) << ChronometerHelpers::EventToString()(i)
-                << ": " << totalTimes[i] << "s\n";
+                << ": " << totalTimes[i] << "s, "
+                << totalAllocations[i] << " allocations\n";
         }
 
         return buf.str();
@@ -336,6 +406,7 @@ public:
 
 private:
     FixedArray<double, Chronometer::NUM_INTERVALS> totalTimes;
+    FixedArray<double, Chronometer::NUM_INTERVALS> totalAllocations;
 };
 
 }
@@ -0,0 +1,90 @@
+#include <libgeodecomp/misc/cpufeatures.h>
+
+#include <cstdlib>
+#include <stdexcept>
+
+namespace LibGeoDecomp {
+
+namespace {
+
+const char *ISA_NAMES[CPUFeatures::NUM_ISAS] = {
+    "SCALAR",
+    "SSE2",
+    "SSE4_1",
+    "AVX",
+    "AVX2",
+    "AVX512F"
+};
+
+}
+
+bool CPUFeatures::supports(ISA isa)
+{
+    if (isa == SCALAR) {
+        return true;
+    }
+
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+    // __builtin_cpu_supports() also checks via XGETBV whether the OS
+    // has enabled the AVX and AVX-512 register state:
+    __builtin_cpu_init();
+
+    switch (isa) {
+    case SSE2:
+        return __builtin_cpu_supports("sse2");
+    case SSE4_1:
+        return __builtin_cpu_supports("sse4.1");
+    case AVX:
+        return __builtin_cpu_supports("avx");
+    case AVX2:
+        return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+    case AVX512F:
+        return __builtin_cpu_supports("avx512f");
+    default:
+        return false;
+    }
+#else
+    // without a way to query the CPU we can only trust the compiler
+    // flags used to build the library:
+    return isa <= LIBGEODECOMP_COMPILED_ISA;
+#endif
+}
+
+CPUFeatures::ISA CPUFeatures::widest()
+{
+    int limit = AVX512F;
+    const char *maxISA = std::getenv("LIBGEODECOMP_MAX_ISA");
+    if (maxISA && *maxISA) {
+        limit = parse(maxISA);
+    }
+
+    for (int i = limit; i > SCALAR; --i) {
+        if (supports(ISA(i))) {
+            return ISA(i);
+        }
+    }
+
+    return SCALAR;
+}
+
+std::string CPUFeatures::name(ISA isa)
+{
+    if ((isa < SCALAR) || (isa >= NUM_ISAS)) {
+        throw std::invalid_argument("unknown ISA");
+    }
+
+    return ISA_NAMES[isa];
+}
+
+CPUFeatures::ISA CPUFeatures::parse(const std::string& name)
+{
+    for (int i = 0; i < NUM_ISAS; ++i) {
+        if (name == ISA_NAMES[i]) {
+            return ISA(i);
+        }
+    }
+
+    throw std::invalid_argument("unknown ISA \"" + name + "\"");
+}
+
+}
@@ -0,0 +1,73 @@
+#ifndef LIBGEODECOMP_MISC_CPUFEATURES_H
+#define LIBGEODECOMP_MISC_CPUFEATURES_H
+
+#include <string>
+
+/**
+ * The widest instruction set the current translation unit is being
+ * compiled for. This is deliberately a macro and not an inline
+ * function: translation units built with different -march flags
+ * would otherwise violate the one definition rule.
+ */
+#if defined(__AVX512F__)
+#  define LIBGEODECOMP_COMPILED_ISA LibGeoDecomp::CPUFeatures::AVX512F
+#elif defined(__AVX2__)
+#  define LIBGEODECOMP_COMPILED_ISA LibGeoDecomp::CPUFeatures::AVX2
+#elif defined(__AVX__)
+#  define LIBGEODECOMP_COMPILED_ISA LibGeoDecomp::CPUFeatures::AVX
+#elif defined(__SSE4_1__)
+#  define LIBGEODECOMP_COMPILED_ISA LibGeoDecomp::CPUFeatures::SSE4_1
+#elif defined(__SSE2__) || defined(_M_X64)
+#  define LIBGEODECOMP_COMPILED_ISA LibGeoDecomp::CPUFeatures::SSE2
+#else
+#  define LIBGEODECOMP_COMPILED_ISA LibGeoDecomp::CPUFeatures::SCALAR
+#endif
+
+namespace LibGeoDecomp {
+
+/**
+ * Detects at runtime which SIMD instruction sets the CPU (and the
+ * OS, which has to save the wider registers on context switches)
+ * supports. Together with the ISADispatcher this allows a single
+ * binary to carry kernels for multiple instruction sets and to run
+ * the best one on every node of a heterogeneous cluster.
+ *
+ * The environment variable LIBGEODECOMP_MAX_ISA (e.g. "AVX2") caps
+ * the result of widest(), which is handy to compare variants on one
+ * machine or to work around frequency throttling of AVX-512 units.
+ */
+class CPUFeatures
+{
+public:
+    /**
+     * Ordered by width, each ISA implies all previous ones.
+     */
+    enum ISA {
+        SCALAR = 0,
+        SSE2,
+        SSE4_1,
+        AVX,
+        AVX2,
+        AVX512F
+    };
+
+    static const int NUM_ISAS = AVX512F + 1;
+
+    static bool supports(ISA isa);
+
+    /**
+     * Returns the widest supported ISA, subject to LIBGEODECOMP_MAX_ISA.
+     */
+    static ISA widest();
+
+    static std::string name(ISA isa);
+
+    /**
+     * Inverse of name(), throws std::invalid_argument for unknown names.
+     */
+    static ISA parse(const std::string& name);
+};
+
+}
+
+#endif
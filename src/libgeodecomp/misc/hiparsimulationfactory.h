@@ -0,0 +1,150 @@
+#ifndef LIBGEODECOMP_MISC_HIPARSIMULATIONFACTORY_H
+#define LIBGEODECOMP_MISC_HIPARSIMULATIONFACTORY_H
+
+#include <libgeodecomp/config.h>
+#ifdef LIBGEODECOMP_WITH_MPI
+
+#include <libgeodecomp/geometry/partitions/hilbertcurvepartition.h>
+#include <libgeodecomp/geometry/partitions/recursivebisectionpartition.h>
+#include <libgeodecomp/geometry/partitions/stripingpartition.h>
+#include <libgeodecomp/geometry/partitions/zcurvepartition.h>
+#include <libgeodecomp/misc/simulationfactory.h>
+#include <libgeodecomp/misc/stdcontaineroverloads.h>
+#include <libgeodecomp/parallelization/hiparsimulator.h>
+#include <libgeodecomp/parallelization/nesting/vanillastepper.h>
+#include <mpi.h>
+
+namespace LibGeoDecomp {
+
+/**
+ * Customized factory for instantiating a HiParSimulator. Tunable
+ * parameters are the ghost zone width, the domain decomposition
+ * ("Partition") and whether the Stepper should update its region
+ * via OpenMP or serially ("Stepper").
+ *
+ * All ranks of the communicator need to evaluate the same sequence
+ * of parameters (as the simulator's construction is a collective
+ * operation). Hence the fitness is reduced to the minimum over all
+ * ranks, which ensures that the optimizers on all ranks take the
+ * same decisions.
+ */
+template<typename CELL>
+class HiParSimulationFactory : public SimulationFactory<CELL>
+{
+public:
+    using SimulationFactory<CELL>::addSteerers;
+    using SimulationFactory<CELL>::addWriters;
+    using SimulationFactory<CELL>::operator();
+    typedef typename SimulationFactory<CELL>::InitPtr InitPtr;
+    typedef typename APITraits::SelectTopology<CELL>::Value Topology;
+    static const int DIM = Topology::DIM;
+
+    explicit
+    HiParSimulationFactory<CELL>(
+        InitPtr initializer,
+        unsigned maxGhostZoneWidth = 8,
+        MPI_Comm communicator = MPI_COMM_WORLD):
+        SimulationFactory<CELL>(initializer),
+        communicator(communicator)
+    {
+        std::vector<std::string> partitions;
+        partitions << "Striping" << "RecursiveBisection" << "ZCurve" << "HilbertCurve";
+        std::vector<std::string> steppers;
+        steppers << "OpenMP" << "Serial";
+        std::vector<bool> fineGrainedParallelism;
+        fineGrainedParallelism << false << true;
+
+        SimulationFactory<CELL>::parameterSet.addParameter("GhostZoneWidth", 1, int(maxGhostZoneWidth) + 1);
+        SimulationFactory<CELL>::parameterSet.addParameter("Partition", partitions);
+        SimulationFactory<CELL>::parameterSet.addParameter("Stepper", steppers);
+        SimulationFactory<CELL>::parameterSet.addParameter("FineGrainedParallelism", fineGrainedParallelism);
+    }
+
+    std::string name() const
+    {
+        return "HiParSimulator";
+    }
+
+    virtual double operator()(const SimulationParameters& params)
+    {
+        double localFitness = SimulationFactory<CELL>::operator()(params);
+        double globalFitness;
+        MPI_Allreduce(&localFitness, &globalFitness, 1, MPI_DOUBLE, MPI_MIN, communicator);
+
+        return globalFitness;
+    }
+
+protected:
+    MPI_Comm communicator;
+
+    virtual Simulator<CELL> *buildSimulator(
+        typename SharedPtr<ClonableInitializer<CELL> >::Type initializer,
+        const SimulationParameters& params) const
+    {
+        std::string partition = params["Partition"];
+
+        if (partition == "Striping") {
+            return buildSimulatorWithPartition<StripingPartition<DIM> >(initializer, params);
+        }
+        if (partition == "RecursiveBisection") {
+            return buildSimulatorWithPartition<RecursiveBisectionPartition<DIM> >(initializer, params);
+        }
+        if (partition == "ZCurve") {
+            return buildSimulatorWithPartition<ZCurvePartition<DIM> >(initializer, params);
+        }
+        if (partition == "HilbertCurve") {
+            return buildSimulatorWithPartition<HilbertCurvePartition<DIM> >(initializer, params);
+        }
+
+        throw std::invalid_argument("HiParSimulationFactory: unknown partition " + partition);
+    }
+
+private:
+    template<typename PARTITION>
+    Simulator<CELL> *buildSimulatorWithPartition(
+        typename SharedPtr<ClonableInitializer<CELL> >::Type initializer,
+        const SimulationParameters& params) const
+    {
+        std::string stepper = params["Stepper"];
+
+        if (stepper == "OpenMP") {
+            return buildSimulatorWithStepper<PARTITION, VanillaStepper<CELL, UpdateFunctorHelpers::ConcurrencyEnableOpenMP> >(
+                initializer, params);
+        }
+        if (stepper == "Serial") {
+            return buildSimulatorWithStepper<PARTITION, VanillaStepper<CELL, UpdateFunctorHelpers::ConcurrencyNoP> >(
+                initializer, params);
+        }
+
+        throw std::invalid_argument("HiParSimulationFactory: unknown stepper " + stepper);
+    }
+
+    template<typename PARTITION, typename STEPPER>
+    Simulator<CELL> *buildSimulatorWithStepper(
+        typename SharedPtr<ClonableInitializer<CELL> >::Type initializer,
+        const SimulationParameters& params) const
+    {
+        int ghostZoneWidth = params["GhostZoneWidth"];
+        bool enableFineGrainedParallelism = params["FineGrainedParallelism"];
+
+        HiParSimulator<CELL, PARTITION, STEPPER> *sim =
+            new HiParSimulator<CELL, PARTITION, STEPPER>(
+                initializer->clone(),
+                0,
+                1,
+                ghostZoneWidth,
+                enableFineGrainedParallelism,
+                communicator);
+
+        addWriters(sim);
+        addSteerers(sim);
+
+        return sim;
+    }
+};
+
+}
+
+#endif
+
+#endif
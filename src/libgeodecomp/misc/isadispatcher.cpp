@@ -0,0 +1,58 @@
+#include <libgeodecomp/misc/isadispatcher.h>
+
+#include <stdexcept>
+
+namespace LibGeoDecomp {
+
+void ISADispatcher::add(const std::string& name, CPUFeatures::ISA isa, GenericFunction function)
+{
+    registry()[name][isa] = function;
+}
+
+std::vector<CPUFeatures::ISA> ISADispatcher::variants(const std::string& name)
+{
+    std::vector<CPUFeatures::ISA> ret;
+    Registry::iterator entry = registry().find(name);
+    if (entry == registry().end()) {
+        return ret;
+    }
+
+    for (std::map<CPUFeatures::ISA, GenericFunction>::iterator i = entry->second.begin();
+         i != entry->second.end();
+         ++i) {
+        ret.push_back(i->first);
+    }
+
+    return ret;
+}
+
+CPUFeatures::ISA ISADispatcher::select(const std::string& name)
+{
+    std::vector<CPUFeatures::ISA> available = variants(name);
+    CPUFeatures::ISA widest = CPUFeatures::widest();
+
+    for (std::vector<CPUFeatures::ISA>::reverse_iterator i = available.rbegin();
+         i != available.rend();
+         ++i) {
+        if (*i <= widest) {
+            return *i;
+        }
+    }
+
+    throw std::logic_error(
+        "no variant of kernel \"" + name + "\" can run on this CPU (widest ISA: " +
+        CPUFeatures::name(widest) + ")");
+}
+
+ISADispatcher::GenericFunction ISADispatcher::lookup(const std::string& name, CPUFeatures::ISA isa)
+{
+    return registry()[name][isa];
+}
+
+ISADispatcher::Registry& ISADispatcher::registry()
+{
+    static Registry registry;
+    return registry;
+}
+
+}
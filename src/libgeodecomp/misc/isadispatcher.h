@@ -0,0 +1,95 @@
+#ifndef LIBGEODECOMP_MISC_ISADISPATCHER_H
+#define LIBGEODECOMP_MISC_ISADISPATCHER_H
+
+#include <libgeodecomp/misc/cpufeatures.h>
+
+#include <map>
+#include <string>
+#include <vector>
+
+namespace LibGeoDecomp {
+
+/**
+ * Registry for kernels which have been compiled multiple times, once
+ * per instruction set. get() returns the variant for the widest ISA
+ * which the current CPU supports (see CPUFeatures::widest()).
+ *
+ * A kernel is usually a factory function which sets up the complete
+ * simulation (i.e. Simulator, Grid and the model's updateLineX()),
+ * as all of these get instantiated with the vector types selected
+ * by LibFlatArray at compile time. Its source file registers it via
+ * LIBGEODECOMP_REGISTER_ISA_VARIANT and gets added to the build with
+ * CMake's lgd_add_isa_variants(), which compiles it once per ISA and
+ * keeps the inline functions and template instances of the variants
+ * apart. Callers then do:
+ *
+ *   typedef Simulator<Cell> *Factory(Initializer<Cell>*);
+ *   Factory *factory = ISADispatcher::get<Factory>("spmvm");
+ *   Simulator<Cell> *sim = factory(init);
+ *
+ * Names are free form, but all variants registered under one name
+ * need to share the same signature.
+ *
+ * Only code instantiated within such a factory gets dispatched. The
+ * library itself (e.g. the update loops of SoAGrid and
+ * UnstructuredSoAGrid) is compiled once with the default flags; a
+ * model benefits only if it builds its simulator in a dispatched
+ * translation unit, as the spmvmvectorized example does.
+ */
+class ISADispatcher
+{
+public:
+    typedef void (*GenericFunction)();
+
+    static void add(const std::string& name, CPUFeatures::ISA isa, GenericFunction function);
+
+    /**
+     * Lists the ISAs for which variants of the named kernel are
+     * available, from narrowest to widest.
+     */
+    static std::vector<CPUFeatures::ISA> variants(const std::string& name);
+
+    /**
+     * Picks the widest variant of the named kernel which can run on
+     * this CPU. Throws std::logic_error if there is none.
+     */
+    static CPUFeatures::ISA select(const std::string& name);
+
+    template<typename FUNCTION>
+    static FUNCTION *get(const std::string& name)
+    {
+        return reinterpret_cast<FUNCTION*>(lookup(name, select(name)));
+    }
+
+private:
+    typedef std::map<std::string, std::map<CPUFeatures::ISA, GenericFunction> > Registry;
+
+    static GenericFunction lookup(const std::string& name, CPUFeatures::ISA isa);
+
+    // function-local static so that registration from static
+    // initializers doesn't depend on the initialization order:
+    static Registry& registry();
+};
+
+}
+
+/**
+ * Registers FUNCTION (an unqualified name) as the variant of the
+ * kernel NAME for the ISA this translation unit is compiled for.
+ */
+#define LIBGEODECOMP_REGISTER_ISA_VARIANT(NAME, FUNCTION)               \
+    namespace {                                                         \
+    class ISAVariantRegistrar_##FUNCTION                                \
+    {                                                                   \
+    public:                                                             \
+        ISAVariantRegistrar_##FUNCTION()                                \
+        {                                                               \
+            LibGeoDecomp::ISADispatcher::add(                           \
+                NAME,                                                   \
+                LIBGEODECOMP_COMPILED_ISA,                              \
+                reinterpret_cast<LibGeoDecomp::ISADispatcher::GenericFunction>(&FUNCTION)); \
+        }                                                               \
+    } isaVariantRegistrar_##FUNCTION;                                   \
+    }
+
+#endif
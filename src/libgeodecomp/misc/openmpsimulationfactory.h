@@ -0,0 +1,64 @@
+#ifndef LIBGEODECOMP_MISC_OPENMPSIMULATIONFACTORY_H
+#define LIBGEODECOMP_MISC_OPENMPSIMULATIONFACTORY_H
+
+#include <libgeodecomp/misc/simulationfactory.h>
+#include <libgeodecomp/misc/stdcontaineroverloads.h>
+#include <libgeodecomp/parallelization/openmpsimulator.h>
+
+#ifdef LIBGEODECOMP_WITH_THREADS
+
+namespace LibGeoDecomp {
+
+/**
+ * Customized factory for instantiating an OpenMPSimulator. The
+ * parameter "Scheduling" selects how the grid is distributed among
+ * threads: "static" or "dynamic" distribution of rows, or
+ * "fine-grained" distribution of chunks of rows.
+ */
+template<typename CELL>
+class OpenMPSimulationFactory : public SimulationFactory<CELL>
+{
+public:
+    using SimulationFactory<CELL>::addSteerers;
+    using SimulationFactory<CELL>::addWriters;
+    typedef typename SimulationFactory<CELL>::InitPtr InitPtr;
+
+    explicit
+    OpenMPSimulationFactory<CELL>(InitPtr initializer):
+        SimulationFactory<CELL>(initializer)
+    {
+        std::vector<std::string> scheduling;
+        scheduling << "dynamic" << "static" << "fine-grained";
+        SimulationFactory<CELL>::parameterSet.addParameter("Scheduling", scheduling);
+    }
+
+    std::string name() const
+    {
+        return "OpenMPSimulator";
+    }
+
+protected:
+    virtual Simulator<CELL> *buildSimulator(
+        typename SharedPtr<ClonableInitializer<CELL> >::Type initializer,
+        const SimulationParameters& params) const
+    {
+        std::string scheduling = params["Scheduling"];
+
+        OpenMPSimulator<CELL> *sim =
+            new OpenMPSimulator<CELL>(
+                initializer->clone(),
+                scheduling == "fine-grained",
+                scheduling == "static");
+
+        addWriters(sim);
+        addSteerers(sim);
+
+        return sim;
+    }
+};
+
+}
+
+#endif
+
+#endif
@@ -94,6 +94,13 @@ protected:
         }
     }
 
+    void addSteerers(DistributedSimulator<CELL> *simulator) const
+    {
+        for (typename SteerersVec::const_iterator i = steerers.begin(); i != steerers.end(); ++i) {
+            simulator->addSteerer((*i)->clone());
+        }
+    }
+
     void addWriters(MonolithicSimulator<CELL> *simulator) const
     {
         for (typename WritersVec::const_iterator i = writers.begin(); i != writers.end(); ++i) {
@@ -0,0 +1,82 @@
+#include <libgeodecomp/io/varstepinitializerproxy.h>
+#include <libgeodecomp/misc/hiparsimulationfactory.h>
+#include <libgeodecomp/misc/patternoptimizer.h>
+#include <libgeodecomp/misc/simfabtestmodel.h>
+#include <libgeodecomp/parallelization/autotuningsimulator.h>
+
+#include <cxxtest/TestSuite.h>
+
+using namespace LibGeoDecomp;
+
+namespace LibGeoDecomp {
+
+class HiParSimulationFactoryTest : public CxxTest::TestSuite
+{
+public:
+    void setUp()
+    {
+#ifdef LIBGEODECOMP_WITH_CPP14
+        initializer.reset(
+            new VarStepInitializerProxy<SimFabTestCell>(
+                new SimFabTestInitializer(Coord<3>(20, 15, 10), 5)));
+#endif
+    }
+
+    void testParameters()
+    {
+#ifdef LIBGEODECOMP_WITH_CPP14
+        HiParSimulationFactory<SimFabTestCell> fab(initializer, 4);
+        TS_ASSERT_EQUALS("HiParSimulator", fab.name());
+
+        SimulationParameters params = fab.parameters();
+        TS_ASSERT_EQUALS(std::size_t(4), params.size());
+        // ghost zone widths 1 through 4:
+        TS_ASSERT_EQUALS(4, params["GhostZoneWidth"].getMax());
+        params["GhostZoneWidth"].setValue(3);
+        TS_ASSERT_EQUALS(4, int(params["GhostZoneWidth"]));
+        TS_ASSERT_EQUALS(4, params["Partition"].getMax());
+        TS_ASSERT_EQUALS(2, params["Stepper"].getMax());
+        TS_ASSERT_EQUALS(2, params["FineGrainedParallelism"].getMax());
+#endif
+    }
+
+    void testAllVariantsRun()
+    {
+#ifdef LIBGEODECOMP_WITH_CPP14
+        HiParSimulationFactory<SimFabTestCell> fab(initializer, 4);
+        SimulationParameters params = fab.parameters();
+
+        for (int partition = 0; partition < 4; ++partition) {
+            for (int stepper = 0; stepper < 2; ++stepper) {
+                params["Partition"].setValue(partition);
+                params["Stepper"].setValue(stepper);
+                params["GhostZoneWidth"].setValue(partition);
+                params["FineGrainedParallelism"].setValue(stepper);
+
+                TS_ASSERT(fab(params) <= 0);
+            }
+        }
+#endif
+    }
+
+    void testAutoTuningSimulatorRegistersFactory()
+    {
+#ifdef LIBGEODECOMP_WITH_CPP14
+        AutoTuningSimulator<SimFabTestCell, PatternOptimizer> ats(
+            new SimFabTestInitializer(Coord<3>(20, 15, 10), 5));
+        // distributed tuning is opt-in:
+        TS_ASSERT_THROWS(ats.getSimulation("HiParSimulator"), std::invalid_argument&);
+
+        ats.enableDistributedTuning(MPI_COMM_SELF);
+        TS_ASSERT_EQUALS("HiParSimulator", ats.getSimulation("HiParSimulator")->simulationType);
+        TS_ASSERT_EQUALS(MPI_COMM_SELF, ats.communicator);
+#endif
+    }
+
+private:
+#ifdef LIBGEODECOMP_WITH_CPP14
+    SharedPtr<VarStepInitializerProxy<SimFabTestCell> >::Type initializer;
+#endif
+};
+
+}
@@ -0,0 +1,47 @@
+#include <cxxtest/TestSuite.h>
+#include <libgeodecomp/misc/bfloat16.h>
+
+#include <cmath>
+#include <limits>
+
+using namespace LibGeoDecomp;
+
+namespace LibGeoDecomp {
+
+class BFloat16Test : public CxxTest::TestSuite
+{
+public:
+    void testExactValues()
+    {
+        TS_ASSERT_EQUALS(0.0f,   float(BFloat16(0.0f)));
+        TS_ASSERT_EQUALS(1.0f,   float(BFloat16(1.0f)));
+        TS_ASSERT_EQUALS(-2.5f,  float(BFloat16(-2.5f)));
+        TS_ASSERT_EQUALS(256.0f, float(BFloat16(256.0f)));
+        TS_ASSERT_EQUALS(0x3f80, BFloat16(1.0f).raw());
+    }
+
+    void testRounding()
+    {
+        // 1 + 2^-8 is exactly halfway between 1 and 1 + 2^-7, ties go to even:
+        TS_ASSERT_EQUALS(1.0f, float(BFloat16(1.0f + 1.0f / 256)));
+        TS_ASSERT_EQUALS(1.0f + 1.0f / 128, float(BFloat16(1.0f + 1.0f / 256 + 1.0f / 4096)));
+        TS_ASSERT_EQUALS(1.0f + 2.0f / 128, float(BFloat16(1.0f + 3.0f / 256)));
+
+        for (float f = -100; f < 100; f += 0.37f) {
+            TS_ASSERT_DELTA(f, float(BFloat16(f)), std::abs(f) / 256);
+        }
+    }
+
+    void testSpecialValues()
+    {
+        float inf = std::numeric_limits<float>::infinity();
+        TS_ASSERT_EQUALS(inf, float(BFloat16(inf)));
+        TS_ASSERT_EQUALS(-inf, float(BFloat16(-inf)));
+        TS_ASSERT(std::isnan(float(BFloat16(std::numeric_limits<float>::quiet_NaN()))));
+
+        // overflows to infinity instead of wrapping around:
+        TS_ASSERT_EQUALS(inf, float(BFloat16(std::numeric_limits<float>::max())));
+    }
+};
+
+}
@@ -147,6 +147,64 @@ public:
         TS_ASSERT_LESS_THAN_EQUALS(0.015, c->interval<TimeComputeInner>());
     }
 
+    void testAllocations()
+    {
+        AllocationCounter::count(100);
+        {
+            TimeTotal t(c);
+            AllocationCounter::count(100);
+            {
+                TimeComputeInner t(c);
+                AllocationCounter::count(100);
+                AllocationCounter::count(100);
+            }
+            {
+                TimeComputeGhost t(c);
+            }
+        }
+        AllocationCounter::count(100);
+
+        TS_ASSERT_EQUALS(3, c->allocations<TimeTotal>());
+        TS_ASSERT_EQUALS(2, c->allocations<TimeCompute>());
+        TS_ASSERT_EQUALS(2, c->allocations<TimeComputeInner>());
+        TS_ASSERT_EQUALS(0, c->allocations<TimeComputeGhost>());
+        TS_ASSERT_EQUALS(0, c->allocations<TimeOutput>());
+
+        c->addTime<TimeOutput>(5);
+        TS_ASSERT_EQUALS(0, c->allocations<TimeOutput>());
+
+        Chronometer sum = *c + *c;
+        TS_ASSERT_EQUALS(6, sum.allocations<TimeTotal>());
+        TS_ASSERT_EQUALS(4, sum.allocations(TimeCompute::ID));
+
+        c->reset();
+        TS_ASSERT_EQUALS(0, c->allocations<TimeTotal>());
+    }
+
+    void testDelta()
+    {
+        c->addTime<TimeCompute>(5);
+        c->addTime<TimeTotal>(7);
+        Chronometer previous = *c;
+
+        c->addTime<TimeCompute>(2);
+        {
+            TimeOutput t(c);
+            AllocationCounter::count(100);
+        }
+        Chronometer delta = c->delta(previous);
+        TS_ASSERT_EQUALS(2, delta.interval<TimeCompute>());
+        TS_ASSERT_EQUALS(0, delta.interval<TimeTotal>());
+        TS_ASSERT_EQUALS(1, delta.allocations<TimeOutput>());
+
+        // a reset Chronometer yields its current totals:
+        c->reset();
+        c->addTime<TimeCompute>(3);
+        delta = c->delta(previous);
+        TS_ASSERT_EQUALS(3, delta.interval<TimeCompute>());
+        TS_ASSERT_EQUALS(0, delta.interval<TimeTotal>());
+    }
+
 private:
     Chronometer *c;
 };
@@ -0,0 +1,72 @@
+#include <cxxtest/TestSuite.h>
+#include <libgeodecomp/misc/cpufeatures.h>
+
+#include <cstdlib>
+
+using namespace LibGeoDecomp;
+
+namespace LibGeoDecomp {
+
+class CPUFeaturesTest : public CxxTest::TestSuite
+{
+public:
+    void setUp()
+    {
+        unsetenv("LIBGEODECOMP_MAX_ISA");
+    }
+
+    void tearDown()
+    {
+        unsetenv("LIBGEODECOMP_MAX_ISA");
+    }
+
+    void testSupportsCompiledISA()
+    {
+        // we're running, so the CPU can execute what we were compiled for:
+        for (int i = CPUFeatures::SCALAR; i <= LIBGEODECOMP_COMPILED_ISA; ++i) {
+            TS_ASSERT(CPUFeatures::supports(CPUFeatures::ISA(i)));
+        }
+        TS_ASSERT(CPUFeatures::widest() >= LIBGEODECOMP_COMPILED_ISA);
+    }
+
+    void testISAsAreOrdered()
+    {
+        for (int i = CPUFeatures::SSE2; i < CPUFeatures::NUM_ISAS; ++i) {
+            if (CPUFeatures::supports(CPUFeatures::ISA(i))) {
+                TS_ASSERT(CPUFeatures::supports(CPUFeatures::ISA(i - 1)));
+            }
+        }
+    }
+
+    void testLimitViaEnvironment()
+    {
+        CPUFeatures::ISA widest = CPUFeatures::widest();
+
+        setenv("LIBGEODECOMP_MAX_ISA", "SCALAR", 1);
+        TS_ASSERT_EQUALS(CPUFeatures::SCALAR, CPUFeatures::widest());
+
+        setenv("LIBGEODECOMP_MAX_ISA", "AVX512F", 1);
+        TS_ASSERT_EQUALS(widest, CPUFeatures::widest());
+
+        if (widest >= CPUFeatures::SSE4_1) {
+            setenv("LIBGEODECOMP_MAX_ISA", "SSE4_1", 1);
+            TS_ASSERT_EQUALS(CPUFeatures::SSE4_1, CPUFeatures::widest());
+        }
+
+        setenv("LIBGEODECOMP_MAX_ISA", "MMX", 1);
+        TS_ASSERT_THROWS(CPUFeatures::widest(), std::invalid_argument&);
+    }
+
+    void testNames()
+    {
+        for (int i = 0; i < CPUFeatures::NUM_ISAS; ++i) {
+            CPUFeatures::ISA isa = CPUFeatures::ISA(i);
+            TS_ASSERT_EQUALS(isa, CPUFeatures::parse(CPUFeatures::name(isa)));
+        }
+
+        TS_ASSERT_EQUALS("AVX2", CPUFeatures::name(CPUFeatures::AVX2));
+        TS_ASSERT_THROWS(CPUFeatures::parse("avx2"), std::invalid_argument&);
+    }
+};
+
+}
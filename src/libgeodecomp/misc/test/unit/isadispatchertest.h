@@ -0,0 +1,119 @@
+#include <cxxtest/TestSuite.h>
+#include <libgeodecomp/misc/isadispatcher.h>
+#include <libgeodecomp/misc/stdcontaineroverloads.h>
+
+#include <cstdlib>
+
+using namespace LibGeoDecomp;
+
+namespace LibGeoDecomp {
+
+namespace ISADispatcherTestHelpers {
+
+int scalarKernel(int x)
+{
+    return x + 1;
+}
+
+int sse2Kernel(int x)
+{
+    return x + 2;
+}
+
+int avx512Kernel(int x)
+{
+    return x + 512;
+}
+
+int compiledKernel(int x)
+{
+    return -x;
+}
+
+}
+
+}
+
+using LibGeoDecomp::ISADispatcherTestHelpers::compiledKernel;
+
+LIBGEODECOMP_REGISTER_ISA_VARIANT("ISADispatcherTest::compiled", compiledKernel)
+
+namespace LibGeoDecomp {
+
+class ISADispatcherTest : public CxxTest::TestSuite
+{
+public:
+    typedef int Kernel(int);
+
+    void setUp()
+    {
+        unsetenv("LIBGEODECOMP_MAX_ISA");
+    }
+
+    void tearDown()
+    {
+        unsetenv("LIBGEODECOMP_MAX_ISA");
+    }
+
+    void testStaticRegistration()
+    {
+        std::vector<CPUFeatures::ISA> expected(1, LIBGEODECOMP_COMPILED_ISA);
+        TS_ASSERT_EQUALS(expected, ISADispatcher::variants("ISADispatcherTest::compiled"));
+        TS_ASSERT_EQUALS(-5, ISADispatcher::get<Kernel>("ISADispatcherTest::compiled")(5));
+    }
+
+    void testSelectsWidestSupportedVariant()
+    {
+        ISADispatcher::add(
+            "ISADispatcherTest::foo",
+            CPUFeatures::SCALAR,
+            reinterpret_cast<ISADispatcher::GenericFunction>(&ISADispatcherTestHelpers::scalarKernel));
+        ISADispatcher::add(
+            "ISADispatcherTest::foo",
+            CPUFeatures::SSE2,
+            reinterpret_cast<ISADispatcher::GenericFunction>(&ISADispatcherTestHelpers::sse2Kernel));
+        ISADispatcher::add(
+            "ISADispatcherTest::foo",
+            CPUFeatures::AVX512F,
+            reinterpret_cast<ISADispatcher::GenericFunction>(&ISADispatcherTestHelpers::avx512Kernel));
+
+        std::vector<CPUFeatures::ISA> expected;
+        expected << CPUFeatures::SCALAR
+                 << CPUFeatures::SSE2
+                 << CPUFeatures::AVX512F;
+        TS_ASSERT_EQUALS(expected, ISADispatcher::variants("ISADispatcherTest::foo"));
+
+        int expectedResult = 11;
+        if (CPUFeatures::supports(CPUFeatures::SSE2)) {
+            expectedResult = 12;
+        }
+        if (CPUFeatures::supports(CPUFeatures::AVX512F)) {
+            expectedResult = 522;
+        }
+        TS_ASSERT_EQUALS(expectedResult, ISADispatcher::get<Kernel>("ISADispatcherTest::foo")(10));
+
+        setenv("LIBGEODECOMP_MAX_ISA", "AVX2", 1);
+        if (CPUFeatures::supports(CPUFeatures::SSE2)) {
+            TS_ASSERT_EQUALS(CPUFeatures::SSE2, ISADispatcher::select("ISADispatcherTest::foo"));
+        }
+
+        setenv("LIBGEODECOMP_MAX_ISA", "SCALAR", 1);
+        TS_ASSERT_EQUALS(CPUFeatures::SCALAR, ISADispatcher::select("ISADispatcherTest::foo"));
+        TS_ASSERT_EQUALS(11, ISADispatcher::get<Kernel>("ISADispatcherTest::foo")(10));
+    }
+
+    void testMissingVariant()
+    {
+        ISADispatcher::add(
+            "ISADispatcherTest::bar",
+            CPUFeatures::AVX,
+            reinterpret_cast<ISADispatcher::GenericFunction>(&ISADispatcherTestHelpers::sse2Kernel));
+
+        setenv("LIBGEODECOMP_MAX_ISA", "SSE4_1", 1);
+        TS_ASSERT_THROWS(ISADispatcher::select("ISADispatcherTest::bar"), std::logic_error&);
+        TS_ASSERT_THROWS(ISADispatcher::get<Kernel>("ISADispatcherTest::nonexistent"), std::logic_error&);
+        TS_ASSERT(ISADispatcher::variants("ISADispatcherTest::nonexistent").empty());
+    }
+};
+
+}
@@ -5,6 +5,7 @@
 #include <libgeodecomp/misc/cacheblockingsimulationfactory.h>
 #include <libgeodecomp/misc/cudasimulationfactory.h>
 #include <libgeodecomp/misc/limits.h>
+#include <libgeodecomp/misc/openmpsimulationfactory.h>
 #include <libgeodecomp/misc/serialsimulationfactory.h>
 #include <libgeodecomp/misc/simulationfactory.h>
 
@@ -142,6 +143,41 @@ public:
         cFab->operator()(cFab->parameterSet);
         delete writer;
 #endif
+#endif
+    }
+
+    void testOpenMPSimulationFactory()
+    {
+#ifdef LIBGEODECOMP_WITH_THREADS
+#ifdef LIBGEODECOMP_WITH_CPP14
+        SharedPtr<VarStepInitializerProxy<SimFabTestCell> >::Type smallInitializer(
+            new VarStepInitializerProxy<SimFabTestCell>(
+                new SimFabTestInitializer(Coord<3>(20, 15, 10), 5)));
+        SerialSimulationFactory<SimFabTestCell> serialFab(smallInitializer);
+        OpenMPSimulationFactory<SimFabTestCell> openMPFab(smallInitializer);
+        TS_ASSERT_EQUALS("OpenMPSimulator", openMPFab.name());
+
+        typedef MonolithicSimulator<SimFabTestCell> SimulatorType;
+        SharedPtr<SimulatorType>::Type reference(dynamic_cast<SimulatorType*>(serialFab()));
+        reference->run();
+
+        std::vector<std::string> modes;
+        modes << "dynamic" << "static" << "fine-grained";
+        for (int i = 0; i < 3; ++i) {
+            openMPFab.parameterSet["Scheduling"].setValue(i);
+            TS_ASSERT_EQUALS(modes[i], std::string(openMPFab.parameterSet["Scheduling"]));
+
+            SharedPtr<SimulatorType>::Type sim(dynamic_cast<SimulatorType*>(openMPFab()));
+            sim->run();
+
+            CoordBox<3> box = sim->getGrid()->boundingBox();
+            for (CoordBox<3>::Iterator j = box.begin(); j != box.end(); ++j) {
+                TS_ASSERT_EQUALS(reference->getGrid()->get(*j).temp, sim->getGrid()->get(*j).temp);
+            }
+
+            TS_ASSERT(openMPFab(openMPFab.parameterSet) <= 0);
+        }
+#endif
 #endif
     }
 
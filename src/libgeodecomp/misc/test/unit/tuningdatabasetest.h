@@ -0,0 +1,147 @@
+#include <libgeodecomp/misc/tempfile.h>
+#include <libgeodecomp/misc/tuningdatabase.h>
+
+#include <cxxtest/TestSuite.h>
+#include <cstdio>
+#include <fstream>
+
+using namespace LibGeoDecomp;
+
+namespace LibGeoDecomp {
+
+class TuningDatabaseTest : public CxxTest::TestSuite
+{
+public:
+    void setUp()
+    {
+        filename1 = TempFile::serial("tuningdatabase1");
+        filename2 = TempFile::serial("tuningdatabase2");
+
+        params = freshParams();
+        params["PipelineLength"].setValue(7);
+        params["Schedule"].setValue(2);
+        params["Factor"].setValue(1.0 / 3.0);
+
+        key = TuningDatabase::Key("FooCell", "(100, 200, 300)", 8, "Some CPU @ 2.5GHz");
+    }
+
+    void tearDown()
+    {
+        remove(filename1.c_str());
+        remove(filename2.c_str());
+    }
+
+    void testLookupAndApply()
+    {
+        TuningDatabase db;
+        TuningDatabase::Entry entry;
+        TS_ASSERT(!db.lookup(key, &entry));
+
+        db.store(key, TuningDatabase::Entry("CacheBlockingSimulator", params, -1.5));
+        TS_ASSERT_EQUALS(std::size_t(1), db.size());
+        TS_ASSERT(db.lookup(key, &entry));
+        TS_ASSERT(!db.lookup(TuningDatabase::Key("FooCell", "(100, 200, 300)", 4, "Some CPU @ 2.5GHz"), &entry));
+
+        TS_ASSERT(db.lookup(key, &entry));
+        TS_ASSERT_EQUALS("CacheBlockingSimulator", entry.simulator);
+        TS_ASSERT_EQUALS(-1.5, entry.fitness);
+
+        SimulationParameters restored = freshParams();
+        TS_ASSERT(entry.applyTo(&restored));
+        TS_ASSERT_EQUALS(8,         int(restored["PipelineLength"]));
+        TS_ASSERT_EQUALS("guided",  std::string(restored["Schedule"]));
+        TS_ASSERT_DELTA(1.0 / 3.0,  double(restored["Factor"]), 1e-15);
+
+        SimulationParameters mismatch;
+        mismatch.addParameter("PipelineLength", 1, 30);
+        TS_ASSERT(!entry.applyTo(&mismatch));
+    }
+
+    void testPersistence()
+    {
+        {
+            TuningDatabase db(filename1);
+            TS_ASSERT_EQUALS(std::size_t(0), db.size());
+            db.store(key, TuningDatabase::Entry("CacheBlockingSimulator", params, -1.25));
+            db.store(TuningDatabase::Key("BarCell", "(10, 20)", 1, "unknown"), TuningDatabase::Entry("SerialSimulator", -0.5));
+        }
+
+        TuningDatabase db(filename1);
+        TS_ASSERT_EQUALS(std::size_t(2), db.size());
+
+        TuningDatabase::Entry entry;
+        TS_ASSERT(db.lookup(key, &entry));
+        TS_ASSERT_EQUALS(TuningDatabase::Entry("CacheBlockingSimulator", params, -1.25), entry);
+
+        TS_ASSERT(db.lookup(TuningDatabase::Key("BarCell", "(10, 20)", 1, "unknown"), &entry));
+        TS_ASSERT_EQUALS("SerialSimulator", entry.simulator);
+        TS_ASSERT_EQUALS(std::size_t(0), entry.values.size());
+    }
+
+    void testImportExport()
+    {
+        TuningDatabase source;
+        source.store(key, TuningDatabase::Entry("CacheBlockingSimulator", params, -2.0));
+        source.save(filename1);
+
+        TuningDatabase target(filename2);
+        TuningDatabase::Key otherKey("FooCell", "(100, 200, 300)", 16, "Some CPU @ 2.5GHz");
+        target.store(otherKey, TuningDatabase::Entry("SerialSimulator", -3.0));
+        TS_ASSERT(target.load(filename1));
+        TS_ASSERT(!target.load(filename1 + "_does_not_exist"));
+        TS_ASSERT_EQUALS(std::size_t(2), target.size());
+
+        // tabs in fields must not break the format:
+        target.store(TuningDatabase::Key("Foo\tCell", "", 1, ""), TuningDatabase::Entry("SerialSimulator", -1.0));
+        TuningDatabase reloaded(filename2);
+        TS_ASSERT_EQUALS(std::size_t(3), reloaded.size());
+
+        TuningDatabase::Entry entry;
+        TS_ASSERT(reloaded.lookup(key, &entry));
+        TS_ASSERT_EQUALS("CacheBlockingSimulator", entry.simulator);
+        TS_ASSERT(reloaded.lookup(TuningDatabase::Key("Foo Cell", "", 1, ""), &entry));
+    }
+
+    void testMalformedRecordsAreSkipped()
+    {
+        {
+            std::ofstream file(filename1.c_str());
+            file << "# comment\n"
+                 << "garbage\n"
+                 << "FooCell\t(1, 2)\t4\tcpu\tSerialSimulator\t-1\tbroken\tPipelineLength=3\n";
+        }
+
+        TuningDatabase db(filename1);
+        TS_ASSERT_EQUALS(std::size_t(1), db.size());
+
+        TuningDatabase::Entry entry;
+        TS_ASSERT(db.lookup(TuningDatabase::Key("FooCell", "(1, 2)", 4, "cpu"), &entry));
+        TS_ASSERT_EQUALS(std::size_t(1), entry.values.size());
+        TS_ASSERT_EQUALS(3.0, entry.values["PipelineLength"]);
+    }
+
+    void testFingerprint()
+    {
+        TS_ASSERT(!TuningDatabase::cpuFingerprint().empty());
+        TS_ASSERT(TuningDatabase::threadCount() > 0);
+    }
+
+private:
+    std::string filename1;
+    std::string filename2;
+    SimulationParameters params;
+    TuningDatabase::Key key;
+
+    SimulationParameters freshParams()
+    {
+        SimulationParameters ret;
+        ret.addParameter("PipelineLength", 1, 30);
+        std::vector<std::string> modes;
+        modes << "static" << "dynamic" << "guided";
+        ret.addParameter("Schedule", modes);
+        ret.addParameter("Factor", 0.0, 1.0, 0.0);
+        return ret;
+    }
+};
+
+}
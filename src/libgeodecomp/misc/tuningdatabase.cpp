@@ -0,0 +1,197 @@
+#include <libgeodecomp/io/logger.h>
+#include <libgeodecomp/misc/stringops.h>
+#include <libgeodecomp/misc/tuningdatabase.h>
+
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <stdexcept>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+namespace LibGeoDecomp {
+
+bool TuningDatabase::Entry::applyTo(SimulationParameters *params) const
+{
+    std::vector<std::string> names = params->getNames();
+    if (names.size() != values.size()) {
+        return false;
+    }
+
+    for (std::vector<std::string>::iterator i = names.begin(); i != names.end(); ++i) {
+        if (values.find(*i) == values.end()) {
+            return false;
+        }
+    }
+
+    for (std::map<std::string, double>::const_iterator i = values.begin(); i != values.end(); ++i) {
+        (*params)[i->first].setValue(i->second);
+    }
+
+    return true;
+}
+
+TuningDatabase::TuningDatabase(const std::string& filename) :
+    filename(filename)
+{
+    if (!filename.empty()) {
+        load(filename);
+    }
+}
+
+bool TuningDatabase::lookup(const Key& key, Entry *entry) const
+{
+    EntryMap::const_iterator i = entries.find(key);
+    if (i == entries.end()) {
+        return false;
+    }
+
+    *entry = i->second;
+    return true;
+}
+
+void TuningDatabase::store(const Key& key, const Entry& entry)
+{
+    entries[key] = entry;
+
+    if (!filename.empty()) {
+        save(filename);
+    }
+}
+
+bool TuningDatabase::load(const std::string& filename)
+{
+    std::ifstream file(filename.c_str());
+    if (!file) {
+        return false;
+    }
+
+    std::string line;
+    while (std::getline(file, line)) {
+        if (line.empty() || (line[0] == '#')) {
+            continue;
+        }
+
+        std::vector<std::string> fields;
+        std::size_t start = 0;
+        for (;;) {
+            std::size_t end = line.find('\t', start);
+            fields.push_back(line.substr(start, end - start));
+            if (end == std::string::npos) {
+                break;
+            }
+            start = end + 1;
+        }
+
+        if (fields.size() < 6) {
+            LOG(Logger::WARN, "TuningDatabase ignoring malformed record in " << filename << ": " << line);
+            continue;
+        }
+
+        Key key(fields[0], fields[1], StringOps::atoi(fields[2]), fields[3]);
+        Entry entry(fields[4], StringOps::atof(fields[5]));
+        for (std::size_t i = 6; i < fields.size(); ++i) {
+            std::size_t separator = fields[i].rfind('=');
+            if (separator == std::string::npos) {
+                LOG(Logger::WARN, "TuningDatabase ignoring malformed parameter in " << filename << ": " << fields[i]);
+                continue;
+            }
+
+            entry.values[fields[i].substr(0, separator)] = StringOps::atof(fields[i].substr(separator + 1));
+        }
+
+        entries[key] = entry;
+    }
+
+    return true;
+}
+
+void TuningDatabase::save(const std::string& filename) const
+{
+    std::ofstream file(filename.c_str());
+    if (!file) {
+        throw std::runtime_error("could not open tuning database " + filename + " for writing");
+    }
+
+    file << std::setprecision(std::numeric_limits<double>::digits10 + 2);
+    file << "# LibGeoDecomp tuning database\n"
+         << "# cell type, dimensions, threads, CPU, simulator, fitness, parameters...\n";
+
+    for (EntryMap::const_iterator i = entries.begin(); i != entries.end(); ++i) {
+        file << sanitize(i->first.cellType) << "\t"
+             << sanitize(i->first.dimensions) << "\t"
+             << i->first.threads << "\t"
+             << sanitize(i->first.cpu) << "\t"
+             << sanitize(i->second.simulator) << "\t"
+             << i->second.fitness;
+
+        for (std::map<std::string, double>::const_iterator j = i->second.values.begin();
+             j != i->second.values.end();
+             ++j) {
+            file << "\t" << sanitize(j->first) << "=" << j->second;
+        }
+
+        file << "\n";
+    }
+}
+
+std::string TuningDatabase::cpuFingerprint()
+{
+    std::ifstream cpuinfo("/proc/cpuinfo");
+    std::string line;
+    const char *fields[] = { "model name", "cpu model", "Hardware", "cpu" };
+
+    for (int f = 0; f < 4; ++f) {
+        cpuinfo.clear();
+        cpuinfo.seekg(0);
+
+        while (std::getline(cpuinfo, line)) {
+            std::size_t separator = line.find(':');
+            if ((separator == std::string::npos) ||
+                (trim(line.substr(0, separator)) != fields[f])) {
+                continue;
+            }
+
+            return trim(line.substr(separator + 1));
+        }
+    }
+
+    return "unknown";
+}
+
+int TuningDatabase::threadCount()
+{
+#ifdef _OPENMP
+    return omp_get_max_threads();
+#else
+    return 1;
+#endif
+}
+
+std::string TuningDatabase::trim(const std::string& string)
+{
+    std::size_t start = string.find_first_not_of(" \t");
+    if (start == std::string::npos) {
+        return "";
+    }
+
+    std::size_t end = string.find_last_not_of(" \t");
+    return string.substr(start, end - start + 1);
+}
+
+std::string TuningDatabase::sanitize(const std::string& field)
+{
+    std::string ret = field;
+    for (std::string::iterator i = ret.begin(); i != ret.end(); ++i) {
+        if ((*i == '\t') || (*i == '\n') || (*i == '\r')) {
+            *i = ' ';
+        }
+    }
+
+    return ret;
+}
+
+}
@@ -0,0 +1,181 @@
+#ifndef LIBGEODECOMP_MISC_TUNINGDATABASE_H
+#define LIBGEODECOMP_MISC_TUNINGDATABASE_H
+
+#include <libgeodecomp/misc/simulationparameters.h>
+
+#include <map>
+#include <string>
+
+namespace LibGeoDecomp {
+
+/**
+ * The TuningDatabase stores the results of the AutoTuningSimulator
+ * (i.e. the best simulator and its parameters) so that subsequent
+ * runs on the same hardware with the same model can skip the tuning
+ * phase. Results are keyed on the cell type, the grid dimensions,
+ * the number of threads and the CPU model.
+ *
+ * The database is a plain text file with one tab-separated record
+ * per line. Records from other files may be imported via load(),
+ * and save() can be used to export a database, e.g. to ship
+ * pre-tuned profiles to cluster nodes.
+ */
+class TuningDatabase
+{
+public:
+    friend class TuningDatabaseTest;
+
+    /**
+     * Identifies a tuning problem. Two runs with equal keys are
+     * expected to yield the same tuning result.
+     */
+    class Key
+    {
+    public:
+        inline Key(
+            const std::string& cellType = "",
+            const std::string& dimensions = "",
+            int threads = 0,
+            const std::string& cpu = "") :
+            cellType(cellType),
+            dimensions(dimensions),
+            threads(threads),
+            cpu(cpu)
+        {}
+
+        inline bool operator<(const Key& other) const
+        {
+            if (cellType != other.cellType) {
+                return cellType < other.cellType;
+            }
+            if (dimensions != other.dimensions) {
+                return dimensions < other.dimensions;
+            }
+            if (threads != other.threads) {
+                return threads < other.threads;
+            }
+            return cpu < other.cpu;
+        }
+
+        inline bool operator==(const Key& other) const
+        {
+            return
+                (cellType   == other.cellType) &&
+                (dimensions == other.dimensions) &&
+                (threads    == other.threads) &&
+                (cpu        == other.cpu);
+        }
+
+        std::string cellType;
+        std::string dimensions;
+        int threads;
+        std::string cpu;
+    };
+
+    /**
+     * The tuning result: name of the winning simulator, its
+     * parameters (stored via their real-valued representation, see
+     * OptimizableParameter::getValue()) and fitness.
+     */
+    class Entry
+    {
+    public:
+        inline explicit Entry(
+            const std::string& simulator = "",
+            double fitness = 0) :
+            simulator(simulator),
+            fitness(fitness)
+        {}
+
+        inline Entry(
+            const std::string& simulator,
+            const SimulationParameters& params,
+            double fitness) :
+            simulator(simulator),
+            fitness(fitness)
+        {
+            std::vector<std::string> names = params.getNames();
+            for (std::vector<std::string>::iterator i = names.begin(); i != names.end(); ++i) {
+                values[*i] = params[*i].getValue();
+            }
+        }
+
+        /**
+         * Sets the stored values on the given parameters. Returns
+         * false if the parameter names don't match, e.g. because
+         * the factory's parameters were changed since the entry was
+         * stored.
+         */
+        bool applyTo(SimulationParameters *params) const;
+
+        inline bool operator==(const Entry& other) const
+        {
+            return
+                (simulator == other.simulator) &&
+                (values    == other.values) &&
+                (fitness   == other.fitness);
+        }
+
+        std::string simulator;
+        std::map<std::string, double> values;
+        double fitness;
+    };
+
+    /**
+     * If filename is not empty, any existing records will be read
+     * from that file and store() will write the database back to it.
+     */
+    explicit TuningDatabase(const std::string& filename = "");
+
+    /**
+     * Returns true and copies the entry for the given key to entry
+     * if one exists.
+     */
+    bool lookup(const Key& key, Entry *entry) const;
+
+    /**
+     * Adds or replaces the entry for key and persists the database
+     * if it's backed by a file.
+     */
+    void store(const Key& key, const Entry& entry);
+
+    /**
+     * Imports all records from the given file. Records for keys
+     * which are already present will be overwritten. Returns false
+     * if the file couldn't be read.
+     */
+    bool load(const std::string& filename);
+
+    /**
+     * Exports all records to the given file.
+     */
+    void save(const std::string& filename) const;
+
+    inline std::size_t size() const
+    {
+        return entries.size();
+    }
+
+    /**
+     * A string which identifies the CPU model of the current host.
+     */
+    static std::string cpuFingerprint();
+
+    /**
+     * The number of threads available to the simulators.
+     */
+    static int threadCount();
+
+private:
+    typedef std::map<Key, Entry> EntryMap;
+
+    std::string filename;
+    EntryMap entries;
+
+    static std::string trim(const std::string& string);
+    static std::string sanitize(const std::string& field);
+};
+
+}
+
+#endif
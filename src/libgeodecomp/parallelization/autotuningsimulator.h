@@ -5,16 +5,24 @@
 
 #ifdef LIBGEODECOMP_WITH_CPP14
 
+#ifdef LIBGEODECOMP_WITH_MPI
+#include <libgeodecomp/communication/mpilayer.h>
+#endif
 #include <libgeodecomp/misc/optimizer.h>
 #include <libgeodecomp/misc/cacheblockingsimulationfactory.h>
 #include <libgeodecomp/misc/cudasimulationfactory.h>
+#include <libgeodecomp/misc/hiparsimulationfactory.h>
 #include <libgeodecomp/misc/limits.h>
+#include <libgeodecomp/misc/openmpsimulationfactory.h>
 #include <libgeodecomp/misc/serialsimulationfactory.h>
 #include <libgeodecomp/misc/simulationparameters.h>
+#include <libgeodecomp/misc/tuningdatabase.h>
 #include <libgeodecomp/io/initializer.h>
 #include <libgeodecomp/io/varstepinitializerproxy.h>
 #include <libgeodecomp/io/logger.h>
+#include <algorithm>
 #include <cfloat>
+#include <typeinfo>
 
 namespace LibGeoDecomp {
 
@@ -54,6 +62,14 @@ public:
  * and suitable parameters for the given simulation model and
  * hardware.
  *
+ * Tuning results can be cached in a TuningDatabase (see
+ * setTuningDatabase()). Subsequent runs with the same model, grid
+ * dimensions, thread count and CPU will then skip the tuning phase.
+ *
+ * By default all candidates are node-local and tuning doesn't
+ * communicate. HiParSimulator needs to be enabled explicitly via
+ * enableDistributedTuning().
+ *
  * fixme: shouldn't we inherit from Monolithic- or DistributedSimulator?
  */
 template<typename CELL_TYPE, typename OPTIMIZER_TYPE>
@@ -62,6 +78,8 @@ class AutoTuningSimulator
 public:
     friend class AutotuningSimulatorWithoutCUDATest;
     friend class AutotuningSimulatorWithCUDATest;
+    friend class HiParSimulationFactoryTest;
+    friend class AutoTuningSimulatorTest;
 
     typedef AutoTuningSimulatorHelpers::Simulation<CELL_TYPE>  Simulation;
     typedef typename SharedPtr<SimulationFactory<CELL_TYPE> >::Type SimFactoryPtr;
@@ -79,6 +97,24 @@ public:
 
     void addSteerer(const Steerer<CELL_TYPE> *steerer);
 
+    /**
+     * Results will be looked up in/stored to the given file. Set
+     * forceRetuning to true to ignore any cached result (the new
+     * result will still be stored).
+     */
+    void setTuningDatabase(const std::string& filename, bool forceRetuning = false);
+
+#ifdef LIBGEODECOMP_WITH_MPI
+    /**
+     * Adds HiParSimulator, running on the given communicator, to the
+     * candidates. This turns tuning into a collective operation: all
+     * ranks of the communicator need to call run() and fitness
+     * values are reduced over the communicator so that all ranks
+     * select the same simulator.
+     */
+    void enableDistributedTuning(MPI_Comm communicator);
+#endif
+
     void run();
 
 private:
@@ -88,6 +124,12 @@ private:
     std::vector<typename SharedPtr<ParallelWriter<CELL_TYPE> >::Type> parallelWriters;
     std::vector<typename SharedPtr<Writer<CELL_TYPE> >::Type> writers;
     std::vector<typename SharedPtr<Steerer<CELL_TYPE> >::Type> steerers;
+    typename SharedPtr<TuningDatabase>::Type tuningDatabase;
+    bool forceRetuning;
+#ifdef LIBGEODECOMP_WITH_MPI
+    bool distributedTuning;
+    MPI_Comm communicator;
+#endif
 
     template<typename FACTORY_TYPE>
     void addSimulation(const std::string& name, const FACTORY_TYPE& factory)
@@ -116,6 +158,25 @@ private:
 
     void prepareSimulations();
 
+    TuningDatabase::Key tuningKey() const;
+
+    bool loadTuningResult(std::string *bestSimulation);
+
+    /**
+     * With distributed tuning only rank 0 reads and writes the
+     * TuningDatabase, so that all ranks share its result and don't
+     * race when writing to the same file.
+     */
+    bool tuningDatabaseOwner() const;
+
+#ifdef LIBGEODECOMP_WITH_MPI
+    /**
+     * Sends rank 0's lookup result to all ranks. Returns whether
+     * rank 0 had found an entry.
+     */
+    bool broadcastTuningResult(bool found, TuningDatabase::Entry *entry) const;
+#endif
+
     SimulationPtr getSimulation(const std::string& simulatorName)
     {
         if (simulations.find(simulatorName) == simulations.end()) {
@@ -129,11 +190,18 @@ private:
 template<typename CELL_TYPE,typename OPTIMIZER_TYPE>
 AutoTuningSimulator<CELL_TYPE, OPTIMIZER_TYPE>::AutoTuningSimulator(Initializer<CELL_TYPE> *initializer, unsigned optimizationSteps):
     optimizationSteps(optimizationSteps),
-    varStepInitializer(new VarStepInitializerProxy<CELL_TYPE>(initializer))
+    varStepInitializer(new VarStepInitializerProxy<CELL_TYPE>(initializer)),
+    forceRetuning(false)
 {
+#ifdef LIBGEODECOMP_WITH_MPI
+    distributedTuning = false;
+    communicator = MPI_COMM_NULL;
+#endif
+
     addSimulation(SerialSimulationFactory<CELL_TYPE>(varStepInitializer));
 #ifdef LIBGEODECOMP_WITH_THREADS
     addSimulation(CacheBlockingSimulationFactory<CELL_TYPE>(varStepInitializer));
+    addSimulation(OpenMPSimulationFactory<CELL_TYPE>(varStepInitializer));
 #endif
 
 #ifdef __CUDACC__
@@ -162,6 +230,23 @@ void AutoTuningSimulator<CELL_TYPE, OPTIMIZER_TYPE>::addSteerer(const Steerer<CE
     steerers.push_back(SteererPtr(steerer));
 }
 
+template<typename CELL_TYPE,typename OPTIMIZER_TYPE>
+void AutoTuningSimulator<CELL_TYPE, OPTIMIZER_TYPE>::setTuningDatabase(const std::string& filename, bool forceRetuning)
+{
+    tuningDatabase.reset(new TuningDatabase(filename));
+    this->forceRetuning = forceRetuning;
+}
+
+#ifdef LIBGEODECOMP_WITH_MPI
+template<typename CELL_TYPE,typename OPTIMIZER_TYPE>
+void AutoTuningSimulator<CELL_TYPE, OPTIMIZER_TYPE>::enableDistributedTuning(MPI_Comm communicator)
+{
+    distributedTuning = true;
+    this->communicator = communicator;
+    addSimulation(HiParSimulationFactory<CELL_TYPE>(varStepInitializer, 8, communicator));
+}
+#endif
+
 template<typename CELL_TYPE,typename OPTIMIZER_TYPE>
 void AutoTuningSimulator<CELL_TYPE, OPTIMIZER_TYPE>::run()
 {
@@ -172,13 +257,28 @@ void AutoTuningSimulator<CELL_TYPE, OPTIMIZER_TYPE>::run()
     unsigned defaultInitializerSteps = 5;
 
     prepareSimulations();
+
+    std::string best;
+    if (loadTuningResult(&best)) {
+        runToCompletion(best);
+        return;
+    }
+
     if (!normalizeSteps(fitnessGoal, defaultInitializerSteps)) {
         LOG(Logger::WARN, "normalize Steps was not successful, default step number will be used");
         varStepInitializer->setMaxSteps(defaultInitializerSteps);
     }
 
     runTest();
-    std::string best = getBestSim();
+    best = getBestSim();
+
+    if (tuningDatabase && tuningDatabaseOwner()) {
+        SimulationPtr simulation = getSimulation(best);
+        tuningDatabase->store(
+            tuningKey(),
+            TuningDatabase::Entry(best, simulation->parameters, simulation->fitness));
+    }
+
     runToCompletion(best);
 }
 
@@ -215,7 +315,7 @@ unsigned AutoTuningSimulator<CELL_TYPE, OPTIMIZER_TYPE>::normalizeSteps(double g
         throw std::invalid_argument("startSteps needs to be grater than zero");
     }
 
-    SimulationPtr simulation = getSimulation("SerialSimulation");
+    SimulationPtr simulation = getSimulation("SerialSimulator");
     SimFactoryPtr factory = simulation->simulationFactory;
     unsigned steps = startStepNum;
     unsigned oldSteps = startStepNum;
@@ -258,6 +358,17 @@ void AutoTuningSimulator<CELL_TYPE, OPTIMIZER_TYPE>::runTest()
             << "new Parameters:"<< std::endl << iter->second->parameters
             << std::endl);
     }
+
+#ifdef LIBGEODECOMP_WITH_MPI
+    // all ranks need to agree on the winner, otherwise they might
+    // end up running different (distributed) simulators:
+    if (distributedTuning) {
+        for (IterType iter = simulations.begin(); iter != simulations.end(); iter++) {
+            double localFitness = iter->second->fitness;
+            MPI_Allreduce(&localFitness, &iter->second->fitness, 1, MPI_DOUBLE, MPI_MIN, communicator);
+        }
+    }
+#endif
 }
 
 template<typename CELL_TYPE,typename OPTIMIZER_TYPE>
@@ -282,6 +393,110 @@ void AutoTuningSimulator<CELL_TYPE, OPTIMIZER_TYPE>::prepareSimulations()
     }
 }
 
+template<typename CELL_TYPE,typename OPTIMIZER_TYPE>
+TuningDatabase::Key AutoTuningSimulator<CELL_TYPE, OPTIMIZER_TYPE>::tuningKey() const
+{
+    return TuningDatabase::Key(
+        typeid(CELL_TYPE).name(),
+        varStepInitializer->gridDimensions().toString(),
+        TuningDatabase::threadCount(),
+        TuningDatabase::cpuFingerprint());
+}
+
+template<typename CELL_TYPE,typename OPTIMIZER_TYPE>
+bool AutoTuningSimulator<CELL_TYPE, OPTIMIZER_TYPE>::loadTuningResult(std::string *bestSimulation)
+{
+    TuningDatabase::Entry entry;
+    bool found =
+        tuningDatabase &&
+        !forceRetuning &&
+        tuningDatabaseOwner() &&
+        tuningDatabase->lookup(tuningKey(), &entry);
+
+#ifdef LIBGEODECOMP_WITH_MPI
+    // ranks which skip tuning would deadlock those which don't, so
+    // rank 0's result is used everywhere:
+    if (distributedTuning) {
+        found = broadcastTuningResult(found, &entry);
+    }
+#endif
+
+    if (!found) {
+        return false;
+    }
+
+    if (simulations.find(entry.simulator) == simulations.end()) {
+        LOG(Logger::WARN, "AutoTuningSimulator ignoring cached result for unknown simulator " << entry.simulator);
+        return false;
+    }
+
+    SimulationPtr simulation = simulations[entry.simulator];
+    SimulationParameters params = simulation->parameters;
+    if (!entry.applyTo(&params)) {
+        LOG(Logger::WARN, "AutoTuningSimulator ignoring cached result with mismatching parameters for " << entry.simulator);
+        return false;
+    }
+
+    LOG(Logger::INFO, "AutoTuningSimulator using cached result: " << entry.simulator);
+    simulation->parameters = params;
+    simulation->fitness = entry.fitness;
+    *bestSimulation = entry.simulator;
+    return true;
+}
+
+template<typename CELL_TYPE,typename OPTIMIZER_TYPE>
+bool AutoTuningSimulator<CELL_TYPE, OPTIMIZER_TYPE>::tuningDatabaseOwner() const
+{
+#ifdef LIBGEODECOMP_WITH_MPI
+    if (distributedTuning) {
+        return MPILayer(communicator).rank() == 0;
+    }
+#endif
+
+    return true;
+}
+
+#ifdef LIBGEODECOMP_WITH_MPI
+template<typename CELL_TYPE,typename OPTIMIZER_TYPE>
+bool AutoTuningSimulator<CELL_TYPE, OPTIMIZER_TYPE>::broadcastTuningResult(
+    bool found,
+    TuningDatabase::Entry *entry) const
+{
+    MPILayer mpiLayer(communicator);
+    int hit = mpiLayer.broadcast(int(found), 0);
+    if (!hit) {
+        return false;
+    }
+
+    // parameter names are sent as one block, separated by '\0':
+    std::vector<char> simulator(entry->simulator.begin(), entry->simulator.end());
+    std::vector<char> names;
+    std::vector<double> values;
+    for (std::map<std::string, double>::const_iterator i = entry->values.begin(); i != entry->values.end(); ++i) {
+        names.insert(names.end(), i->first.begin(), i->first.end());
+        names << '\0';
+        values << i->second;
+    }
+    values << entry->fitness;
+
+    mpiLayer.broadcastVector(&simulator, 0);
+    mpiLayer.broadcastVector(&names, 0);
+    mpiLayer.broadcastVector(&values, 0);
+
+    entry->simulator = std::string(simulator.begin(), simulator.end());
+    entry->values.clear();
+    std::vector<char>::iterator name = names.begin();
+    for (std::size_t i = 0; i < (values.size() - 1); ++i) {
+        std::vector<char>::iterator end = std::find(name, names.end(), '\0');
+        entry->values[std::string(name, end)] = values[i];
+        name = end + 1;
+    }
+    entry->fitness = values.back();
+
+    return true;
+}
+#endif
+
 }
 
 #endif
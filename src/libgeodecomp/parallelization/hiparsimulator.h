@@ -9,17 +9,255 @@
 #include <libgeodecomp/geometry/partitions/ptscotchunstructuredpartition.h>
 #include <libgeodecomp/geometry/partitions/unstructuredstripingpartition.h>
 #include <libgeodecomp/geometry/partitions/distributedptscotchunstructuredpartition.h>
+#include <libgeodecomp/io/logger.h>
+#include <libgeodecomp/loadbalancer/imbalancemonitor.h>
 #include <libgeodecomp/loadbalancer/loadbalancer.h>
+#include <libgeodecomp/misc/scopedtimer.h>
 #include <libgeodecomp/misc/sharedptr.h>
 #include <libgeodecomp/parallelization/hierarchicalsimulator.h>
+#include <libgeodecomp/parallelization/nesting/ghostzonewidthmodel.h>
 #include <libgeodecomp/parallelization/nesting/parallelwriteradapter.h>
 #include <libgeodecomp/parallelization/nesting/steereradapter.h>
 #include <libgeodecomp/parallelization/nesting/mpiupdategroup.h>
 #include <cmath>
+#include <set>
 #include <stdexcept>
 
 namespace LibGeoDecomp {
 
+namespace HiParSimulatorHelpers {
+
+/**
+ * Forwards all patches up to (and including) nano step "barrier" to
+ * the wrapped PatchAccepter and hides all later requests. This way a
+ * Stepper can't satisfy requests of IO adapters ahead of time (as it
+ * does for the rim) if we intend to replace it at "barrier".
+ */
+template<typename GRID_TYPE>
+class GatedPatchAccepter : public PatchAccepter<GRID_TYPE>
+{
+public:
+    typedef typename SharedPtr<PatchAccepter<GRID_TYPE> >::Type PatchAccepterPtr;
+    using PatchAccepter<GRID_TYPE>::infinity;
+
+    GatedPatchAccepter(const PatchAccepterPtr& delegate, std::size_t barrier) :
+        delegate(delegate),
+        barrier(barrier)
+    {}
+
+    virtual void put(
+        const GRID_TYPE& grid,
+        const Region<GRID_TYPE::DIM>& validRegion,
+        const Coord<GRID_TYPE::DIM>& globalGridDimensions,
+        const std::size_t nanoStep,
+        const std::size_t rank)
+    {
+        if (nanoStep <= barrier) {
+            delegate->put(grid, validRegion, globalGridDimensions, nanoStep, rank);
+        }
+    }
+
+    virtual void setRegion(const Region<GRID_TYPE::DIM>& region)
+    {
+        delegate->setRegion(region);
+    }
+
+    virtual std::size_t nextRequiredNanoStep() const
+    {
+        std::size_t ret = delegate->nextRequiredNanoStep();
+        return (ret <= barrier) ? ret : infinity();
+    }
+
+private:
+    PatchAccepterPtr delegate;
+    std::size_t barrier;
+};
+
+/**
+ * Counterpart of GatedPatchAccepter for PatchProviders (i.e.
+ * steerers). The barrier is exclusive as the replacement Stepper
+ * will query all providers once more during its initialization.
+ */
+template<typename GRID_TYPE>
+class GatedPatchProvider : public PatchProvider<GRID_TYPE>
+{
+public:
+    typedef typename SharedPtr<PatchProvider<GRID_TYPE> >::Type PatchProviderPtr;
+    using PatchProvider<GRID_TYPE>::infinity;
+
+    GatedPatchProvider(const PatchProviderPtr& delegate, std::size_t barrier) :
+        delegate(delegate),
+        barrier(barrier)
+    {}
+
+    virtual void setRegion(const Region<GRID_TYPE::DIM>& region)
+    {
+        delegate->setRegion(region);
+    }
+
+    virtual void get(
+        GRID_TYPE *destinationGrid,
+        const Region<GRID_TYPE::DIM>& patchableRegion,
+        const Coord<GRID_TYPE::DIM>& globalGridDimensions,
+        const std::size_t nanoStep,
+        const std::size_t rank,
+        const bool remove = true)
+    {
+        if (nanoStep < barrier) {
+            delegate->get(destinationGrid, patchableRegion, globalGridDimensions, nanoStep, rank, remove);
+        }
+    }
+
+    virtual std::size_t nextAvailableNanoStep() const
+    {
+        std::size_t ret = delegate->nextAvailableNanoStep();
+        return (ret < barrier) ? ret : infinity();
+    }
+
+private:
+    PatchProviderPtr delegate;
+    std::size_t barrier;
+};
+
+/**
+ * Copies the own region of a Stepper at a given nano step. Needs to
+ * be registered for both, the ghost zone and the inner set, as
+ * the Stepper hands out the rim and the inner set separately.
+ */
+template<typename GRID_TYPE>
+class SnapshotAccepter : public PatchAccepter<GRID_TYPE>
+{
+public:
+    typedef typename GRID_TYPE::CellType CellType;
+    typedef typename SerializationBuffer<CellType>::BufferType BufferType;
+    static const int DIM = GRID_TYPE::DIM;
+
+    using PatchAccepter<GRID_TYPE>::pushRequest;
+
+    explicit SnapshotAccepter(std::size_t nanoStep)
+    {
+        pushRequest(nanoStep);
+    }
+
+    virtual void setRegion(const Region<DIM>& newRegion)
+    {
+        region = newRegion;
+    }
+
+    virtual void put(
+        const GRID_TYPE& grid,
+        const Region<DIM>& validRegion,
+        const Coord<DIM>& globalGridDimensions,
+        const std::size_t /* unused: nanoStep */,
+        const std::size_t /* unused: rank */)
+    {
+        if (!snapshot) {
+            snapshot.reset(new GRID_TYPE(region, CellType(), grid.getEdge(), globalGridDimensions));
+        }
+
+        BufferType buffer = SerializationBuffer<CellType>::create(validRegion);
+        grid.saveRegion(&buffer, validRegion);
+        snapshot->loadRegion(buffer, validRegion);
+    }
+
+    const Region<DIM>& getRegion() const
+    {
+        return region;
+    }
+
+    const typename SharedPtr<GRID_TYPE>::Type& getSnapshot() const
+    {
+        return snapshot;
+    }
+
+private:
+    Region<DIM> region;
+    typename SharedPtr<GRID_TYPE>::Type snapshot;
+};
+
+/**
+ * Restarts a simulation from a snapshot of the own region (see
+ * SnapshotAccepter) plus ghost zone fragments received from
+ * neighboring nodes. All other queries are forwarded to the original
+ * Initializer.
+ */
+template<typename CELL, typename GRID_TYPE>
+class SnapshotInitializer : public Initializer<CELL>
+{
+public:
+    typedef typename Initializer<CELL>::AdjacencyPtr AdjacencyPtr;
+    typedef typename SharedPtr<Initializer<CELL> >::Type InitPtr;
+    typedef typename SerializationBuffer<CELL>::BufferType BufferType;
+    typedef std::vector<std::pair<Region<GRID_TYPE::DIM>, BufferType> > FragmentVec;
+    static const int DIM = GRID_TYPE::DIM;
+
+    SnapshotInitializer(
+        const InitPtr& delegate,
+        unsigned startStep,
+        const SnapshotAccepter<GRID_TYPE>& snapshot,
+        const FragmentVec& fragments) :
+        delegate(delegate),
+        myStartStep(startStep),
+        ownRegion(snapshot.getRegion()),
+        snapshot(snapshot.getSnapshot()),
+        fragments(fragments)
+    {}
+
+    virtual void grid(GridBase<CELL, DIM> *target)
+    {
+        target->setEdge(snapshot->getEdge());
+
+        Region<DIM> ownPart = target->boundingRegion() & ownRegion;
+        BufferType buffer = SerializationBuffer<CELL>::create(ownPart);
+        snapshot->saveRegion(&buffer, ownPart);
+        target->loadRegion(buffer, ownPart);
+
+        for (typename FragmentVec::const_iterator i = fragments.begin(); i != fragments.end(); ++i) {
+            target->loadRegion(i->second, i->first);
+        }
+    }
+
+    virtual CoordBox<DIM> gridBox()
+    {
+        return delegate->gridBox();
+    }
+
+    virtual Coord<DIM> gridDimensions() const
+    {
+        return delegate->gridDimensions();
+    }
+
+    virtual unsigned startStep() const
+    {
+        return myStartStep;
+    }
+
+    virtual unsigned maxSteps() const
+    {
+        return delegate->maxSteps();
+    }
+
+    virtual AdjacencyPtr getAdjacency(const Region<DIM>& region) const
+    {
+        return delegate->getAdjacency(region);
+    }
+
+    virtual AdjacencyPtr getReverseAdjacency(const Region<DIM>& region) const
+    {
+        const AdjacencyManufacturer<DIM>& manufacturer = *delegate;
+        return manufacturer.getReverseAdjacency(region);
+    }
+
+private:
+    InitPtr delegate;
+    unsigned myStartStep;
+    Region<DIM> ownRegion;
+    typename SharedPtr<GRID_TYPE>::Type snapshot;
+    FragmentVec fragments;
+};
+
+}
+
 /**
  * The HiParSimulator implements our hierarchical parallelization
  * algorithm which delivers best-of-breed latency hiding (wide ghost
@@ -29,6 +267,11 @@ namespace LibGeoDecomp {
  * inter-node or inter-NUMA-domain communication and OpenMP and/or
  * CUDA for local paralelism.
  *
+ * The optimal ghost zone width depends on the network's latency and
+ * bandwidth, the cost of updating a cell and the shape of the
+ * subdomains. See enableGhostZoneWidthTuning() for how to let the
+ * simulator choose it at runtime.
+ *
  * fixme: check if code runs with a communicator which is merely a subset of MPI_COMM_WORLD
  */
 template<
@@ -70,14 +313,78 @@ public:
             enableFineGrainedParallelism),
         balancer(balancer),
         ghostZoneWidth(ghostZoneWidth),
+        maxGhostZoneWidth(0),
+        tuningMeasurementSteps(0),
+        tuningNanoStep(-1),
         mpiLayer(communicator)
     {}
 
+    /**
+     * Lets the simulator pick the ghost zone width on its own: during
+     * the first measurementSteps time steps (rounded up to the next
+     * load balancing event) it runs with the width passed to the
+     * c-tor and measures the time required for updating cells. At
+     * the following load balancing event it probes the latency and
+     * bandwidth to its neighbors and evaluates a GhostZoneWidthModel
+     * for all widths up to maxGhostZoneWidth. All nodes then switch
+     * to the width that's best for the slowest node by rebuilding
+     * their UpdateGroup from a snapshot of the current state.
+     *
+     * Needs to be called before run() or step(). Writers and
+     * steerers are handed over to the new UpdateGroup, so they'll
+     * observe each step exactly once, just as without tuning.
+     */
+    inline void enableGhostZoneWidthTuning(
+        unsigned maxGhostZoneWidth = 8,
+        unsigned measurementSteps = 10)
+    {
+        if (updateGroup) {
+            throw std::logic_error("ghost zone width tuning needs to be enabled before the simulation starts");
+        }
+        if (maxGhostZoneWidth == 0) {
+            throw std::invalid_argument("maxGhostZoneWidth needs to be at least 1");
+        }
+
+        this->maxGhostZoneWidth = maxGhostZoneWidth;
+        tuningMeasurementSteps = (std::max)(measurementSteps, 1u);
+    }
+
+    inline unsigned getGhostZoneWidth() const
+    {
+        return ghostZoneWidth;
+    }
+
+    /**
+     * Lets an ImbalanceMonitor check the load distribution at every
+     * load balancing event (see there for threshold and patience).
+     * The timings are exchanged in the background while the
+     * simulation proceeds to the next event. Consistently slow ranks
+     * and recommended rebalancing are reported as warnings, the
+     * monitor is accessible via getImbalanceMonitor(). The last
+     * exchange is completed once the simulation has reached its
+     * final step.
+     *
+     * As HiParSimulator can't yet repartition a running simulation,
+     * recommendations don't trigger the LoadBalancer.
+     */
+    inline void enableImbalanceMonitoring(
+        double threshold = 1.2,
+        unsigned patience = 3)
+    {
+        imbalanceMonitor.reset(new ImbalanceMonitor(threshold, patience, mpiLayer.communicator()));
+    }
+
+    inline const ImbalanceMonitor *getImbalanceMonitor() const
+    {
+        return imbalanceMonitor.get();
+    }
+
     inline void run()
     {
         initSimulation();
 
         nanoStep(timeToLastEvent());
+        finishImbalanceMonitoring();
     }
 
     inline void step()
@@ -85,6 +392,9 @@ public:
         initSimulation();
 
         nanoStep(NANO_STEPS);
+        if (getStep() >= initializer->maxSteps()) {
+            finishImbalanceMonitoring();
+        }
     }
 
     virtual unsigned getStep() const
@@ -145,8 +455,16 @@ public:
 
     std::vector<Chronometer> gatherStatistics()
     {
-        Chronometer stats = chronometer + updateGroup->statistics();
-        return mpiLayer.gather(stats, 0);
+        return mpiLayer.gather(currentStatistics(), 0);
+    }
+
+    virtual Chronometer currentStatistics() const
+    {
+        if (!updateGroup) {
+            return chronometer;
+        }
+
+        return chronometer + updateGroup->statistics();
     }
 
 private:
@@ -154,10 +472,22 @@ private:
     using DistributedSimulator<CELL_TYPE>::steerers;
     using DistributedSimulator<CELL_TYPE>::writers;
 
+    typedef typename UpdateGroupType::GridType StepperGridType;
+    typedef typename SerializationBuffer<CELL_TYPE>::BufferType BufferType;
+    typedef HiParSimulatorHelpers::SnapshotAccepter<StepperGridType> SnapshotAccepterType;
+    typedef HiParSimulatorHelpers::SnapshotInitializer<CELL_TYPE, StepperGridType> SnapshotInitializerType;
+    typedef typename PartitionManager<Topology>::RegionVecMap RegionVecMap;
+
     SharedPtr<LoadBalancer>::Type balancer;
     unsigned ghostZoneWidth;
+    unsigned maxGhostZoneWidth;
+    unsigned tuningMeasurementSteps;
+    long tuningNanoStep;
     MPILayer mpiLayer;
     typename SharedPtr<UpdateGroupType>::Type updateGroup;
+    typename SharedPtr<PARTITION>::Type partition;
+    typename SharedPtr<SnapshotAccepterType>::Type snapshotAccepter;
+    SharedPtr<ImbalanceMonitor>::Type imbalanceMonitor;
 
     typename UpdateGroupType::PatchProviderVec steererAdaptersGhost;
     typename UpdateGroupType::PatchProviderVec steererAdaptersInner;
@@ -201,7 +531,7 @@ private:
             box.dimensions.prod(),
             rankSpeeds);
 
-        typename SharedPtr<PARTITION>::Type partition(
+        partition.reset(
             new PARTITION(
                 box.origin,
                 box.dimensions,
@@ -209,26 +539,97 @@ private:
                 weights,
                 initializer->getAdjacency(globalRegion)));
 
+        long startNanoStep = long(initializer->startStep()) * NANO_STEPS;
+        long lastNanoStep = long(initializer->maxSteps()) * NANO_STEPS;
+        long period = this->loadBalancingPeriod;
+        long measurementNanoSteps = long(tuningMeasurementSteps) * NANO_STEPS;
+        tuningNanoStep = startNanoStep + (measurementNanoSteps + period - 1) / period * period;
+
+        if ((maxGhostZoneWidth == 0) || (tuningNanoStep >= lastNanoStep)) {
+            tuningNanoStep = -1;
+            resetUpdateGroup(
+                initializer,
+                writerAdaptersGhost,
+                writerAdaptersInner,
+                steererAdaptersGhost,
+                steererAdaptersInner);
+
+            writerAdaptersGhost.clear();
+            writerAdaptersInner.clear();
+            steererAdaptersGhost.clear();
+            steererAdaptersInner.clear();
+        } else {
+            // the adapters are gated so that the UpdateGroup can't
+            // feed them with data beyond the switch-over step
+            // (tuningNanoStep). The ungated adapters are handed to
+            // its successor.
+            typename UpdateGroupType::PatchAccepterVec gatedWritersGhost;
+            typename UpdateGroupType::PatchAccepterVec gatedWritersInner;
+            typename UpdateGroupType::PatchProviderVec gatedSteerersGhost;
+            typename UpdateGroupType::PatchProviderVec gatedSteerersInner;
+            gate(writerAdaptersGhost,  &gatedWritersGhost);
+            gate(writerAdaptersInner,  &gatedWritersInner);
+            gate(steererAdaptersGhost, &gatedSteerersGhost);
+            gate(steererAdaptersInner, &gatedSteerersInner);
+
+            snapshotAccepter.reset(new SnapshotAccepterType(tuningNanoStep));
+            gatedWritersGhost.push_back(snapshotAccepter);
+            gatedWritersInner.push_back(snapshotAccepter);
+
+            resetUpdateGroup(
+                initializer,
+                gatedWritersGhost,
+                gatedWritersInner,
+                gatedSteerersGhost,
+                gatedSteerersInner);
+            // the original adapters are retained for the rebuild
+        }
+
+        initEvents();
+    }
+
+    inline void resetUpdateGroup(
+        typename UpdateGroupType::InitPtr init,
+        const typename UpdateGroupType::PatchAccepterVec& newWriterAdaptersGhost,
+        const typename UpdateGroupType::PatchAccepterVec& newWriterAdaptersInner,
+        const typename UpdateGroupType::PatchProviderVec& newSteererAdaptersGhost,
+        const typename UpdateGroupType::PatchProviderVec& newSteererAdaptersInner)
+    {
         updateGroup.reset(
             new UpdateGroupType(
                 partition,
-                box,
+                initializer->gridBox(),
                 ghostZoneWidth,
-                initializer,
+                init,
                 static_cast<STEPPER*>(0),
-                writerAdaptersGhost,
-                writerAdaptersInner,
-                steererAdaptersGhost,
-                steererAdaptersInner,
+                newWriterAdaptersGhost,
+                newWriterAdaptersInner,
+                newSteererAdaptersGhost,
+                newSteererAdaptersInner,
                 enableFineGrainedParallelism,
                 mpiLayer.communicator()));
+    }
 
-        writerAdaptersGhost.clear();
-        writerAdaptersInner.clear();
-        steererAdaptersGhost.clear();
-        steererAdaptersInner.clear();
+    inline void gate(
+        const typename UpdateGroupType::PatchAccepterVec& source,
+        typename UpdateGroupType::PatchAccepterVec *target)
+    {
+        for (std::size_t i = 0; i < source.size(); ++i) {
+            target->push_back(
+                typename UpdateGroupType::PatchAccepterPtr(
+                    new HiParSimulatorHelpers::GatedPatchAccepter<StepperGridType>(source[i], tuningNanoStep)));
+        }
+    }
 
-        initEvents();
+    inline void gate(
+        const typename UpdateGroupType::PatchProviderVec& source,
+        typename UpdateGroupType::PatchProviderVec *target)
+    {
+        for (std::size_t i = 0; i < source.size(); ++i) {
+            target->push_back(
+                typename UpdateGroupType::PatchProviderPtr(
+                    new HiParSimulatorHelpers::GatedPatchProvider<StepperGridType>(source[i], tuningNanoStep)));
+        }
     }
 
     inline long currentNanoStep() const
@@ -239,6 +640,15 @@ private:
 
     inline void balanceLoad()
     {
+        if (currentNanoStep() == tuningNanoStep) {
+            tuneGhostZoneWidth();
+        }
+
+        if (imbalanceMonitor) {
+            monitorImbalance();
+            return;
+        }
+
         if (mpiLayer.rank() == 0) {
             if (!balancer) {
                 return;
@@ -250,6 +660,265 @@ private:
             // fixme: actually balance the load!
         }
     }
+
+    /**
+     * Evaluates the timings posted at the previous load balancing
+     * event and posts the current ones, so the exchange overlaps with
+     * the time steps until the next event.
+     */
+    inline void monitorImbalance()
+    {
+        if (imbalanceMonitor->evaluate()) {
+            std::vector<int> slowRanks = imbalanceMonitor->slowRanks();
+            bool rebalance = imbalanceMonitor->rebalancingRecommended();
+
+            if ((mpiLayer.rank() == 0) && !slowRanks.empty()) {
+                LOG(WARN, "HiParSimulator at step " << updateGroup->currentStep().first
+                    << ": ranks " << slowRanks << " have been consistently slow, imbalance is "
+                    << imbalanceMonitor->imbalance());
+            }
+
+            if (rebalance) {
+                if (mpiLayer.rank() == 0) {
+                    LOG(WARN, "HiParSimulator at step " << updateGroup->currentStep().first
+                        << ": rebalancing recommended, imbalance is "
+                        << imbalanceMonitor->imbalance());
+                }
+                imbalanceMonitor->resetStrikes();
+            }
+        }
+
+        imbalanceMonitor->post(currentStatistics());
+    }
+
+    /**
+     * Completes the exchange posted at the last load balancing
+     * event, which must happen before MPI gets finalized.
+     */
+    inline void finishImbalanceMonitoring()
+    {
+        if (imbalanceMonitor) {
+            imbalanceMonitor->evaluate();
+        }
+    }
+
+    /**
+     * Evaluates the GhostZoneWidthModel for all candidate widths and
+     * restarts the UpdateGroup with the best one. The restart is done
+     * even if the width remains unchanged as the gated adapters of
+     * the current UpdateGroup won't accept any further data.
+     */
+    inline void tuneGhostZoneWidth()
+    {
+        // the current width may exceed the candidates, but we need
+        // its expansions to derive the cell update time:
+        unsigned maxWidth = (std::max)(ghostZoneWidth, maxGhostZoneWidth);
+        CoordBox<DIM> box = initializer->gridBox();
+        PartitionManager<Topology> partitionManager;
+        partitionManager.resetRegions(
+            initializer,
+            box,
+            partition,
+            mpiLayer.rank(),
+            maxWidth);
+        partitionManager.resetGhostZones(
+            mpiLayer.allGather(partitionManager.ownRegion().boundingBox()),
+            mpiLayer.allGather(partitionManager.ownExpandedRegion().boundingBox()));
+
+        const RegionVecMap& outerFragments = partitionManager.getOuterGhostZoneFragments();
+        const RegionVecMap& innerFragments = partitionManager.getInnerGhostZoneFragments();
+        std::set<int> neighbors;
+        for (typename RegionVecMap::const_iterator i = outerFragments.begin(); i != outerFragments.end(); ++i) {
+            neighbors << i->first;
+        }
+        for (typename RegionVecMap::const_iterator i = innerFragments.begin(); i != innerFragments.end(); ++i) {
+            neighbors << i->first;
+        }
+        neighbors.erase(PartitionManager<Topology>::OUTGROUP);
+
+        std::vector<std::size_t> expandedRegionSizes;
+        for (unsigned k = 0; k <= maxWidth; ++k) {
+            expandedRegionSizes << partitionManager.ownRegion(k).size();
+        }
+
+        std::vector<double> costs = localGhostZoneWidthCosts(neighbors, outerFragments, expandedRegionSizes);
+        std::vector<double> globalCosts(costs.size());
+        MPI_Allreduce(&costs[0], &globalCosts[0], costs.size(), MPI_DOUBLE, MPI_MAX, mpiLayer.communicator());
+        unsigned newGhostZoneWidth = GhostZoneWidthModel::optimum(globalCosts, ghostZoneWidth);
+
+        if (mpiLayer.rank() == 0) {
+            LOG(INFO, "HiParSimulator switching ghost zone width from " << ghostZoneWidth
+                << " to " << newGhostZoneWidth << ", predicted time per nano step: "
+                << globalCosts[newGhostZoneWidth - 1] << "s");
+        }
+
+        typename SnapshotInitializerType::FragmentVec fragments =
+            exchangeGhostZoneFragments(
+                *snapshotAccepter->getSnapshot(),
+                neighbors,
+                outerFragments,
+                innerFragments,
+                newGhostZoneWidth);
+        typename UpdateGroupType::InitPtr snapshotInitializer(
+            new SnapshotInitializerType(
+                initializer,
+                tuningNanoStep / NANO_STEPS,
+                *snapshotAccepter,
+                fragments));
+
+        chronometer += updateGroup->statistics();
+        // the old UpdateGroup needs to be torn down first as its
+        // PatchLinks will wait for pending transmissions:
+        updateGroup.reset();
+        snapshotAccepter.reset();
+        ghostZoneWidth = newGhostZoneWidth;
+
+        resetUpdateGroup(
+            snapshotInitializer,
+            writerAdaptersGhost,
+            writerAdaptersInner,
+            steererAdaptersGhost,
+            steererAdaptersInner);
+
+        writerAdaptersGhost.clear();
+        writerAdaptersInner.clear();
+        steererAdaptersGhost.clear();
+        steererAdaptersInner.clear();
+    }
+
+    /**
+     * Returns the predicted time per nano step for ghost zone widths
+     * 1 to maxGhostZoneWidth. The cell update time is derived from
+     * the current UpdateGroup, latency and bandwidth are measured by
+     * exchanging messages with all neighbors.
+     */
+    inline std::vector<double> localGhostZoneWidthCosts(
+        const std::set<int>& neighbors,
+        const RegionVecMap& outerFragments,
+        const std::vector<std::size_t>& expandedRegionSizes)
+    {
+        const Chronometer& stats = updateGroup->statistics();
+        double computeTime =
+            stats.interval<TimeComputeInner>() +
+            stats.interval<TimeComputeGhost>();
+        long nanoSteps = tuningNanoStep - long(initializer->startStep()) * NANO_STEPS;
+        // a model with unit cell update time and no communication
+        // yields the number of cells updated per nano step:
+        double cellsPerNanoStep = GhostZoneWidthModel(1, 0, 0, 0).timePerNanoStep(
+            ghostZoneWidth, expandedRegionSizes, 0, 0);
+        double cellUpdateTime = computeTime / (nanoSteps * (std::max)(cellsPerNanoStep, 1.0));
+
+        std::size_t largestFragment = 1;
+        for (typename RegionVecMap::const_iterator i = outerFragments.begin(); i != outerFragments.end(); ++i) {
+            if (i->first != PartitionManager<Topology>::OUTGROUP) {
+                largestFragment = (std::max)(largestFragment, i->second.back().size());
+            }
+        }
+        // both ends of each link need to agree on the message size:
+        unsigned long localMessageSize = largestFragment * sizeof(CELL_TYPE);
+        unsigned long largeMessage;
+        MPI_Allreduce(&localMessageSize, &largeMessage, 1, MPI_UNSIGNED_LONG, MPI_MAX, mpiLayer.communicator());
+
+        double latency = 0;
+        double bandwidth = 0;
+        if (!neighbors.empty()) {
+            double timeSmall = pingNeighbors(neighbors, 1);
+            double timeLarge = pingNeighbors(neighbors, largeMessage);
+            latency = timeSmall / neighbors.size();
+            if (timeLarge > timeSmall) {
+                bandwidth = neighbors.size() * (largeMessage - 1) / (timeLarge - timeSmall);
+            }
+        }
+
+        GhostZoneWidthModel model(cellUpdateTime, latency, bandwidth, sizeof(CELL_TYPE));
+        std::vector<double> costs;
+        for (unsigned width = 1; width <= maxGhostZoneWidth; ++width) {
+            std::size_t messages = 0;
+            std::size_t ghostCells = 0;
+            for (typename RegionVecMap::const_iterator i = outerFragments.begin(); i != outerFragments.end(); ++i) {
+                if ((i->first != PartitionManager<Topology>::OUTGROUP) && !i->second[width].empty()) {
+                    ++messages;
+                    ghostCells += i->second[width].size();
+                }
+            }
+
+            costs << model.timePerNanoStep(width, expandedRegionSizes, messages, ghostCells);
+        }
+
+        return costs;
+    }
+
+    /**
+     * Returns the average time for simultaneously exchanging
+     * messages of the given size with all neighbors.
+     */
+    inline double pingNeighbors(const std::set<int>& neighbors, std::size_t bytes)
+    {
+        const int repeats = 10;
+        std::vector<char> sendBuffer(bytes);
+        std::vector<std::vector<char> > recvBuffers(neighbors.size(), std::vector<char>(bytes));
+
+        double startTime = ScopedTimer::time();
+        for (int i = 0; i < repeats; ++i) {
+            std::size_t index = 0;
+            for (std::set<int>::const_iterator n = neighbors.begin(); n != neighbors.end(); ++n, ++index) {
+                mpiLayer.recv(&recvBuffers[index][0], *n, bytes, MPILayer::GHOST_ZONE_WIDTH_TUNING, MPI_CHAR);
+                mpiLayer.send(&sendBuffer[0],         *n, bytes, MPILayer::GHOST_ZONE_WIDTH_TUNING, MPI_CHAR);
+            }
+            mpiLayer.wait(MPILayer::GHOST_ZONE_WIDTH_TUNING);
+        }
+
+        return (ScopedTimer::time() - startTime) / repeats;
+    }
+
+    /**
+     * Sends those parts of the snapshot to our neighbors which they
+     * need to fill their outer ghost zones for the new width and
+     * receives our outer ghost zone in turn.
+     */
+    inline typename SnapshotInitializerType::FragmentVec exchangeGhostZoneFragments(
+        const StepperGridType& snapshot,
+        const std::set<int>& neighbors,
+        const RegionVecMap& outerFragments,
+        const RegionVecMap& innerFragments,
+        unsigned width)
+    {
+        typename SnapshotInitializerType::FragmentVec ret;
+        std::vector<BufferType> sendBuffers;
+        ret.reserve(neighbors.size());
+        sendBuffers.reserve(neighbors.size());
+        MPI_Datatype datatype = SerializationBuffer<CELL_TYPE>::cellMPIDataType();
+
+        for (std::set<int>::const_iterator n = neighbors.begin(); n != neighbors.end(); ++n) {
+            typename RegionVecMap::const_iterator outer = outerFragments.find(*n);
+            if ((outer != outerFragments.end()) && !outer->second[width].empty()) {
+                const Region<DIM>& region = outer->second[width];
+                ret << std::make_pair(region, SerializationBuffer<CELL_TYPE>::create(region));
+                mpiLayer.recv(
+                    SerializationBuffer<CELL_TYPE>::getData(ret.back().second),
+                    *n,
+                    ret.back().second.size(),
+                    MPILayer::GHOST_ZONE_WIDTH_TUNING,
+                    datatype);
+            }
+
+            typename RegionVecMap::const_iterator inner = innerFragments.find(*n);
+            if ((inner != innerFragments.end()) && !inner->second[width].empty()) {
+                const Region<DIM>& region = inner->second[width];
+                sendBuffers << SerializationBuffer<CELL_TYPE>::create(region);
+                snapshot.saveRegion(&sendBuffers.back(), region);
+                mpiLayer.send(
+                    SerializationBuffer<CELL_TYPE>::getData(sendBuffers.back()),
+                    *n,
+                    sendBuffers.back().size(),
+                    MPILayer::GHOST_ZONE_WIDTH_TUNING,
+                    datatype);
+            }
+        }
+
+        mpiLayer.wait(MPILayer::GHOST_ZONE_WIDTH_TUNING);
+        return ret;
+    }
 };
 
 }
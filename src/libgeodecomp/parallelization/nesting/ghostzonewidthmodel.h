@@ -0,0 +1,118 @@
+#ifndef LIBGEODECOMP_PARALLELIZATION_NESTING_GHOSTZONEWIDTHMODEL_H
+#define LIBGEODECOMP_PARALLELIZATION_NESTING_GHOSTZONEWIDTHMODEL_H
+
+#include <cstddef>
+#include <stdexcept>
+#include <vector>
+
+namespace LibGeoDecomp {
+
+/**
+ * Performance model for choosing the ghost zone width of a Stepper.
+ * Wider ghost zones reduce the number of synchronizations (and thus
+ * messages) by a factor of the width, but the cells in the ghost
+ * zone need to be updated redundantly on both sides, and the
+ * messages grow.
+ *
+ * For a width w, one synchronization cycle spans w nano steps. In
+ * that time each of the m neighbors sends us its part of the outer
+ * ghost zone (G(w) cells in total), and the ghost zone is updated
+ * redundantly while it shrinks by one layer per nano step. Given
+ * the number of cells E(k) of the own region expanded by k layers,
+ * the expected time per nano step is
+ *
+ *   t(w) = c * (E(0) + sum_{k=1}^{w-1} (E(k) - E(0)) / w) +
+ *          (m * latency + G(w) * cellSize / bandwidth) / w
+ *
+ * with c being the time to update a single cell. Latency and
+ * bandwidth are per message, concurrent transmissions to different
+ * neighbors are assumed to be serialized, which makes the model
+ * slightly pessimistic w.r.t. communication.
+ */
+class GhostZoneWidthModel
+{
+public:
+    /**
+     * cellUpdateTime, latency and bandwidth are expected in seconds,
+     * seconds and bytes per second, cellSize in bytes.
+     */
+    inline GhostZoneWidthModel(
+        double cellUpdateTime,
+        double latency,
+        double bandwidth,
+        std::size_t cellSize) :
+        cellUpdateTime(cellUpdateTime),
+        latency(latency),
+        bandwidth(bandwidth),
+        cellSize(cellSize)
+    {}
+
+    /**
+     * Returns the average time per nano step for ghost zone width
+     * "width". expandedRegionSizes[k] needs to hold the number of
+     * cells of the own region, expanded by k layers, for all k <
+     * width. messages and ghostCells refer to the transmissions
+     * required per synchronization.
+     */
+    inline double timePerNanoStep(
+        unsigned width,
+        const std::vector<std::size_t>& expandedRegionSizes,
+        std::size_t messages,
+        std::size_t ghostCells) const
+    {
+        if ((width == 0) || (expandedRegionSizes.size() < width)) {
+            throw std::invalid_argument("GhostZoneWidthModel needs region sizes for all expansions below width");
+        }
+
+        double ownCells = expandedRegionSizes[0];
+        double redundantCells = 0;
+        for (unsigned k = 1; k < width; ++k) {
+            redundantCells += expandedRegionSizes[k] - ownCells;
+        }
+
+        double computeTime = cellUpdateTime * (ownCells + redundantCells / width);
+        double communicationTime = messages * latency;
+        if (bandwidth > 0) {
+            communicationTime += ghostCells * cellSize / bandwidth;
+        }
+
+        return computeTime + communicationTime / width;
+    }
+
+    /**
+     * Returns the width (i.e. index + 1) with the lowest cost. Ties
+     * are resolved in favor of currentWidth to avoid needless
+     * reconfigurations, and then in favor of smaller widths.
+     */
+    static unsigned optimum(const std::vector<double>& costs, unsigned currentWidth)
+    {
+        if (costs.empty()) {
+            throw std::invalid_argument("GhostZoneWidthModel can't pick optimum from empty cost vector");
+        }
+
+        unsigned best = 0;
+        for (unsigned i = 1; i < costs.size(); ++i) {
+            if (costs[i] < costs[best]) {
+                best = i;
+            }
+        }
+
+        if ((currentWidth > 0) &&
+            (currentWidth <= costs.size()) &&
+            (costs[currentWidth - 1] <= costs[best])) {
+            return currentWidth;
+        }
+
+        return best + 1;
+    }
+
+private:
+    double cellUpdateTime;
+    double latency;
+    double bandwidth;
+    std::size_t cellSize;
+};
+
+}
+
+#endif
@@ -87,7 +87,7 @@ private:
                 region,
                 target,
                 MPILayer::PATCH_LINK,
-                SerializationBuffer<CELL_TYPE>::cellMPIDataType(),
+                GhostZoneSerializationBuffer<CELL_TYPE>::cellMPIDataType(),
                 mpiLayer.communicator()));
 
     }
@@ -99,7 +99,7 @@ private:
                 region,
                 source,
                 MPILayer::PATCH_LINK,
-                SerializationBuffer<CELL_TYPE>::cellMPIDataType(),
+                GhostZoneSerializationBuffer<CELL_TYPE>::cellMPIDataType(),
                 mpiLayer.communicator()));
     }
 };
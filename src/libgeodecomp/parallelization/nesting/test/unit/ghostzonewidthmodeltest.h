@@ -0,0 +1,76 @@
+#include <cxxtest/TestSuite.h>
+#include <libgeodecomp/misc/stdcontaineroverloads.h>
+#include <libgeodecomp/parallelization/nesting/ghostzonewidthmodel.h>
+
+using namespace LibGeoDecomp;
+
+namespace LibGeoDecomp {
+
+class GhostZoneWidthModelTest : public CxxTest::TestSuite
+{
+public:
+    void setUp()
+    {
+        // a 100x100 subdomain with neighbors on all four sides:
+        expandedSizes.clear();
+        for (int k = 0; k < 10; ++k) {
+            expandedSizes << std::size_t((100 + 2 * k) * (100 + 2 * k));
+        }
+    }
+
+    void testTimePerNanoStep()
+    {
+        GhostZoneWidthModel model(1e-8, 1e-5, 1e9, 8);
+
+        // w = 1: no redundant updates, 4 messages with 404 cells
+        double expected = 1e-8 * 10000 + 4 * 1e-5 + 404 * 8 / 1e9;
+        TS_ASSERT_DELTA(expected, model.timePerNanoStep(1, expandedSizes, 4, 404), 1e-15);
+
+        // w = 2: 404 redundant cells every other step, messages
+        // twice as large, but only every other step
+        expected = 1e-8 * (10000 + 404 / 2.0) + (4 * 1e-5 + 816 * 8 / 1e9) / 2;
+        TS_ASSERT_DELTA(expected, model.timePerNanoStep(2, expandedSizes, 4, 816), 1e-15);
+
+        TS_ASSERT_THROWS(model.timePerNanoStep(0,  expandedSizes, 4, 0), std::invalid_argument&);
+        TS_ASSERT_THROWS(model.timePerNanoStep(11, expandedSizes, 4, 0), std::invalid_argument&);
+    }
+
+    void testLatencyBoundFavorsWideGhostZones()
+    {
+        GhostZoneWidthModel cheapNetwork(1e-8, 1e-7, 1e10, 8);
+        GhostZoneWidthModel slowNetwork( 1e-8, 1e-5, 1e10, 8);
+
+        TS_ASSERT_EQUALS(1u, GhostZoneWidthModel::optimum(costs(cheapNetwork), 1));
+        TS_ASSERT_LESS_THAN(1u, GhostZoneWidthModel::optimum(costs(slowNetwork), 1));
+        TS_ASSERT_LESS_THAN(
+            GhostZoneWidthModel::optimum(costs(slowNetwork), 1),
+            GhostZoneWidthModel::optimum(costs(GhostZoneWidthModel(1e-9, 1e-3, 1e10, 8)), 1));
+    }
+
+    void testOptimumPrefersCurrentWidthOnTies()
+    {
+        std::vector<double> costs;
+        costs << 3.0 << 1.0 << 2.0 << 1.0;
+        TS_ASSERT_EQUALS(2u, GhostZoneWidthModel::optimum(costs, 1));
+        TS_ASSERT_EQUALS(4u, GhostZoneWidthModel::optimum(costs, 4));
+        TS_ASSERT_EQUALS(2u, GhostZoneWidthModel::optimum(costs, 7));
+
+        TS_ASSERT_THROWS(GhostZoneWidthModel::optimum(std::vector<double>(), 1), std::invalid_argument&);
+    }
+
+private:
+    std::vector<std::size_t> expandedSizes;
+
+    std::vector<double> costs(const GhostZoneWidthModel& model)
+    {
+        std::vector<double> ret;
+        for (unsigned w = 1; w <= 10; ++w) {
+            std::size_t ghostCells = expandedSizes[w - 1] + 4 * (100 + 2 * (w - 1)) + 4 - expandedSizes[0];
+            ret << model.timePerNanoStep(w, expandedSizes, 4, ghostCells);
+        }
+
+        return ret;
+    }
+};
+
+}
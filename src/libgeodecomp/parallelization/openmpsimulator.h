@@ -43,17 +43,25 @@ public:
     using SerialSimulator<CELL_TYPE>::gridDim;
 
     /**
-     * creates a OpenMPSimulator with the given initializer.
+     * creates a OpenMPSimulator with the given initializer. By
+     * default rows are scheduled dynamically among threads.
+     * enableStaticScheduling trades load balance for lower
+     * scheduling overhead, enableFineGrainedParallelism splits rows
+     * into chunks (see APITraits::HasThreadedUpdate) and only applies
+     * to dynamic scheduling.
      */
     explicit OpenMPSimulator(
         Initializer<CELL_TYPE> *initializer,
-        bool enableFineGrainedParallelism = false) :
+        bool enableFineGrainedParallelism = false,
+        bool enableStaticScheduling = false) :
         SerialSimulator<CELL_TYPE>(initializer),
-        enableFineGrainedParallelism(enableFineGrainedParallelism)
+        enableFineGrainedParallelism(enableFineGrainedParallelism),
+        enableStaticScheduling(enableStaticScheduling)
     {}
 
 protected:
     bool enableFineGrainedParallelism;
+    bool enableStaticScheduling;
 
     void nanoStep(unsigned nanoStep)
     {
@@ -67,7 +75,7 @@ protected:
             *curGrid,
             newGrid,
             nanoStep,
-            UpdateFunctorHelpers::ConcurrencyEnableOpenMP(true, enableFineGrainedParallelism));
+            UpdateFunctorHelpers::ConcurrencyEnableOpenMP(!enableStaticScheduling, enableFineGrainedParallelism));
         swap(curGrid, newGrid);
     }
 
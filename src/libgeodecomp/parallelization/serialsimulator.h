@@ -5,11 +5,19 @@
 #include <libgeodecomp/misc/apitraits.h>
 
 #include <libgeodecomp/communication/hpxserializationwrapper.h>
+#include <libgeodecomp/io/analyzer.h>
 #include <libgeodecomp/io/writer.h>
+#include <libgeodecomp/misc/sharedptr.h>
 #include <libgeodecomp/parallelization/monolithicsimulator.h>
 #include <libgeodecomp/storage/gridtypeselector.h>
 #include <libgeodecomp/storage/updatefunctor.h>
 
+#ifdef LIBGEODECOMP_WITH_THREADS
+#include <omp.h>
+#endif
+
+#include <algorithm>
+
 namespace LibGeoDecomp {
 
 /**
@@ -30,6 +38,8 @@ public:
     typedef typename APITraits::SelectSoA<CELL_TYPE>::Value SupportsSoA;
     typedef typename GridTypeSelector<CELL_TYPE, Topology, false, SupportsSoA>::Value GridType;
     typedef typename Steerer<CELL_TYPE>::SteererFeedback SteererFeedback;
+    typedef typename SharedPtr<Analyzer<CELL_TYPE> >::Type AnalyzerPtr;
+    typedef std::vector<AnalyzerPtr> AnalyzerVector;
 
     static const int DIM = Topology::DIM;
 
@@ -46,7 +56,9 @@ public:
      * creates a SerialSimulator with the given initializer.
      */
     explicit SerialSimulator(Initializer<CELL_TYPE> *initializer) :
-        MonolithicSimulator<CELL_TYPE>(initializer)
+        MonolithicSimulator<CELL_TYPE>(initializer),
+        analysisPending(false),
+        analysisStep(0)
     {
         stepNum = initializer->startStep();
         Coord<DIM> dim = initializer->gridBox().dimensions;
@@ -77,10 +89,19 @@ public:
     {
         TimeTotal t(&chronometer);
 
+        if (steerersDue()) {
+            // Steerers may modify the grid which the Analyzers are
+            // waiting for:
+            flushAnalyzers();
+        }
         handleInput(STEERER_NEXT_STEP, feedback);
 
         for (unsigned i = 0; i < NANO_STEPS; ++i) {
-            nanoStep(i);
+            if ((i == 0) && analysisPending) {
+                nanoStepWithAnalysis();
+            } else {
+                nanoStep(i);
+            }
         }
 
         ++stepNum;
@@ -90,6 +111,7 @@ public:
             event = WRITER_ALL_DONE;
         }
         handleOutput(event);
+        scheduleAnalyzers(event == WRITER_ALL_DONE);
     }
 
     /**
@@ -99,11 +121,13 @@ public:
     {
         initializer->grid(curGrid);
         stepNum = initializer->startStep();
+        analysisPending = false;
         setIORegions();
 
         SteererFeedback feedback;
         handleInput(STEERER_INITIALIZED, &feedback);
         handleOutput(WRITER_INITIALIZED);
+        scheduleAnalyzers(false);
 
         for (; stepNum < initializer->maxSteps();) {
             if (feedback.simulationEnded()) {
@@ -113,6 +137,7 @@ public:
             step(&feedback);
         }
 
+        flushAnalyzers();
         handleInput(STEERER_ALL_DONE, &feedback);
     }
 
@@ -124,10 +149,37 @@ public:
         return curGrid;
     }
 
+    /**
+     * Analyzers are run on the grid of every period-th step. With
+     * threading enabled they're deferred and run on an additional
+     * thread while the first nano step of the following step is
+     * being computed. Call flushAnalyzers() when driving the
+     * Simulator via step() to make sure the last step gets
+     * analyzed, too.
+     */
+    void addAnalyzer(Analyzer<CELL_TYPE> *analyzer)
+    {
+        analyzers.push_back(AnalyzerPtr(analyzer));
+    }
+
+    /**
+     * Runs pending Analyzers synchronously.
+     */
+    void flushAnalyzers()
+    {
+        if (analysisPending) {
+            analysisPending = false;
+            runAnalyzers(*curGrid, analysisStep);
+        }
+    }
+
 protected:
     GridType *curGrid;
     GridType *newGrid;
     Region<DIM> simArea;
+    AnalyzerVector analyzers;
+    bool analysisPending;
+    unsigned analysisStep;
 
     virtual void nanoStep(unsigned nanoStep)
     {
@@ -138,6 +190,83 @@ protected:
         swap(curGrid, newGrid);
     }
 
+    /**
+     * The update only reads from curGrid, so the Analyzers can work
+     * on it concurrently. They need to be done before the next nano
+     * step overwrites it.
+     */
+    void nanoStepWithAnalysis()
+    {
+        const GridType *analysisGrid = curGrid;
+        analysisPending = false;
+
+#ifdef LIBGEODECOMP_WITH_THREADS
+        // nanoStep() may open its own parallel region (see
+        // OpenMPSimulator), which would otherwise be serialized:
+        int maxActiveLevels = omp_get_max_active_levels();
+        omp_set_max_active_levels((std::max)(maxActiveLevels, 2));
+
+#pragma omp parallel sections num_threads(2)
+        {
+#pragma omp section
+            nanoStep(0);
+#pragma omp section
+            runAnalyzers(*analysisGrid, analysisStep);
+        }
+
+        omp_set_max_active_levels(maxActiveLevels);
+#else
+        runAnalyzers(*analysisGrid, analysisStep);
+        nanoStep(0);
+#endif
+    }
+
+    void runAnalyzers(const GridType& grid, unsigned step)
+    {
+        for (typename AnalyzerVector::iterator i = analyzers.begin(); i != analyzers.end(); ++i) {
+            if ((step % (*i)->getPeriod()) == 0) {
+                (*i)->analyze(grid, simArea, step);
+            }
+        }
+    }
+
+    /**
+     * Marks the current grid for analysis. Without threading there
+     * is nothing to overlap with, so the Analyzers are run right
+     * away.
+     */
+    void scheduleAnalyzers(bool lastStep)
+    {
+        bool due = false;
+        for (typename AnalyzerVector::iterator i = analyzers.begin(); i != analyzers.end(); ++i) {
+            due |= (getStep() % (*i)->getPeriod()) == 0;
+        }
+        if (!due) {
+            return;
+        }
+
+        analysisPending = true;
+        analysisStep = getStep();
+
+#ifndef LIBGEODECOMP_WITH_THREADS
+        lastStep = true;
+#endif
+        if (lastStep) {
+            flushAnalyzers();
+        }
+    }
+
+    bool steerersDue() const
+    {
+        for (unsigned i = 0; i < steerers.size(); ++i) {
+            if ((stepNum % steerers[i]->getPeriod()) == 0) {
+                return true;
+            }
+        }
+
+        return false;
+    }
+
     /**
      * notifies all registered Writers
      */
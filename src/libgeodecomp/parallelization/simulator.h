@@ -97,6 +97,16 @@ public:
      */
     virtual std::vector<Chronometer> gatherStatistics() = 0;
 
+    /**
+     * Returns the histogram of the local rank only. As opposed to
+     * gatherStatistics() this doesn't involve any communication, so
+     * it may be called at any time, e.g. from within a Writer.
+     */
+    virtual Chronometer currentStatistics() const
+    {
+        return chronometer;
+    }
+
 protected:
     Chronometer chronometer;
     unsigned stepNum;
@@ -0,0 +1,100 @@
+#include <cxxtest/TestSuite.h>
+#include <libgeodecomp/communication/mpilayer.h>
+#include <libgeodecomp/misc/patternoptimizer.h>
+#include <libgeodecomp/misc/simfabtestmodel.h>
+#include <libgeodecomp/misc/tempfile.h>
+#include <libgeodecomp/parallelization/autotuningsimulator.h>
+#include <cstdio>
+
+using namespace LibGeoDecomp;
+
+namespace LibGeoDecomp {
+
+class AutoTuningSimulatorTest : public CxxTest::TestSuite
+{
+public:
+    void setUp()
+    {
+        dim = Coord<3>(25, 25, 25);
+        maxSteps = 20;
+        filename = TempFile::serial("tuningdatabase");
+    }
+
+    void tearDown()
+    {
+        remove(filename.c_str());
+    }
+
+    void testCacheHitOnRootIsUsedEverywhere()
+    {
+#ifdef LIBGEODECOMP_WITH_CPP14
+        AutoTuningSimulator<SimFabTestCell, PatternOptimizer> ats(
+            new SimFabTestInitializer(dim, maxSteps));
+        ats.enableDistributedTuning(MPI_COMM_WORLD);
+
+        if (MPILayer().rank() == 0) {
+            TuningDatabase db(filename);
+            db.store(ats.tuningKey(), TuningDatabase::Entry("SerialSimulator", -0.125));
+        }
+
+        ats.setTuningDatabase(filename);
+        ats.run();
+
+        TS_ASSERT_EQUALS(-0.125, ats.getSimulation("SerialSimulator")->fitness);
+#endif
+    }
+
+    void testCacheHitOnOtherRanksIsIgnored()
+    {
+#ifdef LIBGEODECOMP_WITH_CPP14
+        AutoTuningSimulator<SimFabTestCell, PatternOptimizer> ats(
+            new SimFabTestInitializer(dim, maxSteps));
+        ats.enableDistributedTuning(MPI_COMM_WORLD);
+
+        if (MPILayer().rank() != 0) {
+            TuningDatabase db(filename);
+            db.store(ats.tuningKey(), TuningDatabase::Entry("SerialSimulator", -0.125));
+        }
+
+        ats.setTuningDatabase(filename);
+        ats.prepareSimulations();
+
+        std::string best;
+        TS_ASSERT(!ats.loadTuningResult(&best));
+#endif
+    }
+
+    void testBroadcastTuningResult()
+    {
+#ifdef LIBGEODECOMP_WITH_CPP14
+        AutoTuningSimulator<SimFabTestCell, PatternOptimizer> ats(
+            new SimFabTestInitializer(dim, maxSteps));
+        ats.enableDistributedTuning(MPI_COMM_WORLD);
+
+        TuningDatabase::Entry expected("CacheBlockingSimulator", -0.5);
+        expected.values["pipelineLength"] = 3;
+        expected.values["wavefrontDim"] = 12;
+
+        TuningDatabase::Entry entry;
+        bool found = false;
+        if (MPILayer().rank() == 0) {
+            entry = expected;
+            found = true;
+        }
+
+        TS_ASSERT(ats.broadcastTuningResult(found, &entry));
+        TS_ASSERT_EQUALS(expected, entry);
+
+        entry = TuningDatabase::Entry();
+        TS_ASSERT(!ats.broadcastTuningResult(false, &entry));
+        TS_ASSERT_EQUALS(TuningDatabase::Entry(), entry);
+#endif
+    }
+
+private:
+    Coord<3> dim;
+    unsigned maxSteps;
+    std::string filename;
+};
+
+}
@@ -0,0 +1,4 @@
+#include <libgeodecomp/misc/allocationcounter.h>
+
+// lets the tests of this executable check that code doesn't allocate:
+LIBGEODECOMP_COUNT_HEAP_ALLOCATIONS()
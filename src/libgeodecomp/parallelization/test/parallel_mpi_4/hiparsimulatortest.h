@@ -9,6 +9,7 @@
 #include <libgeodecomp/io/testinitializer.h>
 #include <libgeodecomp/io/unstructuredtestinitializer.h>
 #include <libgeodecomp/loadbalancer/mockbalancer.h>
+#include <libgeodecomp/misc/allocationcounter.h>
 #include <libgeodecomp/misc/nonpodtestcell.h>
 #include <libgeodecomp/misc/testcell.h>
 #include <libgeodecomp/misc/testhelper.h>
@@ -195,6 +196,109 @@ public:
         TS_ASSERT_EQUALS(*events, expected);
     }
 
+    void testGhostZoneWidthTuning()
+    {
+        SharedPtr<MockSteererType::EventsStore>::Type steererEvents(new MockSteererType::EventsStore);
+        sim->addSteerer(new MockSteererType(1, steererEvents));
+        sim->addWriter(new AccumulatingWriter());
+        sim->enableGhostZoneWidthTuning(4, 10);
+        sim->run();
+
+        TS_ASSERT_LESS_THAN_EQUALS(1u, sim->getGhostZoneWidth());
+        TS_ASSERT_LESS_THAN_EQUALS(sim->getGhostZoneWidth(), 4u);
+
+        MemoryWriterType::GridMap& grids = memoryWriter->getGrids();
+        for (unsigned t = firstStep; t < maxSteps; t += outputPeriod) {
+            TS_ASSERT_TEST_GRID(
+                MemoryWriterType::GridType,
+                grids[t],
+                t * NANO_STEPS);
+        }
+        TS_ASSERT_TEST_GRID(
+            MemoryWriterType::GridType,
+            grids[maxSteps],
+            maxSteps * NANO_STEPS);
+
+        sim.reset();
+
+        MockWriter<>::EventsStore expectedWriterEvents;
+        MockSteererType::EventsStore expectedSteererEvents;
+        typedef MockSteererType::Event SteererEvent;
+        expectedWriterEvents << MockWriter<>::Event(20, WRITER_INITIALIZED, rank, false)
+                             << MockWriter<>::Event(20, WRITER_INITIALIZED, rank, true);
+        expectedSteererEvents << SteererEvent(20, STEERER_INITIALIZED, rank, false)
+                              << SteererEvent(20, STEERER_INITIALIZED, rank, true);
+        for (unsigned t = firstStep + 1; t < maxSteps; ++t) {
+            expectedWriterEvents << MockWriter<>::Event(t, WRITER_STEP_FINISHED, rank, false)
+                                 << MockWriter<>::Event(t, WRITER_STEP_FINISHED, rank, true);
+            expectedSteererEvents << SteererEvent(t, STEERER_NEXT_STEP, rank, false)
+                                  << SteererEvent(t, STEERER_NEXT_STEP, rank, true);
+        }
+        expectedWriterEvents << MockWriter<>::Event(101, WRITER_ALL_DONE, rank, false)
+                             << MockWriter<>::Event(101, WRITER_ALL_DONE, rank, true)
+                             << MockWriter<>::Event(-1,  WRITER_ALL_DONE, -1,   true);
+        expectedSteererEvents << SteererEvent(101, STEERER_ALL_DONE, rank, false)
+                              << SteererEvent(101, STEERER_ALL_DONE, rank, true)
+                              << SteererEvent(-1,  STEERER_ALL_DONE, -1,   true);
+
+        TS_ASSERT_EQUALS(expectedWriterEvents,  *events);
+        TS_ASSERT_EQUALS(expectedSteererEvents, *steererEvents);
+    }
+
+    void testImbalanceMonitoring()
+    {
+        // any imbalance will lead to a recommendation:
+        sim->enableImbalanceMonitoring(1.0, 1);
+        sim->run();
+
+        // load balancing events occur at steps 51 and 82, timings
+        // posted at the first one are evaluated at the second one,
+        // the last exchange is completed at the end of run():
+        const ImbalanceMonitor *monitor = sim->getImbalanceMonitor();
+        TS_ASSERT(!monitor->pending());
+        TS_ASSERT_EQUALS(2u, monitor->evaluations());
+        TS_ASSERT_LESS_THAN_EQUALS(1.0, monitor->imbalance());
+        TS_ASSERT_EQUALS(std::size_t(4), monitor->loads().size());
+
+        // recommendations are only logged:
+        TS_ASSERT_EQUALS("", MockBalancer::events);
+
+        MemoryWriterType::GridMap& grids = memoryWriter->getGrids();
+        TS_ASSERT_TEST_GRID(
+            MemoryWriterType::GridType,
+            grids[maxSteps],
+            maxSteps * NANO_STEPS);
+    }
+
+    void testStepsDontAllocate()
+    {
+        // no writers and no load balancer, as these may allocate:
+        SimulatorType sim(
+            new TestInitializer<TestCell<2> >(dim, maxSteps, firstStep),
+            0,
+            loadBalancingPeriod,
+            ghostZoneWidth);
+
+        // the first ghost zone cycle fills the buffers of all patch
+        // accepters and providers. The next one ends before the load
+        // balancing event at step 51, which may allocate:
+        for (unsigned i = 0; i < ghostZoneWidth; ++i) {
+            sim.step();
+        }
+        Chronometer before = sim.currentStatistics();
+        std::size_t allocations = AllocationCounter::allocations();
+
+        for (unsigned i = 0; i < ghostZoneWidth; ++i) {
+            sim.step();
+        }
+        TS_ASSERT_EQUALS(firstStep + 2 * ghostZoneWidth, sim.getStep());
+
+        TS_ASSERT_EQUALS(allocations, AllocationCounter::allocations());
+        TS_ASSERT_EQUALS(
+            before.allocations<TimeTotal>(),
+            sim.currentStatistics().allocations<TimeTotal>());
+    }
+
     void testSteererFunctionalityBasic()
     {
         sim->addSteerer(new TestSteererType(5, 25, 4711 * 27));
@@ -7,7 +7,9 @@
 #include <libgeodecomp/misc/simplexoptimizer.h>
 #include <libgeodecomp/misc/simulationfactory.h>
 #include <libgeodecomp/misc/simulationparameters.h>
+#include <libgeodecomp/misc/tempfile.h>
 #include <libgeodecomp/parallelization/autotuningsimulator.h>
+#include <cstdio>
 #include <sstream>
 
 using namespace LibGeoDecomp;
@@ -149,7 +151,7 @@ public:
             new SimFabTestInitializer(dim, maxSteps));
         ats.simulations.clear();
         ats.addSimulation(
-            "SerialSimulation",
+            "SerialSimulator",
             SerialSimulationFactory<SimFabTestCell>(ats.varStepInitializer));
         std::ostringstream buf;
         ats.addWriter(static_cast<Writer<SimFabTestCell> *>(new TracingWriter<SimFabTestCell>(1, 100, 0, buf)));
@@ -157,6 +159,32 @@ public:
 #endif
     }
 
+    void testCachedTuningResultSkipsTuning()
+    {
+#ifdef LIBGEODECOMP_WITH_CPP14
+        std::string filename = TempFile::serial("tuningdatabase");
+        AutoTuningSimulator<SimFabTestCell, PatternOptimizer> ats(
+            new SimFabTestInitializer(dim, maxSteps));
+        TuningDatabase::Key key = ats.tuningKey();
+        TS_ASSERT_EQUALS(dim.toString(), key.dimensions);
+
+        {
+            TuningDatabase db(filename);
+            db.store(key, TuningDatabase::Entry("SerialSimulator", -0.125));
+        }
+
+        ats.setTuningDatabase(filename);
+        ats.run();
+
+        // cached fitness is retained if tuning was skipped:
+        TS_ASSERT_EQUALS(-0.125, ats.getSimulation("SerialSimulator")->fitness);
+        TuningDatabase::Entry entry;
+        TS_ASSERT(TuningDatabase(filename).lookup(key, &entry));
+        TS_ASSERT_EQUALS(-0.125, entry.fitness);
+        remove(filename.c_str());
+#endif
+    }
+
 private:
     Coord<3> dim;
     unsigned maxSteps;
@@ -1,6 +1,7 @@
 #include <cxxtest/TestSuite.h>
 #include <sstream>
 #include <libgeodecomp/io/writer.h>
+#include <libgeodecomp/io/histogramanalyzer.h>
 #include <libgeodecomp/io/memorywriter.h>
 #include <libgeodecomp/io/mockinitializer.h>
 #include <libgeodecomp/io/mockwriter.h>
@@ -9,6 +10,7 @@
 #include <libgeodecomp/io/teststeerer.h>
 #include <libgeodecomp/io/testwriter.h>
 #include <libgeodecomp/io/unstructuredtestinitializer.h>
+#include <libgeodecomp/misc/allocationcounter.h>
 #include <libgeodecomp/misc/stringops.h>
 #include <libgeodecomp/misc/testcell.h>
 #include <libgeodecomp/misc/testhelper.h>
@@ -72,6 +74,22 @@ public:
             init->maxSteps() * NANO_STEPS_2D);
     }
 
+    void testSteadyStateStepsDontAllocate()
+    {
+        simulator->step();
+        Chronometer before = simulator->currentStatistics();
+        std::size_t allocations = AllocationCounter::allocations();
+
+        for (int i = 0; i < 5; ++i) {
+            simulator->step();
+        }
+
+        TS_ASSERT_EQUALS(allocations, AllocationCounter::allocations());
+        TS_ASSERT_EQUALS(
+            before.allocations<TimeTotal>(),
+            simulator->currentStatistics().allocations<TimeTotal>());
+    }
+
     void testWriterInvocation()
     {
         unsigned period = 4;
@@ -236,6 +254,44 @@ public:
         TS_ASSERT_TEST_GRID(GridBaseType, *sim.getGrid(), 21 * NANO_STEPS_3D);
     }
 
+    void testAnalyzersSeeGridOfTheirStep()
+    {
+        typedef HistogramAnalyzer<TestCell<2>, unsigned> AnalyzerType;
+        AnalyzerType *analyzer = new AnalyzerType(&TestCell<2>::cycleCounter, 0, 1000, 4, 3);
+        simulator->addAnalyzer(analyzer);
+        simulator->run();
+
+        std::vector<unsigned> steps;
+        for (AnalyzerType::ResultMap::const_iterator i = analyzer->getResults().begin();
+             i != analyzer->getResults().end();
+             ++i) {
+            steps << i->first;
+
+            double expected = i->first * NANO_STEPS_2D;
+            TS_ASSERT_EQUALS(std::size_t(dim.prod()), i->second.count);
+            TS_ASSERT_EQUALS(expected, i->second.min);
+            TS_ASSERT_EQUALS(expected, i->second.max);
+        }
+
+        std::vector<unsigned> expectedSteps;
+        expectedSteps << 15 << 18 << 21;
+        TS_ASSERT_EQUALS(expectedSteps, steps);
+    }
+
+    void testAnalyzersWithSoA()
+    {
+        typedef HistogramAnalyzer<TestCellSoA, double> AnalyzerType;
+        SerialSimulator<TestCellSoA> sim(new TestInitializer<TestCellSoA>(Coord<3>(10, 5, 4), 5));
+        AnalyzerType *analyzer = new AnalyzerType(&TestCellSoA::testValue, 0, 1000, 4);
+        sim.addAnalyzer(analyzer);
+
+        sim.step();
+        sim.step();
+        sim.flushAnalyzers();
+        TS_ASSERT_EQUALS(std::size_t(2), analyzer->getResults().size());
+        TS_ASSERT_EQUALS(std::size_t(200), analyzer->getResults().find(2)->second.count);
+    }
+
     void testUnstructured()
     {
 #ifdef LIBGEODECOMP_WITH_CPP14
@@ -0,0 +1,121 @@
+#ifndef LIBGEODECOMP_STORAGE_BUFFERPOOL_H
+#define LIBGEODECOMP_STORAGE_BUFFERPOOL_H
+
+#include <libgeodecomp/storage/serializationbuffer.h>
+
+#include <utility>
+#include <vector>
+
+namespace LibGeoDecomp {
+
+/**
+ * Recycles transient SerializationBuffers (e.g. patches which are
+ * staged for a couple of nano steps, or messages which are built for
+ * each send). Released buffers are binned by capacity into
+ * power-of-two size classes, and acquire() hands out the smallest
+ * one which can hold the requested region. Once the pool has seen
+ * the largest buffer of each class that is in flight at the same
+ * time, it no longer allocates memory.
+ *
+ * A pool is not thread-safe, each owner (PatchAccepter,
+ * PatchProvider...) should keep its own.
+ */
+template<typename CELL>
+class BufferPool
+{
+public:
+    friend class BufferPoolTest;
+
+    typedef typename SerializationBuffer<CELL>::BufferType BufferType;
+    typedef typename SerializationBuffer<CELL>::ElementType ElementType;
+
+    template<typename REGION>
+    BufferType acquire(const REGION& region)
+    {
+        std::size_t size = SerializationBuffer<CELL>::storageSize(region);
+        if (size == 0) {
+            return BufferType();
+        }
+
+        std::size_t sizeClass = ceilLog2(size);
+
+        for (std::size_t i = sizeClass; i < bins.size(); ++i) {
+            if (!bins[i].empty()) {
+                BufferType ret = std::move(bins[i].back());
+                bins[i].pop_back();
+                ret.resize(size);
+                return ret;
+            }
+        }
+
+        std::size_t capacity = std::size_t(1) << sizeClass;
+        BufferType ret;
+        ret.reserve(capacity);
+        ret.resize(size);
+        return ret;
+    }
+
+    void release(BufferType&& buffer)
+    {
+        if (buffer.capacity() == 0) {
+            return;
+        }
+
+        // each buffer in bin i can hold at least 2^i elements:
+        std::size_t sizeClass = floorLog2(buffer.capacity());
+        if (sizeClass >= bins.size()) {
+            bins.resize(sizeClass + 1);
+        }
+
+        bins[sizeClass].push_back(std::move(buffer));
+    }
+
+    /**
+     * Number of buffers available for recycling.
+     */
+    std::size_t size() const
+    {
+        std::size_t ret = 0;
+        for (std::size_t i = 0; i < bins.size(); ++i) {
+            ret += bins[i].size();
+        }
+
+        return ret;
+    }
+
+    /**
+     * Frees all pooled buffers.
+     */
+    void clear()
+    {
+        bins.clear();
+    }
+
+private:
+    std::vector<std::vector<BufferType> > bins;
+
+    static std::size_t floorLog2(std::size_t n)
+    {
+        std::size_t ret = 0;
+        while (n > 1) {
+            n >>= 1;
+            ++ret;
+        }
+
+        return ret;
+    }
+
+    static std::size_t ceilLog2(std::size_t n)
+    {
+        std::size_t ret = floorLog2(n);
+        if ((std::size_t(1) << ret) < n) {
+            ++ret;
+        }
+
+        return ret;
+    }
+};
+
+}
+
+#endif
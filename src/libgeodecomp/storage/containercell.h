@@ -7,8 +7,133 @@
 #include <libgeodecomp/geometry/stencils.h>
 #include <libgeodecomp/storage/neighborhoodadapter.h>
 
+#include <algorithm>
+#include <stdexcept>
+#include <vector>
+
 namespace LibGeoDecomp {
 
+namespace ContainerCellHelpers {
+
+/**
+ * Cargo without APITraits::HasMigration never moves, so its
+ * containers don't need an outbox. Being empty, this base class
+ * doesn't add to the size of ContainerCell.
+ */
+template<typename CARGO, std::size_t SIZE, typename KEY, int DIM, typename HAS_MIGRATION = void>
+class Outbox
+{
+public:
+    static const bool ENABLED = false;
+
+    inline void resetOutbox()
+    {}
+
+    inline void recordMigration(const KEY& id, const CARGO& cargo)
+    {}
+
+    inline std::size_t numOutgoing() const
+    {
+        return 0;
+    }
+
+    inline const KEY *outgoingIDs() const
+    {
+        return 0;
+    }
+
+    inline const Coord<DIM> *outgoingTargets() const
+    {
+        return 0;
+    }
+
+    inline bool isInDomain() const
+    {
+        return true;
+    }
+
+    template<class ARCHIVE>
+    inline void serializeOutbox(ARCHIVE& ar)
+    {}
+};
+
+/**
+ * Records the entities which were marked for migration during the
+ * last update.
+ */
+template<typename CARGO, std::size_t SIZE, typename KEY, int DIM>
+class Outbox<CARGO, SIZE, KEY, DIM, typename CARGO::API::SupportsMigration>
+{
+public:
+    static const bool ENABLED = true;
+
+    inline Outbox() :
+        numOutgoingEntities(0),
+        inDomain(false)
+    {}
+
+    inline void resetOutbox()
+    {
+        numOutgoingEntities = 0;
+        inDomain = true;
+    }
+
+    inline void recordMigration(const KEY& id, const CARGO& cargo)
+    {
+        Coord<DIM> target = cargo.migrationTarget();
+        if (target == Coord<DIM>()) {
+            return;
+        }
+
+        for (int d = 0; d < DIM; ++d) {
+            if ((target[d] < -1) || (target[d] > 1)) {
+                throw std::logic_error("ContainerCell migration target is not a neighboring container");
+            }
+        }
+
+        ids[numOutgoingEntities] = id;
+        targets[numOutgoingEntities] = target;
+        ++numOutgoingEntities;
+    }
+
+    inline std::size_t numOutgoing() const
+    {
+        return numOutgoingEntities;
+    }
+
+    inline const KEY *outgoingIDs() const
+    {
+        return ids;
+    }
+
+    inline const Coord<DIM> *outgoingTargets() const
+    {
+        return targets;
+    }
+
+    inline bool isInDomain() const
+    {
+        return inDomain;
+    }
+
+    template<class ARCHIVE>
+    inline void serializeOutbox(ARCHIVE& ar)
+    {
+        ar & ids & targets & numOutgoingEntities & inDomain;
+    }
+
+private:
+    KEY ids[SIZE];
+    Coord<DIM> targets[SIZE];
+    std::size_t numOutgoingEntities;
+    // containers outside of the simulation domain (e.g. a grid's edge
+    // cell) never get updated, this flag lets senders detect entities
+    // which would be lost in transit:
+    bool inDomain;
+};
+
+}
+
 /**
  * This class is useful for writing irregularly shaped codes with
  * LibGeoDecomp (e.g. meshfree or unstructured grids). It acts as an
@@ -16,12 +141,24 @@ namespace LibGeoDecomp {
  * structure of the model. Each entity of the model (of type CARGO)
  * needs to be assigned a unique KEY, which will be used for lookups.
  *
+ * Entities may move between neighboring containers, see
+ * APITraits::HasMigration. Migrations are applied in bulk at the
+ * beginning of the following update(), and as each container pulls
+ * its new entities from its neighbors, this works across rank
+ * boundaries, too. Entities which would migrate out of the
+ * simulation domain trigger an exception. Containers of cargo
+ * without migration support carry no outbox.
+ *
  * If your model doesn't access neighboring cells via IDs but rather
  * all neighbors within a certain radius, then BoxCell is a better
  * choice.
  */
 template<typename CARGO, std::size_t SIZE, typename KEY = int>
-class ContainerCell
+class ContainerCell : private ContainerCellHelpers::Outbox<
+    CARGO,
+    SIZE,
+    KEY,
+    APITraits::SelectTopology<CARGO>::Value::DIM>
 {
 public:
     friend class ContainerCellTest;
@@ -38,6 +175,8 @@ public:
     const static int DIM = Topology::DIM;
     const static std::size_t MAX_SIZE = SIZE;
 
+    typedef ContainerCellHelpers::Outbox<CARGO, SIZE, KEY, DIM> Outbox;
+
     template<
         // currently unused as we don't yet allow unstructed grid
         // codes to add cells to ContainerCells at runtime:
@@ -78,25 +217,39 @@ public:
             return;
         }
 
-        for (int i = numElements; i > offset; --i) {
-            cells[i] = cells[i - 1];
-            ids[i] = ids[i - 1];
-        }
+        std::copy_backward(cells + offset, cells + numElements, cells + numElements + 1);
+        std::copy_backward(ids   + offset, ids   + numElements, ids   + numElements + 1);
 
         cells[offset] = cell;
         ids[offset] = id;
         ++numElements;
     }
 
+    /**
+     * Inserts a whole batch of entities. The batch is sorted and
+     * then merged with the container's contents in a single pass,
+     * which is much cheaper than inserting the entities one by one.
+     * Just like insert(), this will overwrite entities with matching
+     * IDs.
+     */
+    template<typename KEY_ITERATOR, typename CARGO_ITERATOR>
+    inline void insert(KEY_ITERATOR idsBegin, KEY_ITERATOR idsEnd, CARGO_ITERATOR cellsBegin)
+    {
+        Batch batch;
+        for (; idsBegin != idsEnd; ++idsBegin, ++cellsBegin) {
+            batch.push_back(std::make_pair(*idsBegin, &*cellsBegin));
+        }
+
+        insertBatch(&batch);
+    }
+
     inline bool remove(const Key& id)
     {
         Cargo *pos = (*this)[id];
         if (pos) {
             int offset = pos - cells;
-            for (std::size_t i = offset; i < numElements - 1; ++i) {
-                cells[i] = cells[i + 1];
-                ids[i] = ids[i + 1];
-            }
+            std::copy(cells + offset + 1, cells + numElements, cells + offset);
+            std::copy(ids   + offset + 1, ids   + numElements, ids   + offset);
             --numElements;
             return true;
         }
@@ -104,6 +257,38 @@ public:
         return false;
     }
 
+    /**
+     * Removes all entities whose IDs are contained in the given
+     * range in a single pass and returns the number of entities
+     * actually removed. IDs not present in the container are
+     * ignored.
+     */
+    template<typename KEY_ITERATOR>
+    inline std::size_t remove(KEY_ITERATOR idsBegin, KEY_ITERATOR idsEnd)
+    {
+        std::vector<Key> doomed(idsBegin, idsEnd);
+        std::sort(doomed.begin(), doomed.end());
+        typename std::vector<Key>::iterator cursor = doomed.begin();
+
+        std::size_t target = 0;
+        for (std::size_t i = 0; i < numElements; ++i) {
+            cursor = std::lower_bound(cursor, doomed.end(), ids[i]);
+            if ((cursor != doomed.end()) && (*cursor == ids[i])) {
+                continue;
+            }
+
+            if (target != i) {
+                cells[target] = cells[i];
+                ids[target] = ids[i];
+            }
+            ++target;
+        }
+
+        std::size_t ret = numElements - target;
+        numElements = target;
+        return ret;
+    }
+
     inline Cargo *operator[](const Key& id)
     {
         Key *end = ids + numElements;
@@ -170,6 +355,7 @@ public:
         NeighborhoodAdapterType adapter(this, &neighbors);
 
         copyOver(neighbors[Coord<DIM>()], adapter, nanoStep);
+        applyMigrations(neighbors);
         updateCargo(adapter, nanoStep);
     }
 
@@ -187,8 +373,63 @@ public:
     template<class HOOD_ALL>
     inline void updateCargo(HOOD_ALL& allNeighbors, const int nanoStep)
     {
+        this->resetOutbox();
+
         for (std::size_t i = 0; i < numElements; ++i) {
             cells[i].update(allNeighbors, nanoStep);
+            this->recordMigration(ids[i], cells[i]);
+        }
+    }
+
+    /**
+     * Removes all entities which were marked for migration during
+     * the last update and pulls in those which neighboring
+     * containers have marked for migration to this one. This is
+     * separate from copyOver() as it needs access to all
+     * neighboring containers, not just the old self.
+     */
+    template<class HOOD>
+    inline void applyMigrations(const HOOD& neighbors)
+    {
+        if (!Outbox::ENABLED) {
+            return;
+        }
+
+        if (this->numOutgoing() > 0) {
+            for (std::size_t i = 0; i < this->numOutgoing(); ++i) {
+                // entities may have been removed since, e.g. by a Steerer:
+                if ((*this)[this->outgoingIDs()[i]] &&
+                    !neighbors[this->outgoingTargets()[i]].isInDomain()) {
+                    throw std::logic_error("ContainerCell entity migrated out of the simulation domain");
+                }
+            }
+
+            remove(this->outgoingIDs(), this->outgoingIDs() + this->numOutgoing());
+            this->resetOutbox();
+        }
+
+        Batch batch;
+        CoordBox<DIM> box(Coord<DIM>::diagonal(-1), Coord<DIM>::diagonal(3));
+        for (typename CoordBox<DIM>::Iterator i = box.begin(); i != box.end(); ++i) {
+            if (*i == Coord<DIM>()) {
+                continue;
+            }
+
+            const ContainerCell& source = neighbors[*i];
+            Coord<DIM> target = -*i;
+            for (std::size_t j = 0; j < source.numOutgoing(); ++j) {
+                if (source.outgoingTargets()[j] == target) {
+                    const Key& id = source.outgoingIDs()[j];
+                    const Cargo *cargo = source[id];
+                    if (cargo) {
+                        batch.push_back(std::make_pair(id, cargo));
+                    }
+                }
+            }
+        }
+
+        if (!batch.empty()) {
+            insertBatch(&batch);
         }
     }
 
@@ -196,6 +437,7 @@ public:
     void serialize(ARCHIVE& ar, unsigned)
     {
         ar & ids & cells & numElements;
+        this->serializeOutbox(ar);
     }
 
     inline const Key *getIDs() const
@@ -204,6 +446,7 @@ public:
     }
 
 private:
+    typedef std::vector<std::pair<Key, const Cargo*> > Batch;
 
     Key ids[SIZE];
     Cargo cells[SIZE];
@@ -215,6 +458,62 @@ private:
             throw std::logic_error("ContainerCell capacity exeeded");
         }
     }
+
+    static inline bool keyLessThan(
+        const typename Batch::value_type& a,
+        const typename Batch::value_type& b)
+    {
+        return a.first < b.first;
+    }
+
+    inline void insertBatch(Batch *batch)
+    {
+        // stable sort ensures that the last of several entities
+        // sharing the same ID wins, just as with repeated insert():
+        std::stable_sort(batch->begin(), batch->end(), keyLessThan);
+
+        Batch fresh;
+        std::vector<std::pair<Cargo*, const Cargo*> > overwrites;
+        for (std::size_t i = 0; i < batch->size(); ++i) {
+            const Key& id = (*batch)[i].first;
+            if (((i + 1) < batch->size()) && ((*batch)[i + 1].first == id)) {
+                continue;
+            }
+
+            Cargo *existing = (*this)[id];
+            if (existing) {
+                overwrites.push_back(std::make_pair(existing, (*batch)[i].second));
+            } else {
+                fresh.push_back((*batch)[i]);
+            }
+        }
+
+        if ((numElements + fresh.size()) > MAX_SIZE) {
+            throw std::logic_error("ContainerCell capacity exeeded");
+        }
+
+        for (std::size_t i = 0; i < overwrites.size(); ++i) {
+            *overwrites[i].first = *overwrites[i].second;
+        }
+
+        // merge from the back so that each element is moved at most once:
+        std::size_t target = numElements + fresh.size();
+        std::size_t source = numElements;
+        for (std::size_t i = fresh.size(); i > 0;) {
+            --target;
+            if ((source > 0) && (fresh[i - 1].first < ids[source - 1])) {
+                --source;
+                cells[target] = cells[source];
+                ids[target] = ids[source];
+            } else {
+                --i;
+                cells[target] = *fresh[i].second;
+                ids[target] = fresh[i].first;
+            }
+        }
+
+        numElements += fresh.size();
+    }
 };
 
 template<typename ARCHIVE, typename CARGO, std::size_t SIZE, typename KEY>
@@ -231,6 +231,15 @@ public:
         return message.str();
     }
 
+    const char *memberAddress(
+        const Selector<CELL_TYPE>& selector,
+        const Coord<DIM>& coord,
+        std::ptrdiff_t *stride) const
+    {
+        *stride = sizeof(CELL_TYPE);
+        return selector.memberAddress(&(*this)[coord]);
+    }
+
 protected:
     void saveMemberImplementation(
         char *target,
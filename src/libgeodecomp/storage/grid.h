@@ -7,6 +7,7 @@
 #include <libgeodecomp/geometry/region.h>
 #include <libgeodecomp/geometry/topologies.h>
 #include <libgeodecomp/io/logger.h>
+#include <libgeodecomp/misc/apitraits.h>
 #include <libgeodecomp/storage/coordmap.h>
 #include <libgeodecomp/storage/gridbase.h>
 #include <libgeodecomp/storage/selector.h>
@@ -37,7 +38,10 @@ public:
     using GridBase<CELL_TYPE, TOPOLOGY::DIM>::saveRegion;
 
     // always align on cache line boundaries
-    typedef typename std::vector<CELL_TYPE, LibFlatArray::aligned_allocator<CELL_TYPE, 64> > CellVector;
+    typedef typename APITraits::SelectAllocator<
+        CELL_TYPE,
+        LibFlatArray::aligned_allocator<CELL_TYPE, 64> >::Value Allocator;
+    typedef typename std::vector<CELL_TYPE, Allocator> CellVector;
     typedef TOPOLOGY Topology;
     typedef CELL_TYPE Cell;
     typedef CoordMap<CELL_TYPE, Grid<CELL_TYPE, TOPOLOGY> > CoordMapType;
@@ -263,6 +267,15 @@ public:
         }
     }
 
+    const char *memberAddress(
+        const Selector<CELL_TYPE>& selector,
+        const Coord<DIM>& coord,
+        std::ptrdiff_t *stride) const
+    {
+        *stride = sizeof(CELL_TYPE);
+        return selector.memberAddress(&(*this)[coord]);
+    }
+
 protected:
     void saveMemberImplementation(
         char *target,
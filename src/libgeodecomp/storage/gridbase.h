@@ -8,6 +8,8 @@
 #include <libgeodecomp/storage/memorylocation.h>
 #include <libgeodecomp/storage/selector.h>
 
+#include <cstddef>
+
 namespace LibGeoDecomp {
 
 namespace GridBaseHelpers {
@@ -260,6 +262,18 @@ public:
         loadMemberImplementation(reinterpret_cast<const char*>(source), sourceLocation, selector, region);
     }
 
+    /**
+     * Same as loadMember(), but sans the type checking.
+     */
+    void loadMemberUnchecked(
+        const char *source,
+        MemoryLocation::Location sourceLocation,
+        const Selector<CELL>& selector,
+        const Region<DIM>& region)
+    {
+        loadMemberImplementation(source, sourceLocation, selector, region);
+    }
+
     /**
      * Through this function the weights of the edges on unstructured
      * grids can be set. Unavailable on regular grids.
@@ -289,6 +303,22 @@ public:
         return region;
     }
 
+    /**
+     * Grants read-only access to a member of the cell at coord
+     * without copying: returns the member's address and stores the
+     * distance in bytes to the same member of the next cell along the
+     * x-axis in stride. The selector's filter is ignored. Grids which
+     * don't keep their cells in host memory with a fixed stride
+     * return 0, callers then need to fall back to saveMember().
+     */
+    virtual const char *memberAddress(
+        const Selector<CELL>& /* selector */,
+        const Coord<DIM>& /* coord */,
+        std::ptrdiff_t* /* stride */) const
+    {
+        return 0;
+    }
+
 protected:
     Coord<DIM> topoDimensions;
     Region<DIM> myBoundingRegion;
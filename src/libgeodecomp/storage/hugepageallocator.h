@@ -0,0 +1,168 @@
+#ifndef LIBGEODECOMP_STORAGE_HUGEPAGEALLOCATOR_H
+#define LIBGEODECOMP_STORAGE_HUGEPAGEALLOCATOR_H
+
+#include <libflatarray/aligned_allocator.hpp>
+#include <libgeodecomp/misc/allocationcounter.h>
+
+#include <new>
+
+#ifdef __linux__
+#include <sys/mman.h>
+#endif
+
+namespace LibGeoDecomp {
+
+/**
+ * Allocator for large, long-lived arrays such as the cell storage of
+ * grids (see APITraits::HasAllocator). Stencil sweeps over grids
+ * which span hundreds of MB touch a new 4 KB page every few hundred
+ * cells, so the TLB can't cover the working set and every sweep
+ * pays for page walks. Blocks of at least HUGE_PAGE_SIZE bytes are
+ * therefore mapped with huge pages: first we try explicit huge pages
+ * (MAP_HUGETLB, requires a pre-allocated pool, see
+ * /proc/sys/vm/nr_hugepages), then fall back to an anonymous mapping
+ * for which we request transparent huge pages via madvise(). The
+ * mappings are page aligned, which also satisfies ALIGNMENT.
+ *
+ * Smaller blocks, and all blocks on non-Linux systems, are served by
+ * LibFlatArray::aligned_allocator.
+ */
+template<class T, std::size_t ALIGNMENT = 64>
+class HugePageAllocator
+{
+public:
+    typedef std::ptrdiff_t difference_type;
+    typedef T* pointer;
+    typedef const T* const_pointer;
+    typedef T& reference;
+    typedef const T& const_reference;
+    typedef T value_type;
+    typedef std::size_t size_type;
+
+    static const std::size_t HUGE_PAGE_SIZE = 2 * 1024 * 1024;
+
+    template<typename OTHER>
+    struct rebind
+    {
+        typedef HugePageAllocator<OTHER, ALIGNMENT> other;
+    };
+
+    inline HugePageAllocator()
+    {}
+
+    template<typename OTHER>
+    inline HugePageAllocator(const HugePageAllocator<OTHER, ALIGNMENT>& /* other */)
+    {}
+
+    inline pointer address(reference x) const
+    {
+        return &x;
+    }
+
+    inline const_pointer address(const_reference x) const
+    {
+        return &x;
+    }
+
+    pointer allocate(std::size_t n, const void* = 0)
+    {
+        std::size_t bytes = n * sizeof(T);
+
+#ifdef __linux__
+        if (bytes >= HUGE_PAGE_SIZE) {
+            // mmap() bypasses operator new, see AllocationCounter:
+            AllocationCounter::count(bytes);
+            return static_cast<pointer>(mapHugePages(mappingSize(bytes)));
+        }
+#endif
+
+        return LibFlatArray::aligned_allocator<T, ALIGNMENT>().allocate(n);
+    }
+
+    void deallocate(pointer p, std::size_t n)
+    {
+        if (p == 0) {
+            return;
+        }
+
+#ifdef __linux__
+        std::size_t bytes = n * sizeof(T);
+        if (bytes >= HUGE_PAGE_SIZE) {
+            munmap(p, mappingSize(bytes));
+            return;
+        }
+#endif
+
+        LibFlatArray::aligned_allocator<T, ALIGNMENT>().deallocate(p, n);
+    }
+
+    std::size_t max_size() const throw()
+    {
+        return std::allocator<T>().max_size();
+    }
+
+    void construct(pointer p, const_reference val)
+    {
+        new (p) T(val);
+    }
+
+    void construct(pointer p)
+    {
+        new (p) T();
+    }
+
+    void destroy(pointer p)
+    {
+        p->~T();
+    }
+
+    bool operator!=(const HugePageAllocator& other) const
+    {
+        return !(*this == other);
+    }
+
+    bool operator==(const HugePageAllocator& /* other */) const
+    {
+        return true;
+    }
+
+private:
+    /**
+     * Explicit huge pages can only be unmapped as a whole, so we
+     * round up to full huge pages on both allocation and
+     * deallocation.
+     */
+    static std::size_t mappingSize(std::size_t bytes)
+    {
+        return (bytes + HUGE_PAGE_SIZE - 1) / HUGE_PAGE_SIZE * HUGE_PAGE_SIZE;
+    }
+
+#ifdef __linux__
+    static void *mapHugePages(std::size_t length)
+    {
+        void *ret = MAP_FAILED;
+
+#ifdef MAP_HUGETLB
+        ret = mmap(0, length, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+#endif
+
+        if (ret == MAP_FAILED) {
+            ret = mmap(0, length, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+            if (ret == MAP_FAILED) {
+                throw std::bad_alloc();
+            }
+
+#ifdef MADV_HUGEPAGE
+            // only a hint, the kernel may have THP disabled:
+            madvise(ret, length, MADV_HUGEPAGE);
+#endif
+        }
+
+        return ret;
+    }
+#endif
+};
+
+}
+
+#endif
@@ -0,0 +1,137 @@
+#ifndef LIBGEODECOMP_STORAGE_MEMBERVIEW_H
+#define LIBGEODECOMP_STORAGE_MEMBERVIEW_H
+
+#include <libgeodecomp/geometry/region.h>
+#include <libgeodecomp/misc/apitraits.h>
+#include <libgeodecomp/storage/gridbase.h>
+#include <libgeodecomp/storage/selector.h>
+
+#include <cstddef>
+#include <vector>
+
+namespace LibGeoDecomp {
+
+/**
+ * Read-only access to one member of a contiguous run of cells. The
+ * stride is given in bytes, so this works for AoS (stride equals the
+ * cell's size) and SoA layouts (stride equals the member's size)
+ * alike.
+ */
+template<typename MEMBER>
+class MemberStreak
+{
+public:
+    MemberStreak(const char *base, std::ptrdiff_t stride, int length) :
+        base(base),
+        stride(stride),
+        length(length)
+    {}
+
+    inline const MEMBER& operator[](int i) const
+    {
+        return *reinterpret_cast<const MEMBER*>(base + i * stride);
+    }
+
+    inline int size() const
+    {
+        return length;
+    }
+
+    inline std::ptrdiff_t getStride() const
+    {
+        return stride;
+    }
+
+private:
+    const char *base;
+    std::ptrdiff_t stride;
+    int length;
+};
+
+/**
+ * Gives read-only access to a single member of all cells within a
+ * Region, e.g. for in-situ analysis (see Analyzer). Grids which
+ * support GridBase::memberAddress() (Grid, DisplacedGrid, SoAGrid)
+ * are accessed in place, all others are copied streak by streak via
+ * saveMember().
+ */
+template<typename CELL, typename MEMBER, int DIM = APITraits::SelectTopology<CELL>::Value::DIM>
+class MemberView
+{
+public:
+    typedef GridBase<CELL, DIM> GridType;
+
+    MemberView(
+        const GridType& grid,
+        MEMBER CELL:: *memberPointer,
+        const Region<DIM>& region) :
+        grid(&grid),
+        selector(memberPointer, "view"),
+        region(&region)
+    {}
+
+    /**
+     * Calls functor(streak, memberStreak) for each Streak of the
+     * Region, with memberStreak[i] referring to the member of the
+     * i-th cell of the Streak.
+     */
+    template<typename FUNCTOR>
+    void forEachStreak(FUNCTOR& functor) const
+    {
+        std::vector<MEMBER> buffer;
+
+        for (typename Region<DIM>::StreakIterator i = region->beginStreak(); i != region->endStreak(); ++i) {
+            std::ptrdiff_t stride = 0;
+            const char *address = grid->memberAddress(selector, i->origin, &stride);
+
+            if (address == 0) {
+                buffer.resize(i->length());
+                Region<DIM> streakRegion;
+                streakRegion << *i;
+                grid->saveMember(&buffer[0], MemoryLocation::HOST, selector, streakRegion);
+                address = reinterpret_cast<const char*>(&buffer[0]);
+                stride = sizeof(MEMBER);
+            }
+
+            functor(*i, MemberStreak<MEMBER>(address, stride, i->length()));
+        }
+    }
+
+    /**
+     * Calls functor(member) for all cells within the Region.
+     */
+    template<typename FUNCTOR>
+    void forEach(FUNCTOR& functor) const
+    {
+        ForEachAdapter<FUNCTOR> adapter(functor);
+        forEachStreak(adapter);
+    }
+
+private:
+    template<typename FUNCTOR>
+    class ForEachAdapter
+    {
+    public:
+        explicit ForEachAdapter(FUNCTOR& functor) :
+            functor(functor)
+        {}
+
+        void operator()(const Streak<DIM>& /* streak */, const MemberStreak<MEMBER>& members)
+        {
+            for (int i = 0; i < members.size(); ++i) {
+                functor(members[i]);
+            }
+        }
+
+    private:
+        FUNCTOR& functor;
+    };
+
+    const GridType *grid;
+    Selector<CELL> selector;
+    const Region<DIM> *region;
+};
+
+}
+
+#endif
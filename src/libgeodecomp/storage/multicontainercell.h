@@ -31,6 +31,49 @@ public:
     typedef Argument Value;
 };
 
+/**
+ * Presents one member of the cells in a neighborhood as if the
+ * neighborhood consisted of plain containers. This is what
+ * ContainerCell::applyMigrations() expects.
+ */
+template<typename CELL, typename CONTAINER, typename NEIGHBORHOOD>
+class MemberNeighborhood
+{
+public:
+    inline MemberNeighborhood(const NEIGHBORHOOD& hood, CONTAINER CELL:: *member) :
+        hood(hood),
+        member(member)
+    {}
+
+    template<int DIM>
+    inline const CONTAINER& operator[](const Coord<DIM>& coord) const
+    {
+        return hood[coord].*member;
+    }
+
+private:
+    const NEIGHBORHOOD& hood;
+    CONTAINER CELL:: *member;
+};
+
+/**
+ * Containers other than ContainerCell (e.g. BoxCell) move their
+ * entities on their own.
+ */
+template<typename CELL, typename CONTAINER, typename NEIGHBORHOOD>
+inline void applyMigrations(CONTAINER *container, const NEIGHBORHOOD& hood, CONTAINER CELL:: *member)
+{}
+
+template<typename CELL, typename CARGO, std::size_t SIZE, typename KEY, typename NEIGHBORHOOD>
+inline void applyMigrations(
+    ContainerCell<CARGO, SIZE, KEY> *container,
+    const NEIGHBORHOOD& hood,
+    ContainerCell<CARGO, SIZE, KEY> CELL:: *member)
+{
+    container->applyMigrations(
+        MemberNeighborhood<CELL, ContainerCell<CARGO, SIZE, KEY>, NEIGHBORHOOD>(hood, member));
+}
+
 }
 
 }
@@ -74,6 +117,12 @@ public:
         multiHood.LIBFLATARRAY_ELEM(1, MEMBER),                         \
         nanoStep);
 
+#define DECLARE_MULTI_CONTAINER_MIGRATE_MEMBER(INDEX, CELL, MEMBER)     \
+    LibGeoDecomp::MultiContainerCellHelpers::applyMigrations(           \
+        &LIBFLATARRAY_ELEM(1, MEMBER),                                  \
+        hood,                                                           \
+        &CELL::LIBFLATARRAY_ELEM(1, MEMBER));
+
 #define DECLARE_MULTI_CONTAINER_CELL_UPDATE(INDEX, CELL, MEMBER)        \
     LIBFLATARRAY_ELEM(1, MEMBER).updateCargo(multiHood, nanoStep);
 
@@ -86,6 +135,10 @@ public:
  * particles interacting with each other. This Macro will generate the
  * necessary glue to stitch both components of the model together.
  *
+ * Entities in ContainerCell members may migrate between neighboring
+ * cells (see APITraits::HasMigration), just as with a standalone
+ * ContainerCell.
+ *
  * See the unit tests for examples of how to use this class.
  *
  * The macro expects MEMBERS to be a sequence of member specifications
@@ -163,6 +216,11 @@ public:
                 NAME,                                                   \
                 MEMBERS)                                                \
                                                                         \
+            LIBFLATARRAY_FOR_EACH(                                      \
+                DECLARE_MULTI_CONTAINER_MIGRATE_MEMBER,                 \
+                NAME,                                                   \
+                MEMBERS)                                                \
+                                                                        \
             LIBFLATARRAY_FOR_EACH(                                      \
                 DECLARE_MULTI_CONTAINER_CELL_UPDATE,                    \
                 NAME,                                                   \
@@ -0,0 +1,94 @@
+#ifndef LIBGEODECOMP_STORAGE_NANOSTEPSET_H
+#define LIBGEODECOMP_STORAGE_NANOSTEPSET_H
+
+#include <algorithm>
+#include <cstddef>
+#include <vector>
+
+namespace LibGeoDecomp {
+
+/**
+ * Ordered set of nano steps, used by PatchAccepter and PatchProvider
+ * to track which steps they expect next. These hold only a handful
+ * of steps at a time, but get updated multiple times per step, so
+ * unlike a std::set, which allocates a node per insert, this keeps
+ * its steps in a sorted vector that won't allocate any more memory
+ * once it has reached its maximum size.
+ */
+class NanoStepSet
+{
+public:
+    typedef std::vector<std::size_t>::const_iterator const_iterator;
+
+    inline void insert(std::size_t nanoStep)
+    {
+        std::vector<std::size_t>::iterator i = std::lower_bound(steps.begin(), steps.end(), nanoStep);
+        if ((i == steps.end()) || (*i != nanoStep)) {
+            steps.insert(i, nanoStep);
+        }
+    }
+
+    inline std::size_t erase(std::size_t nanoStep)
+    {
+        std::vector<std::size_t>::iterator i = std::lower_bound(steps.begin(), steps.end(), nanoStep);
+        if ((i == steps.end()) || (*i != nanoStep)) {
+            return 0;
+        }
+
+        steps.erase(i);
+        return 1;
+    }
+
+    inline void clear()
+    {
+        steps.clear();
+    }
+
+    inline bool empty() const
+    {
+        return steps.empty();
+    }
+
+    inline std::size_t size() const
+    {
+        return steps.size();
+    }
+
+    inline const_iterator begin() const
+    {
+        return steps.begin();
+    }
+
+    inline const_iterator end() const
+    {
+        return steps.end();
+    }
+
+    inline std::size_t capacity() const
+    {
+        return steps.capacity();
+    }
+
+private:
+    std::vector<std::size_t> steps;
+};
+
+inline NanoStepSet& operator<<(NanoStepSet& set, std::size_t nanoStep)
+{
+    set.insert(nanoStep);
+    return set;
+}
+
+inline const std::size_t& (min)(const NanoStepSet& set)
+{
+    return *set.begin();
+}
+
+inline void erase_min(NanoStepSet& set)
+{
+    set.erase((min)(set));
+}
+
+}
+
+#endif
@@ -4,6 +4,7 @@
 #include <libgeodecomp/geometry/region.h>
 #include <libgeodecomp/misc/limits.h>
 #include <libgeodecomp/misc/stdcontaineroverloads.h>
+#include <libgeodecomp/storage/nanostepset.h>
 #include <libgeodecomp/storage/serializationbuffer.h>
 
 #ifdef LIBGEODECOMP_WITH_HPX
@@ -72,7 +73,7 @@ public:
     }
 
 protected:
-    std::set<std::size_t> requestedNanoSteps;
+    NanoStepSet requestedNanoSteps;
 
     bool checkNanoStepPut(const std::size_t nanoStep) const
     {
@@ -2,6 +2,7 @@
 #define LIBGEODECOMP_STORAGE_PATCHBUFFER_H
 
 #include <deque>
+#include <libgeodecomp/storage/bufferpool.h>
 #include <libgeodecomp/storage/patchaccepter.h>
 #include <libgeodecomp/storage/patchprovider.h>
 
@@ -12,7 +13,8 @@ namespace LibGeoDecomp {
  * Region, for later retrieval. Useful for building Steppers which
  * implement overlapping communication and calculation (and hence need
  * to buffer certain parts of the grid which will be temporarily
- * overwritten).
+ * overwritten). Buffers of retrieved fragments are recycled, so
+ * that in steady state put() doesn't allocate.
  */
 template<class GRID_TYPE1, class GRID_TYPE2>
 class PatchBuffer :
@@ -48,9 +50,8 @@ public:
             return;
         }
 
-        storedRegions.push_back(BufferType());
+        storedRegions.push_back(pool.acquire(region));
         BufferType& buffer = storedRegions.back();
-        buffer = SerializationBuffer<CellType>::create(region);
 
         grid.saveRegion(&buffer, region);
         storedNanoSteps << (min)(requestedNanoSteps);
@@ -73,6 +74,7 @@ public:
         destinationGrid->loadRegion(storedRegions.front(), region);
 
         if (remove) {
+            pool.release(std::move(storedRegions.front()));
             storedRegions.pop_front();
             erase_min(storedNanoSteps);
         }
@@ -82,6 +84,7 @@ public:
 private:
     Region<DIM> region;
     std::deque<BufferType> storedRegions;
+    BufferPool<CellType> pool;
 };
 
 }
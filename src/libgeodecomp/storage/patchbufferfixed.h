@@ -11,9 +11,12 @@ namespace LibGeoDecomp {
 /**
  * The PatchBuffer's cousin can only store a fixed number of regions
  * at a time, but avoids the memory allocation hassle during
- * put().
+ * put(). BUFFER selects how cells are serialized, e.g.
+ * GhostZoneSerializationBuffer would store only a model's ghost
+ * members.
  */
-template<class GRID_TYPE1, class GRID_TYPE2, int SIZE>
+template<class GRID_TYPE1, class GRID_TYPE2, int SIZE,
+         class BUFFER = SerializationBuffer<typename GRID_TYPE1::CellType> >
 class PatchBufferFixed :
         public PatchAccepter<GRID_TYPE1>,
         public PatchProvider<GRID_TYPE2>
@@ -21,7 +24,7 @@ class PatchBufferFixed :
 public:
     friend class PatchBufferFixedTest;
     typedef typename GRID_TYPE1::CellType CellType;
-    typedef typename SerializationBuffer<CellType>::BufferType BufferType;
+    typedef typename BUFFER::BufferType BufferType;
     const static int DIM = GRID_TYPE1::DIM;
 
     using PatchAccepter<GRID_TYPE1>::checkNanoStepPut;
@@ -34,7 +37,7 @@ public:
         region(region),
         indexRead(0),
         indexWrite(0),
-        buffer(SIZE, SerializationBuffer<CellType>::create(region))
+        buffer(SIZE, BUFFER::create(region))
     {}
 
     virtual void put(
@@ -54,7 +57,7 @@ public:
             throw std::logic_error("PatchBufferFixed capacity exceeded.");
         }
 
-        grid.saveRegion(&buffer[indexWrite], region);
+        BUFFER::save(grid, &buffer[indexWrite], region);
         storedNanoSteps << (min)(requestedNanoSteps);
         erase_min(requestedNanoSteps);
         inc(&indexWrite);
@@ -70,7 +73,7 @@ public:
     {
         checkNanoStepGet(nanoStep);
 
-        destinationGrid->loadRegion(buffer[indexRead], region);
+        BUFFER::load(destinationGrid, buffer[indexRead], region);
 
         if (remove) {
             erase_min(storedNanoSteps);
@@ -10,6 +10,7 @@
 #include <libgeodecomp/misc/limits.h>
 #include <libgeodecomp/misc/stdcontaineroverloads.h>
 #include <libgeodecomp/misc/stringops.h>
+#include <libgeodecomp/storage/nanostepset.h>
 
 namespace LibGeoDecomp {
 
@@ -70,7 +71,7 @@ public:
     }
 
 protected:
-    std::set<std::size_t> storedNanoSteps;
+    NanoStepSet storedNanoSteps;
 
     void checkNanoStepGet(const std::size_t nanoStep) const
     {
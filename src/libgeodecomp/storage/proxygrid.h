@@ -59,6 +59,14 @@ public:
         return viewBox;
     }
 
+    const char *memberAddress(
+        const Selector<CELL>& selector,
+        const Coord<DIM>& coord,
+        std::ptrdiff_t *stride) const
+    {
+        return delegate->memberAddress(selector, coord, stride);
+    }
+
     void saveMemberImplementation(
         char *target,
         MemoryLocation::Location targetLocation,
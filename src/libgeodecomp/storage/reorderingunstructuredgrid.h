@@ -32,6 +32,134 @@ std::vector<IntPair>::const_iterator mapLogicalToPhysicalID(int logicalID, const
     return pos;
 }
 
+/**
+ * Computes a Reverse Cuthill-McKee ordering of nodes (which need to
+ * be sorted) from the adjacency given by matrix. Edges are treated
+ * as undirected, entries which refer to IDs outside of nodes are
+ * ignored. Each connected component is traversed breadth-first,
+ * starting at a pseudo-peripheral node and visiting neighbors in
+ * order of ascending degree. Returns the IDs in their new order.
+ */
+template<typename SPARSE_MATRIX>
+std::vector<int> reverseCuthillMcKee(const std::vector<int>& nodes, const SPARSE_MATRIX& matrix)
+{
+    const int numNodes = nodes.size();
+    auto indexOf = [&nodes](int id) {
+        std::vector<int>::const_iterator i = std::lower_bound(nodes.begin(), nodes.end(), id);
+        return ((i == nodes.end()) || (*i != id)) ? -1 : int(i - nodes.begin());
+    };
+
+    // adjacency in compressed row format:
+    std::vector<IntPair> edges;
+    edges.reserve(2 * matrix.size());
+    for (typename SPARSE_MATRIX::const_iterator i = matrix.begin(); i != matrix.end(); ++i) {
+        int a = indexOf(i->first.x());
+        int b = indexOf(i->first.y());
+        if ((a < 0) || (b < 0) || (a == b)) {
+            continue;
+        }
+
+        edges << std::make_pair(a, b)
+              << std::make_pair(b, a);
+    }
+    std::sort(edges.begin(), edges.end());
+    edges.erase(std::unique(edges.begin(), edges.end()), edges.end());
+
+    std::vector<int> offsets(numNodes + 1, 0);
+    std::vector<int> neighbors(edges.size());
+    for (std::size_t i = 0; i < edges.size(); ++i) {
+        ++offsets[edges[i].first + 1];
+        neighbors[i] = edges[i].second;
+    }
+    for (int i = 0; i < numNodes; ++i) {
+        offsets[i + 1] += offsets[i];
+    }
+
+    auto degree = [&offsets](int node) {
+        return offsets[node + 1] - offsets[node];
+    };
+    auto lessDegree = [&degree](int a, int b) {
+        return (degree(a) < degree(b)) || ((degree(a) == degree(b)) && (a < b));
+    };
+
+    // breadth-first search which appends the component of root to
+    // order and records each node's level:
+    std::vector<int> level(numNodes, -1);
+    std::vector<int> buffer;
+    auto traverse = [&](int root, std::vector<int> *order) {
+        std::size_t begin = order->size();
+        level[root] = 0;
+        *order << root;
+
+        for (std::size_t head = begin; head < order->size(); ++head) {
+            int node = (*order)[head];
+            buffer.clear();
+            for (int i = offsets[node]; i < offsets[node + 1]; ++i) {
+                if (level[neighbors[i]] < 0) {
+                    level[neighbors[i]] = level[node] + 1;
+                    buffer << neighbors[i];
+                }
+            }
+            std::sort(buffer.begin(), buffer.end(), lessDegree);
+            order->insert(order->end(), buffer.begin(), buffer.end());
+        }
+    };
+
+    std::vector<int> roots(numNodes);
+    for (int i = 0; i < numNodes; ++i) {
+        roots[i] = i;
+    }
+    std::sort(roots.begin(), roots.end(), lessDegree);
+
+    std::vector<int> order;
+    std::vector<int> component;
+    order.reserve(numNodes);
+
+    for (std::vector<int>::iterator r = roots.begin(); r != roots.end(); ++r) {
+        if (level[*r] >= 0) {
+            continue;
+        }
+
+        // find a pseudo-peripheral node (George and Liu): move the
+        // root to the lowest degree node in the last level for as
+        // long as that increases the component's depth.
+        int root = *r;
+        int depth = -1;
+        for (;;) {
+            component.clear();
+            traverse(root, &component);
+            int lastLevel = level[component.back()];
+            int candidate = component.back();
+            for (std::vector<int>::reverse_iterator i = component.rbegin();
+                 (i != component.rend()) && (level[*i] == lastLevel);
+                 ++i) {
+                if (lessDegree(*i, candidate)) {
+                    candidate = *i;
+                }
+            }
+
+            for (std::vector<int>::iterator i = component.begin(); i != component.end(); ++i) {
+                level[*i] = -1;
+            }
+            if (lastLevel <= depth) {
+                break;
+            }
+            depth = lastLevel;
+            root = candidate;
+        }
+
+        traverse(root, &order);
+    }
+
+    std::vector<int> ret;
+    ret.reserve(numNodes);
+    for (std::vector<int>::reverse_iterator i = order.rbegin(); i != order.rend(); ++i) {
+        ret << nodes[*i];
+    }
+
+    return ret;
+}
+
 /**
  * Helper class which converts logical coordinates to physical ones
  * (i.e. those that are actually used to address memory).
@@ -154,6 +282,7 @@ public:
     typedef typename DELEGATE_GRID::StorageType StorageType;
     typedef typename DELEGATE_GRID::WeightType WeightType;
     typedef typename APITraits::SelectSoA<CellType>::Value SoAFlag;
+    typedef typename APITraits::SelectSellLocalityReordering<CellType>::Value LocalityReorderingFlag;
     typedef typename SerializationBuffer<CellType>::BufferType BufferType;
     typedef typename ReorderingUnstructuredGridHelpers::Selector<SoAFlag>::Value ReorderingRegionIterator;
 
@@ -240,10 +369,9 @@ public:
         RowLengthVec reorderedRowLengths;
         reorderedRowLengths.reserve(nodeSet.size());
 
-        for (Region<1>::StreakIterator i = nodeSet.beginStreak(); i != nodeSet.endStreak(); ++i) {
-            for (int j = i->origin.x(); j != i->endX; ++j) {
-                reorderedRowLengths << std::make_pair(j, rowLengths[j]);
-            }
+        std::vector<int> nodes = orderNodes(matrix, LocalityReorderingFlag());
+        for (std::vector<int>::iterator i = nodes.begin(); i != nodes.end(); ++i) {
+            reorderedRowLengths << std::make_pair(*i, rowLengths[*i]);
         }
 
         for (RowLengthVec::iterator i = reorderedRowLengths.begin(); i != reorderedRowLengths.end(); ) {
@@ -507,6 +635,33 @@ private:
             ReorderingRegionIterator(region.end(), logicalToPhysicalIDs));
     }
 
+    /**
+     * Order of the nodes before the SELL-C-SIGMA sorting is applied,
+     * by default that's just ascending IDs.
+     */
+    std::vector<int> orderNodes(const SparseMatrix& /* matrix */, APITraits::FalseType) const
+    {
+        return nodeIDs();
+    }
+
+    std::vector<int> orderNodes(const SparseMatrix& matrix, APITraits::TrueType) const
+    {
+        return ReorderingUnstructuredGridHelpers::reverseCuthillMcKee(nodeIDs(), matrix);
+    }
+
+    std::vector<int> nodeIDs() const
+    {
+        std::vector<int> ret;
+        ret.reserve(nodeSet.size());
+        for (Region<1>::StreakIterator i = nodeSet.beginStreak(); i != nodeSet.endStreak(); ++i) {
+            for (int j = i->origin.x(); j != i->endX; ++j) {
+                ret << j;
+            }
+        }
+
+        return ret;
+    }
+
     void reorderDelegateGrid(std::vector<IntPair>&& newLogicalToPhysicalIDs, std::vector<int>&& newPhysicalToLogicalIDs)
     {
         CoordBox<1> box(Coord<1>(), nodeSet.boundingBox().dimensions);
@@ -124,6 +124,11 @@ public:
         return 0;
     }
 
+    const char *memberAddress(const CELL *cell) const
+    {
+        return reinterpret_cast<const char*>(cell);
+    }
+
     void copyMemberIn(
         const char *source,
         MemoryLocation::Location sourceLocation,
@@ -399,6 +404,15 @@ public:
         return memberOffset;
     }
 
+    /**
+     * Address of the selected member within cell. Only useful for
+     * AoS memory layout.
+     */
+    inline const char *memberAddress(const CELL *cell) const
+    {
+        return &(cell->*memberPointer);
+    }
+
     /**
      * Read the data from source and set the corresponding member of
      * each CELL at target. Only useful for AoS memory layout.
@@ -7,6 +7,8 @@
 
 #include <libflatarray/aligned_allocator.hpp>
 #include <libgeodecomp/geometry/coord.h>
+#include <libgeodecomp/misc/apitraits.h>
+#include <libgeodecomp/misc/bfloat16.h>
 
 #include <map>
 #include <vector>
@@ -14,6 +16,8 @@
 #include <assert.h>
 #include <stdexcept>
 #include <algorithm>
+#include <type_traits>
+#include <stdint.h>
 
 #include <iostream>
 
@@ -41,9 +45,74 @@ public:
 };
 
 /**
- * Helper class to initialize the sell container from an adjacency matrix.
- * This is a class and not a method, because there are two different implementations,
- * one for SIGMA = 1 and one for SIGMA > 1.
+ * Identifies the format in which a SELL container keeps its weights
+ * (see compressWeights()).
+ */
+enum WeightPrecision {
+    FULL_PRECISION,
+    SINGLE_PRECISION,
+    BFLOAT16_PRECISION
+};
+
+/**
+ * Maps the type selected via APITraits::HasSellWeightStorage to the
+ * corresponding WeightPrecision. void means no reduction.
+ */
+template<typename WEIGHT_STORAGE>
+class SelectWeightPrecision
+{
+public:
+    static const WeightPrecision VALUE = FULL_PRECISION;
+};
+
+template<>
+class SelectWeightPrecision<float>
+{
+public:
+    static const WeightPrecision VALUE = SINGLE_PRECISION;
+};
+
+template<>
+class SelectWeightPrecision<BFloat16>
+{
+public:
+    static const WeightPrecision VALUE = BFLOAT16_PRECISION;
+};
+
+/**
+ * Yields TrueType if weights of type VALUETYPE are to be stored as
+ * WEIGHT_STORAGE, which allows neighborhoods to skip the decoding
+ * logic entirely at compile time if they don't.
+ */
+template<typename VALUETYPE, typename WEIGHT_STORAGE>
+class IsReducedPrecision
+{
+public:
+    typedef APITraits::TrueType Value;
+};
+
+template<typename VALUETYPE>
+class IsReducedPrecision<VALUETYPE, void>
+{
+public:
+    typedef APITraits::FalseType Value;
+};
+
+template<typename VALUETYPE>
+class IsReducedPrecision<VALUETYPE, VALUETYPE>
+{
+public:
+    typedef APITraits::FalseType Value;
+};
+
+/**
+ * Helper class to initialize the sell container from an adjacency
+ * matrix, which needs to be sorted by row and column. All phases
+ * (row lengths, sorting within the SIGMA windows, chunk lengths and
+ * the scattering of the values into the chunks) are parallelized via
+ * OpenMP if LIBGEODECOMP_WITH_THREADS is set. Only the prefix sum
+ * over the chunk lengths and the allocation of the value arrays are
+ * serial. The result does not depend on the number of threads.
  */
 template<typename VALUETYPE, int C, int SIGMA>
 class InitFromMatrix
@@ -54,14 +123,13 @@ public:
 
     void operator()(SellContainer *container, const Matrix& matrix) const
     {
-        std::vector<int> rowLengthCopy;
-
         // calculate size for arrays
         const int matrixRows = container->dimension;
         const int numberOfChunks = (matrixRows - 1) / C + 1;
-        const int numberOfSigmas = (matrixRows - 1) / SIGMA + 1;
         const int rowsPadded = numberOfChunks * C;
-        int numberOfValues = 0;
+        // padding rows need to be mapped, too:
+        const int numberOfSigmas = (rowsPadded - 1) / SIGMA + 1;
+        const long numberOfEntries = matrix.size();
 
         // save references to sell data structures
         auto& chunkOffset     = container->chunkOffset;
@@ -72,27 +140,54 @@ public:
         auto& values          = container->values;
         auto& column          = container->column;
 
+        // previously compressed weights are stale now:
+        container->precision = FULL_PRECISION;
+        typename SellContainer::AlignedFloatVector().swap(container->valuesSingle);
+        typename SellContainer::AlignedUInt16Vector().swap(container->valuesBFloat16);
+
         // allocate memory
+        std::vector<long> rowBegin(rowsPadded, 0);
+        std::vector<long> rowEnd(rowsPadded, 0);
+        std::vector<int> realRowLength(rowsPadded);
         chunkOffset.resize(numberOfChunks + 1);
         chunkLength.resize(numberOfChunks);
         rowLength.resize(rowsPadded);
-        rowLengthCopy.resize(rowsPadded);
-        realRowToSorted.reserve(rowsPadded);
+        realRowToSorted.resize(rowsPadded);
         chunkRowToReal.resize(rowsPadded);
 
-        // get row lengths
-        std::fill(begin(rowLength), end(rowLength), 0);
-        for (const auto& pair: matrix) {
-            ++rowLength[pair.first.x()];
+        // get row lengths: as the matrix is sorted, each row is a
+        // contiguous range and its bounds can be found without any
+        // synchronization between threads.
+#ifdef LIBGEODECOMP_WITH_THREADS
+#pragma omp parallel for schedule(static)
+#endif
+        for (long i = 0; i < numberOfEntries; ++i) {
+            const int row = matrix[i].first.x();
+            if ((i == 0) || (matrix[i - 1].first.x() != row)) {
+                rowBegin[row] = i;
+            }
+            if ((i == (numberOfEntries - 1)) || (matrix[i + 1].first.x() != row)) {
+                rowEnd[row] = i + 1;
+            }
+        }
+
+#ifdef LIBGEODECOMP_WITH_THREADS
+#pragma omp parallel for schedule(static)
+#endif
+        for (int row = 0; row < rowsPadded; ++row) {
+            realRowLength[row] = rowEnd[row] - rowBegin[row];
         }
 
-        // map sorting scope
+        // map sorting scope, windows are independent of each other
+#ifdef LIBGEODECOMP_WITH_THREADS
+#pragma omp parallel for schedule(dynamic)
+#endif
         for (int nSigma = 0; nSigma < numberOfSigmas; ++nSigma) {
             const int numberOfRows = (std::min)(SIGMA, rowsPadded - nSigma * SIGMA);
             std::vector<SortItem> lengths(numberOfRows);
             for (int i = 0; i < numberOfRows; ++i) {
                 const int row = nSigma * SIGMA + i;
-                lengths[i] = SortItem(rowLength[row], row);
+                lengths[i] = SortItem(realRowLength[row], row);
             }
             std::stable_sort(begin(lengths), end(lengths),
                              [] (const SortItem& a, const SortItem& b) -> bool
@@ -100,63 +195,51 @@ public:
             for (int i = 0; i < numberOfRows; ++i) {
                 int newID = nSigma * SIGMA + i;
                 chunkRowToReal[newID] = lengths[i].rowIndex;
-                realRowToSorted.push_back(std::make_pair(lengths[i].rowIndex, newID));
-                rowLengthCopy[newID] = lengths[i].rowLength;
+                realRowToSorted[lengths[i].rowIndex] = std::make_pair(lengths[i].rowIndex, newID);
+                rowLength[newID] = lengths[i].rowLength;
             }
         }
 
-        std::stable_sort(realRowToSorted.begin(), realRowToSorted.end(),
-                         [] (const std::pair<int, int>& a, const std::pair<int, int>& b) -> bool
-                         { return a.first < b.first; });
+        // save chunk lengths...
+#ifdef LIBGEODECOMP_WITH_THREADS
+#pragma omp parallel for schedule(static)
+#endif
+        for (int nChunk = 0; nChunk < numberOfChunks; ++nChunk) {
+            int maxLength = 0;
+            for (int i = 0; i < C; ++i) {
+                maxLength = (std::max)(maxLength, rowLength[nChunk * C + i]);
+            }
+            chunkLength[nChunk] = maxLength;
+        }
 
-        // save chunk lengths and offsets
+        // ...and offsets
         chunkOffset[0] = 0;
         for (int nChunk = 0; nChunk < numberOfChunks; ++nChunk) {
-            std::vector<int> lengths(C);
-            for (auto i = 0u; i < lengths.size(); ++i) {
-                lengths[i] = rowLength[chunkRowToReal[nChunk * C + i]];
-            }
-            chunkLength[nChunk] = *std::max_element(begin(lengths), end(lengths));
-            if (nChunk > 0) {
-                chunkOffset[nChunk] = chunkOffset[nChunk - 1] + chunkLength[nChunk - 1] * C;
-            }
-            numberOfValues += chunkLength[nChunk] * C;
+            chunkOffset[nChunk + 1] = chunkOffset[nChunk] + chunkLength[nChunk] * C;
         }
-        chunkOffset[numberOfChunks] =
-            chunkOffset[numberOfChunks - 1] +
-            chunkLength[numberOfChunks - 1] * C;
+        const int numberOfValues = chunkOffset[numberOfChunks];
 
         // save values
-        rowLength = std::move(rowLengthCopy);
         values.resize(numberOfValues);
         column.resize(numberOfValues);
-        std::fill(begin(values), end(values), 0);
-        std::fill(begin(column), end(column), 0);
-        int currentRow = 0;
-        int index = 0;
-
-        for (const auto& pair: matrix) {
-            if (pair.first.x() != currentRow) {
-                currentRow = pair.first.x();
-                index = 0;
-            }
-            std::vector<std::pair<int, int> >::iterator iter = std::lower_bound(
-                realRowToSorted.begin(), realRowToSorted.end(), pair.first.x(),
-                [](const std::pair<int, int>& a, const int id) {
-                    return a.first < id;
-                });
-
-            if (iter == realRowToSorted.end()) {
-                throw std::logic_error("ID not found");
-            }
 
-            const int chunk = iter->second / C;
-            const int row   = iter->second % C;
-            const int start = chunkOffset[chunk];
-            const int idx   = start + index * C + row;
-            values[idx]     = pair.second;
-            column[idx]     = pair.first.y();
-            ++index;
+#ifdef LIBGEODECOMP_WITH_THREADS
+#pragma omp parallel for schedule(dynamic, 16)
+#endif
+        for (int nChunk = 0; nChunk < numberOfChunks; ++nChunk) {
+            // padding needs to be zero, too:
+            std::fill(values.begin() + chunkOffset[nChunk], values.begin() + chunkOffset[nChunk + 1], 0);
+            std::fill(column.begin() + chunkOffset[nChunk], column.begin() + chunkOffset[nChunk + 1], 0);
+
+            for (int row = 0; row < C; ++row) {
+                const int realRow = chunkRowToReal[nChunk * C + row];
+                int idx = chunkOffset[nChunk] + row;
+
+                for (long i = rowBegin[realRow]; i < rowEnd[realRow]; ++i, idx += C) {
+                    values[idx] = matrix[i].second;
+                    column[idx] = matrix[i].first.y();
+                }
+            }
         }
     }
 };
@@ -176,6 +259,8 @@ public:
     typedef std::vector<std::pair<Coord<2>, VALUETYPE> > SparseMatrix;
     using AlignedValueVector = std::vector<VALUETYPE, LibFlatArray::aligned_allocator<VALUETYPE, 64> >;
     using AlignedIntVector   = std::vector<int, LibFlatArray::aligned_allocator<int, 64> >;
+    using AlignedFloatVector = std::vector<float, LibFlatArray::aligned_allocator<float, 64> >;
+    using AlignedUInt16Vector = std::vector<uint16_t, LibFlatArray::aligned_allocator<uint16_t, 64> >;
 
     friend SellHelpers::InitFromMatrix<VALUETYPE, C, SIGMA>;
     friend class ReorderingUnstructuredGridTest;
@@ -187,7 +272,8 @@ public:
         rowLength(N, 0),
         chunkLength((N-1)/C + 1, 0),
         chunkOffset((N-1)/C + 2, 0),
-        dimension(N)
+        dimension(N),
+        precision(SellHelpers::FULL_PRECISION)
     {
         static_assert(C >= 1, "C should be greater or equal to 1!");
         static_assert(SIGMA >= 1, "SIGMA should be greater or equal to 1!");
@@ -207,7 +293,7 @@ public:
         int index = chunkOffset[chunk] + offset;
 
         for (int element = 0; element < rowLength[row]; ++element, index += C) {
-            vec.push_back(std::pair<int, VALUETYPE>(column[index], values[index]));
+            vec.push_back(std::pair<int, VALUETYPE>(column[index], weight(index)));
         }
 
         return vec;
@@ -217,22 +303,128 @@ public:
      * This method can be used, if this container should be initialized from a
      * _complete_ matrix. Matrix is represented as map, key is Coord<2> which contains
      * (row, column). value_type of map contains the actual value.
+     * Matrices which are already sorted that way are used as is,
+     * which saves a copy and a sort of all entries.
      */
     void initFromMatrix(const SparseMatrix& matrix)
     {
+        auto compare = [](const std::pair<Coord<2>, VALUETYPE>& a, const std::pair<Coord<2>, VALUETYPE>& b) {
+            return a.first < b.first;
+        };
+
+        if (std::is_sorted(matrix.begin(), matrix.end(), compare)) {
+            SellHelpers::InitFromMatrix<VALUETYPE, C, SIGMA>()(this, matrix);
+            return;
+        }
+
         SparseMatrix sortedMatrix = matrix;
-        std::sort(sortedMatrix.begin(), sortedMatrix.end(), [](const std::pair<Coord<2>, VALUETYPE>& a, const std::pair<Coord<2>, VALUETYPE>& b){
-                return a.first < b.first;
-            });
+        std::sort(sortedMatrix.begin(), sortedMatrix.end(), compare);
         SellHelpers::InitFromMatrix<VALUETYPE, C, SIGMA>()(this, sortedMatrix);
     }
 
+    /**
+     * Converts the weights to reduced precision: WEIGHT_STORAGE may
+     * be float or BFloat16, void or VALUETYPE restore VALUETYPE. The
+     * full precision weights are dropped to save memory, so valuesVec()
+     * is empty afterwards and kernels need to use decodeWeights()
+     * (UnstructuredSoANeighborhood does so transparently). The
+     * conversion is lossy, restoring VALUETYPE won't bring back the
+     * original weights.
+     */
+    template<typename WEIGHT_STORAGE>
+    void compressWeights()
+    {
+        static_assert(
+            std::is_same<WEIGHT_STORAGE, void>::value ||
+            std::is_same<WEIGHT_STORAGE, VALUETYPE>::value ||
+            std::is_same<WEIGHT_STORAGE, float>::value ||
+            std::is_same<WEIGHT_STORAGE, BFloat16>::value,
+            "weights can only be stored as float or BFloat16");
+
+        SellHelpers::WeightPrecision newPrecision = SellHelpers::SelectWeightPrecision<WEIGHT_STORAGE>::VALUE;
+        if (std::is_same<WEIGHT_STORAGE, VALUETYPE>::value) {
+            newPrecision = SellHelpers::FULL_PRECISION;
+        }
+        if (newPrecision == precision) {
+            return;
+        }
+
+        const long numberOfValues = chunkOffset.back();
+
+        // go through full precision so we can switch between the
+        // reduced formats, too:
+        if (precision != SellHelpers::FULL_PRECISION) {
+            values.resize(numberOfValues);
+            decodeWeights(0, numberOfValues, values.data());
+            AlignedFloatVector().swap(valuesSingle);
+            AlignedUInt16Vector().swap(valuesBFloat16);
+            precision = SellHelpers::FULL_PRECISION;
+        }
+
+        if (newPrecision == SellHelpers::SINGLE_PRECISION) {
+            valuesSingle.resize(numberOfValues);
+#ifdef LIBGEODECOMP_WITH_THREADS
+#pragma omp parallel for schedule(static)
+#endif
+            for (long i = 0; i < numberOfValues; ++i) {
+                valuesSingle[i] = static_cast<float>(values[i]);
+            }
+        }
+
+        if (newPrecision == SellHelpers::BFLOAT16_PRECISION) {
+            valuesBFloat16.resize(numberOfValues);
+#ifdef LIBGEODECOMP_WITH_THREADS
+#pragma omp parallel for schedule(static)
+#endif
+            for (long i = 0; i < numberOfValues; ++i) {
+                valuesBFloat16[i] = BFloat16(static_cast<float>(values[i])).raw();
+            }
+        }
+
+        if (newPrecision != SellHelpers::FULL_PRECISION) {
+            AlignedValueVector().swap(values);
+        }
+        precision = newPrecision;
+    }
+
+    /**
+     * Widens LENGTH weights starting at OFFSET to VALUETYPE,
+     * regardless of the format selected via compressWeights().
+     */
+    inline void decodeWeights(long offset, int length, VALUETYPE *target) const
+    {
+        switch (precision) {
+        case SellHelpers::SINGLE_PRECISION:
+            decodeWeights<float>(offset, length, target);
+            break;
+        case SellHelpers::BFLOAT16_PRECISION:
+            decodeWeights<BFloat16>(offset, length, target);
+            break;
+        default:
+            std::copy(&values[offset], &values[offset] + length, target);
+        }
+    }
+
+    /**
+     * Same as above, but for kernels which know the format at
+     * compile time: WEIGHT_STORAGE needs to match the type passed to
+     * compressWeights().
+     */
+    template<typename WEIGHT_STORAGE>
+    inline void decodeWeights(long offset, int length, VALUETYPE *target) const
+    {
+        widen(reducedValues(static_cast<WEIGHT_STORAGE*>(0)) + offset, length, target);
+    }
+
     inline bool operator==(const SellCSigmaSparseMatrixContainer& other) const
     {
-        return ((dimension   == other.dimension)  &&
-                (values      == other.values)     &&
-                (column      == other.column)     &&
-                (chunkLength == other.chunkLength));
+        return ((dimension      == other.dimension)      &&
+                (precision      == other.precision)      &&
+                (values         == other.values)         &&
+                (valuesSingle   == other.valuesSingle)   &&
+                (valuesBFloat16 == other.valuesBFloat16) &&
+                (column         == other.column)         &&
+                (chunkLength    == other.chunkLength));
     }
 
     template<int O_C, int O_SIGMA>
@@ -257,6 +449,10 @@ public:
         return !(*this == other);
     }
 
+    /**
+     * Empty if the weights are kept in reduced precision, see
+     * compressWeights().
+     */
     inline const AlignedValueVector& valuesVec() const
     {
         return values;
@@ -297,7 +493,53 @@ public:
         return dimension;
     }
 
+    inline SellHelpers::WeightPrecision weightPrecision() const
+    {
+        return precision;
+    }
+
+    inline const AlignedFloatVector& valuesSingleVec() const
+    {
+        return valuesSingle;
+    }
+
+    inline const AlignedUInt16Vector& valuesBFloat16Vec() const
+    {
+        return valuesBFloat16;
+    }
+
 private:
+    inline VALUETYPE weight(long index) const
+    {
+        VALUETYPE ret;
+        decodeWeights(index, 1, &ret);
+        return ret;
+    }
+
+    inline const float *reducedValues(float*) const
+    {
+        return valuesSingle.data();
+    }
+
+    inline const uint16_t *reducedValues(BFloat16*) const
+    {
+        return valuesBFloat16.data();
+    }
+
+    static inline void widen(const float *source, int length, VALUETYPE *target)
+    {
+        for (int i = 0; i < length; ++i) {
+            target[i] = source[i];
+        }
+    }
+
+    static inline void widen(const uint16_t *source, int length, VALUETYPE *target)
+    {
+        for (int i = 0; i < length; ++i) {
+            target[i] = BFloat16::toFloat(source[i]);
+        }
+    }
+
     AlignedValueVector values;
     AlignedIntVector column;
     std::vector<int> rowLength;       // = Non Zero Entres in Row
@@ -306,6 +548,9 @@ private:
     std::vector<std::pair<int, int> > realRowToSorted; // mapping between rows and real rows, used for SIGMA
     std::vector<int> chunkRowToReal;  // and the other way around
     std::size_t dimension;              // = N
+    SellHelpers::WeightPrecision precision; // which of the following holds the weights
+    AlignedFloatVector valuesSingle;    // replaces values if precision == SINGLE_PRECISION
+    AlignedUInt16Vector valuesBFloat16; // replaces values if precision == BFLOAT16_PRECISION
 };
 
 }
@@ -3,6 +3,10 @@
 
 #include <libflatarray/flat_array.hpp>
 #include <libgeodecomp/misc/apitraits.h>
+#include <libgeodecomp/storage/memorylocation.h>
+#include <libgeodecomp/storage/selector.h>
+
+#include <vector>
 
 namespace LibGeoDecomp {
 
@@ -44,6 +48,18 @@ public:
         return &buffer.front();
     }
 
+    template<typename GRID, typename REGION>
+    static void save(const GRID& grid, BufferType *buffer, const REGION& region)
+    {
+        grid.saveRegion(buffer, region);
+    }
+
+    template<typename GRID, typename REGION>
+    static void load(GRID *grid, const BufferType& buffer, const REGION& region)
+    {
+        grid->loadRegion(buffer, region);
+    }
+
 #ifdef LIBGEODECOMP_WITH_MPI
     static inline MPI_Datatype cellMPIDataType()
     {
@@ -86,6 +102,18 @@ public:
         return &buffer.front();
     }
 
+    template<typename GRID, typename REGION>
+    static void save(const GRID& grid, BufferType *buffer, const REGION& region)
+    {
+        grid.saveRegion(buffer, region);
+    }
+
+    template<typename GRID, typename REGION>
+    static void load(GRID *grid, const BufferType& buffer, const REGION& region)
+    {
+        grid->loadRegion(buffer, region);
+    }
+
 #ifdef LIBGEODECOMP_WITH_MPI
     static inline MPI_Datatype cellMPIDataType()
     {
@@ -94,6 +122,110 @@ public:
 #endif
 };
 
+/**
+ * Selects the buffer type for ghost zone exchange. Unless a model
+ * restricts its ghost zones to certain members, this is the same as
+ * Implementation.
+ */
+template<typename CELL, typename SUPPORTS_GHOST_MEMBERS = void>
+class GhostZoneImplementation : public Implementation<CELL>
+{};
+
+/**
+ * Stores only the members listed by the model (see
+ * APITraits::HasGhostMembers), one block per member. Works for both,
+ * AoS and SoA grids as it relies on GridBase::saveMember().
+ */
+template<typename CELL>
+class GhostZoneImplementation<CELL, typename CELL::API::SupportsGhostMembers>
+{
+public:
+    typedef std::vector<char> BufferType;
+    typedef char ElementType;
+    typedef typename APITraits::TrueType FixedSize;
+
+    template<typename REGION>
+    static BufferType create(const REGION& region)
+    {
+        return BufferType(storageSize(region));
+    }
+
+    template<typename REGION>
+    static std::size_t storageSize(const REGION& region)
+    {
+        return bytesPerCell() * region.size();
+    }
+
+    template<typename REGION>
+    static void resize(BufferType *buffer, const REGION& region)
+    {
+        return buffer->resize(storageSize(region));
+    }
+
+    static ElementType *getData(BufferType& buffer)
+    {
+        return &buffer.front();
+    }
+
+    template<typename GRID, typename REGION>
+    static void save(const GRID& grid, BufferType *buffer, const REGION& region)
+    {
+        if (region.size() == 0) {
+            return;
+        }
+
+        char *cursor = &(*buffer)[0];
+        for (typename std::vector<Selector<CELL> >::const_iterator i = selectors().begin();
+             i != selectors().end();
+             ++i) {
+            grid.saveMemberUnchecked(cursor, MemoryLocation::HOST, *i, region);
+            cursor += i->sizeOfExternal() * region.size();
+        }
+    }
+
+    template<typename GRID, typename REGION>
+    static void load(GRID *grid, const BufferType& buffer, const REGION& region)
+    {
+        if (region.size() == 0) {
+            return;
+        }
+
+        const char *cursor = &buffer[0];
+        for (typename std::vector<Selector<CELL> >::const_iterator i = selectors().begin();
+             i != selectors().end();
+             ++i) {
+            grid->loadMemberUnchecked(cursor, MemoryLocation::HOST, *i, region);
+            cursor += i->sizeOfExternal() * region.size();
+        }
+    }
+
+#ifdef LIBGEODECOMP_WITH_MPI
+    static inline MPI_Datatype cellMPIDataType()
+    {
+        return MPI_CHAR;
+    }
+#endif
+
+private:
+    static const std::vector<Selector<CELL> >& selectors()
+    {
+        static std::vector<Selector<CELL> > ret = CELL::ghostMembers();
+        return ret;
+    }
+
+    static std::size_t bytesPerCell()
+    {
+        std::size_t ret = 0;
+        for (typename std::vector<Selector<CELL> >::const_iterator i = selectors().begin();
+             i != selectors().end();
+             ++i) {
+            ret += i->sizeOfExternal();
+        }
+
+        return ret;
+    }
+};
+
 /**
  * see above
  */
@@ -143,11 +275,11 @@ public:
  * This class provides a uniform interface to the different buffer
  * types to be used with GridVecConv.
  */
-template<typename CELL>
+template<typename CELL, typename IMPLEMENTATION = SerializationBufferHelpers::Implementation<CELL> >
 class SerializationBuffer
 {
 public:
-    typedef SerializationBufferHelpers::Implementation<CELL> Implementation;
+    typedef IMPLEMENTATION Implementation;
     typedef typename Implementation::BufferType BufferType;
     typedef typename Implementation::ElementType ElementType;
     typedef typename Implementation::FixedSize FixedSize;
@@ -175,6 +307,18 @@ public:
         Implementation::resize(buffer, region);
     }
 
+    template<typename GRID, typename REGION>
+    static inline void save(const GRID& grid, BufferType *buffer, const REGION& region)
+    {
+        Implementation::save(grid, buffer, region);
+    }
+
+    template<typename GRID, typename REGION>
+    static inline void load(GRID *grid, const BufferType& buffer, const REGION& region)
+    {
+        Implementation::load(grid, buffer, region);
+    }
+
 #ifdef LIBGEODECOMP_WITH_MPI
     static inline  MPI_Datatype cellMPIDataType()
     {
@@ -183,6 +327,16 @@ public:
 #endif
 };
 
+/**
+ * SerializationBuffer for ghost zone exchange: transfers whole cells,
+ * unless the model declares via APITraits::HasGhostMembers that its
+ * neighbors only read certain members.
+ */
+template<typename CELL>
+class GhostZoneSerializationBuffer :
+        public SerializationBuffer<CELL, SerializationBufferHelpers::GhostZoneImplementation<CELL> >
+{};
+
 }
 
 #endif
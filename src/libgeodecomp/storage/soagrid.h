@@ -259,6 +259,39 @@ private:
     long memberOffset;
 };
 
+/**
+ * Yields the address of a single member of one cell, see
+ * GridBase::memberAddress().
+ */
+template<typename CELL, int DIM>
+class MemberAddress
+{
+public:
+    MemberAddress(
+        const char **target,
+        const Selector<CELL>& selector,
+        const Coord<DIM>& coord,
+        const Coord<3>& edgeRadii) :
+        target(target),
+        selector(selector),
+        coord(coord),
+        edgeRadii(edgeRadii)
+    {}
+
+    template<long DIM_X, long DIM_Y, long DIM_Z, long INDEX>
+    void operator()(LibFlatArray::soa_accessor<CELL, DIM_X, DIM_Y, DIM_Z, INDEX> accessor) const
+    {
+        accessor.index() = GenIndex<DIM_X, DIM_Y, DIM_Z>()(coord, edgeRadii);
+        *target = accessor.access_member(selector.sizeOfMember(), selector.offset());
+    }
+
+private:
+    const char **target;
+    const Selector<CELL>& selector;
+    const Coord<DIM>& coord;
+    const Coord<3>& edgeRadii;
+};
+
 /**
  * This class duplicates some functionality from RegionStreakIterator,
  * but is still necessary as we always need 3D coordinates (because of
@@ -355,7 +388,10 @@ public:
 
     typedef CELL CellType;
     typedef TOPOLOGY Topology;
-    typedef LibFlatArray::soa_grid<CELL> Delegate;
+    typedef typename APITraits::SelectAllocator<
+        CELL,
+        LibFlatArray::aligned_allocator<char, 4096> >::Value Allocator;
+    typedef LibFlatArray::soa_grid<CELL, Allocator> Delegate;
     typedef typename APITraits::SelectStencil<CELL>::Value Stencil;
 
     explicit SoAGrid(
@@ -558,6 +594,27 @@ public:
             Topology::wrapsAxis(2) || (Topology::DIM < 3) ? 0 : Stencil::RADIUS);
     }
 
+    /**
+     * Members are stored contiguously along the x-axis, so the
+     * stride is simply the member's size.
+     */
+    const char *memberAddress(
+        const Selector<CELL>& selector,
+        const Coord<DIM>& coord,
+        std::ptrdiff_t *stride) const
+    {
+        const char *ret = 0;
+        delegate.callback(
+            SoAGridHelpers::MemberAddress<CELL, DIM>(
+                &ret,
+                selector,
+                coord - box.origin,
+                edgeRadii));
+        *stride = selector.sizeOfMember();
+
+        return ret;
+    }
+
 protected:
     void saveMemberImplementation(
         char *target,
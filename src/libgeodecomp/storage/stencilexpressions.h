@@ -0,0 +1,338 @@
+#ifndef LIBGEODECOMP_STORAGE_STENCILEXPRESSIONS_H
+#define LIBGEODECOMP_STORAGE_STENCILEXPRESSIONS_H
+
+#include <libflatarray/ilp_to_arity.hpp>
+#include <libflatarray/loop_peeler.hpp>
+#include <libflatarray/member_ptr_to_offset.hpp>
+#include <libflatarray/short_vec.hpp>
+#include <libgeodecomp/geometry/fixedcoord.h>
+
+namespace LibGeoDecomp {
+
+/**
+ * StencilExpressions let models with a Struct of Arrays layout
+ * (APITraits::HasSoA, APITraits::HasFixedCoordsOnlyUpdate and
+ * APITraits::HasUpdateLineX) specify their update as an arithmetic
+ * expression over members of their neighbors, instead of writing
+ * intrinsics or short_vec loops by hand. StencilExpressions::updateLineX()
+ * then generates a loop which evaluates the expression via
+ * LibFlatArray's short_vec, so it will use SSE, AVX or AVX-512,
+ * whatever the target architecture supports. Iterations before the
+ * first index divisible by the vector's arity and after the last one
+ * are peeled off and done with scalar code. A 3D Jacobi smoother
+ * would read:
+ *
+ *   template<typename HOOD_OLD, typename HOOD_NEW>
+ *   static void updateLineX(HOOD_OLD& hoodOld, long indexEnd, HOOD_NEW& hoodNew, int nanoStep)
+ *   {
+ *       using StencilExpressions::neighbor;
+ *
+ *       StencilExpressions::updateLineX(
+ *           hoodOld, indexEnd, hoodNew, &Cell::temp,
+ *           (neighbor(FixedCoord< 0,  0, -1>(), &Cell::temp) +
+ *            neighbor(FixedCoord< 0, -1,  0>(), &Cell::temp) +
+ *            neighbor(FixedCoord<-1,  0,  0>(), &Cell::temp) +
+ *            neighbor(FixedCoord< 1,  0,  0>(), &Cell::temp) +
+ *            neighbor(FixedCoord< 0,  1,  0>(), &Cell::temp) +
+ *            neighbor(FixedCoord< 0,  0,  1>(), &Cell::temp)) * (1.0 / 6.0));
+ *   }
+ *
+ * Expressions may combine neighbors and scalars via +, -, * and /,
+ * negation and sqrt(). Models which update multiple members can call
+ * updateLineX() once per member. Members which are not written keep
+ * whatever the new grid held before.
+ */
+namespace StencilExpressions {
+
+/**
+ * Base class of all expression nodes, required to restrict the
+ * operator overloads below to expressions.
+ */
+template<typename DERIVED>
+class Expression
+{
+public:
+    inline const DERIVED& derived() const
+    {
+        return static_cast<const DERIVED&>(*this);
+    }
+};
+
+/**
+ * Refers to member MEMBER of the neighbor at relative coordinate (X,
+ * Y, Z). The member's offset within the SoA layout is determined
+ * once, when the expression is constructed.
+ */
+template<typename CELL, typename MEMBER, int X, int Y, int Z>
+class Neighbor : public Expression<Neighbor<CELL, MEMBER, X, Y, Z> >
+{
+public:
+    inline explicit Neighbor(MEMBER CELL:: *memberPointer) :
+        offset(LibFlatArray::member_ptr_to_offset()(memberPointer))
+    {}
+
+    template<typename SHORT_VEC, typename HOOD>
+    inline SHORT_VEC evaluate(const HOOD& hood) const
+    {
+        return SHORT_VEC(address(hood[FixedCoord<X, Y, Z>()]));
+    }
+
+private:
+    int offset;
+
+    template<typename ACCESSOR>
+    inline const MEMBER *address(ACCESSOR accessor) const
+    {
+        return reinterpret_cast<const MEMBER*>(accessor.access_member(sizeof(MEMBER), offset));
+    }
+};
+
+/**
+ * A scalar which will be broadcast to all vector lanes.
+ */
+class Constant : public Expression<Constant>
+{
+public:
+    inline explicit Constant(double value) :
+        value(value)
+    {}
+
+    template<typename SHORT_VEC, typename HOOD>
+    inline SHORT_VEC evaluate(const HOOD& /* hood */) const
+    {
+        return SHORT_VEC(value);
+    }
+
+private:
+    double value;
+};
+
+class Plus
+{
+public:
+    template<typename SHORT_VEC>
+    static inline SHORT_VEC apply(const SHORT_VEC& left, const SHORT_VEC& right)
+    {
+        return left + right;
+    }
+};
+
+class Minus
+{
+public:
+    template<typename SHORT_VEC>
+    static inline SHORT_VEC apply(const SHORT_VEC& left, const SHORT_VEC& right)
+    {
+        return left - right;
+    }
+};
+
+class Multiplies
+{
+public:
+    template<typename SHORT_VEC>
+    static inline SHORT_VEC apply(const SHORT_VEC& left, const SHORT_VEC& right)
+    {
+        return left * right;
+    }
+};
+
+class Divides
+{
+public:
+    template<typename SHORT_VEC>
+    static inline SHORT_VEC apply(const SHORT_VEC& left, const SHORT_VEC& right)
+    {
+        return left / right;
+    }
+};
+
+template<typename LEFT, typename RIGHT, typename OPERATOR>
+class BinaryOperation : public Expression<BinaryOperation<LEFT, RIGHT, OPERATOR> >
+{
+public:
+    inline BinaryOperation(const LEFT& left, const RIGHT& right) :
+        left(left),
+        right(right)
+    {}
+
+    template<typename SHORT_VEC, typename HOOD>
+    inline SHORT_VEC evaluate(const HOOD& hood) const
+    {
+        return OPERATOR::apply(
+            left.template evaluate<SHORT_VEC>(hood),
+            right.template evaluate<SHORT_VEC>(hood));
+    }
+
+private:
+    LEFT left;
+    RIGHT right;
+};
+
+template<typename OPERAND>
+class Negation : public Expression<Negation<OPERAND> >
+{
+public:
+    inline explicit Negation(const OPERAND& operand) :
+        operand(operand)
+    {}
+
+    template<typename SHORT_VEC, typename HOOD>
+    inline SHORT_VEC evaluate(const HOOD& hood) const
+    {
+        return SHORT_VEC(0.0) - operand.template evaluate<SHORT_VEC>(hood);
+    }
+
+private:
+    OPERAND operand;
+};
+
+template<typename OPERAND>
+class SquareRoot : public Expression<SquareRoot<OPERAND> >
+{
+public:
+    inline explicit SquareRoot(const OPERAND& operand) :
+        operand(operand)
+    {}
+
+    template<typename SHORT_VEC, typename HOOD>
+    inline SHORT_VEC evaluate(const HOOD& hood) const
+    {
+        return operand.template evaluate<SHORT_VEC>(hood).sqrt();
+    }
+
+private:
+    OPERAND operand;
+};
+
+/**
+ * Convenience function so users don't have to spell out the
+ * Neighbor's type.
+ */
+template<typename CELL, typename MEMBER, int X, int Y, int Z>
+inline Neighbor<CELL, MEMBER, X, Y, Z> neighbor(FixedCoord<X, Y, Z> /* coord */, MEMBER CELL:: *memberPointer)
+{
+    return Neighbor<CELL, MEMBER, X, Y, Z>(memberPointer);
+}
+
+#define LIBGEODECOMP_STENCIL_EXPRESSION_OPERATOR(SYMBOL, OPERATOR)      \
+    template<typename LEFT, typename RIGHT>                             \
+    inline BinaryOperation<LEFT, RIGHT, OPERATOR> operator SYMBOL(      \
+        const Expression<LEFT>& left,                                   \
+        const Expression<RIGHT>& right)                                 \
+    {                                                                   \
+        return BinaryOperation<LEFT, RIGHT, OPERATOR>(                  \
+            left.derived(), right.derived());                           \
+    }                                                                   \
+                                                                        \
+    template<typename LEFT>                                             \
+    inline BinaryOperation<LEFT, Constant, OPERATOR> operator SYMBOL(   \
+        const Expression<LEFT>& left,                                   \
+        double right)                                                   \
+    {                                                                   \
+        return BinaryOperation<LEFT, Constant, OPERATOR>(               \
+            left.derived(), Constant(right));                           \
+    }                                                                   \
+                                                                        \
+    template<typename RIGHT>                                            \
+    inline BinaryOperation<Constant, RIGHT, OPERATOR> operator SYMBOL(  \
+        double left,                                                    \
+        const Expression<RIGHT>& right)                                 \
+    {                                                                   \
+        return BinaryOperation<Constant, RIGHT, OPERATOR>(              \
+            Constant(left), right.derived());                           \
+    }
+
+LIBGEODECOMP_STENCIL_EXPRESSION_OPERATOR(+, Plus)
+LIBGEODECOMP_STENCIL_EXPRESSION_OPERATOR(-, Minus)
+LIBGEODECOMP_STENCIL_EXPRESSION_OPERATOR(*, Multiplies)
+LIBGEODECOMP_STENCIL_EXPRESSION_OPERATOR(/, Divides)
+
+#undef LIBGEODECOMP_STENCIL_EXPRESSION_OPERATOR
+
+template<typename OPERAND>
+inline Negation<OPERAND> operator-(const Expression<OPERAND>& operand)
+{
+    return Negation<OPERAND>(operand.derived());
+}
+
+template<typename OPERAND>
+inline SquareRoot<OPERAND> sqrt(const Expression<OPERAND>& operand)
+{
+    return SquareRoot<OPERAND>(operand.derived());
+}
+
+/**
+ * Evaluates the expression for all cells from the current index of
+ * hoodOld up to indexEnd, with both neighborhoods being advanced in
+ * lockstep, just as an updateLineX() written by hand would do.
+ */
+template<typename SHORT_VEC, typename HOOD_OLD, typename HOOD_NEW, typename MEMBER, typename EXPRESSION>
+inline void updateLineXImplementation(
+    long& x,
+    long endX,
+    const HOOD_OLD& hoodOld,
+    HOOD_NEW& hoodNew,
+    MEMBER * /* type tag */,
+    int targetOffset,
+    const EXPRESSION& expression)
+{
+    for (; x < endX; x += SHORT_VEC::ARITY) {
+        SHORT_VEC value = expression.template evaluate<SHORT_VEC>(hoodOld);
+        MEMBER *target = reinterpret_cast<MEMBER*>(hoodNew.access_member(sizeof(MEMBER), targetOffset));
+        target << value;
+        hoodNew += SHORT_VEC::ARITY;
+    }
+}
+
+/**
+ * Writes the value of expression to member target of all cells
+ * covered by the current streak. SHORT_VEC determines the vector
+ * type used for the bulk of the iterations, its scalar sibling is
+ * used for the peeled iterations.
+ */
+template<typename SHORT_VEC, typename HOOD_OLD, typename HOOD_NEW, typename CELL, typename MEMBER, typename EXPRESSION>
+inline void updateLineX(
+    HOOD_OLD& hoodOld,
+    long indexEnd,
+    HOOD_NEW& hoodNew,
+    MEMBER CELL:: *target,
+    const Expression<EXPRESSION>& expression)
+{
+    typedef typename LibFlatArray::detail::flat_array::sibling_short_vec_switch<SHORT_VEC, 1>::VALUE Scalar;
+    int targetOffset = LibFlatArray::member_ptr_to_offset()(target);
+    MEMBER *tag = 0;
+
+    // the peeler assumes at least one full vector per streak:
+    if ((indexEnd - hoodOld.index()) < long(SHORT_VEC::ARITY)) {
+        updateLineXImplementation<Scalar>(
+            hoodOld.index(), indexEnd, hoodOld, hoodNew, tag, targetOffset, expression.derived());
+        return;
+    }
+
+    LIBFLATARRAY_LOOP_PEELER_TEMPLATE(
+        SHORT_VEC, long, hoodOld.index(), indexEnd, updateLineXImplementation,
+        hoodOld, hoodNew, tag, targetOffset, expression.derived());
+}
+
+/**
+ * Same as above, but picks the vector type based on the target
+ * member's type and the instruction set LibFlatArray was built for.
+ */
+template<typename HOOD_OLD, typename HOOD_NEW, typename CELL, typename MEMBER, typename EXPRESSION>
+inline void updateLineX(
+    HOOD_OLD& hoodOld,
+    long indexEnd,
+    HOOD_NEW& hoodNew,
+    MEMBER CELL:: *target,
+    const Expression<EXPRESSION>& expression)
+{
+    typedef LibFlatArray::short_vec<MEMBER, LibFlatArray::ilp_to_arity<MEMBER, 2>::ARITY> ShortVec;
+    updateLineX<ShortVec>(hoodOld, indexEnd, hoodNew, target, expression);
+}
+
+}
+
+}
+
+#endif
@@ -0,0 +1,120 @@
+#include <cxxtest/TestSuite.h>
+#include <libgeodecomp/geometry/region.h>
+#include <libgeodecomp/misc/allocationcounter.h>
+#include <libgeodecomp/storage/bufferpool.h>
+
+#include <vector>
+
+using namespace LibGeoDecomp;
+
+namespace LibGeoDecomp {
+
+class BufferPoolTest : public CxxTest::TestSuite
+{
+public:
+    typedef BufferPool<double> PoolType;
+    typedef PoolType::BufferType BufferType;
+
+    void testPlainAllocationsAreCounted()
+    {
+        std::size_t allocations = AllocationCounter::allocations();
+        std::size_t bytes = AllocationCounter::bytes();
+        {
+            std::vector<double> vec(1000);
+            vec[999] = 1;
+        }
+        TS_ASSERT_EQUALS(allocations + 1, AllocationCounter::allocations());
+        TS_ASSERT_EQUALS(bytes + 1000 * sizeof(double), AllocationCounter::bytes());
+
+        Region<2> region;
+        region << Streak<2>(Coord<2>(0, 0), 10)
+               << Streak<2>(Coord<2>(0, 5), 10);
+        TS_ASSERT_LESS_THAN(allocations + 1, AllocationCounter::allocations());
+    }
+
+    void testRecycling()
+    {
+        PoolType pool;
+        Region<2> small = region(10);
+        Region<2> large = region(100);
+
+        BufferType buf1 = pool.acquire(small);
+        BufferType buf2 = pool.acquire(large);
+        TS_ASSERT_EQUALS(std::size_t(10),  buf1.size());
+        TS_ASSERT_EQUALS(std::size_t(100), buf2.size());
+        TS_ASSERT_EQUALS(std::size_t(16),  buf1.capacity());
+        TS_ASSERT_EQUALS(std::size_t(128), buf2.capacity());
+
+        const double *data1 = &buf1[0];
+        const double *data2 = &buf2[0];
+        pool.release(std::move(buf1));
+        pool.release(std::move(buf2));
+        TS_ASSERT_EQUALS(std::size_t(2), pool.size());
+
+        // in steady state no new memory is needed:
+        std::size_t allocations = AllocationCounter::allocations();
+        for (int i = 0; i < 10; ++i) {
+            BufferType buf3 = pool.acquire(large);
+            BufferType buf4 = pool.acquire(small);
+            TS_ASSERT_EQUALS(data2, &buf3[0]);
+            TS_ASSERT_EQUALS(data1, &buf4[0]);
+            TS_ASSERT_EQUALS(std::size_t(100), buf3.size());
+            TS_ASSERT_EQUALS(std::size_t(10),  buf4.size());
+
+            pool.release(std::move(buf4));
+            pool.release(std::move(buf3));
+        }
+        TS_ASSERT_EQUALS(allocations, AllocationCounter::allocations());
+    }
+
+    void testLargerBuffersServeSmallerRequests()
+    {
+        PoolType pool;
+        pool.release(pool.acquire(region(100)));
+        // Regions allocate, too:
+        Region<2> request = region(20);
+
+        std::size_t allocations = AllocationCounter::allocations();
+        BufferType buf = pool.acquire(request);
+        TS_ASSERT_EQUALS(std::size_t(20), buf.size());
+        TS_ASSERT_EQUALS(std::size_t(0), pool.size());
+        TS_ASSERT_EQUALS(allocations, AllocationCounter::allocations());
+
+        // pool is empty, so this will allocate:
+        BufferType buf2 = pool.acquire(request);
+        TS_ASSERT_EQUALS(allocations + 1, AllocationCounter::allocations());
+    }
+
+    void testEmptyRegion()
+    {
+        PoolType pool;
+        std::size_t allocations = AllocationCounter::allocations();
+
+        BufferType buf = pool.acquire(Region<2>());
+        TS_ASSERT_EQUALS(std::size_t(0), buf.size());
+        pool.release(std::move(buf));
+        TS_ASSERT_EQUALS(std::size_t(0), pool.size());
+        TS_ASSERT_EQUALS(allocations, AllocationCounter::allocations());
+    }
+
+    void testClear()
+    {
+        PoolType pool;
+        pool.release(pool.acquire(region(5)));
+        pool.release(pool.acquire(region(50)));
+        TS_ASSERT_EQUALS(std::size_t(2), pool.size());
+
+        pool.clear();
+        TS_ASSERT_EQUALS(std::size_t(0), pool.size());
+    }
+
+private:
+    Region<2> region(int size)
+    {
+        Region<2> ret;
+        ret << Streak<2>(Coord<2>(0, 0), size);
+        return ret;
+    }
+};
+
+}
@@ -1,6 +1,8 @@
 #include <libgeodecomp/storage/containercell.h>
 #include <libgeodecomp/storage/displacedgrid.h>
+#include <libgeodecomp/storage/grid.h>
 #include <libgeodecomp/storage/meshlessadapter.h>
+#include <libgeodecomp/storage/updatefunctor.h>
 #include <libgeodecomp/misc/testhelper.h>
 
 #include <cxxtest/TestSuite.h>
@@ -40,6 +42,36 @@ public:
     std::vector<int> *ids;
 };
 
+class MigratingCell
+{
+public:
+    typedef Topologies::Cube<2>::Topology Topology;
+
+    class API : public APITraits::HasMigration
+    {};
+
+    explicit MigratingCell(int id = 0, const Coord<2>& direction = Coord<2>()) :
+        id(id),
+        direction(direction),
+        updates(0)
+    {}
+
+    template<class NEIGHBORHOOD>
+    void update(const NEIGHBORHOOD& neighbors, int nanoStep)
+    {
+        ++updates;
+    }
+
+    Coord<2> migrationTarget() const
+    {
+        return direction;
+    }
+
+    int id;
+    Coord<2> direction;
+    int updates;
+};
+
 class ContainerCellTest : public CxxTest::TestSuite
 {
 public:
@@ -214,6 +246,154 @@ public:
             }
         }
     }
+
+    void testBulkInsert()
+    {
+        ContainerCell<MockCell, 10> container;
+        container.insert(3, MockCell(3));
+        container.insert(7, MockCell(7));
+        container.insert(8, MockCell(8));
+
+        std::vector<int> newIDs;
+        std::vector<MockCell> newCells;
+        newIDs << 9 << 1 << 7 << 5 << 4 << 1;
+        newCells << MockCell(9) << MockCell(1) << MockCell(70) << MockCell(5) << MockCell(4) << MockCell(10);
+        container.insert(newIDs.begin(), newIDs.end(), newCells.begin());
+
+        std::vector<int> expectedIDs;
+        expectedIDs << 1 << 3 << 4 << 5 << 7 << 8 << 9;
+        std::vector<int> expectedCells;
+        expectedCells << 10 << 3 << 4 << 5 << 70 << 8 << 9;
+
+        TS_ASSERT_EQUALS(expectedIDs.size(), container.size());
+        for (std::size_t i = 0; i < container.size(); ++i) {
+            TS_ASSERT_EQUALS(expectedIDs[i], container.ids[i]);
+            TS_ASSERT_EQUALS(expectedCells[i], container.cells[i].id);
+        }
+
+        newIDs.clear();
+        newIDs << 11 << 12 << 13 << 14;
+        TS_ASSERT_THROWS(container.insert(newIDs.begin(), newIDs.end(), newCells.begin()), std::logic_error);
+        TS_ASSERT_EQUALS(expectedIDs.size(), container.size());
+    }
+
+    void testBulkRemove()
+    {
+        ContainerCell<MockCell, 10> container;
+        for (int i = 0; i < 10; ++i) {
+            container.insert(i * 2, MockCell(i * 2));
+        }
+
+        std::vector<int> doomed;
+        doomed << 18 << 3 << 0 << 10 << 8 << 10;
+        TS_ASSERT_EQUALS(std::size_t(4), container.remove(doomed.begin(), doomed.end()));
+
+        std::vector<int> expectedIDs;
+        expectedIDs << 2 << 4 << 6 << 12 << 14 << 16;
+        TS_ASSERT_EQUALS(expectedIDs.size(), container.size());
+        for (std::size_t i = 0; i < container.size(); ++i) {
+            TS_ASSERT_EQUALS(expectedIDs[i], container.ids[i]);
+            TS_ASSERT_EQUALS(expectedIDs[i], container.cells[i].id);
+        }
+    }
+
+    void testMigration()
+    {
+        typedef ContainerCell<MigratingCell, 10> CellType;
+        Coord<2> dim(4, 3);
+        Region<2> region;
+        region << CoordBox<2>(Coord<2>(), dim);
+        Grid<CellType> grid1(dim);
+        Grid<CellType> grid2(dim);
+
+        grid1[Coord<2>(1, 1)].insert(1, MigratingCell(1, Coord<2>( 1, 0)));
+        grid1[Coord<2>(1, 1)].insert(2, MigratingCell(2, Coord<2>( 0, 1)));
+        grid1[Coord<2>(1, 1)].insert(3, MigratingCell(3, Coord<2>( 0, 0)));
+        grid1[Coord<2>(2, 1)].insert(4, MigratingCell(4, Coord<2>(-1, 0)));
+        grid1[Coord<2>(2, 1)].insert(5, MigratingCell(5, Coord<2>( 0, 0)));
+
+        // migrations get recorded during the update...
+        UpdateFunctor<CellType>()(region, Coord<2>(), Coord<2>(), grid1, &grid2, 0);
+        checkContainer(grid2[Coord<2>(1, 1)], idList(1, 2, 3), 1);
+        checkContainer(grid2[Coord<2>(2, 1)], idList(4, 5), 1);
+
+        // ...and applied during the next one:
+        UpdateFunctor<CellType>()(region, Coord<2>(), Coord<2>(), grid2, &grid1, 0);
+        checkContainer(grid1[Coord<2>(1, 1)], idList(3, 4), 2);
+        checkContainer(grid1[Coord<2>(2, 1)], idList(1, 5), 2);
+        checkContainer(grid1[Coord<2>(1, 2)], idList(2), 2);
+
+        // entity 2 would drop off the grid...
+        TS_ASSERT_THROWS(
+            UpdateFunctor<CellType>()(region, Coord<2>(), Coord<2>(), grid1, &grid2, 0),
+            std::logic_error&);
+
+        // ...unless it gets removed beforehand:
+        grid1[Coord<2>(1, 2)].remove(2);
+        UpdateFunctor<CellType>()(region, Coord<2>(), Coord<2>(), grid1, &grid2, 0);
+        checkContainer(grid2[Coord<2>(0, 1)], idList(4), 3);
+        checkContainer(grid2[Coord<2>(1, 1)], idList(3), 3);
+        checkContainer(grid2[Coord<2>(2, 1)], idList(5), 3);
+        checkContainer(grid2[Coord<2>(3, 1)], idList(1), 3);
+        checkContainer(grid2[Coord<2>(1, 2)], idList(), 3);
+
+        std::size_t total = 0;
+        for (CoordBox<2>::Iterator i = region.boundingBox().begin(); i != region.boundingBox().end(); ++i) {
+            total += grid2[*i].size();
+        }
+        TS_ASSERT_EQUALS(std::size_t(4), total);
+    }
+
+    void testMigrationTargetMustBeNeighbor()
+    {
+        typedef ContainerCell<MigratingCell, 10> CellType;
+        Coord<2> dim(5, 5);
+        Region<2> region;
+        region << CoordBox<2>(Coord<2>(), dim);
+        Grid<CellType> grid1(dim);
+        Grid<CellType> grid2(dim);
+
+        grid1[Coord<2>(2, 2)].insert(1, MigratingCell(1, Coord<2>(2, 0)));
+        TS_ASSERT_THROWS(
+            UpdateFunctor<CellType>()(region, Coord<2>(), Coord<2>(), grid1, &grid2, 0),
+            std::logic_error&);
+    }
+
+    void testNoOutboxWithoutMigration()
+    {
+        // cargo without migration support doesn't pay for an outbox:
+        TS_ASSERT_EQUALS(
+            sizeof(ContainerCell<MockCell, 10>),
+            sizeof(int[10]) + sizeof(MockCell[10]) + sizeof(std::size_t));
+        TS_ASSERT(
+            sizeof(ContainerCell<MigratingCell, 10>) >
+            sizeof(int[10]) + sizeof(MigratingCell[10]) + sizeof(std::size_t));
+    }
+
+private:
+    std::vector<int> idList(int a = -1, int b = -1, int c = -1)
+    {
+        std::vector<int> ret;
+        int ids[] = { a, b, c };
+        for (int i = 0; i < 3; ++i) {
+            if (ids[i] != -1) {
+                ret << ids[i];
+            }
+        }
+
+        return ret;
+    }
+
+    template<typename CONTAINER>
+    void checkContainer(const CONTAINER& container, const std::vector<int>& expectedIDs, int expectedUpdates)
+    {
+        TS_ASSERT_EQUALS(expectedIDs.size(), container.size());
+        for (std::size_t i = 0; i < expectedIDs.size(); ++i) {
+            TS_ASSERT_EQUALS(expectedIDs[i], container.getIDs()[i]);
+            TS_ASSERT_EQUALS(expectedIDs[i], container[expectedIDs[i]]->id);
+            TS_ASSERT_EQUALS(expectedUpdates, container[expectedIDs[i]]->updates);
+        }
+    }
 };
 
 }
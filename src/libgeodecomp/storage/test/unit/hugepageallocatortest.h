@@ -0,0 +1,74 @@
+#include <cxxtest/TestSuite.h>
+#include <libgeodecomp/misc/allocationcounter.h>
+#include <libgeodecomp/storage/grid.h>
+#include <libgeodecomp/storage/hugepageallocator.h>
+
+#include <vector>
+
+using namespace LibGeoDecomp;
+
+namespace LibGeoDecomp {
+
+class HugePageTestCell
+{
+public:
+    class API :
+        public APITraits::HasAllocator<HugePageAllocator<char> >
+    {};
+
+    explicit HugePageTestCell(double value = 0) :
+        value(value)
+    {}
+
+    double value;
+};
+
+class HugePageAllocatorTest : public CxxTest::TestSuite
+{
+public:
+    void testSmallAndLargeBlocks()
+    {
+        HugePageAllocator<double> allocator;
+        std::size_t sizes[] = { 1, 17, 1000, (1 << 21) / sizeof(double), 3 * (1 << 20) + 5 };
+
+        for (int i = 0; i < 5; ++i) {
+            std::size_t allocations = AllocationCounter::allocations();
+            double *data = allocator.allocate(sizes[i]);
+            TS_ASSERT_EQUALS(allocations + 1, AllocationCounter::allocations());
+            TS_ASSERT_EQUALS(std::size_t(0), reinterpret_cast<std::size_t>(data) % 64);
+
+            for (std::size_t j = 0; j < sizes[i]; ++j) {
+                data[j] = j;
+            }
+            TS_ASSERT_EQUALS(double(sizes[i] - 1), data[sizes[i] - 1]);
+
+            allocator.deallocate(data, sizes[i]);
+        }
+    }
+
+    void testVector()
+    {
+        std::vector<int, HugePageAllocator<int> > vec(1 << 20, 5);
+        vec.resize(3 << 20, 7);
+        TS_ASSERT_EQUALS(5, vec[(1 << 20) - 1]);
+        TS_ASSERT_EQUALS(7, vec[1 << 20]);
+        TS_ASSERT_EQUALS(std::size_t(0), reinterpret_cast<std::size_t>(&vec[0]) % 64);
+    }
+
+    void testGridUsesAllocatorFromAPITraits()
+    {
+        typedef Grid<HugePageTestCell> GridType;
+        typedef GridType::Allocator Allocator;
+        TS_ASSERT_EQUALS(sizeof(HugePageTestCell), sizeof(Allocator::value_type));
+
+        std::size_t allocations = AllocationCounter::allocations();
+        GridType grid(Coord<2>(1000, 500), HugePageTestCell(1.5));
+        TS_ASSERT_EQUALS(allocations + 1, AllocationCounter::allocations());
+
+        TS_ASSERT_EQUALS(1.5, grid.get(Coord<2>(999, 499)).value);
+        grid.set(Coord<2>(10, 20), HugePageTestCell(-1));
+        TS_ASSERT_EQUALS(-1, grid.get(Coord<2>(10, 20)).value);
+    }
+};
+
+}
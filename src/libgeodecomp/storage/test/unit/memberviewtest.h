@@ -0,0 +1,156 @@
+#include <libgeodecomp/misc/stdcontaineroverloads.h>
+#include <libgeodecomp/misc/testcell.h>
+#include <libgeodecomp/storage/displacedgrid.h>
+#include <libgeodecomp/storage/grid.h>
+#include <libgeodecomp/storage/memberview.h>
+#include <libgeodecomp/storage/proxygrid.h>
+#include <libgeodecomp/storage/soagrid.h>
+#include <libgeodecomp/storage/unstructuredgrid.h>
+
+#include <cxxtest/TestSuite.h>
+
+using namespace LibGeoDecomp;
+
+namespace LibGeoDecomp {
+
+class MemberViewTestElement
+{
+public:
+    explicit MemberViewTestElement(double value = 0, int id = 0) :
+        value(value),
+        id(id)
+    {}
+
+    double value;
+    int id;
+};
+
+/**
+ * Collects everything a MemberView passes on.
+ */
+template<typename MEMBER, int DIM>
+class MemberViewRecorder
+{
+public:
+    void operator()(const Streak<DIM>& streak, const MemberStreak<MEMBER>& members)
+    {
+        streaks << streak;
+        strides << members.getStride();
+        for (int i = 0; i < members.size(); ++i) {
+            values << members[i];
+        }
+        firstAddresses << &members[0];
+    }
+
+    void operator()(const MEMBER& member)
+    {
+        values << member;
+    }
+
+    std::vector<Streak<DIM> > streaks;
+    std::vector<std::ptrdiff_t> strides;
+    std::vector<MEMBER> values;
+    std::vector<const MEMBER*> firstAddresses;
+};
+
+class MemberViewTest : public CxxTest::TestSuite
+{
+public:
+    void testAoSInPlace()
+    {
+        Grid<TestCell<2> > grid(Coord<2>(6, 4));
+        for (int y = 0; y < 4; ++y) {
+            for (int x = 0; x < 6; ++x) {
+                grid[Coord<2>(x, y)].testValue = 10 * y + x;
+            }
+        }
+
+        Region<2> region;
+        region << Streak<2>(Coord<2>(1, 1), 4)
+               << Streak<2>(Coord<2>(0, 3), 2);
+
+        MemberViewRecorder<double, 2> recorder;
+        MemberView<TestCell<2>, double>(grid, &TestCell<2>::testValue, region).forEachStreak(recorder);
+
+        std::vector<Streak<2> > expectedStreaks;
+        expectedStreaks << Streak<2>(Coord<2>(1, 1), 4)
+                        << Streak<2>(Coord<2>(0, 3), 2);
+        TS_ASSERT_EQUALS(expectedStreaks, recorder.streaks);
+
+        std::vector<double> expectedValues;
+        expectedValues << 11 << 12 << 13 << 30 << 31;
+        TS_ASSERT_EQUALS(expectedValues, recorder.values);
+
+        // no copies:
+        TS_ASSERT_EQUALS(std::ptrdiff_t(sizeof(TestCell<2>)), recorder.strides[0]);
+        TS_ASSERT_EQUALS(&grid[Coord<2>(1, 1)].testValue, recorder.firstAddresses[0]);
+        TS_ASSERT_EQUALS(&grid[Coord<2>(0, 3)].testValue, recorder.firstAddresses[1]);
+    }
+
+    void testDisplacedAndProxyGrid()
+    {
+        CoordBox<2> box(Coord<2>(10, 20), Coord<2>(5, 3));
+        DisplacedGrid<TestCell<2> > grid(box);
+        for (CoordBox<2>::Iterator i = box.begin(); i != box.end(); ++i) {
+            grid[*i].testValue = i->x() + i->y();
+        }
+        ProxyGrid<TestCell<2>, 2> proxy(&grid, box);
+
+        Region<2> region;
+        region << Streak<2>(Coord<2>(12, 21), 15);
+
+        MemberViewRecorder<double, 2> recorder;
+        MemberView<TestCell<2>, double>(proxy, &TestCell<2>::testValue, region).forEach(recorder);
+
+        std::vector<double> expectedValues;
+        expectedValues << 33 << 34 << 35;
+        TS_ASSERT_EQUALS(expectedValues, recorder.values);
+    }
+
+    void testSoAInPlace()
+    {
+        CoordBox<3> box(Coord<3>(1, 2, 3), Coord<3>(8, 4, 3));
+        SoAGrid<TestCellSoA, Topologies::Cube<3>::Topology> grid(box);
+        for (CoordBox<3>::Iterator i = box.begin(); i != box.end(); ++i) {
+            TestCellSoA cell;
+            cell.testValue = i->x() + 100 * i->y() + 10000 * i->z();
+            grid.set(*i, cell);
+        }
+
+        Region<3> region;
+        region << Streak<3>(Coord<3>(2, 3, 4), 6)
+               << Streak<3>(Coord<3>(1, 5, 5), 3);
+
+        MemberViewRecorder<double, 3> recorder;
+        MemberView<TestCellSoA, double>(grid, &TestCellSoA::testValue, region).forEachStreak(recorder);
+
+        std::vector<double> expectedValues;
+        expectedValues << 40302 << 40303 << 40304 << 40305
+                       << 50501 << 50502;
+        TS_ASSERT_EQUALS(expectedValues, recorder.values);
+        TS_ASSERT_EQUALS(std::ptrdiff_t(sizeof(double)), recorder.strides[0]);
+        TS_ASSERT_EQUALS(std::ptrdiff_t(sizeof(double)), recorder.strides[1]);
+    }
+
+    void testFallbackCopiesStreaks()
+    {
+        UnstructuredGrid<MemberViewTestElement> grid(Coord<1>(10));
+        for (int i = 0; i < 10; ++i) {
+            grid.set(Coord<1>(i), MemberViewTestElement(i * 0.5, i));
+        }
+
+        Region<1> region;
+        region << Streak<1>(Coord<1>(2), 5)
+               << Streak<1>(Coord<1>(8), 10);
+
+        MemberViewRecorder<int, 1> recorder;
+        MemberView<MemberViewTestElement, int, 1>(grid, &MemberViewTestElement::id, region).forEachStreak(recorder);
+
+        std::vector<int> expectedValues;
+        expectedValues << 2 << 3 << 4 << 8 << 9;
+        TS_ASSERT_EQUALS(expectedValues, recorder.values);
+        TS_ASSERT_EQUALS(std::ptrdiff_t(sizeof(int)), recorder.strides[0]);
+    }
+};
+
+}
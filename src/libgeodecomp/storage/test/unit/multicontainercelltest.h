@@ -241,6 +241,34 @@ DECLARE_MULTI_CONTAINER_CELL(
     (((BoxCell<FixedArray<SimpleParticle, 20> >))(particles))
     (((ContainerCell<SimpleElement, 10>))(elements)) )
 
+class MultiContainerMigratingCell
+{
+public:
+    typedef Topologies::Cube<2>::Topology Topology;
+
+    class API : public APITraits::HasMigration
+    {};
+
+    explicit MultiContainerMigratingCell(const Coord<2>& direction = Coord<2>()) :
+        direction(direction)
+    {}
+
+    template<typename NEIGHBORHOOD>
+    void update(const NEIGHBORHOOD& hood, int nanoStep)
+    {}
+
+    Coord<2> migrationTarget() const
+    {
+        return direction;
+    }
+
+    Coord<2> direction;
+};
+
+DECLARE_MULTI_CONTAINER_CELL(
+    MigratingContainer,
+    MultiContainerMigratingCell,
+    (((ContainerCell<MultiContainerMigratingCell, 5>))(movers)) )
 
 class MultiContainerCellTest : public CxxTest::TestSuite
 {
@@ -356,6 +384,33 @@ public:
         TS_ASSERT_EQUALS(expectedLog, multiContainerCellTestLog);
     }
 
+    void testMigration()
+    {
+        Coord<2> dim(3, 3);
+        Region<2> region;
+        region << CoordBox<2>(Coord<2>(), dim);
+        Grid<MigratingContainer> grid1(dim);
+        Grid<MigratingContainer> grid2(dim);
+
+        grid1[Coord<2>(0, 1)].movers.insert(1, MultiContainerMigratingCell(Coord<2>(1, 0)));
+        grid1[Coord<2>(0, 1)].movers.insert(2, MultiContainerMigratingCell(Coord<2>(0, 0)));
+
+        UpdateFunctor<MigratingContainer>()(region, Coord<2>(), Coord<2>(), grid1, &grid2, 0);
+        UpdateFunctor<MigratingContainer>()(region, Coord<2>(), Coord<2>(), grid2, &grid1, 0);
+        TS_ASSERT_EQUALS(std::size_t(1), grid1[Coord<2>(0, 1)].movers.size());
+        TS_ASSERT(grid1[Coord<2>(0, 1)].movers[2]);
+        TS_ASSERT_EQUALS(std::size_t(1), grid1[Coord<2>(1, 1)].movers.size());
+        TS_ASSERT(grid1[Coord<2>(1, 1)].movers[1]);
+
+        UpdateFunctor<MigratingContainer>()(region, Coord<2>(), Coord<2>(), grid1, &grid2, 0);
+        TS_ASSERT(grid2[Coord<2>(2, 1)].movers[1]);
+
+        // next stop would be outside of the grid:
+        TS_ASSERT_THROWS(
+            UpdateFunctor<MigratingContainer>()(region, Coord<2>(), Coord<2>(), grid2, &grid1, 0),
+            std::logic_error&);
+    }
+
     void testBoxCell()
     {
         Coord<2> dim(10, 5);
@@ -0,0 +1,58 @@
+#include <cxxtest/TestSuite.h>
+#include <libgeodecomp/misc/allocationcounter.h>
+#include <libgeodecomp/storage/nanostepset.h>
+
+#include <vector>
+
+using namespace LibGeoDecomp;
+
+namespace LibGeoDecomp {
+
+class NanoStepSetTest : public CxxTest::TestSuite
+{
+public:
+    void testOrderAndUniqueness()
+    {
+        NanoStepSet set;
+        TS_ASSERT(set.empty());
+
+        set << 30 << 10 << 20 << 10;
+        TS_ASSERT_EQUALS(std::size_t(3), set.size());
+
+        std::vector<std::size_t> expected;
+        expected.push_back(10);
+        expected.push_back(20);
+        expected.push_back(30);
+        TS_ASSERT_EQUALS(expected, std::vector<std::size_t>(set.begin(), set.end()));
+        TS_ASSERT_EQUALS(std::size_t(10), (min)(set));
+
+        erase_min(set);
+        TS_ASSERT_EQUALS(std::size_t(20), (min)(set));
+
+        TS_ASSERT_EQUALS(std::size_t(0), set.erase(25));
+        TS_ASSERT_EQUALS(std::size_t(1), set.erase(30));
+        TS_ASSERT_EQUALS(std::size_t(1), set.size());
+
+        set.clear();
+        TS_ASSERT(set.empty());
+    }
+
+    void testNoAllocationsOnceWarmedUp()
+    {
+        NanoStepSet set;
+        set << 0 << 1;
+        erase_min(set);
+        erase_min(set);
+
+        std::size_t allocations = AllocationCounter::allocations();
+        for (std::size_t i = 0; i < 100; ++i) {
+            set << i << (i + 1);
+            erase_min(set);
+            erase_min(set);
+        }
+
+        TS_ASSERT_EQUALS(allocations, AllocationCounter::allocations());
+    }
+};
+
+}
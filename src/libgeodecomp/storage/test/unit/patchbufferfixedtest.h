@@ -8,6 +8,29 @@ using namespace LibGeoDecomp;
 
 namespace LibGeoDecomp {
 
+class PatchBufferFixedTestCell
+{
+public:
+    class API :
+        public APITraits::HasGhostMembers
+    {};
+
+    explicit PatchBufferFixedTestCell(int value = 0, int diagnostic = 0) :
+        value(value),
+        diagnostic(diagnostic)
+    {}
+
+    static std::vector<Selector<PatchBufferFixedTestCell> > ghostMembers()
+    {
+        std::vector<Selector<PatchBufferFixedTestCell> > ret;
+        ret << Selector<PatchBufferFixedTestCell>(&PatchBufferFixedTestCell::value, "value");
+        return ret;
+    }
+
+    int value;
+    int diagnostic;
+};
+
 class PatchBufferFixedTest : public CxxTest::TestSuite
 {
 public:
@@ -84,6 +107,34 @@ public:
         TS_ASSERT_THROWS(patchBuffer.get(&compGrid, validRegion, dimensions.dimensions, 2, 0, true), std::logic_error);
     }
 
+    void testGhostZoneSerializationBuffer()
+    {
+        typedef DisplacedGrid<PatchBufferFixedTestCell> CellGridType;
+        typedef PatchBufferFixed<
+            CellGridType,
+            CellGridType,
+            1,
+            GhostZoneSerializationBuffer<PatchBufferFixedTestCell> > CellPatchBufferType;
+
+        CellGridType source(dimensions);
+        for (CoordBox<2>::Iterator i = dimensions.begin(); i != dimensions.end(); ++i) {
+            source[*i] = PatchBufferFixedTestCell(10 * i->y() + i->x(), 1);
+        }
+
+        CellPatchBufferType patchBuffer(region1);
+        patchBuffer.pushRequest(0);
+        patchBuffer.put(source, validRegion, dimensions.dimensions, 0, 0);
+
+        CellGridType target(dimensions, PatchBufferFixedTestCell(-1, -1));
+        patchBuffer.get(&target, validRegion, dimensions.dimensions, 0, 0);
+
+        for (CoordBox<2>::Iterator i = dimensions.begin(); i != dimensions.end(); ++i) {
+            int expectedValue = region1.count(*i) ? source[*i].value : -1;
+            TS_ASSERT_EQUALS(expectedValue, target[*i].value);
+            TS_ASSERT_EQUALS(-1, target[*i].diagnostic);
+        }
+    }
+
 private:
     CoordBox<2> dimensions;
     GridType baseGrid;
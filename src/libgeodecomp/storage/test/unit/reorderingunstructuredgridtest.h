@@ -9,6 +9,33 @@ using namespace LibGeoDecomp;
 
 namespace LibGeoDecomp {
 
+template<typename ADDITIONAL_API>
+class ReorderingTestCell
+{
+public:
+    class API :
+        public ADDITIONAL_API,
+        public APITraits::HasUnstructuredTopology,
+        public APITraits::HasSellC<4>,
+        public APITraits::HasSellSigma<8>
+    {};
+
+    inline explicit ReorderingTestCell(int id = -1) :
+        id(id)
+    {}
+
+    template<typename HOOD>
+    void update(const HOOD& hood, int nanoStep)
+    {}
+
+    inline bool operator==(const ReorderingTestCell& other) const
+    {
+        return id == other.id;
+    }
+
+    int id;
+};
+
 class ReorderingUnstructuredGridTest : public CxxTest::TestSuite
 {
 public:
@@ -787,6 +814,134 @@ public:
         TS_ASSERT_EQUALS(expected, actual);
 #endif
     }
+
+    void testReverseCuthillMcKee()
+    {
+#ifdef LIBGEODECOMP_WITH_CPP14
+        // a path with scrambled IDs, a triangle and an isolated node:
+        std::vector<int> path;
+        path << 17 << 3 << 40 << 8 << 23 << 11 << 35 << 2;
+
+        std::vector<std::pair<Coord<2>, double> > matrix;
+        for (std::size_t i = 1; i < path.size(); ++i) {
+            matrix << std::make_pair(Coord<2>(path[i - 1], path[i]), 1.0);
+        }
+        matrix << std::make_pair(Coord<2>(5,   7), 1.0)
+               << std::make_pair(Coord<2>(7,  42), 1.0)
+               << std::make_pair(Coord<2>(42,  5), 1.0)
+               << std::make_pair(Coord<2>(3,   3), 1.0)
+               << std::make_pair(Coord<2>(3, 666), 1.0);
+
+        std::vector<int> nodes(path);
+        nodes << 5 << 7 << 42 << 99;
+        std::sort(nodes.begin(), nodes.end());
+
+        std::vector<int> order = ReorderingUnstructuredGridHelpers::reverseCuthillMcKee(nodes, matrix);
+        std::vector<int> sortedOrder = order;
+        std::sort(sortedOrder.begin(), sortedOrder.end());
+        TS_ASSERT_EQUALS(nodes, sortedOrder);
+
+        // the path needs to be contiguous and start at one of its ends:
+        std::vector<int>::iterator start = std::find(order.begin(), order.end(), path.front());
+        std::vector<int>::iterator end   = std::find(order.begin(), order.end(), path.back());
+        TS_ASSERT_EQUALS(std::size_t(std::abs(std::distance(start, end))), path.size() - 1);
+        std::vector<int> expected(path);
+        if (end < start) {
+            std::reverse(expected.begin(), expected.end());
+            std::swap(start, end);
+        }
+        TS_ASSERT_EQUALS(expected, std::vector<int>(start, end + 1));
+#endif
+    }
+
+    void testLocalityReordering()
+    {
+#ifdef LIBGEODECOMP_WITH_CPP14
+        typedef ReorderingTestCell<APITraits::HasSellLocalityReordering> ReorderedCell;
+        typedef ReorderingTestCell<APITraits::HasSellType<double> > PlainCell;
+        typedef GridTypeSelector<ReorderedCell, Topology, false, APITraits::FalseType>::Value ReorderedGrid;
+        typedef GridTypeSelector<PlainCell,     Topology, false, APITraits::FalseType>::Value PlainGrid;
+
+        // a 2D mesh whose IDs have been shuffled:
+        const int width = 30;
+        const int size = width * width;
+        std::vector<int> ids(size);
+        for (int i = 0; i < size; ++i) {
+            ids[i] = (i * 337) % size;
+        }
+
+        std::vector<std::pair<Coord<2>, double> > matrix;
+        for (int y = 0; y < width; ++y) {
+            for (int x = 0; x < width; ++x) {
+                int id = ids[y * width + x];
+                matrix << std::make_pair(Coord<2>(id, id), 4.0);
+                if (x > 0) {
+                    matrix << std::make_pair(Coord<2>(id, ids[y * width + x - 1]), -1.0);
+                }
+                if (x < (width - 1)) {
+                    matrix << std::make_pair(Coord<2>(id, ids[y * width + x + 1]), -1.0);
+                }
+                if (y > 0) {
+                    matrix << std::make_pair(Coord<2>(id, ids[(y - 1) * width + x]), -1.0);
+                }
+                if (y < (width - 1)) {
+                    matrix << std::make_pair(Coord<2>(id, ids[(y + 1) * width + x]), -1.0);
+                }
+            }
+        }
+
+        Region<1> nodeSet;
+        nodeSet << Streak<1>(Coord<1>(0), size);
+        ReorderedGrid reorderedGrid(nodeSet);
+        PlainGrid plainGrid(nodeSet);
+        for (int i = 0; i < size; ++i) {
+            reorderedGrid.set(Coord<1>(i), ReorderedCell(i));
+            plainGrid.set(Coord<1>(i), PlainCell(i));
+        }
+        reorderedGrid.setWeights(0, matrix);
+        plainGrid.setWeights(0, matrix);
+
+        // IDs are mapped transparently:
+        for (int i = 0; i < size; ++i) {
+            TS_ASSERT_EQUALS(i, reorderedGrid.get(Coord<1>(i)).id);
+        }
+        TS_ASSERT_EQUALS(
+            reorderedGrid.remapRegion(nodeSet),
+            nodeSet);
+
+        int reorderedBandwidth = bandwidth(reorderedGrid.getWeights(0));
+        int plainBandwidth = bandwidth(plainGrid.getWeights(0));
+        TS_ASSERT_LESS_THAN(plainBandwidth, size);
+        TS_ASSERT_LESS_THAN(size / 2, plainBandwidth);
+        // RCM yields a bandwidth close to the mesh's width, the
+        // SIGMA sorting may add a couple of rows:
+        TS_ASSERT_LESS_THAN_EQUALS(reorderedBandwidth, width + 2 * 8);
+
+        // all edges survive:
+        for (int i = 0; i < size; ++i) {
+            TS_ASSERT_EQUALS(
+                reorderedGrid.getWeights(0).getRow(reorderedGrid.remapRegion(Region<1>() << Coord<1>(i)).begin()->x()).size(),
+                plainGrid.getWeights(0).getRow(plainGrid.remapRegion(Region<1>() << Coord<1>(i)).begin()->x()).size());
+        }
+#endif
+    }
+
+private:
+#ifdef LIBGEODECOMP_WITH_CPP14
+    template<typename MATRIX>
+    int bandwidth(const MATRIX& matrix)
+    {
+        int ret = 0;
+        for (std::size_t row = 0; row < matrix.dim(); ++row) {
+            std::vector<std::pair<int, double> > entries = matrix.getRow(row);
+            for (std::size_t i = 0; i < entries.size(); ++i) {
+                ret = (std::max)(ret, std::abs(entries[i].first - int(row)));
+            }
+        }
+
+        return ret;
+    }
+#endif
 };
 
 }
@@ -5,6 +5,10 @@
 
 #include <cxxtest/TestSuite.h>
 
+#ifdef LIBGEODECOMP_WITH_THREADS
+#include <omp.h>
+#endif
+
 #include <iostream>
 #include <cstdlib>
 #include <algorithm>
@@ -881,6 +885,130 @@ public:
         TS_ASSERT(col[11] == 0);
         TS_ASSERT(col[12] == 2);
         TS_ASSERT(col[13] == 0);
+#endif
+    }
+
+    void testInitFromMatrixIsIndependentOfThreadCount()
+    {
+#ifdef LIBGEODECOMP_WITH_CPP14
+        const int size = 1234;
+        DMatrix matrix;
+        std::map<int, std::vector<std::pair<int, double> > > expectedRows;
+
+        // varying row lengths, including empty rows:
+        for (int row = 0; row < size; ++row) {
+            const int length = (row * 7) % 13;
+            for (int i = 0; i < length; ++i) {
+                const int column = (row + i * 97) % size;
+                const double value = row + 0.001 * column;
+                matrix << std::make_pair(Coord<2>(row, column), value);
+                expectedRows[row] << std::make_pair(column, value);
+            }
+            std::sort(expectedRows[row].begin(), expectedRows[row].end());
+        }
+        std::reverse(matrix.begin(), matrix.end());
+
+        SellCSigmaSparseMatrixContainer<double, 4, 32> serial(size);
+        SellCSigmaSparseMatrixContainer<double, 4, 32> parallel(size);
+#ifdef LIBGEODECOMP_WITH_THREADS
+        int threads = omp_get_max_threads();
+        omp_set_num_threads(1);
+        serial.initFromMatrix(matrix);
+        omp_set_num_threads(4);
+        parallel.initFromMatrix(matrix);
+        omp_set_num_threads(threads);
+#else
+        serial.initFromMatrix(matrix);
+        parallel.initFromMatrix(matrix);
+#endif
+
+        TS_ASSERT(serial == parallel);
+        TS_ASSERT_EQUALS(serial.chunkOffsetVec(),     parallel.chunkOffsetVec());
+        TS_ASSERT_EQUALS(serial.rowLengthVec(),       parallel.rowLengthVec());
+        TS_ASSERT_EQUALS(serial.realRowToSortedVec(), parallel.realRowToSortedVec());
+        TS_ASSERT_EQUALS(serial.chunkRowToRealVec(),  parallel.chunkRowToRealVec());
+
+        for (int row = 0; row < size; ++row) {
+            const std::pair<int, int>& mapping = parallel.realRowToSortedVec()[row];
+            TS_ASSERT_EQUALS(row, mapping.first);
+            TS_ASSERT_EQUALS(row, parallel.chunkRowToRealVec()[mapping.second]);
+            TS_ASSERT_EQUALS(expectedRows[row], parallel.getRow(mapping.second));
+        }
+
+        // rows are sorted by length within each window of SIGMA rows:
+        for (int row = 1; row < size; ++row) {
+            if ((row % 32) != 0) {
+                TS_ASSERT(parallel.rowLengthVec()[row - 1] >= parallel.rowLengthVec()[row]);
+            }
+        }
+#endif
+    }
+
+    void testCompressWeights()
+    {
+#ifdef LIBGEODECOMP_WITH_CPP14
+        const int size = 100;
+        DMatrix matrix;
+        for (int row = 0; row < size; ++row) {
+            for (int i = 0; i < (row % 5); ++i) {
+                matrix << std::make_pair(Coord<2>(row, (row + i) % size), 1.0 / (1 + row + i));
+            }
+        }
+
+        SellCSigmaSparseMatrixContainer<double, 8, 16> smc(size);
+        smc.initFromMatrix(matrix);
+        TS_ASSERT_EQUALS(SellHelpers::FULL_PRECISION, smc.weightPrecision());
+
+        const std::vector<double> original(smc.valuesVec().begin(), smc.valuesVec().end());
+        const std::size_t numberOfValues = original.size();
+        std::vector<double> buffer(numberOfValues);
+
+        // the full precision weights are replaced, not duplicated:
+        smc.compressWeights<float>();
+        TS_ASSERT_EQUALS(SellHelpers::SINGLE_PRECISION, smc.weightPrecision());
+        TS_ASSERT_EQUALS(numberOfValues, smc.valuesSingleVec().size());
+        TS_ASSERT_EQUALS(0, smc.valuesVec().size());
+        TS_ASSERT_EQUALS(0, smc.valuesVec().capacity());
+        smc.decodeWeights(0, numberOfValues, &buffer[0]);
+        for (std::size_t i = 0; i < numberOfValues; ++i) {
+            TS_ASSERT_EQUALS(double(float(original[i])), buffer[i]);
+        }
+
+        // getRow() decodes, too:
+        for (int row = 0; row < size; ++row) {
+            std::vector<std::pair<int, double> > expected;
+            for (int i = 0; i < (row % 5); ++i) {
+                expected << std::make_pair((row + i) % size, double(float(1.0 / (1 + row + i))));
+            }
+            std::sort(expected.begin(), expected.end());
+            TS_ASSERT_EQUALS(expected, smc.getRow(smc.realRowToSortedVec()[row].second));
+        }
+
+        smc.compressWeights<BFloat16>();
+        TS_ASSERT_EQUALS(SellHelpers::BFLOAT16_PRECISION, smc.weightPrecision());
+        TS_ASSERT_EQUALS(0, smc.valuesSingleVec().size());
+        TS_ASSERT_EQUALS(0, smc.valuesVec().size());
+        smc.decodeWeights(0, numberOfValues, &buffer[0]);
+        std::vector<double> buffer2(numberOfValues);
+        smc.decodeWeights<BFloat16>(0, numberOfValues, &buffer2[0]);
+        TS_ASSERT_EQUALS(buffer, buffer2);
+        for (std::size_t i = 0; i < numberOfValues; ++i) {
+            // 8 bits of mantissa:
+            TS_ASSERT_DELTA(original[i], buffer[i], std::abs(original[i]) / 256);
+        }
+
+        // restoring full precision is lossy:
+        smc.compressWeights<double>();
+        TS_ASSERT_EQUALS(SellHelpers::FULL_PRECISION, smc.weightPrecision());
+        TS_ASSERT_EQUALS(0, smc.valuesBFloat16Vec().size());
+        TS_ASSERT_EQUALS(buffer, std::vector<double>(smc.valuesVec().begin(), smc.valuesVec().end()));
+
+        // re-initialization restores the original weights:
+        smc.compressWeights<float>();
+        smc.initFromMatrix(matrix);
+        TS_ASSERT_EQUALS(SellHelpers::FULL_PRECISION, smc.weightPrecision());
+        TS_ASSERT_EQUALS(original, std::vector<double>(smc.valuesVec().begin(), smc.valuesVec().end()));
+        TS_ASSERT_EQUALS(0, smc.valuesSingleVec().size());
 #endif
     }
 };
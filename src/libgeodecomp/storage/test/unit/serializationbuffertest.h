@@ -2,12 +2,80 @@
 #include <libgeodecomp/communication/hpxserializationwrapper.h>
 #include <libgeodecomp/geometry/region.h>
 #include <libgeodecomp/misc/testcell.h>
+#include <libgeodecomp/storage/displacedgrid.h>
 #include <libgeodecomp/storage/serializationbuffer.h>
+#include <libgeodecomp/storage/soagrid.h>
 
 using namespace LibGeoDecomp;
 
 namespace LibGeoDecomp {
 
+/**
+ * Neighbors only read density and flow, so the diagnostics can be
+ * omitted during ghost zone exchange.
+ */
+class GhostMembersTestCell
+{
+public:
+    class API :
+        public APITraits::HasGhostMembers
+    {};
+
+    explicit GhostMembersTestCell(double density = 0, int counter = 0) :
+        density(density),
+        counter(counter)
+    {
+        flow[0] = density + 1;
+        flow[1] = density + 2;
+        for (int i = 0; i < 3; ++i) {
+            diagnostics[i] = counter + i;
+        }
+    }
+
+    static std::vector<Selector<GhostMembersTestCell> > ghostMembers()
+    {
+        std::vector<Selector<GhostMembersTestCell> > ret;
+        ret << Selector<GhostMembersTestCell>(&GhostMembersTestCell::density, "density")
+            << Selector<GhostMembersTestCell>(&GhostMembersTestCell::flow,    "flow");
+        return ret;
+    }
+
+    double density;
+    double flow[2];
+    int counter;
+    double diagnostics[3];
+};
+
+class GhostMembersTestCellSoA
+{
+public:
+    class API :
+        public APITraits::HasSoA,
+        public APITraits::HasGhostMembers
+    {};
+
+    explicit GhostMembersTestCellSoA(double density = 0, int counter = 0) :
+        density(density),
+        counter(counter)
+    {}
+
+    static std::vector<Selector<GhostMembersTestCellSoA> > ghostMembers()
+    {
+        std::vector<Selector<GhostMembersTestCellSoA> > ret;
+        ret << Selector<GhostMembersTestCellSoA>(&GhostMembersTestCellSoA::density, "density");
+        return ret;
+    }
+
+    double density;
+    int counter;
+};
+
+}
+
+LIBFLATARRAY_REGISTER_SOA(LibGeoDecomp::GhostMembersTestCellSoA, ((double)(density))((int)(counter)))
+
+namespace LibGeoDecomp {
+
 class SerializationBufferTest : public CxxTest::TestSuite
 {
 public:
@@ -78,6 +146,92 @@ public:
 
         TS_ASSERT_EQUALS(sizeof(SerializationBufferType::ElementType), sizeof(char));
     }
+
+    void testGhostZoneBufferDefaultsToWholeCells()
+    {
+        typedef GhostZoneSerializationBuffer<TestCell<2> > BufferType;
+
+        Region<2> region;
+        region << Streak<2>(Coord<2>(10, 10), 30);
+
+        TS_ASSERT_EQUALS(BufferType::storageSize(region), region.size());
+        TS_ASSERT_EQUALS(sizeof(BufferType::ElementType), sizeof(TestCell<2>));
+        TS_ASSERT_EQUALS(
+            BufferType::storageSize(region),
+            SerializationBuffer<TestCell<2> >::storageSize(region));
+    }
+
+    void testGhostMembersAoS()
+    {
+        typedef GhostZoneSerializationBuffer<GhostMembersTestCell> BufferType;
+
+        CoordBox<2> box(Coord<2>(0, 0), Coord<2>(10, 5));
+        DisplacedGrid<GhostMembersTestCell> source(box);
+        DisplacedGrid<GhostMembersTestCell> target(box, GhostMembersTestCell(-1, -1));
+        for (CoordBox<2>::Iterator i = box.begin(); i != box.end(); ++i) {
+            source[*i] = GhostMembersTestCell(i->x() + 10 * i->y(), 100);
+        }
+
+        Region<2> region;
+        region << Streak<2>(Coord<2>(2, 1), 8)
+               << Streak<2>(Coord<2>(0, 3), 4);
+
+        BufferType::BufferType buf = BufferType::create(region);
+        TS_ASSERT_EQUALS(sizeof(BufferType::ElementType), sizeof(char));
+        TS_ASSERT_EQUALS(buf.size(), 3 * sizeof(double) * region.size());
+        TS_ASSERT_EQUALS(BufferType::storageSize(region), buf.size());
+        TS_ASSERT(BufferType::storageSize(region) < region.size() * sizeof(GhostMembersTestCell) / 2);
+
+        BufferType::save(source, &buf, region);
+        BufferType::load(&target, buf, region);
+
+        for (CoordBox<2>::Iterator i = box.begin(); i != box.end(); ++i) {
+            const GhostMembersTestCell& cell = target[*i];
+
+            if (region.count(*i)) {
+                TS_ASSERT_EQUALS(source[*i].density, cell.density);
+                TS_ASSERT_EQUALS(source[*i].flow[0], cell.flow[0]);
+                TS_ASSERT_EQUALS(source[*i].flow[1], cell.flow[1]);
+            } else {
+                TS_ASSERT_EQUALS(-1, cell.density);
+            }
+
+            // diagnostics are never transferred:
+            TS_ASSERT_EQUALS(-1, cell.counter);
+            TS_ASSERT_EQUALS(-1, cell.diagnostics[0]);
+            TS_ASSERT_EQUALS( 1, cell.diagnostics[2]);
+        }
+    }
+
+    void testGhostMembersSoA()
+    {
+        typedef GhostZoneSerializationBuffer<GhostMembersTestCellSoA> BufferType;
+
+        CoordBox<3> box(Coord<3>(0, 0, 0), Coord<3>(10, 5, 3));
+        SoAGrid<GhostMembersTestCellSoA, Topologies::Cube<3>::Topology> source(box);
+        SoAGrid<GhostMembersTestCellSoA, Topologies::Cube<3>::Topology> target(box, GhostMembersTestCellSoA(-1, -1));
+        for (CoordBox<3>::Iterator i = box.begin(); i != box.end(); ++i) {
+            source.set(*i, GhostMembersTestCellSoA(i->x() + 10 * i->y() + 100 * i->z(), 4711));
+        }
+
+        Region<3> region;
+        region << Streak<3>(Coord<3>(2, 1, 1), 8)
+               << Streak<3>(Coord<3>(0, 3, 2), 4);
+
+        BufferType::BufferType buf = BufferType::create(region);
+        TS_ASSERT_EQUALS(buf.size(), sizeof(double) * region.size());
+
+        BufferType::save(source, &buf, region);
+        BufferType::load(&target, buf, region);
+
+        for (CoordBox<3>::Iterator i = box.begin(); i != box.end(); ++i) {
+            GhostMembersTestCellSoA cell = target.get(*i);
+            double expectedDensity = region.count(*i) ? source.get(*i).density : -1;
+
+            TS_ASSERT_EQUALS(expectedDensity, cell.density);
+            TS_ASSERT_EQUALS(-1, cell.counter);
+        }
+    }
 };
 
 }
@@ -0,0 +1,183 @@
+#include <cxxtest/TestSuite.h>
+#include <libgeodecomp/storage/fixedneighborhoodupdatefunctor.h>
+#include <libgeodecomp/storage/soagrid.h>
+#include <libgeodecomp/storage/stencilexpressions.h>
+#include <libgeodecomp/storage/updatefunctor.h>
+
+#include <cmath>
+
+using namespace LibGeoDecomp;
+
+class StencilExpressionsTestCell
+{
+public:
+    class API :
+          public LibGeoDecomp::APITraits::HasFixedCoordsOnlyUpdate,
+          public LibGeoDecomp::APITraits::HasUpdateLineX,
+          public LibGeoDecomp::APITraits::HasStencil<LibGeoDecomp::Stencils::VonNeumann<3, 1> >,
+          public LibGeoDecomp::APITraits::HasTorusTopology<3>,
+          public LibGeoDecomp::APITraits::HasSoA
+    {};
+
+    inline
+    explicit StencilExpressionsTestCell(
+        const double temp = 0,
+        const double weight = 1,
+        const double result = 0,
+        const float single = 0) :
+        temp(temp),
+        weight(weight),
+        result(result),
+        single(single)
+    {}
+
+    template<typename NEIGHBORHOOD>
+    void update(const NEIGHBORHOOD& hood, const int nanoStep)
+    {}
+
+    template<typename HOOD_OLD, typename HOOD_NEW>
+    static void updateLineX(HOOD_OLD& hoodOld, long indexEnd,
+                            HOOD_NEW& hoodNew, long /* nanoStep */)
+    {
+        using StencilExpressions::neighbor;
+        typedef StencilExpressionsTestCell Cell;
+        long indexOld = hoodOld.index();
+        long indexNew = hoodNew.index();
+
+        StencilExpressions::updateLineX(
+            hoodOld, indexEnd, hoodNew, &Cell::temp,
+            (neighbor(FixedCoord< 0,  0, -1>(), &Cell::temp) +
+             neighbor(FixedCoord< 0, -1,  0>(), &Cell::temp) +
+             neighbor(FixedCoord<-1,  0,  0>(), &Cell::temp) +
+             neighbor(FixedCoord< 1,  0,  0>(), &Cell::temp) +
+             neighbor(FixedCoord< 0,  1,  0>(), &Cell::temp) +
+             neighbor(FixedCoord< 0,  0,  1>(), &Cell::temp)) * (1.0 / 6.0));
+
+        hoodOld.index() = indexOld;
+        hoodNew.index() = indexNew;
+        StencilExpressions::updateLineX<LibFlatArray::short_vec<double, 4> >(
+            hoodOld, indexEnd, hoodNew, &Cell::result,
+            (neighbor(FixedCoord<-1, 0, 0>(), &Cell::temp) -
+             2.0 * neighbor(FixedCoord<0, 0, 0>(), &Cell::temp) +
+             neighbor(FixedCoord< 1, 0, 0>(), &Cell::temp)) / neighbor(FixedCoord<0, 0, 0>(), &Cell::weight) -
+            sqrt(neighbor(FixedCoord<0, 1, 0>(), &Cell::weight)) +
+            -neighbor(FixedCoord<0, 0, 1>(), &Cell::result));
+
+        hoodOld.index() = indexOld;
+        hoodNew.index() = indexNew;
+        StencilExpressions::updateLineX(
+            hoodOld, indexEnd, hoodNew, &Cell::single,
+            neighbor(FixedCoord<0, -1, 0>(), &Cell::single) * 0.5f + 1.0f);
+    }
+
+    double temp;
+    double weight;
+    double result;
+    float single;
+};
+
+LIBFLATARRAY_REGISTER_SOA(
+    StencilExpressionsTestCell,
+    ((double)(temp))
+    ((double)(weight))
+    ((double)(result))
+    ((float)(single)))
+
+namespace LibGeoDecomp {
+
+class StencilExpressionsTest : public CxxTest::TestSuite
+{
+public:
+    typedef StencilExpressionsTestCell Cell;
+    typedef SoAGrid<Cell, Topologies::Torus<3>::Topology> GridType;
+
+    void testUpdateLineX()
+    {
+        CoordBox<3> box(Coord<3>(0, 0, 0), Coord<3>(43, 12, 7));
+
+        Cell defaultCell(666, 777, 888, 999);
+        Cell edgeCell(-1, -1, -1, -1);
+        GridType gridOld(box, defaultCell, edgeCell);
+        GridType gridNew(box, defaultCell, edgeCell);
+
+        for (CoordBox<3>::Iterator i = box.begin(); i != box.end(); ++i) {
+            double temp = i->x() + i->y() * 100.0 + i->z() * 100 * 100.0;
+            gridOld.set(*i, Cell(temp, 1 + i->x() * 0.5, i->y() - 0.25 * i->z(), i->x() * 0.125f));
+        }
+
+        // streaks of all lengths around the vector arities, starting
+        // at aligned and unaligned indices, plus full lines which
+        // wrap around the torus:
+        Region<3> region;
+        for (int length = 1; length <= 19; ++length) {
+            region << Streak<3>(Coord<3>(length % 5, length % 12, length % 7), length % 5 + length);
+        }
+        region << Streak<3>(Coord<3>(0, 11, 6), 43)
+               << Streak<3>(Coord<3>(0,  0, 0), 43)
+               << Streak<3>(Coord<3>(21, 5, 3), 43);
+
+        CoordBox<3> boxNew = gridNew.boundingBox();
+        CoordBox<3> boxOld = gridOld.boundingBox();
+        Coord<3> offsetOld = -boxOld.origin;
+        Coord<3> offsetNew = -boxNew.origin;
+        Coord<3> topoDim = boxNew.dimensions;
+
+        gridOld.callback(&gridNew, FixedNeighborhoodUpdateFunctor<
+                         Cell,
+                         UpdateFunctorHelpers::ConcurrencyNoP,
+                         APITraits::SelectThreadedUpdate<void>::Value>(
+                             &region,
+                             &offsetOld,
+                             &offsetNew,
+                             &boxNew.dimensions,
+                             &boxNew.dimensions,
+                             &topoDim,
+                             0,
+                             0,
+                             0));
+
+        for (CoordBox<3>::Iterator i = box.begin(); i != box.end(); ++i) {
+            Cell actual = gridNew.get(*i);
+
+            if (!region.count(*i)) {
+                TS_ASSERT_EQUALS(666, actual.temp);
+                TS_ASSERT_EQUALS(888, actual.result);
+                TS_ASSERT_EQUALS(999, actual.single);
+                continue;
+            }
+
+            double temp =
+                (old(gridOld, *i, Coord<3>( 0,  0, -1)).temp +
+                 old(gridOld, *i, Coord<3>( 0, -1,  0)).temp +
+                 old(gridOld, *i, Coord<3>(-1,  0,  0)).temp +
+                 old(gridOld, *i, Coord<3>( 1,  0,  0)).temp +
+                 old(gridOld, *i, Coord<3>( 0,  1,  0)).temp +
+                 old(gridOld, *i, Coord<3>( 0,  0,  1)).temp) * (1.0 / 6.0);
+            TS_ASSERT_DELTA(temp, actual.temp, 1e-9);
+
+            double result =
+                (old(gridOld, *i, Coord<3>(-1, 0, 0)).temp -
+                 2.0 * old(gridOld, *i, Coord<3>(0, 0, 0)).temp +
+                 old(gridOld, *i, Coord<3>( 1, 0, 0)).temp) / old(gridOld, *i, Coord<3>(0, 0, 0)).weight -
+                std::sqrt(old(gridOld, *i, Coord<3>(0, 1, 0)).weight) -
+                old(gridOld, *i, Coord<3>(0, 0, 1)).result;
+            TS_ASSERT_DELTA(result, actual.result, 1e-9);
+
+            float single = old(gridOld, *i, Coord<3>(0, -1, 0)).single * 0.5f + 1.0f;
+            TS_ASSERT_EQUALS(single, actual.single);
+
+            TS_ASSERT_EQUALS(777, actual.weight);
+        }
+    }
+
+private:
+    Cell old(const GridType& grid, const Coord<3>& center, const Coord<3>& offset)
+    {
+        CoordBox<3> box = grid.boundingBox();
+        Coord<3> c = box.origin + Topologies::Torus<3>::Topology::normalize(
+            center + offset - box.origin, box.dimensions);
+        return grid.get(c);
+    }
+};
+
+}
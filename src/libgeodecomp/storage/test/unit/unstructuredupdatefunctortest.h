@@ -156,6 +156,22 @@ public:
 
 LIBFLATARRAY_REGISTER_SOA(SimpleUnstructuredSoATestCell<1 >, ((double)(sum))((double)(value)))
 LIBFLATARRAY_REGISTER_SOA(SimpleUnstructuredSoATestCell<60>, ((double)(sum))((double)(value)))
+
+class CompressedUnstructuredSoATestCell : public SimpleUnstructuredSoATestCell<1>
+{
+public:
+    class API :
+        public SimpleUnstructuredSoATestCell<1>::API,
+        public APITraits::HasSellWeightStorage<float>
+    {};
+
+    inline
+    explicit CompressedUnstructuredSoATestCell(double v = 0) :
+        SimpleUnstructuredSoATestCell<1>(v)
+    {}
+};
+
+LIBFLATARRAY_REGISTER_SOA(CompressedUnstructuredSoATestCell, ((double)(sum))((double)(value)))
 #endif
 
 namespace LibGeoDecomp {
@@ -443,6 +459,70 @@ public:
 #endif
     }
 
+    void testSoAWithCompressedWeights()
+    {
+#ifdef LIBGEODECOMP_WITH_CPP14
+        const int DIM = 150;
+        CoordBox<1> dim(Coord<1>(0), Coord<1>(DIM));
+        Region<1> boundingRegion;
+        boundingRegion << dim;
+
+        typedef CompressedUnstructuredSoATestCell Cell;
+        Cell defaultCell(200);
+        Cell edgeCell(-1);
+
+        typedef ReorderingUnstructuredGrid<UnstructuredSoAGrid<Cell, 1, double, 4, 1> > GridType;
+        GridType gridOld(boundingRegion, defaultCell, edgeCell);
+        GridType gridNew(boundingRegion, defaultCell, edgeCell);
+
+        for (int i = 0; i < DIM; ++i) {
+            gridOld.set(Coord<1>(i), Cell(2000 + i));
+        }
+
+        // same matrix as in testSoA(), the weights are exactly
+        // representable as floats:
+        GridType::SparseMatrix matrix;
+        for (int row = 0; row < DIM; ++row) {
+            for (int col = 0; col < row; ++col) {
+                matrix << std::make_pair(Coord<2>(row, col), row + col * 10);
+            }
+        }
+        gridOld.setWeights(0, matrix);
+        gridNew.setWeights(0, matrix);
+
+        TS_ASSERT_EQUALS(SellHelpers::SINGLE_PRECISION, gridOld.getWeights(0).weightPrecision());
+        TS_ASSERT_EQUALS(0, gridOld.getWeights(0).valuesVec().size());
+
+        Region<1> region;
+        // loop peeling in first and last chunk
+        region << Streak<1>(Coord<1>(10),   30);
+        // "normal" streak
+        region << Streak<1>(Coord<1>(64),   80);
+        // loop peeling in last chunk
+        region << Streak<1>(Coord<1>(100), 149);
+        region = gridOld.remapRegion(region);
+
+        UnstructuredUpdateFunctor<Cell> functor;
+        UpdateFunctorHelpers::ConcurrencyNoP concurrencySpec;
+        APITraits::SelectThreadedUpdate<Cell>::Value modelThreadingSpec;
+
+        functor(region, gridOld, &gridNew, 0, concurrencySpec, modelThreadingSpec);
+
+        for (Coord<1> coord(0); coord < Coord<1>(150); ++coord.x()) {
+            if (region.count(coord)) {
+                double sum = 0;
+                for (int i = 0; i < coord.x(); ++i) {
+                    double weight = coord.x() + i * 10;
+                    sum += weight * (2000 + i);
+                }
+                TS_ASSERT_EQUALS(sum, gridNew.get(coord).sum);
+            } else {
+                TS_ASSERT_EQUALS(0.0, gridNew.get(coord).sum);
+            }
+        }
+#endif
+    }
+
     void testSoAWithSIGMA()
     {
 #ifdef LIBGEODECOMP_WITH_CPP14
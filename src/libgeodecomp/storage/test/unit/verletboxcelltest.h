@@ -0,0 +1,197 @@
+#include <libgeodecomp/geometry/region.h>
+#include <libgeodecomp/storage/boxcell.h>
+#include <libgeodecomp/storage/grid.h>
+#include <libgeodecomp/storage/updatefunctor.h>
+#include <libgeodecomp/storage/verletboxcell.h>
+#include <cxxtest/TestSuite.h>
+
+using namespace LibGeoDecomp;
+
+namespace LibGeoDecomp {
+
+/**
+ * Moves with constant velocity and counts the particles within
+ * maxDistance.
+ */
+class DriftingParticle
+{
+public:
+    class API : public APITraits::HasCubeTopology<2>
+    {};
+
+    explicit DriftingParticle(
+        const FloatCoord<2>& pos = FloatCoord<2>(),
+        const FloatCoord<2>& velocity = FloatCoord<2>(),
+        const double maxDistance = 0) :
+        pos(pos),
+        velocity(velocity),
+        maxDistance2(maxDistance * maxDistance),
+        neighbors(0)
+    {}
+
+    template<typename HOOD>
+    inline void update(const HOOD& hood, const int nanoStep)
+    {
+        neighbors = 0;
+
+        for (typename HOOD::Iterator i = hood.begin(); i != hood.end(); ++i) {
+            FloatCoord<2> delta = i->pos - pos;
+            if ((delta * delta) < maxDistance2) {
+                ++neighbors;
+            }
+        }
+
+        pos += velocity;
+    }
+
+    inline const FloatCoord<2>& getPos() const
+    {
+        return pos;
+    }
+
+    int getNeighbors() const
+    {
+        return neighbors;
+    }
+
+private:
+    FloatCoord<2> pos;
+    FloatCoord<2> velocity;
+    double maxDistance2;
+    int neighbors;
+};
+
+class VerletBoxCellTest : public CxxTest::TestSuite
+{
+public:
+    typedef BoxCell<FixedArray<DriftingParticle, 40> > BoxCellType;
+    typedef VerletBoxCell<FixedArray<DriftingParticle, 40> > VerletCellType;
+
+    void setUp()
+    {
+        gridDim = Coord<2>(8, 6);
+        cellDim = FloatCoord<2>(3.0, 3.0);
+        box = CoordBox<2>(Coord<2>(), gridDim);
+        region.clear();
+        region << box;
+    }
+
+    void testEquivalenceWithBoxCell()
+    {
+        Grid<BoxCellType> boxGrid1(gridDim);
+        Grid<BoxCellType> boxGrid2(gridDim);
+        Grid<VerletCellType> verletGrid1(gridDim);
+        Grid<VerletCellType> verletGrid2(gridDim);
+
+        for (CoordBox<2>::Iterator i = box.begin(); i != box.end(); ++i) {
+            FloatCoord<2> origin = cellDim.scale(*i);
+            boxGrid1[*i] = BoxCellType(origin, cellDim);
+            verletGrid1[*i] = VerletCellType(origin, cellDim, 2.9, 0.4);
+
+            for (int j = 0; j < 4; ++j) {
+                FloatCoord<2> offset(0.4 + 0.7 * j, 0.3 + 0.6 * ((j * 3 + i->x()) % 4));
+                FloatCoord<2> velocity(0.05 * ((j + i->y()) % 3 - 1), 0.07 * ((j + i->x()) % 3 - 1));
+                DriftingParticle particle(origin + offset, velocity, 2.9);
+
+                boxGrid1[*i].insert(particle);
+                verletGrid1[*i].insert(particle);
+            }
+        }
+
+        for (int t = 0; t < 20; ++t) {
+            UpdateFunctor<BoxCellType>()(region, Coord<2>(), Coord<2>(), boxGrid1, &boxGrid2, 0);
+            UpdateFunctor<VerletCellType>()(region, Coord<2>(), Coord<2>(), verletGrid1, &verletGrid2, 0);
+            std::swap(boxGrid1, boxGrid2);
+            std::swap(verletGrid1, verletGrid2);
+
+            for (CoordBox<2>::Iterator i = box.begin(); i != box.end(); ++i) {
+                TS_ASSERT_EQUALS(boxGrid1[*i].size(), verletGrid1[*i].size());
+
+                for (std::size_t j = 0; j < boxGrid1[*i].size(); ++j) {
+                    TS_ASSERT_EQUALS(boxGrid1[*i][j].getPos(),       verletGrid1[*i][j].getPos());
+                    TS_ASSERT_EQUALS(boxGrid1[*i][j].getNeighbors(), verletGrid1[*i][j].getNeighbors());
+                }
+            }
+        }
+    }
+
+    void testListsAreReusedUntilSkinIsExceeded()
+    {
+        Grid<VerletCellType> grid1(gridDim);
+        Grid<VerletCellType> grid2(gridDim);
+        Coord<2> center(4, 3);
+
+        for (CoordBox<2>::Iterator i = box.begin(); i != box.end(); ++i) {
+            FloatCoord<2> origin = cellDim.scale(*i);
+            grid1[*i] = VerletCellType(origin, cellDim, 2.0, 1.0);
+            // all particles stay well within their boxes for 5 steps:
+            grid1[*i] << DriftingParticle(
+                origin + FloatCoord<2>(1.5, 1.5),
+                FloatCoord<2>(0.15, 0.0),
+                2.0);
+        }
+
+        UpdateFunctor<VerletCellType>()(region, Coord<2>(), Coord<2>(), grid1, &grid2, 0);
+        std::vector<double> snapshot = grid2[center].snapshot[0];
+        // 9 boxes with one particle each, but only the particle
+        // itself is closer than cutoff + skin:
+        TS_ASSERT_EQUALS(std::size_t(9), snapshot.size());
+        TS_ASSERT_EQUALS(std::size_t(1), grid2[center].listEntries.size());
+        TS_ASSERT_EQUALS(1, grid2[center][0].getNeighbors());
+
+        // displacement is 0.15 and 0.3, below skin/2:
+        for (int t = 0; t < 2; ++t) {
+            UpdateFunctor<VerletCellType>()(region, Coord<2>(), Coord<2>(), grid2, &grid1, 0);
+            std::swap(grid1, grid2);
+            TS_ASSERT_EQUALS(snapshot, grid2[center].snapshot[0]);
+        }
+
+        // displacement is 0.45, still below skin/2:
+        UpdateFunctor<VerletCellType>()(region, Coord<2>(), Coord<2>(), grid2, &grid1, 0);
+        TS_ASSERT_EQUALS(snapshot, grid1[center].snapshot[0]);
+
+        // displacement reaches 0.6, which triggers a rebuild:
+        UpdateFunctor<VerletCellType>()(region, Coord<2>(), Coord<2>(), grid1, &grid2, 0);
+        TS_ASSERT_DIFFERS(snapshot, grid2[center].snapshot[0]);
+        TS_ASSERT_DELTA(snapshot[4] + 0.6, grid2[center].snapshot[0][4], 1e-9);
+    }
+
+    void testInsertInvalidatesLists()
+    {
+        Grid<VerletCellType> grid1(gridDim);
+        Grid<VerletCellType> grid2(gridDim);
+        Coord<2> center(4, 3);
+
+        for (CoordBox<2>::Iterator i = box.begin(); i != box.end(); ++i) {
+            FloatCoord<2> origin = cellDim.scale(*i);
+            grid1[*i] = VerletCellType(origin, cellDim, 2.0, 1.0);
+            grid1[*i] << DriftingParticle(origin + FloatCoord<2>(1.5, 1.5), FloatCoord<2>(), 2.0);
+        }
+
+        UpdateFunctor<VerletCellType>()(region, Coord<2>(), Coord<2>(), grid1, &grid2, 0);
+        TS_ASSERT_EQUALS(1, grid2[center][0].getNeighbors());
+
+        // a particle right next to the box boundary is within reach
+        // of the neighbor's particle:
+        grid2[Coord<2>(3, 3)] << DriftingParticle(
+            cellDim.scale(center) + FloatCoord<2>(-0.2, 1.5),
+            FloatCoord<2>(),
+            2.0);
+        UpdateFunctor<VerletCellType>()(region, Coord<2>(), Coord<2>(), grid2, &grid1, 0);
+        TS_ASSERT_EQUALS(std::size_t(10), grid1[center].snapshot[0].size());
+        TS_ASSERT_EQUALS(2, grid1[center][0].getNeighbors());
+
+        grid1[Coord<2>(3, 3)].remove(1);
+        UpdateFunctor<VerletCellType>()(region, Coord<2>(), Coord<2>(), grid1, &grid2, 0);
+        TS_ASSERT_EQUALS(std::size_t(9), grid2[center].snapshot[0].size());
+        TS_ASSERT_EQUALS(1, grid2[center][0].getNeighbors());
+    }
+
+private:
+    Coord<2> gridDim;
+    FloatCoord<2> cellDim;
+    CoordBox<2> box;
+    Region<2> region;
+};
+
+}
@@ -10,6 +10,7 @@
 #include <libgeodecomp/geometry/coordbox.h>
 #include <libgeodecomp/geometry/region.h>
 #include <libgeodecomp/geometry/streak.h>
+#include <libgeodecomp/misc/apitraits.h>
 #include <libgeodecomp/misc/stdcontaineroverloads.h>
 #include <libgeodecomp/storage/gridbase.h>
 #include <libgeodecomp/storage/selector.h>
@@ -131,6 +132,9 @@ public:
     typedef typename GridBase<ELEMENT_TYPE, 1>::SparseMatrix SparseMatrix;
     typedef WEIGHT_TYPE WeightType;
     typedef char StorageType;
+    typedef typename APITraits::SelectAllocator<
+        ELEMENT_TYPE,
+        LibFlatArray::aligned_allocator<char, 4096> >::Value Allocator;
     const static int DIM = 1;
     const static int SIGMA = MY_SIGMA;
     const static int C = MY_C;
@@ -184,11 +188,17 @@ public:
         return elements.data();
     }
 
+    /**
+     * Also reduces the precision of the weights if the ELEMENT_TYPE
+     * asks for it, see APITraits::HasSellWeightStorage.
+     */
     inline
     void setWeights(std::size_t matrixID, const SparseMatrix& matrix)
     {
         assert(matrixID < MATRICES);
         matrices[matrixID].initFromMatrix(matrix);
+        matrices[matrixID].template compressWeights<
+            typename APITraits::SelectSellWeightStorage<ELEMENT_TYPE>::Value>();
     }
 
     inline
@@ -444,7 +454,7 @@ protected:
     }
 
 private:
-    LibFlatArray::soa_grid<ELEMENT_TYPE> elements;
+    LibFlatArray::soa_grid<ELEMENT_TYPE, Allocator> elements;
     int origin;
     // TODO wrapper for different types of sell c sigma containers
     SellCSigmaSparseMatrixContainer<WEIGHT_TYPE, C, SIGMA> matrices[MATRICES];
@@ -8,6 +8,7 @@
 #include <libflatarray/soa_accessor.hpp>
 
 #include <libgeodecomp/geometry/coord.h>
+#include <libgeodecomp/misc/apitraits.h>
 #include <libgeodecomp/storage/unstructuredsoagrid.h>
 
 #include <iterator>
@@ -15,6 +16,44 @@
 
 namespace LibGeoDecomp {
 
+namespace UnstructuredSoANeighborhoodHelpers {
+
+/**
+ * Hands out pointers to LENGTH consecutive weights of a SELL matrix.
+ * Weights in full precision are used in place...
+ */
+template<typename MATRIX, typename VALUE_TYPE, int LENGTH, typename WEIGHT_STORAGE, typename REDUCED_PRECISION>
+class WeightLoader
+{
+public:
+    inline
+    const VALUE_TYPE *load(const MATRIX& matrix, int offset) const
+    {
+        return &matrix.valuesVec()[offset];
+    }
+};
+
+/**
+ * ...while weights stored in reduced precision (see
+ * APITraits::HasSellWeightStorage) get widened into a buffer first.
+ */
+template<typename MATRIX, typename VALUE_TYPE, int LENGTH, typename WEIGHT_STORAGE>
+class WeightLoader<MATRIX, VALUE_TYPE, LENGTH, WEIGHT_STORAGE, APITraits::TrueType>
+{
+public:
+    inline
+    const VALUE_TYPE *load(const MATRIX& matrix, int offset) const
+    {
+        matrix.template decodeWeights<WEIGHT_STORAGE>(offset, LENGTH, buffer);
+        return buffer;
+    }
+
+private:
+    alignas(64) mutable VALUE_TYPE buffer[LENGTH];
+};
+
+}
+
 /**
  * Neighborhood providing pointers for vectorization of UnstructuredSoAGrid.
  * weights(id) returns a pair of two pointers. One points to the array where
@@ -26,6 +65,10 @@ namespace LibGeoDecomp {
  * matrices (equals 1 for most applications), VALUE_TYPE is the type
  * of the edge weights, C refers to the chunk size and SIGMA is the
  * sorting scope used by the SELL-C-Sigma container.
+ *
+ * Weights which the grid stores in reduced precision (see
+ * APITraits::HasSellWeightStorage) are transparently widened to
+ * VALUE_TYPE, so updateLineX() doesn't need to be adapted.
  */
 template<
     typename GRID_TYPE,
@@ -47,16 +90,28 @@ public:
     using SoAAccessor = LibFlatArray::soa_accessor<CELL, DIM_X, DIM_Y, DIM_Z, INDEX>;
     using ConstSoAAccessor = LibFlatArray::const_soa_accessor<CELL, DIM_X, DIM_Y, DIM_Z, INDEX>;
 
+    using Matrix = SellCSigmaSparseMatrixContainer<VALUE_TYPE, C, SIGMA>;
+    using WeightStorage = typename APITraits::SelectSellWeightStorage<CELL>::Value;
+    using ReducedPrecision = typename SellHelpers::IsReducedPrecision<VALUE_TYPE, WeightStorage>::Value;
+    using ChunkWeightLoader = UnstructuredSoANeighborhoodHelpers::WeightLoader<
+        Matrix, VALUE_TYPE, C, WeightStorage, ReducedPrecision>;
+    using ScalarWeightLoader = UnstructuredSoANeighborhoodHelpers::WeightLoader<
+        Matrix, VALUE_TYPE, 1, WeightStorage, ReducedPrecision>;
+
     /**
      * This iterator returns objects/values needed to update
      * the current chunk. Iterator consists of a pair: indices reference
      * and matrix values reference.
+     *
+     * If the CELL keeps its weights in reduced precision, second()
+     * widens the current chunk column into a buffer within the
+     * iterator. Otherwise it points directly into the matrix.
      */
-    class Iterator : public std::iterator<std::forward_iterator_tag, const IteratorPair>
+    class Iterator :
+        public std::iterator<std::forward_iterator_tag, const IteratorPair>,
+        private ChunkWeightLoader
     {
     public:
-        using Matrix = SellCSigmaSparseMatrixContainer<VALUE_TYPE, C, SIGMA>;
-
         inline
         Iterator(const Matrix& matrix, int offset) :
             matrix(matrix), offset(offset)
@@ -94,7 +149,7 @@ public:
         inline
         const VALUE_TYPE *second() const
         {
-            return &matrix.valuesVec()[offset];
+            return ChunkWeightLoader::load(matrix, offset);
         }
 
     private:
@@ -107,11 +162,11 @@ public:
      * may be necessary during loop peeling at the begin or end of a
      * Streak if the Streak isn't aligned on the chunk size C.
      */
-    class ScalarIterator : public std::iterator<std::forward_iterator_tag, const IteratorPair>
+    class ScalarIterator :
+        public std::iterator<std::forward_iterator_tag, const IteratorPair>,
+        private ScalarWeightLoader
     {
     public:
-        using Matrix = SellCSigmaSparseMatrixContainer<VALUE_TYPE, C, SIGMA>;
-
         inline
         ScalarIterator(const Matrix& matrix, int offset, int scalarOffset) :
             matrix(matrix),
@@ -151,7 +206,7 @@ public:
         inline
         const VALUE_TYPE *second() const
         {
-            return &matrix.valuesVec()[offset] + scalarOffset;
+            return ScalarWeightLoader::load(matrix, offset + scalarOffset);
         }
 
     private:
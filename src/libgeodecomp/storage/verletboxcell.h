@@ -0,0 +1,406 @@
+#ifndef LIBGEODECOMP_STORAGE_VERLETBOXCELL_H
+#define LIBGEODECOMP_STORAGE_VERLETBOXCELL_H
+
+#include <libgeodecomp/geometry/stencils.h>
+#include <libgeodecomp/storage/boxcell.h>
+
+#include <vector>
+
+namespace LibGeoDecomp {
+
+/**
+ * VerletBoxCell is a drop-in replacement for BoxCell which
+ * accelerates short-range particle interactions via Verlet lists:
+ * instead of handing each particle an iterator over all particles
+ * in the 3^DIM surrounding boxes, it keeps a list of those particles
+ * which reside within (cutoff + skin) of it. Particles still need
+ * to check distances themselves, but the lists are guaranteed to
+ * contain all particles within cutoff.
+ *
+ * The lists are reused across time steps until either a particle in
+ * the neighborhood has moved further than skin/2 since the lists
+ * were built, or particles entered, left, or were inserted into or
+ * removed from one of the surrounding boxes. Particle positions are
+ * kept in SoA form within each box so that the distance checks
+ * during list construction and the displacement checks are
+ * vectorizable.
+ *
+ * Cargo types need to provide getPos(). Unlike BoxCell this class
+ * can't be nested in a MultiContainerCell as the lists need access
+ * to the surrounding boxes' positions.
+ */
+template<typename CONTAINER>
+class VerletBoxCell : public BoxCell<CONTAINER>
+{
+public:
+    friend class VerletBoxCellTest;
+
+    typedef BoxCell<CONTAINER> ParentType;
+    typedef typename ParentType::Container Container;
+    typedef typename ParentType::Cargo Cargo;
+    typedef typename ParentType::Topology Topology;
+
+    const static int DIM = Topology::DIM;
+    const static int NUM_BOXES = Stencils::Moore<DIM, 1>::VOLUME;
+    const static int CENTER = NUM_BOXES / 2;
+
+    /**
+     * References particle number index in the neighboring box with
+     * the given number. Boxes are numbered in the order of a
+     * CoordBox iteration over the Moore neighborhood.
+     */
+    class Entry
+    {
+    public:
+        inline explicit Entry(int box = 0, int index = 0) :
+            box(box),
+            index(index)
+        {}
+
+        int box;
+        int index;
+    };
+
+    /**
+     * Iterates over all particles in a single Verlet list.
+     */
+    class ListIterator
+    {
+    public:
+        inline ListIterator(const VerletBoxCell *const *boxes, const Entry *entry) :
+            boxes(boxes),
+            entry(entry)
+        {}
+
+        inline const Cargo& operator*() const
+        {
+            return (*boxes[entry->box])[entry->index];
+        }
+
+        inline const Cargo *operator->() const
+        {
+            return &**this;
+        }
+
+        inline void operator++()
+        {
+            ++entry;
+        }
+
+        inline bool operator==(const ListIterator& other) const
+        {
+            return entry == other.entry;
+        }
+
+        inline bool operator!=(const ListIterator& other) const
+        {
+            return !(*this == other);
+        }
+
+    private:
+        const VerletBoxCell *const *boxes;
+        const Entry *entry;
+    };
+
+    /**
+     * This is what particles receive in update(). Its interface
+     * matches that of the NeighborhoodIterator::Adapter used by
+     * BoxCell.
+     */
+    class Neighborhood
+    {
+    public:
+        typedef ListIterator Iterator;
+
+        inline Neighborhood(
+            VerletBoxCell *target,
+            const VerletBoxCell *const *boxes,
+            const Entry *listBegin,
+            const Entry *listEnd) :
+            target(target),
+            myBegin(boxes, listBegin),
+            myEnd(boxes, listEnd)
+        {}
+
+        inline const Iterator& begin() const
+        {
+            return myBegin;
+        }
+
+        inline const Iterator& end() const
+        {
+            return myEnd;
+        }
+
+        template<typename PARTICLE>
+        void operator<<(const PARTICLE& particle)
+        {
+            target->particles << particle;
+        }
+
+    private:
+        VerletBoxCell *target;
+        Iterator myBegin;
+        Iterator myEnd;
+    };
+
+    inline explicit VerletBoxCell(
+        const FloatCoord<DIM>& origin = Coord<DIM>(),
+        const FloatCoord<DIM>& dimension = Coord<DIM>(),
+        const double cutoff = 0,
+        const double skin = 0) :
+        ParentType(origin, dimension),
+        cutoff(cutoff),
+        skin(skin),
+        version(0)
+    {}
+
+    inline void insert(const Cargo& particle)
+    {
+        *this << particle;
+    }
+
+    inline void remove(const std::size_t i)
+    {
+        ParentType::remove(i);
+        ++version;
+        updatePositions();
+    }
+
+    inline
+    VerletBoxCell& operator<<(const Cargo& particle)
+    {
+        particles << particle;
+        ++version;
+
+        FloatCoord<DIM> pos = particle.getPos();
+        for (int d = 0; d < DIM; ++d) {
+            positions[d] << pos[d];
+        }
+
+        return *this;
+    }
+
+    template<class HOOD>
+    inline void update(HOOD& hood, const int nanoStep)
+    {
+        typedef CollectionInterface::PassThrough<typename HOOD::Cell> PassThroughType;
+        typedef typename ParentType::template NeighborhoodAdapter<
+            ParentType, HOOD, PassThroughType>::Value NeighborhoodAdapterType;
+
+        const VerletBoxCell *boxes[NUM_BOXES];
+        CoordBox<DIM> box(Coord<DIM>::diagonal(-1), Coord<DIM>::diagonal(3));
+        int index = 0;
+        for (typename CoordBox<DIM>::Iterator i = box.begin(); i != box.end(); ++i) {
+            boxes[index++] = &hood[*i];
+        }
+        const VerletBoxCell& oldSelf = *boxes[CENTER];
+
+        NeighborhoodAdapterType adapter(this, &hood);
+        ParentType::copyOver(oldSelf, adapter, nanoStep);
+        cutoff = oldSelf.cutoff;
+        skin = oldSelf.skin;
+        version = oldSelf.version;
+        if (!sameParticles(oldSelf)) {
+            ++version;
+        }
+        updatePositions();
+
+        if (listsValid(oldSelf, boxes)) {
+            neighborVersions = oldSelf.neighborVersions;
+            snapshotOffsets  = oldSelf.snapshotOffsets;
+            listOffsets      = oldSelf.listOffsets;
+            listEntries      = oldSelf.listEntries;
+            for (int d = 0; d < DIM; ++d) {
+                snapshot[d] = oldSelf.snapshot[d];
+            }
+        } else {
+            rebuildLists(boxes);
+        }
+
+        // particles spawned by update() won't be updated in this
+        // step, just like with BoxCell:
+        std::size_t numParticles = particles.size();
+        for (std::size_t i = 0; i < numParticles; ++i) {
+            Neighborhood neighbors(
+                this,
+                boxes,
+                listEntries.data() + listOffsets[i],
+                listEntries.data() + listOffsets[i + 1]);
+            particles[i].update(neighbors, nanoStep);
+        }
+
+        if (particles.size() != numParticles) {
+            ++version;
+        }
+        updatePositions();
+    }
+
+    inline double getCutoff() const
+    {
+        return cutoff;
+    }
+
+    inline double getSkin() const
+    {
+        return skin;
+    }
+
+private:
+    using ParentType::particles;
+
+    double cutoff;
+    double skin;
+    // incremented whenever particles enter or leave this box, so
+    // that neighbors can detect whether their lists' indices are
+    // still valid:
+    std::size_t version;
+    std::vector<double> positions[DIM];
+
+    // state at the time the lists were built:
+    std::vector<std::size_t> neighborVersions;
+    std::vector<std::size_t> snapshotOffsets;
+    std::vector<double> snapshot[DIM];
+
+    // list of particle i is listEntries[listOffsets[i]] to
+    // listEntries[listOffsets[i + 1] - 1]:
+    std::vector<std::size_t> listOffsets;
+    std::vector<Entry> listEntries;
+
+    inline bool sameParticles(const VerletBoxCell& other) const
+    {
+        if (particles.size() != other.particles.size()) {
+            return false;
+        }
+
+        for (std::size_t i = 0; i < particles.size(); ++i) {
+            if (!(particles[i].getPos() == other.particles[i].getPos())) {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    inline void updatePositions()
+    {
+        for (int d = 0; d < DIM; ++d) {
+            positions[d].resize(particles.size());
+        }
+
+        for (std::size_t i = 0; i < particles.size(); ++i) {
+            FloatCoord<DIM> pos = particles[i].getPos();
+            for (int d = 0; d < DIM; ++d) {
+                positions[d][i] = pos[d];
+            }
+        }
+    }
+
+    /**
+     * Lists may be reused if no particles entered or left any box
+     * in the neighborhood and none has moved further than skin/2,
+     * as no pair of particles can then have closed in by more than
+     * skin.
+     */
+    inline bool listsValid(const VerletBoxCell& oldSelf, const VerletBoxCell *const *boxes) const
+    {
+        if ((version != oldSelf.version) ||
+            (oldSelf.listOffsets.size() != (particles.size() + 1))) {
+            return false;
+        }
+
+        for (int k = 0; k < NUM_BOXES; ++k) {
+            if (boxes[k]->version != oldSelf.neighborVersions[k]) {
+                return false;
+            }
+        }
+
+        double maxDisplacement2 = 0.25 * skin * skin;
+        std::vector<double> displacements2;
+
+        for (int k = 0; k < NUM_BOXES; ++k) {
+            std::size_t offset = oldSelf.snapshotOffsets[k];
+            std::size_t length = oldSelf.snapshotOffsets[k + 1] - offset;
+            if (boxes[k]->positions[0].size() != length) {
+                return false;
+            }
+
+            displacements2.assign(length, 0);
+            for (int d = 0; d < DIM; ++d) {
+                const double *current = boxes[k]->positions[d].data();
+                const double *old = oldSelf.snapshot[d].data() + offset;
+                for (std::size_t j = 0; j < length; ++j) {
+                    double delta = current[j] - old[j];
+                    displacements2[j] += delta * delta;
+                }
+            }
+
+            for (std::size_t j = 0; j < length; ++j) {
+                if (displacements2[j] >= maxDisplacement2) {
+                    return false;
+                }
+            }
+        }
+
+        return true;
+    }
+
+    inline void rebuildLists(const VerletBoxCell *const *boxes)
+    {
+        neighborVersions.clear();
+        snapshotOffsets.clear();
+        for (int d = 0; d < DIM; ++d) {
+            snapshot[d].clear();
+        }
+
+        snapshotOffsets << 0;
+        for (int k = 0; k < NUM_BOXES; ++k) {
+            neighborVersions << boxes[k]->version;
+            for (int d = 0; d < DIM; ++d) {
+                snapshot[d].insert(
+                    snapshot[d].end(),
+                    boxes[k]->positions[d].begin(),
+                    boxes[k]->positions[d].end());
+            }
+            snapshotOffsets << boxes[k]->positions[0].size();
+            snapshotOffsets.back() += snapshotOffsets[k];
+        }
+
+        double radius = cutoff + skin;
+        double radius2 = radius * radius;
+        std::vector<double> distances2;
+
+        listOffsets.clear();
+        listEntries.clear();
+        listOffsets << 0;
+
+        for (std::size_t i = 0; i < particles.size(); ++i) {
+            for (int k = 0; k < NUM_BOXES; ++k) {
+                std::size_t offset = snapshotOffsets[k];
+                std::size_t length = snapshotOffsets[k + 1] - offset;
+
+                distances2.assign(length, 0);
+                for (int d = 0; d < DIM; ++d) {
+                    double pos = positions[d][i];
+                    const double *other = snapshot[d].data() + offset;
+                    for (std::size_t j = 0; j < length; ++j) {
+                        double delta = other[j] - pos;
+                        distances2[j] += delta * delta;
+                    }
+                }
+
+                for (std::size_t j = 0; j < length; ++j) {
+                    if (distances2[j] < radius2) {
+                        listEntries << Entry(k, j);
+                    }
+                }
+            }
+
+            listOffsets << listEntries.size();
+        }
+    }
+};
+
+}
+
+#endif
@@ -8,12 +8,14 @@
 #include <libgeodecomp/geometry/region.h>
 #include <libgeodecomp/geometry/stencils.h>
 #include <libgeodecomp/geometry/partitions/hindexingpartition.h>
+#include <libgeodecomp/geometry/partitions/hilbertcurvepartition.h>
 #include <libgeodecomp/geometry/partitions/hilbertpartition.h>
 #include <libgeodecomp/geometry/partitions/stripingpartition.h>
 #include <libgeodecomp/geometry/partitions/zcurvepartition.h>
 #include <libgeodecomp/storage/grid.h>
 #include <libgeodecomp/storage/linepointerassembly.h>
 #include <libgeodecomp/storage/linepointerupdatefunctor.h>
+#include <libgeodecomp/storage/stencilexpressions.h>
 #include <libgeodecomp/storage/updatefunctor.h>
 #include <libgeodecomp/parallelization/openmpsimulator.h>
 #include <libgeodecomp/parallelization/serialsimulator.h>
@@ -1547,6 +1549,91 @@ public:
     }
 };
 
+class JacobiCellStencilExpression
+{
+public:
+    class API :
+        public APITraits::HasFixedCoordsOnlyUpdate,
+        public APITraits::HasUpdateLineX,
+        public APITraits::HasStencil<Stencils::VonNeumann<3, 1> >,
+        public APITraits::HasCubeTopology<3>,
+        public APITraits::HasSoA
+    {};
+
+    explicit JacobiCellStencilExpression(double t = 0) :
+        temp(t)
+    {}
+
+    template<typename HOOD_OLD, typename HOOD_NEW>
+    static void updateLineX(HOOD_OLD& hoodOld, int indexEnd,
+                            HOOD_NEW& hoodNew, int /* nanoStep */)
+    {
+        using StencilExpressions::neighbor;
+        typedef JacobiCellStencilExpression Cell;
+
+        StencilExpressions::updateLineX(
+            hoodOld, indexEnd, hoodNew, &Cell::temp,
+            (neighbor(FixedCoord< 0,  0, -1>(), &Cell::temp) +
+             neighbor(FixedCoord< 0, -1,  0>(), &Cell::temp) +
+             neighbor(FixedCoord<-1,  0,  0>(), &Cell::temp) +
+             neighbor(FixedCoord< 0,  0,  0>(), &Cell::temp) +
+             neighbor(FixedCoord< 1,  0,  0>(), &Cell::temp) +
+             neighbor(FixedCoord< 0,  1,  0>(), &Cell::temp) +
+             neighbor(FixedCoord< 0,  0,  1>(), &Cell::temp)) * (1.0 / 7.0));
+    }
+
+    double temp;
+};
+
+LIBFLATARRAY_REGISTER_SOA(
+    JacobiCellStencilExpression,
+    ((double)(temp))
+                          )
+
+class Jacobi3DStencilExpression : public CPUBenchmark
+{
+public:
+    std::string family()
+    {
+        return "Jacobi3D";
+    }
+
+    std::string species()
+    {
+        return "short_vec";
+    }
+
+    double performance(std::vector<int> rawDim)
+    {
+        Coord<3> dim(rawDim[0], rawDim[1], rawDim[2]);
+        int maxT = 20;
+        SerialSimulator<JacobiCellStencilExpression> sim(
+            new NoOpInitializer<JacobiCellStencilExpression>(dim, maxT));
+
+        double seconds = 0;
+        {
+            ScopedTimer t(&seconds);
+
+            sim.run();
+        }
+
+        if (sim.getGrid()->get(Coord<3>(1, 1, 1)).temp == 4711) {
+            std::cout << "this statement just serves to prevent the compiler from"
+                      << "optimizing away the loops above\n";
+        }
+
+        double updates = 1.0 * maxT * dim.prod();
+        double gLUPS = 1e-9 * updates / seconds;
+
+        return gLUPS;
+    }
+
+    std::string unit()
+    {
+        return "GLUPS";
+    }
+};
+
 class LBMCell
 {
 public:
@@ -2073,7 +2160,7 @@ public:
     }
 };
 
-template<class PARTITION>
+template<class PARTITION, int DIM = 2>
 class PartitionBenchmark : public CPUBenchmark
 {
 public:
@@ -2093,22 +2180,27 @@ public:
 
     double performance(std::vector<int> rawDim)
     {
-        Coord<3> dim(rawDim[0], rawDim[1], rawDim[2]);
+        Coord<DIM> realDim;
+        Coord<DIM> origin;
+        for (int d = 0; d < DIM; ++d) {
+            realDim[d] = rawDim[d];
+            origin[d] = 100 * (d + 1);
+        }
+
         double duration = 0;
-        Coord<2> accu;
-        Coord<2> realDim(dim.x(), dim.y());
+        Coord<DIM> accu;
 
         {
             ScopedTimer t(&duration);
 
-            PARTITION h(Coord<2>(100, 200), realDim);
+            PARTITION h(origin, realDim);
             typename PARTITION::Iterator end = h.end();
             for (typename PARTITION::Iterator i = h.begin(); i != end; ++i) {
                 accu += *i;
             }
         }
 
-        if (accu == Coord<2>()) {
+        if (accu == Coord<DIM>()) {
             throw std::runtime_error("oops, partition iteration went bad!");
         }
 
@@ -3016,6 +3108,10 @@ int main(int argc, char **argv)
         eval(Jacobi3DStreakUpdateFunctor(), toVector(sizes[i]));
     }
 
+    for (std::size_t i = 0; i < sizes.size(); ++i) {
+        eval(Jacobi3DStencilExpression(), toVector(sizes[i]));
+    }
+
     sizes.clear();
     sizes << Coord<3>(22, 22, 22)
           << Coord<3>(64, 64, 64)
@@ -3034,10 +3130,15 @@ int main(int argc, char **argv)
     }
 
     std::vector<int> dim = toVector(Coord<3>(32 * 1024, 32 * 1024, 1));
-    eval(PartitionBenchmark<HIndexingPartition   >("PartitionHIndexing"), dim);
-    eval(PartitionBenchmark<StripingPartition<2> >("PartitionStriping"),  dim);
-    eval(PartitionBenchmark<HilbertPartition     >("PartitionHilbert"),   dim);
-    eval(PartitionBenchmark<ZCurvePartition<2>   >("PartitionZCurve"),    dim);
+    eval(PartitionBenchmark<HIndexingPartition       >("PartitionHIndexing"),    dim);
+    eval(PartitionBenchmark<StripingPartition<2>     >("PartitionStriping"),     dim);
+    eval(PartitionBenchmark<HilbertPartition         >("PartitionHilbert"),      dim);
+    eval(PartitionBenchmark<ZCurvePartition<2>       >("PartitionZCurve"),       dim);
+    eval(PartitionBenchmark<HilbertCurvePartition<2> >("PartitionHilbertCurve"), dim);
+
+    dim = toVector(Coord<3>(512, 512, 512));
+    eval(PartitionBenchmark<ZCurvePartition<3>,       3>("PartitionZCurve"),       dim);
+    eval(PartitionBenchmark<HilbertCurvePartition<3>, 3>("PartitionHilbertCurve"), dim);
 
     dim = toVector(Coord<3>(10000, 2000, 0));
     eval(UpdateFunctorThreadingSilver(), dim);
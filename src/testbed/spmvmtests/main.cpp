@@ -17,6 +17,7 @@
 #include <libgeodecomp/misc/chronometer.h>
 #include <libgeodecomp/geometry/coord.h>
 #include <libgeodecomp/geometry/region.h>
+#include <libgeodecomp/storage/reorderingunstructuredgrid.h>
 #include <libgeodecomp/storage/unstructuredgrid.h>
 #include <libgeodecomp/storage/unstructuredneighborhood.h>
 #include <libgeodecomp/storage/unstructuredsoagrid.h>
@@ -39,6 +40,7 @@
 #include <stdio.h>
 #include <cstdlib>
 #include <sstream>
+#include <type_traits>
 #include <vector>
 #include <map>
 
@@ -65,7 +67,25 @@ static const int C = 16;
 static const int C = 4;
 #endif
 
-template<int SIGMA>
+/**
+ * Lets SPMVMSoACell opt into the bandwidth-reducing reordering of
+ * ReorderingUnstructuredGrid, see
+ * APITraits::HasSellLocalityReordering.
+ */
+class SPMVMLocalityReorderingAPI :
+        public APITraits::HasSellType<double>,
+        public APITraits::HasSellLocalityReordering
+{};
+
+/**
+ * Additionally stores the weights in single precision.
+ */
+class SPMVMCompressedAPI :
+        public SPMVMLocalityReorderingAPI,
+        public APITraits::HasSellWeightStorage<float>
+{};
+
+template<int SIGMA, typename SELL_API = APITraits::HasSellType<double> >
 class SPMVMSoACell
 {
 public:
@@ -73,7 +93,7 @@ public:
         public APITraits::HasSoA,
         public APITraits::HasUpdateLineX,
         public APITraits::HasUnstructuredTopology,
-        public APITraits::HasSellType<double>,
+        public SELL_API,
         public APITraits::HasSellMatrices<1>,
         public APITraits::HasSellC<C>,
         public APITraits::HasSellSigma<SIGMA>,
@@ -154,6 +174,11 @@ LIBFLATARRAY_REGISTER_SOA(SPMVMSoACell<65536>, ((double)(sum))((double)(value)))
 LIBFLATARRAY_REGISTER_SOA(SPMVMSoACell<131072>, ((double)(sum))((double)(value)))
 LIBFLATARRAY_REGISTER_SOA(SPMVMSoACell<262144>, ((double)(sum))((double)(value)))
 
+typedef SPMVMSoACell<32, SPMVMLocalityReorderingAPI> SPMVMSoACellRCM32;
+LIBFLATARRAY_REGISTER_SOA(SPMVMSoACellRCM32, ((double)(sum))((double)(value)))
+typedef SPMVMSoACell<32, SPMVMCompressedAPI> SPMVMSoACellCompressed32;
+LIBFLATARRAY_REGISTER_SOA(SPMVMSoACellCompressed32, ((double)(sum))((double)(value)))
+
 #define SPMVM_TESTS(METHOD, MATRIX)                                     \
     do {                                                                \
         eval(METHOD<SPMVMSoACell<1     >, MATRIX, NZ, 1>(), toVector(Coord<3>(DIM, 1, 1))); \
@@ -411,6 +436,74 @@ public:
     }
 };
 
+/**
+ * Runs the matrix through ReorderingUnstructuredGrid so that the
+ * effect of the locality reordering (selected via the CELL's API) on
+ * the gather performance can be compared with the plain SELL-C-SIGMA
+ * ordering.
+ */
+template<typename CELL, std::string& FILENAME, int NZ, int SIGMA>
+class SparseMatrixVectorMultiplicationMMReordered : public CPUBenchmark
+{
+private:
+    typedef ReorderingUnstructuredGrid<UnstructuredSoAGrid<CELL, 1, double, C, SIGMA> > Grid;
+
+public:
+    virtual std::string family()
+    {
+        std::stringstream ss;
+        ss << "SPMVM reordered: C:" << C << " SIGMA:" << SIGMA << " RCM:"
+           << (bool(typename APITraits::SelectSellLocalityReordering<CELL>::Value()) ? "yes" : "no")
+           << " float weights:"
+           << (std::is_same<typename APITraits::SelectSellWeightStorage<CELL>::Value, float>::value ? "yes" : "no");
+        return ss.str();
+    }
+
+    virtual std::string species()
+    {
+        return FILENAME;
+    }
+
+    virtual double performance(std::vector<int> rawDim)
+    {
+        Coord<3> dim(rawDim[0], rawDim[1], rawDim[2]);
+        // 1. create grids
+        Region<1> region;
+        region << Streak<1>(Coord<1>(0), dim.x());
+        Grid gridOld(region);
+
+        // 2. init grid old, grid new inherits its node ordering
+        const int maxT = 1;
+        SparseMatrixInitializerMM<CELL, Grid> init(FILENAME, dim, maxT);
+        init.grid(&gridOld);
+        Grid gridNew = gridOld;
+
+        // 3. call updateFunctor()
+        double seconds = 0;
+        UnstructuredUpdateFunctor<CELL> updateFunctor;
+        UpdateFunctorHelpers::ConcurrencyEnableOpenMP concurrencySpec(true, true);
+        typename APITraits::SelectThreadedUpdate<CELL>::Value threadedUpdateSpec;
+        {
+            ScopedTimer t(&seconds);
+            updateFunctor(region, gridOld, &gridNew, 0, concurrencySpec, threadedUpdateSpec);
+        }
+
+        if (gridNew.get(Coord<1>(1)).sum == 4711) {
+            std::cout << "this statement just serves to prevent the compiler from"
+                      << "optimizing away the loops above\n";
+        }
+
+        const double numOps = 2. * static_cast<double>(NZ);
+        const double gflops = 1.0e-9 * numOps / seconds;
+        return gflops;
+    }
+
+    std::string unit()
+    {
+        return "GFLOP/s";
+    }
+};
+
 #ifdef __AVX__
 template<typename CELL, std::string& FILENAME, int NZ, int SIGMA>
 class SparseMatrixVectorMultiplicationMMNative : public CPUBenchmark
@@ -906,6 +999,9 @@ int main(int argc, char **argv)
         const int DIM = 2063494;
 
         SPMVM_TESTS(SparseMatrixVectorMultiplicationMM, KKT);
+        eval(SparseMatrixVectorMultiplicationMMReordered<SPMVMSoACell<32>, KKT, NZ, 32>(), toVector(Coord<3>(DIM, 1, 1)));
+        eval(SparseMatrixVectorMultiplicationMMReordered<SPMVMSoACellRCM32, KKT, NZ, 32>(), toVector(Coord<3>(DIM, 1, 1)));
+        eval(SparseMatrixVectorMultiplicationMMReordered<SPMVMSoACellCompressed32, KKT, NZ, 32>(), toVector(Coord<3>(DIM, 1, 1)));
 
 #ifdef __AVX__
         SPMVM_TESTS(SparseMatrixVectorMultiplicationMMNative, KKT);
@@ -924,6 +1020,9 @@ int main(int argc, char **argv)
         const int DIM = 1447360;
 
         SPMVM_TESTS(SparseMatrixVectorMultiplicationMM, HAM);
+        eval(SparseMatrixVectorMultiplicationMMReordered<SPMVMSoACell<32>, HAM, NZ, 32>(), toVector(Coord<3>(DIM, 1, 1)));
+        eval(SparseMatrixVectorMultiplicationMMReordered<SPMVMSoACellRCM32, HAM, NZ, 32>(), toVector(Coord<3>(DIM, 1, 1)));
+        eval(SparseMatrixVectorMultiplicationMMReordered<SPMVMSoACellCompressed32, HAM, NZ, 32>(), toVector(Coord<3>(DIM, 1, 1)));
 
 #ifdef __AVX__
         SPMVM_TESTS(SparseMatrixVectorMultiplicationMMNative, HAM);
@@ -942,6 +1041,9 @@ int main(int argc, char **argv)
         const int DIM = 1504002;
 
         SPMVM_TESTS(SparseMatrixVectorMultiplicationMM, ML);
+        eval(SparseMatrixVectorMultiplicationMMReordered<SPMVMSoACell<32>, ML, NZ, 32>(), toVector(Coord<3>(DIM, 1, 1)));
+        eval(SparseMatrixVectorMultiplicationMMReordered<SPMVMSoACellRCM32, ML, NZ, 32>(), toVector(Coord<3>(DIM, 1, 1)));
+        eval(SparseMatrixVectorMultiplicationMMReordered<SPMVMSoACellCompressed32, ML, NZ, 32>(), toVector(Coord<3>(DIM, 1, 1)));
 
 #ifdef __AVX__
         SPMVM_TESTS(SparseMatrixVectorMultiplicationMMNative, ML);